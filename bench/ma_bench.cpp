@@ -0,0 +1,724 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_bench.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Benchmarks of the public functions of the Api on the host
+  *               build, written as JSON
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "ma_host.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_dns.h"
+#include "ma_api_wifi_http.h"
+#include "ma_api_wifi_profiles.h"
+#include "ma_api_wifi_scan.h"
+#include "ma_api_wifi_storage.h"
+#include "ma_api_wifi_stream.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	"ma_bench [--quick] [file.json]" runs every benchmark and writes the
+    results to the file, or to stdout. --quick runs 1/100 of the
+    iterations, used by ctest to check the benchmarks still run.
+
+2.  For each benchmark the JSON gives the iterations and, per call:
+      - ns_per_op: wall time of the PC, compare runs of the same PC only
+      - allocations_per_op and bytes_allocated_per_op: operator new and
+        String buffers
+      - bytes_copied_per_op: memcpy() and memmove(), the library is linked
+        with -Wl,--wrap for them
+      - device_us_per_op: time of the virtual clock, the costs of the
+        simulated radio, NVS and SPIFFS (ma_host_nvs_set_costs(),
+        ma_host_fs_set_costs())
+      - flash_writes_per_op: NVS putBytes() and SPIFFS files written, the
+        wear of the flash
+      - bytes_per_us: bytes of input per microsecond of the PC, for the
+        cases that parse a request only
+    On the device the heap and the copies are the same, the time is not.
+
+3.  The "stStorageBackend*" benchmarks call one backend alone, the
+    "ma_api_wifi_storage_*" ones the whole chain with its write-through.
+
+4.  The "baseline" benchmarks run copies of the code of the first version
+    on the same input, as the reference of the case listed just before:
+    the String loop that read the request header char by char, and the
+    ma_api_wifi_get_token() that cut the fields out with indexOf() and
+    substring(). That loop stopped at the blank line, the body was never
+    read, so its POST row covers the header only.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_BENCH_SPIFFS_ROOT            "/tmp/ma_bench_XXXXXX"
+#define DF_BENCH_POST_BODY_LENGTH       47      // Content-Length of cBenchPostRequest
+
+/* Private typedef -----------------------------------------------------------*/
+typedef void (*bench_function_t)(void);
+
+typedef struct {
+  const char *name;                 // Public function measured, and its input
+  bench_function_t function;        // One call
+  uint32_t iterations;
+  size_t inputBytes;                // Bytes parsed per call, 0 when bytes_per_us means nothing
+}st_bench_case_t;
+
+// Output of ma_api_wifi_stream_*, thrown away as a socket with room would take it
+class BenchNullOutput : public Print
+{
+public:
+    size_t write(uint8_t in_byte) override { (void)in_byte; return 1; }
+    size_t write(const uint8_t *in_buffer, size_t in_size) override { (void)in_buffer; return in_size; }
+};
+
+/* Private variables ---------------------------------------------------------*/
+static const char cBenchGetRequest[] =
+    "GET /status.json HTTP/1.1\r\n"
+    "Host: 192.168.123.123\r\n"
+    "User-Agent: Mozilla/5.0 (Linux; Android 14) AppleWebKit/537.36 Chrome/126.0 Mobile Safari/537.36\r\n"
+    "Accept: application/json\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "If-None-Match: \"5d41402a\"\r\n"
+    "\r\n";
+
+static const char cBenchPostRequest[] =
+    "POST /save_data HTTP/1.1\r\n"
+    "Host: 192.168.123.123\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\n"
+    "Content-Length: 47\r\n"
+    "\r\n"
+    "ssid=My+Home%20Net&password=p%40ss+w0rd%21&x=1";
+
+static const char cBenchForm[] = "ssid=My+Home%20Net&password=p%40ss+w0rd%21&priority=120&x=1";
+
+// A query for "connectivitycheck.gstatic.com", as an Android phone sends after joining the portal
+static const uint8_t u8BenchDnsQuery[] = {
+    0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    17, 'c', 'o', 'n', 'n', 'e', 'c', 't', 'i', 'v', 'i', 't', 'y', 'c', 'h', 'e', 'c', 'k',
+    7, 'g', 's', 't', 'a', 't', 'i', 'c', 3, 'c', 'o', 'm', 0,
+    0x00, 0x01, 0x00, 0x01};
+
+static const uint8_t u8BenchPortalIp[4] = {192, 168, 123, 123};
+
+static st_wifi_http_request_t stBenchRequest;
+static st_wifi_profile_store_t stBenchStore;
+static st_wifi_scan_result_t stBenchResults[DF_WIFI_SCAN_CACHE_SIZE];
+static st_wifi_scan_cache_t stBenchScanCache;
+static st_wifi_stream_t stBenchStream;
+static BenchNullOutput clsBenchOutput;
+static uint8_t u8BenchBody[4096];
+static uint8_t u8BenchRecord[sizeof(st_wifi_profile_store_t)];
+static uint8_t u8BenchDnsMessage[512];
+static volatile uint32_t u32BenchSink = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static void bench_http_parse_get(void);
+static void bench_http_parse_post(void);
+static void bench_http_etag_matches(void);
+static void bench_form_decode(void);
+static void bench_baseline_header_get(void);
+static void bench_baseline_header_post(void);
+static void bench_baseline_get_token(void);
+static void bench_baseline_header_loop(const char *in_text, size_t in_length);
+static void bench_baseline_extract(const String &in_params, const char *in_key, String *out_value);
+static void bench_profiles_rank(void);
+static void bench_scan_fill(void);
+static void bench_stream_small_body(void);
+static void bench_stream_chunked_body(void);
+static void bench_storage_crc32(void);
+static void bench_storage_write(void);
+static void bench_storage_read(void);
+static void bench_rtc_write(void);
+static void bench_rtc_read(void);
+static void bench_nvs_write(void);
+static void bench_nvs_read(void);
+static void bench_spiffs_write(void);
+static void bench_spiffs_read(void);
+static void bench_backend_write(const st_wifi_storage_backend_t *in_backend, const char *in_name);
+static void bench_backend_read(const st_wifi_storage_backend_t *in_backend, const char *in_name);
+static uint32_t bench_flash_writes(void);
+static void bench_dns_build_answer(void);
+static void bench_credential_set(void);
+static void bench_profile_list(void);
+static void bench_portal_get(void);
+static void bench_portal_keep_alive(void);
+static void bench_load_request(st_wifi_http_request_t *io_request, const char *in_text, size_t in_length);
+static void bench_fill_profiles(void);
+static void bench_exchange(st_host_socket_t *io_socket, const char *in_request, bool in_untilClosed);
+static void bench_write_result(FILE *io_output, const st_bench_case_t *in_case, double in_ns, const st_host_stats_t *in_before, const st_host_stats_t *in_after,
+                               uint64_t in_deviceUs, uint32_t in_flashWrites, bool in_last);
+
+/* Private objects -----------------------------------------------------------*/
+static const st_bench_case_t stBenchCases[] = {
+    {"ma_api_wifi_http_parse/get_6_headers",            bench_http_parse_get,           200000,     sizeof(cBenchGetRequest) - 1},
+    {"baseline/string_header_loop/get_6_headers",       bench_baseline_header_get,      200000,     sizeof(cBenchGetRequest) - 1},
+    {"ma_api_wifi_http_parse/post_form",                bench_http_parse_post,          200000,     sizeof(cBenchPostRequest) - 1},
+    {"baseline/string_header_loop/post_form",           bench_baseline_header_post,     200000,     sizeof(cBenchPostRequest) - 1 - DF_BENCH_POST_BODY_LENGTH},
+    {"ma_api_wifi_http_etag_matches",                   bench_http_etag_matches,        1000000},
+    {"ma_api_wifi_form_decode/4_fields",                bench_form_decode,              500000},
+    {"baseline/ma_api_wifi_get_token/4_fields",         bench_baseline_get_token,       500000},
+    {"ma_api_wifi_profiles_rank/4_profiles_16_results", bench_profiles_rank,            500000},
+    {"ma_api_wifi_scan_add/16_networks",                bench_scan_fill,                200000},
+    {"ma_api_wifi_stream_write/content_length_200",     bench_stream_small_body,        500000},
+    {"ma_api_wifi_stream_write/chunked_4096",           bench_stream_chunked_body,      100000},
+    {"ma_api_wifi_storage_crc32/profile_store",         bench_storage_crc32,            500000},
+    {"ma_api_wifi_storage_write/profile_store",         bench_storage_write,            2000},
+    {"ma_api_wifi_storage_read/profile_store",          bench_storage_read,             20000},
+    {"stStorageBackendRtc.write/profile_store",         bench_rtc_write,                20000},
+    {"stStorageBackendRtc.read/profile_store",          bench_rtc_read,                 20000},
+    {"stStorageBackendNvs.write/profile_store",         bench_nvs_write,                2000},
+    {"stStorageBackendNvs.read/profile_store",          bench_nvs_read,                 20000},
+    {"stStorageBackendSpiffs.write/profile_store",      bench_spiffs_write,             2000},
+    {"stStorageBackendSpiffs.read/profile_store",       bench_spiffs_read,              20000},
+    {"ma_api_wifi_dns_build_answer",                    bench_dns_build_answer,         1000000},
+    {"ma_api_wifi_credential_set",                      bench_credential_set,           1000000},
+    {"ma_api_wifi_profile_list",                        bench_profile_list,             200000},
+    {"ma_api_wifi_portal_poll/get_page_close",          bench_portal_get,               5000},
+    {"ma_api_wifi_portal_poll/status_keep_alive",       bench_portal_keep_alive,        20000},
+};
+
+/* Body of public functions --------------------------------------------------*/
+int main(int argc, char **argv)
+{
+    bool quick = false;
+    const char *path = NULL;
+    FILE *output = stdout;
+    char root[] = DF_BENCH_SPIFFS_ROOT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            quick = true;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path != NULL && (output = fopen(path, "w")) == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    if (mkdtemp(root) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    ma_host_fs_set_root(root);
+    ma_host_reset();
+
+    bench_fill_profiles();
+    for (size_t i = 0; i < sizeof(u8BenchBody); i++)
+    {
+        u8BenchBody[i] = (uint8_t)('a' + i % 26);
+    }
+    memcpy(u8BenchRecord, &stBenchStore, sizeof(u8BenchRecord));
+    ma_api_wifi_storage_write("bench", 0x42454E43, 1, u8BenchRecord, sizeof(u8BenchRecord));
+
+    st_wifi_credential_t apCredential;
+    memset(&apCredential, 0, sizeof(apCredential));
+    ma_api_wifi_setup_access_point(apCredential);
+
+    const size_t caseCount = sizeof(stBenchCases) / sizeof(stBenchCases[0]);
+    fprintf(output, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < caseCount; i++)
+    {
+        st_bench_case_t benchCase = stBenchCases[i];
+        st_host_stats_t before;
+        st_host_stats_t after;
+
+        benchCase.iterations = quick ? (benchCase.iterations + 99) / 100 : benchCase.iterations;
+        benchCase.function();               // Warm up, first allocations of the Api are not counted
+        ma_host_get_stats(&before);
+        uint64_t deviceStartUs = ma_host_clock_us();
+        uint32_t flashWrites = bench_flash_writes();
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t n = 0; n < benchCase.iterations; n++)
+        {
+            benchCase.function();
+        }
+        auto stop = std::chrono::steady_clock::now();
+        ma_host_get_stats(&after);
+
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        bench_write_result(output, &benchCase, ns, &before, &after, ma_host_clock_us() - deviceStartUs,
+                           bench_flash_writes() - flashWrites, i + 1 == caseCount);
+    }
+    fprintf(output, "  ]\n}\n");
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+    ma_host_fs_erase();
+    rmdir(root);
+    return 0;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : bench_write_result
+  * @brief      : Writes the JSON object of one benchmark
+  * @pre-cond.  : The "benchmarks" array is open
+  * @post-cond. : None
+  * @parameters :
+  *       - io_output: JSON file
+  *       - in_case: Benchmark, with the iterations run
+  *       - in_ns: Time of all the iterations
+  *       - in_before, in_after: Host counters around the iterations
+  *       - in_deviceUs: Time of the virtual clock of all the iterations
+  *       - in_flashWrites: NVS and SPIFFS writes of all the iterations
+  *       - in_last: No comma after the object
+  * @retval     : None
+  */
+static void bench_write_result(FILE *io_output, const st_bench_case_t *in_case, double in_ns, const st_host_stats_t *in_before, const st_host_stats_t *in_after,
+                               uint64_t in_deviceUs, uint32_t in_flashWrites, bool in_last)
+{
+    double iterations = (double)in_case->iterations;
+
+    fprintf(io_output,
+            "    {\"name\": \"%s\", \"iterations\": %u, \"ns_per_op\": %.1f, "
+            "\"allocations_per_op\": %.3f, \"bytes_allocated_per_op\": %.1f, \"bytes_copied_per_op\": %.1f, "
+            "\"device_us_per_op\": %.1f, \"flash_writes_per_op\": %.3f",
+            in_case->name, (unsigned)in_case->iterations, in_ns / iterations,
+            (double)(in_after->allocations - in_before->allocations) / iterations,
+            (double)(in_after->bytesAllocated - in_before->bytesAllocated) / iterations,
+            (double)(in_after->bytesCopied - in_before->bytesCopied) / iterations,
+            (double)in_deviceUs / iterations, (double)in_flashWrites / iterations);
+    if (in_case->inputBytes > 0)
+    {
+        fprintf(io_output, ", \"bytes_per_us\": %.1f", (double)in_case->inputBytes * iterations * 1000.0 / in_ns);
+    }
+    fprintf(io_output, "}%s\n", in_last ? "" : ",");
+}
+
+/**
+  * @Func       : bench_flash_writes
+  * @brief      : Writes to the flash so far, the NVS and the SPIFFS ones
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Number of writes
+  */
+static uint32_t bench_flash_writes(void)
+{
+    st_host_nvs_stats_t nvs;
+    st_host_fs_stats_t fs;
+
+    ma_host_nvs_get_stats(&nvs);
+    ma_host_fs_get_stats(&fs);
+    return nvs.writes + fs.writes;
+}
+
+/**
+  * @Func       : bench_load_request
+  * @brief      : Puts a request in the receive buffer and parses it, as the portal does after a read
+  * @pre-cond.  : in_length fits in DF_HTTP_MAX_REQUEST_SIZE
+  * @post-cond. : The request is parsed
+  * @parameters :
+  *       - io_request: Request
+  *       - in_text, in_length: Bytes received
+  * @retval     : None
+  */
+static void bench_load_request(st_wifi_http_request_t *io_request, const char *in_text, size_t in_length)
+{
+    uint16_t space = 0;
+
+    ma_api_wifi_http_reset(io_request);
+    char *buffer = ma_api_wifi_http_get_rx_buffer(io_request, &space);
+    for (size_t i = 0; i < in_length; i++)      // As the socket would, not counted as a copy of the Api
+    {
+        buffer[i] = in_text[i];
+    }
+    u32BenchSink += ma_api_wifi_http_parse(io_request, (uint16_t)in_length);
+}
+
+static void bench_http_parse_get(void)
+{
+    bench_load_request(&stBenchRequest, cBenchGetRequest, sizeof(cBenchGetRequest) - 1);
+}
+
+static void bench_http_parse_post(void)
+{
+    bench_load_request(&stBenchRequest, cBenchPostRequest, sizeof(cBenchPostRequest) - 1);
+}
+
+static void bench_http_etag_matches(void)
+{
+    static bool loaded = false;
+    if (!loaded)
+    {
+        bench_load_request(&stBenchRequest, cBenchGetRequest, sizeof(cBenchGetRequest) - 1);
+        loaded = true;
+    }
+    u32BenchSink += ma_api_wifi_http_etag_matches(&stBenchRequest, "\"5d41402a\"") ? 1 : 0;
+}
+
+static void bench_form_decode(void)
+{
+    char ssid[33];
+    char password[65];
+    char priority[4];
+    char other[8];
+    st_wifi_form_field_t fields[] = {
+        {"ssid", ssid, sizeof(ssid), -1},
+        {"password", password, sizeof(password), -1},
+        {"priority", priority, sizeof(priority), -1},
+        {"x", other, sizeof(other), -1}};
+
+    u32BenchSink += ma_api_wifi_form_decode(cBenchForm, sizeof(cBenchForm) - 1, fields, 4);
+}
+
+static void bench_baseline_header_get(void)
+{
+    bench_baseline_header_loop(cBenchGetRequest, sizeof(cBenchGetRequest) - 1);
+}
+
+static void bench_baseline_header_post(void)
+{
+    bench_baseline_header_loop(cBenchPostRequest, sizeof(cBenchPostRequest) - 1);
+}
+
+/**
+  * @Func       : bench_baseline_header_loop
+  * @brief      : The receive loop of the first ma_api_wifi_process_client_request(): each char is added to
+  *               the header and to the current line, until a blank line ends the header
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_text, in_length: Bytes received, read one at a time as from WiFiClient::read()
+  * @retval     : None
+  */
+static void bench_baseline_header_loop(const char *in_text, size_t in_length)
+{
+    String header = "";
+    String currentLine = "";
+
+    for (size_t i = 0; i < in_length; i++)
+    {
+        char c = in_text[i];
+        header += c;
+        if (c == '\n')
+        {
+            if (currentLine.length() == 0)
+            {
+                break;
+            }
+            currentLine = "";
+        }
+        else if (c != '\r')
+        {
+            currentLine += c;
+        }
+    }
+    u32BenchSink += header.length();
+}
+
+/**
+  * @Func       : bench_baseline_get_token
+  * @brief      : The first ma_api_wifi_get_token(): the header String taken by value, the parameters cut
+  *               after the '?' and each field cut up to the first delimiter. No percent-decoding.
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+static void bench_baseline_get_token(void)
+{
+    static const String header = String("GET /save_data?") + cBenchForm + " HTTP/1.1\r\n";
+    String ssid;
+    String password;
+
+    // By value, as the String parameter of the first version
+    String in_header = header;
+    int index = in_header.indexOf('?');
+    if (index != -1)
+    {
+        String params = in_header.substring(index + 1);
+        bench_baseline_extract(params, "ssid=", &ssid);
+        bench_baseline_extract(params, "password=", &password);
+    }
+    u32BenchSink += ssid.length() + password.length();
+}
+
+/**
+  * @Func       : bench_baseline_extract
+  * @brief      : One field of the first ma_api_wifi_get_token(), with its five indexOf() for the delimiters
+  * @pre-cond.  : None
+  * @post-cond. : out_value is set if the key is found
+  * @parameters :
+  *       - in_params: Parameters after the '?'
+  *       - in_key: Key with its '='
+  *       - out_value: Value
+  * @retval     : None
+  */
+static void bench_baseline_extract(const String &in_params, const char *in_key, String *out_value)
+{
+    int keyIndex = in_params.indexOf(in_key);
+    if (keyIndex == -1)
+    {
+        return;
+    }
+
+    int delimiterIndex[5];
+    delimiterIndex[0] = in_params.indexOf('&', keyIndex);
+    delimiterIndex[1] = in_params.indexOf(' ', keyIndex);
+    delimiterIndex[2] = in_params.indexOf('\n', keyIndex);
+    delimiterIndex[3] = in_params.indexOf('\r', keyIndex);
+    delimiterIndex[4] = in_params.indexOf('/', keyIndex);
+    int endIndex = in_params.length();
+    for (int i = 0; i < 5; i++)
+    {
+        if (delimiterIndex[i] != -1 && delimiterIndex[i] < endIndex)
+        {
+            endIndex = delimiterIndex[i];
+        }
+    }
+
+    String value = in_params.substring(keyIndex + strlen(in_key), endIndex);
+    if (value.length() > 0 && value[value.length() - 1] == '\r')
+    {
+        value[value.length() - 1] = '\0';
+    }
+    *out_value = value;
+}
+
+/**
+  * @Func       : bench_fill_profiles
+  * @brief      : Fills the store and the scan results of the ranking benchmarks
+  * @pre-cond.  : None
+  * @post-cond. : 4 profiles, 2 with the same priority; 16 results, 3 of them saved networks
+  * @parameters : None
+  * @retval     : None
+  */
+static void bench_fill_profiles(void)
+{
+    static const char *const ssids[] = {"Home", "Office", "Phone hotspot", "Cafe"};
+    static const uint8_t priorities[] = {120, 100, 100, 80};
+
+    ma_api_wifi_profiles_clear(&stBenchStore);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        ma_api_wifi_profiles_add(&stBenchStore, ssids[i], strlen(ssids[i]), "password1", 9, priorities[i]);
+    }
+    ma_api_wifi_profiles_mark_success(&stBenchStore, 1);
+
+    for (uint8_t i = 0; i < DF_WIFI_SCAN_CACHE_SIZE; i++)
+    {
+        snprintf(stBenchResults[i].ssid, sizeof(stBenchResults[i].ssid), "Neighbour %u", (unsigned)i);
+        stBenchResults[i].rssi = (int8_t)(-40 - 3 * i);
+        stBenchResults[i].secure = 1;
+    }
+    strcpy(stBenchResults[5].ssid, "Office");
+    strcpy(stBenchResults[9].ssid, "Phone hotspot");
+    strcpy(stBenchResults[12].ssid, "Home");
+}
+
+static void bench_profiles_rank(void)
+{
+    uint8_t order[DF_WIFI_MAX_PROFILES];
+    u32BenchSink += ma_api_wifi_profiles_rank(&stBenchStore, stBenchResults, DF_WIFI_SCAN_CACHE_SIZE, order);
+}
+
+static void bench_scan_fill(void)
+{
+    ma_api_wifi_scan_clear(&stBenchScanCache);
+    ma_api_wifi_scan_begin(&stBenchScanCache, 1000);
+    for (uint8_t i = 0; i < DF_WIFI_SCAN_CACHE_SIZE; i++)
+    {
+        const char *ssid = stBenchResults[i].ssid;
+        ma_api_wifi_scan_add(&stBenchScanCache, ssid, strlen(ssid), stBenchResults[i].rssi, true);
+    }
+    ma_api_wifi_scan_done(&stBenchScanCache, 3200);
+}
+
+static void bench_stream_small_body(void)
+{
+    ma_api_wifi_stream_begin(&stBenchStream, &clsBenchOutput);
+    ma_api_wifi_stream_print(&stBenchStream, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n");
+    ma_api_wifi_stream_start_body(&stBenchStream);
+    ma_api_wifi_stream_write(&stBenchStream, u8BenchBody, 200);
+    ma_api_wifi_stream_end(&stBenchStream);
+}
+
+static void bench_stream_chunked_body(void)
+{
+    ma_api_wifi_stream_begin(&stBenchStream, &clsBenchOutput);
+    ma_api_wifi_stream_print(&stBenchStream, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n");
+    ma_api_wifi_stream_start_body(&stBenchStream);
+    for (size_t offset = 0; offset < sizeof(u8BenchBody); offset += 64)
+    {
+        ma_api_wifi_stream_write(&stBenchStream, u8BenchBody + offset, 64);
+    }
+    ma_api_wifi_stream_end(&stBenchStream);
+}
+
+static void bench_storage_crc32(void)
+{
+    u32BenchSink += ma_api_wifi_storage_crc32(0, &stBenchStore, sizeof(stBenchStore));
+}
+
+static void bench_storage_write(void)
+{
+    u8BenchRecord[0]++;
+    u32BenchSink += ma_api_wifi_storage_write("bench", 0x42454E43, 1, u8BenchRecord, sizeof(u8BenchRecord));
+}
+
+static void bench_storage_read(void)
+{
+    uint8_t record[sizeof(st_wifi_profile_store_t)];
+    u32BenchSink += ma_api_wifi_storage_read("bench", 0x42454E43, 1, record, sizeof(record));
+}
+
+// The RTC pool holds one profile store: the copy of the chain benchmarks is replaced, not a second one added
+static void bench_rtc_write(void)
+{
+    bench_backend_write(&stStorageBackendRtc, "bench");
+}
+
+static void bench_rtc_read(void)
+{
+    bench_backend_read(&stStorageBackendRtc, "bench");
+}
+
+static void bench_nvs_write(void)
+{
+    bench_backend_write(&stStorageBackendNvs, "bench_nvs");
+}
+
+static void bench_nvs_read(void)
+{
+    bench_backend_read(&stStorageBackendNvs, "bench_nvs");
+}
+
+static void bench_spiffs_write(void)
+{
+    bench_backend_write(&stStorageBackendSpiffs, "/bench_spiffs");
+}
+
+static void bench_spiffs_read(void)
+{
+    bench_backend_read(&stStorageBackendSpiffs, "/bench_spiffs");
+}
+
+/**
+  * @Func       : bench_backend_write
+  * @brief      : Writes the record of the storage benchmarks to one backend, a new value each time
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_backend: Backend
+  *       - in_name: Name of the record
+  * @retval     : None
+  */
+static void bench_backend_write(const st_wifi_storage_backend_t *in_backend, const char *in_name)
+{
+    u8BenchRecord[0]++;
+    u32BenchSink += in_backend->write(in_name, 0x42454E43, 1, u8BenchRecord, sizeof(u8BenchRecord));
+}
+
+/**
+  * @Func       : bench_backend_read
+  * @brief      : Reads the record of the storage benchmarks from one backend
+  * @pre-cond.  : bench_backend_write() ran on the same backend
+  * @post-cond. : None
+  * @parameters :
+  *       - in_backend: Backend
+  *       - in_name: Name of the record
+  * @retval     : None
+  */
+static void bench_backend_read(const st_wifi_storage_backend_t *in_backend, const char *in_name)
+{
+    uint8_t record[sizeof(st_wifi_profile_store_t)];
+    u32BenchSink += in_backend->read(in_name, 0x42454E43, 1, record, sizeof(record));
+}
+
+static void bench_dns_build_answer(void)
+{
+    for (size_t i = 0; i < sizeof(u8BenchDnsQuery); i++)
+    {
+        u8BenchDnsMessage[i] = u8BenchDnsQuery[i];
+    }
+    u32BenchSink += ma_api_wifi_dns_build_answer(u8BenchDnsMessage, sizeof(u8BenchDnsQuery), sizeof(u8BenchDnsMessage), u8BenchPortalIp);
+}
+
+static void bench_credential_set(void)
+{
+    st_wifi_credential_t credential;
+    u32BenchSink += ma_api_wifi_credential_set(&credential, "My Home Net", "p@ss w0rd!");
+}
+
+static void bench_profile_list(void)
+{
+    st_wifi_profile_info_t profiles[DF_WIFI_MAX_PROFILES];
+    u32BenchSink += ma_api_wifi_profile_list(profiles, DF_WIFI_MAX_PROFILES);
+}
+
+/**
+  * @Func       : bench_exchange
+  * @brief      : Sends a request from the phone and polls the portal until the response is read
+  * @pre-cond.  : The portal is running
+  * @post-cond. : The response is consumed
+  * @parameters :
+  *       - io_socket: Phone side of the connection
+  *       - in_request: Request
+  *       - in_untilClosed: Wait for the portal to close, else for the first bytes of the response
+  * @retval     : None
+  */
+static void bench_exchange(st_host_socket_t *io_socket, const char *in_request, bool in_untilClosed)
+{
+    char response[2048];
+
+    ma_host_net_send(io_socket, in_request, strlen(in_request));
+    for (uint32_t polls = 0; polls < 100; polls++)
+    {
+        ma_api_wifi_portal_poll();
+        size_t length = ma_host_net_recv(io_socket, response, sizeof(response));
+        if (in_untilClosed ? ma_host_net_is_closed(io_socket) : (length > 0))
+        {
+            break;
+        }
+    }
+    while (ma_host_net_recv(io_socket, response, sizeof(response)) > 0)
+    {
+    }
+}
+
+static void bench_portal_get(void)
+{
+    st_host_socket_t *socket = ma_host_net_connect(DF_WIFI_HTTP_PORT);
+    bench_exchange(socket, "GET / HTTP/1.1\r\nHost: 192.168.123.123\r\nAccept-Encoding: gzip\r\nConnection: close\r\n\r\n", true);
+    ma_host_net_release(socket);
+}
+
+static void bench_portal_keep_alive(void)
+{
+    static st_host_socket_t *socket = NULL;
+    if (socket != NULL && ma_host_net_is_closed(socket))
+    {
+        ma_host_net_release(socket);            // The portal ends a connection after some requests
+        socket = NULL;
+    }
+    if (socket == NULL)
+    {
+        socket = ma_host_net_connect(DF_WIFI_HTTP_PORT);
+    }
+    bench_exchange(socket, "GET /status.json HTTP/1.1\r\nHost: 192.168.123.123\r\n\r\n", false);
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,1070 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_portal_load.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Load simulator of the portal: phones on the host sockets
+  *               against ma_api_wifi_portal_poll(), on the virtual clock
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "ma_host.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+#include "ma_api_wifi_portal_page.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	"ma_portal_load [options] [file.json]" starts the portal, lets the
+    phones send their requests and writes the results to the file, or to
+    stdout. Options, all optional:
+      --clients N             Phones sending at the same time (8)
+      --requests N            Requests sent by all the phones (2000)
+      --mix page=1,status=6   Weight of each request: page, status, scan,
+                              credentials, profiles, probe (the connectivity
+                              check of a phone) (page=1,status=6,scan=1,
+                              credentials=1,profiles=1,probe=2)
+      --close                 "Connection: close" on every request, else the
+                              phones keep their connection
+      --drip-percent P        Requests sent DRIP_BYTES at a time (0)
+      --drip-bytes B --drip-ms T  B bytes every T ms (1, 100)
+      --disconnect-percent P  Requests whose phone closes the connection in
+                              the middle of the request (0)
+      --poll-ms T             Time between two ma_api_wifi_portal_poll() (1)
+      --connect-ms T          TCP handshake of a new connection on the AP
+                              link, the request waits for it (0)
+      --seed S                Seed of the choices of the phones (1)
+      --page-compare          One phone loads the page of the first version,
+                              then the gzip page, see 4.
+      --link-kbps K --segment-us T  Link of --page-compare: K kbit/s and T us
+                              of airtime per TCP segment (10000, 300)
+
+2.  Time runs on the virtual clock: a phone sends at once and the portal is
+    polled every --poll-ms, so the latency (first byte sent to last byte
+    received) counts the polls and the timeouts of the portal, not the PC.
+    "latencyTotalMs" adds up the latencies, the time a phone waited.
+    The throughput is requests per second of that clock; "hostNsPerRequest"
+    is the time of the PC. The peak heap is the one of the Api, from
+    ma_host_get_stats().
+    A phone keeps its connection until a response says "Connection: close".
+    When the portal closes a kept connection before answering (eviction of
+    an idle connection), the phone sends the request again on a new one,
+    counted in "retried"; "dropped" are the requests left without a
+    response.
+    A provisioning session of one phone, with and without keep-alive:
+      ma_portal_load --clients 1 --requests 12 --connect-ms 30 \
+          --mix page=1,probe=2,scan=3,status=4,credentials=1,profiles=1 [--close]
+    "connections" and "latencyTotalMs" of the two runs are the cost of a
+    new connection per request.
+
+3.  The exit status is 1 when a request was dropped, or when a connection of
+    the portal is still open after every phone left and the idle timeout of
+    the portal ran; 2 on a bad option.
+
+4.  --page-compare writes one row per response instead of the load:
+      - first_version_page: a copy of the first ma_api_wifi_process_client_request(),
+        its headers printed twice and the page in println() calls
+      - gzip_page: "/" of the portal, and credentials_json, the request the
+        page then sends for the saved network
+      - gzip_page_revisit: "/" again with the ETag, the 304 of a second visit
+    "writes" are the WiFiClient::write() calls of the device, each one a TCP
+    segment or more. "bytesOnWire" adds DF_LOAD_TCP_IP_HEADER_SIZE to each
+    segment. The host sockets deliver at once, so the segments are then put
+    one after the other on the link of --link-kbps and --segment-us:
+    "ttfbMs" is the request sent to the end of the first segment, and
+    "lastByteMs" to the end of the last one. The defaults are a phone a few
+    metres from the AP; set them for the link to compare.
+      ma_portal_load --page-compare
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_LOAD_MAX_CLIENTS             64
+#define DF_LOAD_RESPONSE_HEAD_SIZE      1024    // Status line and headers kept of each response
+#define DF_LOAD_SPIFFS_ROOT             "/tmp/ma_portal_load_XXXXXX"
+#define DF_LOAD_MAX_VIRTUAL_MS          (3600u * 1000u)    // Run stopped after an hour of the virtual clock
+#define DF_LOAD_DRAIN_MS                61000   // Polls after the phones left: more than the idle timeout of the portal
+#define DF_LOAD_FIRST_VERSION_PORT      8080    // Server of the copy of the first version, next to the portal
+#define DF_LOAD_PAGE_TIMEOUT_MS         10000   // Response of --page-compare not complete: the row is an error
+#define DF_LOAD_TCP_MSS                 1460    // Payload of a full segment
+#define DF_LOAD_TCP_IP_HEADER_SIZE      40      // IPv4 and TCP headers, without options
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+  eLOAD_REQUEST_PAGE = 0,
+  eLOAD_REQUEST_STATUS,
+  eLOAD_REQUEST_SCAN,
+  eLOAD_REQUEST_CREDENTIALS,
+  eLOAD_REQUEST_PROFILES,
+  eLOAD_REQUEST_PROBE,
+  eLOAD_REQUEST_COUNT
+}e_load_request_t;
+
+typedef enum {
+  eLOAD_CLIENT_IDLE = 0,            // Between two requests
+  eLOAD_CLIENT_SENDING,
+  eLOAD_CLIENT_WAITING              // Request sent, response not complete
+}e_load_client_state_t;
+
+typedef enum {
+  eLOAD_SEND_AT_ONCE = 0,
+  eLOAD_SEND_DRIP,
+  eLOAD_SEND_ABORT                  // Half of the request, then the phone closes
+}e_load_send_t;
+
+typedef struct {
+  st_host_socket_t *socket;
+  e_load_client_state_t state;
+  e_load_send_t send;
+  char request[256];
+  uint16_t requestLength;
+  uint16_t sent;
+  bool reused;                      // Sent on a connection kept from an earlier response
+  uint64_t startUs;                 // Request started, the handshake of a new connection included
+  uint64_t readyUs;                 // End of the handshake of the connection
+  uint64_t nextSendUs;              // Next piece of a drip-fed request
+  char head[DF_LOAD_RESPONSE_HEAD_SIZE];
+  uint16_t headLength;
+  int16_t headEnd;                  // Offset of the body in head, -1 until the headers are complete
+  uint32_t bodyReceived;
+  int32_t contentLength;            // -1 without Content-Length
+  bool chunked;
+  bool close;                       // "Connection: close" in the response
+  char chunkTail[5];                // Last bytes of a chunked body, "0\r\n\r\n" ends it
+}st_load_client_t;
+
+typedef struct {
+  uint32_t clients;
+  uint32_t requests;
+  uint32_t weights[eLOAD_REQUEST_COUNT];
+  bool close;
+  uint32_t dripPercent;
+  uint32_t dripBytes;
+  uint32_t dripMs;
+  uint32_t disconnectPercent;
+  uint32_t pollMs;
+  uint32_t connectMs;
+  uint64_t seed;
+  bool pageCompare;
+  uint32_t linkKbps;
+  uint32_t segmentUs;
+}st_load_config_t;
+
+typedef struct {
+  uint32_t issued;
+  uint32_t completed;               // Response complete, any status
+  uint32_t ok;                      // 2xx, 3xx
+  uint32_t timedOut;                // 408
+  uint32_t otherErrors;             // Other 4xx and 5xx
+  uint32_t dropped;                 // Closed by the portal without a response
+  uint32_t retried;                 // Kept connection closed by the portal before it read the request, sent again
+  uint32_t aborted;                 // Closed by the phone
+  uint32_t refused;                 // Backlog full, the phone tries again at the next poll
+  uint32_t connections;
+  uint64_t bytesReceived;
+}st_load_result_t;
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const cLoadRequestNames[eLOAD_REQUEST_COUNT] = {
+    "page", "status", "scan", "credentials", "profiles", "probe"};
+static const char *const cLoadRequestPaths[eLOAD_REQUEST_COUNT] = {
+    "/", "/status.json", "/scan.json", "/credentials.json", "/profiles.json", "/generate_204"};
+
+static st_load_config_t stLoadConfig = {8, 2000, {1, 6, 1, 1, 1, 2}, false, 0, 1, 100, 0, 1, 0, 1, false, 10000, 300};
+static st_load_client_t *pstLoadClients = NULL;
+static st_load_result_t stLoadResult;
+static uint32_t *pu32LoadLatenciesUs = NULL;
+static uint64_t u64LoadRandom = 1;
+
+/* Private function prototypes -----------------------------------------------*/
+static int ma_load_parse_args(int argc, char **argv, const char **out_path);
+static int ma_load_parse_mix(const char *in_mix);
+static int ma_load_run(FILE *io_output);
+static int ma_load_page_compare(FILE *io_output);
+static int ma_load_page_fetch(FILE *io_output, const char *in_name, WiFiServer *io_firstVersion, const char *in_path,
+                              const char *in_header, bool in_last);
+static uint32_t ma_load_segment_us(uint32_t in_payload);
+static void ma_load_first_version_request(WiFiClient &io_client);
+static void ma_load_first_version_page(WiFiClient in_client);
+static uint32_t ma_load_random(uint32_t in_range);
+static void ma_load_client_start(st_load_client_t *io_client);
+static void ma_load_client_send(st_load_client_t *io_client);
+static bool ma_load_client_connect(st_load_client_t *io_client);
+static void ma_load_client_receive(st_load_client_t *io_client);
+static void ma_load_client_end(st_load_client_t *io_client, bool in_keepSocket);
+static void ma_load_response_data(st_load_client_t *io_client, const char *in_data, size_t in_length);
+static void ma_load_response_body(st_load_client_t *io_client, const char *in_data, size_t in_length);
+static bool ma_load_response_complete(const st_load_client_t *in_client);
+static void ma_load_response_parse_head(st_load_client_t *io_client);
+static int ma_load_compare(const void *in_a, const void *in_b);
+static uint32_t ma_load_percentile(uint32_t in_count, uint32_t in_percent);
+
+/* Body of public functions --------------------------------------------------*/
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    FILE *output = stdout;
+    char root[] = DF_LOAD_SPIFFS_ROOT;
+
+    if (ma_load_parse_args(argc, argv, &path) != 0)
+    {
+        return 2;
+    }
+    if (path != NULL && (output = fopen(path, "w")) == NULL)
+    {
+        perror(path);
+        return 2;
+    }
+    if (mkdtemp(root) == NULL)
+    {
+        perror("mkdtemp");
+        return 2;
+    }
+    ma_host_fs_set_root(root);
+    ma_host_reset();
+    u64LoadRandom = (stLoadConfig.seed != 0) ? stLoadConfig.seed : 1;
+
+    // Networks around, for /scan.json
+    ma_host_wifi_add_ap("Home", "password1", -48, 6);
+    ma_host_wifi_add_ap("Neighbour", "password2", -71, 1);
+    ma_host_wifi_add_ap("Cafe", "", -80, 11);
+
+    pstLoadClients = (st_load_client_t *)calloc(stLoadConfig.clients, sizeof(st_load_client_t));
+    pu32LoadLatenciesUs = (uint32_t *)calloc(stLoadConfig.requests, sizeof(uint32_t));
+
+    st_wifi_credential_t credential;
+    memset(&credential, 0, sizeof(credential));
+    ma_api_wifi_setup_access_point(credential);
+    ma_host_reset_peak();
+
+    int status = stLoadConfig.pageCompare ? ma_load_page_compare(output) : ma_load_run(output);
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+    free(pstLoadClients);
+    free(pu32LoadLatenciesUs);
+    ma_host_fs_erase();
+    rmdir(root);
+    return status;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_load_run
+  * @brief      : Lets the phones send their requests, then leave, and writes the results
+  * @pre-cond.  : Portal started, stLoadConfig set
+  * @post-cond. : Every phone left
+  * @parameters : io_output: JSON file
+  * @retval     : 0 if OK, 1 when a request was dropped or a connection leaked
+  */
+static int ma_load_run(FILE *io_output)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint64_t startUs = ma_host_clock_us();
+    bool busy = true;
+    while (busy && ma_host_clock_us() - startUs < (uint64_t)DF_LOAD_MAX_VIRTUAL_MS * 1000u)
+    {
+        busy = false;
+        for (uint32_t i = 0; i < stLoadConfig.clients; i++)
+        {
+            st_load_client_t *client = &pstLoadClients[i];
+            if (client->state == eLOAD_CLIENT_IDLE && stLoadResult.issued < stLoadConfig.requests)
+            {
+                ma_load_client_start(client);
+            }
+            if (client->state == eLOAD_CLIENT_SENDING)
+            {
+                ma_load_client_send(client);
+            }
+        }
+        ma_api_wifi_portal_poll();
+        for (uint32_t i = 0; i < stLoadConfig.clients; i++)
+        {
+            st_load_client_t *client = &pstLoadClients[i];
+            if (client->state == eLOAD_CLIENT_WAITING)
+            {
+                ma_load_client_receive(client);
+            }
+            busy = busy || (client->state != eLOAD_CLIENT_IDLE);
+        }
+        busy = busy || (stLoadResult.issued < stLoadConfig.requests);
+        ma_host_clock_advance(stLoadConfig.pollMs);
+    }
+    uint64_t elapsedUs = ma_host_clock_us() - startUs;
+    double hostNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    st_host_stats_t stats;
+    ma_host_get_stats(&stats);
+
+    // Every phone leaves; the portal must free its slots once the keep-alive timeout ran
+    for (uint32_t i = 0; i < stLoadConfig.clients; i++)
+    {
+        ma_load_client_end(&pstLoadClients[i], false);
+    }
+    for (uint32_t ms = 0; ms <= DF_LOAD_DRAIN_MS; ms += 10)
+    {
+        ma_api_wifi_portal_poll();
+        ma_host_clock_advance(10);
+    }
+    uint32_t leaked = ma_host_net_open_sockets();
+
+    uint32_t measured = stLoadResult.completed;
+    uint64_t totalUs = 0;
+    for (uint32_t i = 0; i < measured; i++)
+    {
+        totalUs += pu32LoadLatenciesUs[i];
+    }
+    qsort(pu32LoadLatenciesUs, measured, sizeof(uint32_t), ma_load_compare);
+    double seconds = (double)elapsedUs / 1e6;
+    fprintf(io_output,
+            "{\n"
+            "  \"clients\": %u, \"requests\": %u, \"close\": %s, \"dripPercent\": %u, \"disconnectPercent\": %u, \"pollMs\": %u, \"connectMs\": %u,\n"
+            "  \"completed\": %u, \"ok\": %u, \"timedOut408\": %u, \"otherErrors\": %u,\n"
+            "  \"dropped\": %u, \"retried\": %u, \"aborted\": %u, \"refused\": %u, \"connections\": %u,\n"
+            "  \"latencyP50Ms\": %.3f, \"latencyP99Ms\": %.3f, \"latencyMaxMs\": %.3f, \"latencyTotalMs\": %.3f,\n"
+            "  \"virtualSeconds\": %.3f, \"requestsPerSecond\": %.1f, \"bytesReceived\": %llu,\n"
+            "  \"hostNsPerRequest\": %.0f, \"peakHeapBytes\": %u, \"minFreeHeap\": %u, \"leakedConnections\": %u\n"
+            "}\n",
+            (unsigned)stLoadConfig.clients, (unsigned)stLoadConfig.requests, stLoadConfig.close ? "true" : "false",
+            (unsigned)stLoadConfig.dripPercent, (unsigned)stLoadConfig.disconnectPercent, (unsigned)stLoadConfig.pollMs, (unsigned)stLoadConfig.connectMs,
+            (unsigned)stLoadResult.completed, (unsigned)stLoadResult.ok, (unsigned)stLoadResult.timedOut, (unsigned)stLoadResult.otherErrors,
+            (unsigned)stLoadResult.dropped, (unsigned)stLoadResult.retried, (unsigned)stLoadResult.aborted, (unsigned)stLoadResult.refused, (unsigned)stLoadResult.connections,
+            ma_load_percentile(measured, 50) / 1000.0, ma_load_percentile(measured, 99) / 1000.0,
+            (measured > 0) ? pu32LoadLatenciesUs[measured - 1] / 1000.0 : 0.0, totalUs / 1000.0,
+            seconds, (seconds > 0) ? stLoadResult.completed / seconds : 0.0, (unsigned long long)stLoadResult.bytesReceived,
+            (stLoadResult.issued > 0) ? hostNs / stLoadResult.issued : 0.0, (unsigned)stats.peakBytesInUse,
+            (unsigned)ESP.getMinFreeHeap(), (unsigned)leaked);
+    return (leaked == 0 && stLoadResult.dropped == 0) ? 0 : 1;
+}
+
+/**
+  * @Func       : ma_load_page_compare
+  * @brief      : One phone loads the page of the first version, then the gzip page, see HOW TO USE 4
+  * @pre-cond.  : Portal started, stLoadConfig set
+  * @post-cond. : None
+  * @parameters : io_output: JSON file
+  * @retval     : 0 if OK, 1 when a response did not come
+  */
+static int ma_load_page_compare(FILE *io_output)
+{
+    WiFiServer firstVersionServer(DF_LOAD_FIRST_VERSION_PORT);
+    int failed = 0;
+
+    firstVersionServer.begin();
+    fprintf(io_output, "{\n  \"linkKbps\": %u, \"segmentUs\": %u, \"pollMs\": %u,\n  \"pages\": [\n",
+            (unsigned)stLoadConfig.linkKbps, (unsigned)stLoadConfig.segmentUs, (unsigned)stLoadConfig.pollMs);
+    failed |= ma_load_page_fetch(io_output, "first_version_page", &firstVersionServer, "/", "", false);
+    failed |= ma_load_page_fetch(io_output, "gzip_page", NULL, "/", "", false);
+    failed |= ma_load_page_fetch(io_output, "credentials_json", NULL, "/credentials.json", "", false);
+    failed |= ma_load_page_fetch(io_output, "gzip_page_revisit", NULL, "/", "If-None-Match: " DF_PORTAL_PAGE_ETAG "\r\n", true);
+    fprintf(io_output, "  ]\n}\n");
+    return (failed != 0) ? 1 : 0;
+}
+
+/**
+  * @Func       : ma_load_page_fetch
+  * @brief      : Sends one request on a new connection, waits for the whole response and writes its row
+  * @pre-cond.  : None
+  * @post-cond. : Connection closed
+  * @parameters :
+  *       - io_output: JSON file
+  *       - in_name: Name of the row
+  *       - io_firstVersion: Server of the first version, NULL for the portal
+  *       - in_path: Path of the request
+  *       - in_header: Extra header lines, each one ended by "\r\n"
+  *       - in_last: Last row
+  * @retval     : 0 if OK, -1 without a complete response or with more writes than the socket logs
+  */
+static int ma_load_page_fetch(FILE *io_output, const char *in_name, WiFiServer *io_firstVersion, const char *in_path,
+                              const char *in_header, bool in_last)
+{
+    st_load_client_t client;
+    st_host_socket_stats_t stats;
+    uint64_t firstByteUs = 0;
+    bool received = false;
+    bool closed = false;
+    char data[2048];
+    size_t length;
+
+    memset(&client, 0, sizeof(client));
+    client.headEnd = -1;
+    client.contentLength = -1;
+    client.socket = ma_host_net_connect((io_firstVersion != NULL) ? DF_LOAD_FIRST_VERSION_PORT : DF_WIFI_HTTP_PORT);
+    if (client.socket == NULL)
+    {
+        fprintf(stderr, "%s: connection refused\n", in_name);
+        return -1;
+    }
+    client.requestLength = (uint16_t)snprintf(client.request, sizeof(client.request),
+        "GET %s HTTP/1.1\r\nHost: 192.168.123.123\r\nUser-Agent: ma_portal_load\r\nAccept-Encoding: gzip\r\n%s"
+        "Connection: close\r\n\r\n", in_path, in_header);
+    ma_host_net_send(client.socket, client.request, client.requestLength);
+    client.startUs = ma_host_clock_us();
+
+    while (!ma_load_response_complete(&client) && !closed &&
+           ma_host_clock_us() - client.startUs < (uint64_t)DF_LOAD_PAGE_TIMEOUT_MS * 1000u)
+    {
+        if (io_firstVersion != NULL)
+        {
+            WiFiClient device = io_firstVersion->accept();
+            if (device)
+            {
+                ma_load_first_version_request(device);
+            }
+        }
+        else
+        {
+            ma_api_wifi_portal_poll();
+        }
+        while ((length = ma_host_net_recv(client.socket, data, sizeof(data))) > 0)
+        {
+            firstByteUs = received ? firstByteUs : ma_host_clock_us();
+            received = true;
+            ma_load_response_data(&client, data, length);
+        }
+        closed = ma_host_net_is_closed(client.socket) && ma_host_net_pending(client.socket) == 0;
+        ma_host_clock_advance(stLoadConfig.pollMs);
+    }
+    ma_host_net_get_stats(client.socket, &stats);
+    ma_load_client_end(&client, false);
+
+    // The segments of each write, one after the other on the link
+    uint32_t segments = 0;
+    uint64_t firstSegmentUs = 0;
+    uint64_t linkUs = 0;
+    uint32_t logged = (stats.writeCalls < DF_HOST_SOCKET_WRITE_LOG_SIZE) ? stats.writeCalls : DF_HOST_SOCKET_WRITE_LOG_SIZE;
+    for (uint32_t i = 0; i < logged; i++)
+    {
+        for (uint32_t left = stats.writeSizes[i]; left > 0; )
+        {
+            uint32_t payload = (left < DF_LOAD_TCP_MSS) ? left : DF_LOAD_TCP_MSS;
+            linkUs += ma_load_segment_us(payload);
+            firstSegmentUs = (segments == 0) ? linkUs : firstSegmentUs;
+            segments++;
+            left -= payload;
+        }
+    }
+
+    int status = (client.headEnd >= 0) ? atoi(client.head + 9) : 0;
+    uint64_t waitUs = received ? firstByteUs - client.startUs : 0;
+    fprintf(io_output,
+            "    {\"name\": \"%s\", \"status\": %d, \"writes\": %u, \"segments\": %u, \"bytesWritten\": %u, "
+            "\"bodyBytes\": %u, \"bytesOnWire\": %u, \"ttfbMs\": %.3f, \"lastByteMs\": %.3f}%s\n",
+            in_name, status, (unsigned)stats.writeCalls, (unsigned)segments, (unsigned)stats.bytesWritten,
+            (unsigned)client.bodyReceived, (unsigned)(stats.bytesWritten + segments * DF_LOAD_TCP_IP_HEADER_SIZE),
+            (waitUs + firstSegmentUs) / 1000.0, (waitUs + linkUs) / 1000.0, in_last ? "" : ",");
+
+    if (status == 0 || (!closed && !ma_load_response_complete(&client)) || stats.writeCalls > DF_HOST_SOCKET_WRITE_LOG_SIZE)
+    {
+        fprintf(stderr, "%s: no complete response, or more than %u writes\n", in_name, (unsigned)DF_HOST_SOCKET_WRITE_LOG_SIZE);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_load_segment_us
+  * @brief      : Airtime of one TCP segment on the link of --page-compare
+  * @pre-cond.  : linkKbps > 0
+  * @post-cond. : None
+  * @parameters : in_payload: Bytes of the segment, headers not included
+  * @retval     : Time in us
+  */
+static uint32_t ma_load_segment_us(uint32_t in_payload)
+{
+    return stLoadConfig.segmentUs +
+           (uint32_t)((uint64_t)(in_payload + DF_LOAD_TCP_IP_HEADER_SIZE) * 8u * 1000u / stLoadConfig.linkKbps);
+}
+
+/**
+  * @Func       : ma_load_first_version_request
+  * @brief      : Copy of the receive loop of the first ma_api_wifi_process_client_request(): the header read
+  *               char by char, then the status line and the headers, and the page
+  * @pre-cond.  : The request was sent whole
+  * @post-cond. : Connection closed by the device
+  * @parameters : io_client: Device side of the connection
+  * @retval     : None
+  */
+static void ma_load_first_version_request(WiFiClient &io_client)
+{
+    String header = "";
+    String currentLine = "";
+
+    while (io_client.available())
+    {
+        char c = io_client.read();
+        header += c;
+        if (c == '\n')
+        {
+            if (currentLine.length() == 0)
+            {
+                io_client.println("HTTP/1.1 200 OK");
+                io_client.println("Content-type:text/html");
+                io_client.println("Connection: close");
+                io_client.println();
+
+                ma_load_first_version_page(io_client);
+                break;
+            }
+            else
+            {
+                currentLine = "";
+            }
+        }
+        else if (c != '\r')
+        {
+            currentLine += c;
+        }
+    }
+    io_client.stop();
+}
+
+/**
+  * @Func       : ma_load_first_version_page
+  * @brief      : Copy of the first ma_api_wifi_send_http_response(), no network saved. The String sums
+  *               start with String(), the host core has no StringSumHelper.
+  * @pre-cond.  : None
+  * @post-cond. : Page written, one println() at a time
+  * @parameters : in_client: Device side of the connection
+  * @retval     : None
+  */
+static void ma_load_first_version_page(WiFiClient in_client)
+{
+    String ssid = "";
+    String password = "";
+
+    in_client.println("HTTP/1.1 200 OK");
+    in_client.println("Content-type:text/html");
+    in_client.println("Connection: close");
+    in_client.println();
+    in_client.println("<!DOCTYPE html><html>");
+    in_client.println("<head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">");
+    in_client.println("<link rel=\"icon\" href=\"data:,\">");
+    in_client.println("<style>html { font-family: Helvetica; display: inline-block; margin: 0px auto; text-align: center;}");
+    in_client.println(".button { background-color: #4CAF50; border: none; color: white; padding: 16px 40px;");
+    in_client.println("text-decoration: none; font-size: 30px; margin: 2px; cursor: pointer;}");
+    in_client.println(".button2 {background-color: #555555;}</style></head>");
+    in_client.println("<body><h1>Sobreiro Monitor</h1>");
+    in_client.println("<form id=\"formSalvar\" action=\"/save_data\" method=\"post\">");
+    in_client.println("<p>Digite o SSID: </p>");
+    in_client.println(String("<p><input type=\"text\" name=\"user\" value=\"") + ssid + "\"><p>");
+    in_client.println("<p>Digite a SENHA: </p>");
+    in_client.println(String("<p><input type=\"password\" name=\"password\" id=\"password\" value=\"") + password + "\"></p>");
+    in_client.println("<button type=\"button\" onclick=\"togglePasswordVisibility()\">Mostrar/Ocultar Senha</button>");
+    in_client.println("<p><input type=\"submit\" value=\"Salvar\"></p>");
+    in_client.println("</form>");
+    in_client.println("<script>");
+    in_client.println("function togglePasswordVisibility() {");
+    in_client.println("  var passwordField = document.getElementById('password');");
+    in_client.println("  if (passwordField.type === 'password') {");
+    in_client.println("    passwordField.type = 'text';");
+    in_client.println("  } else {");
+    in_client.println("    passwordField.type = 'password';");
+    in_client.println("  }");
+    in_client.println("}");
+    in_client.println("document.getElementById('formSalvar').addEventListener('submit', function(event) {");
+    in_client.println("  event.preventDefault();");
+    in_client.println("  var ssid = document.getElementsByName('user')[0].value;");
+    in_client.println("  var password = document.getElementsByName('password')[0].value;");
+    in_client.println("  var form = document.getElementById('formSalvar');");
+    in_client.println("  var url = '/save_data?ssid=' + encodeURIComponent(ssid) + '&password=' + encodeURIComponent(password);");
+    in_client.println("  form.action = url;");
+    in_client.println("  form.submit();");
+    in_client.println("});");
+    in_client.println("</script>");
+    in_client.println("</body></html>");
+}
+
+/**
+  * @Func       : ma_load_parse_args
+  * @brief      : Reads the options, see HOW TO USE
+  * @pre-cond.  : None
+  * @post-cond. : stLoadConfig set
+  * @parameters :
+  *       - argc, argv: Command line
+  *       - out_path: JSON file, NULL for stdout
+  * @retval     : 0 if OK, -1 on a bad option
+  */
+static int ma_load_parse_args(int argc, char **argv, const char **out_path)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *option = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        uint32_t *number = NULL;
+
+        if (strcmp(option, "--close") == 0)
+        {
+            stLoadConfig.close = true;
+            continue;
+        }
+        if (strcmp(option, "--page-compare") == 0)
+        {
+            stLoadConfig.pageCompare = true;
+            continue;
+        }
+        if (option[0] != '-')
+        {
+            *out_path = option;
+            continue;
+        }
+        if (value == NULL)
+        {
+            fprintf(stderr, "%s needs a value\n", option);
+            return -1;
+        }
+        i++;
+
+        if (strcmp(option, "--mix") == 0)
+        {
+            if (ma_load_parse_mix(value) != 0)
+            {
+                return -1;
+            }
+            continue;
+        }
+        if (strcmp(option, "--seed") == 0)
+        {
+            stLoadConfig.seed = strtoull(value, NULL, 10);
+            continue;
+        }
+        number = (strcmp(option, "--clients") == 0) ? &stLoadConfig.clients :
+                 (strcmp(option, "--requests") == 0) ? &stLoadConfig.requests :
+                 (strcmp(option, "--drip-percent") == 0) ? &stLoadConfig.dripPercent :
+                 (strcmp(option, "--drip-bytes") == 0) ? &stLoadConfig.dripBytes :
+                 (strcmp(option, "--drip-ms") == 0) ? &stLoadConfig.dripMs :
+                 (strcmp(option, "--disconnect-percent") == 0) ? &stLoadConfig.disconnectPercent :
+                 (strcmp(option, "--poll-ms") == 0) ? &stLoadConfig.pollMs :
+                 (strcmp(option, "--connect-ms") == 0) ? &stLoadConfig.connectMs :
+                 (strcmp(option, "--link-kbps") == 0) ? &stLoadConfig.linkKbps :
+                 (strcmp(option, "--segment-us") == 0) ? &stLoadConfig.segmentUs : NULL;
+        if (number == NULL)
+        {
+            fprintf(stderr, "Unknown option %s\n", option);
+            return -1;
+        }
+        *number = (uint32_t)strtoul(value, NULL, 10);
+    }
+
+    if (stLoadConfig.clients == 0 || stLoadConfig.clients > DF_LOAD_MAX_CLIENTS || stLoadConfig.requests == 0 ||
+        stLoadConfig.dripPercent + stLoadConfig.disconnectPercent > 100 || stLoadConfig.dripBytes == 0 ||
+        stLoadConfig.pollMs == 0 || stLoadConfig.linkKbps == 0)
+    {
+        fprintf(stderr, "Bad options: 1 to %u clients, requests > 0, drip + disconnect <= 100%%, drip bytes, poll and link > 0\n",
+                (unsigned)DF_LOAD_MAX_CLIENTS);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_load_parse_mix
+  * @brief      : Reads "name=weight,name=weight"; the requests not named get weight 0
+  * @pre-cond.  : None
+  * @post-cond. : stLoadConfig.weights set
+  * @parameters : in_mix: Text of --mix
+  * @retval     : 0 if OK, -1 on an unknown name or a total weight of 0
+  */
+static int ma_load_parse_mix(const char *in_mix)
+{
+    uint32_t total = 0;
+
+    memset(stLoadConfig.weights, 0, sizeof(stLoadConfig.weights));
+    for (const char *item = in_mix; item != NULL && *item != '\0'; )
+    {
+        const char *equal = strchr(item, '=');
+        const char *comma = strchr(item, ',');
+        size_t nameLength = (equal != NULL) ? (size_t)(equal - item) : 0;
+        int found = -1;
+
+        for (int i = 0; i < eLOAD_REQUEST_COUNT && equal != NULL; i++)
+        {
+            if (strlen(cLoadRequestNames[i]) == nameLength && strncmp(item, cLoadRequestNames[i], nameLength) == 0)
+            {
+                found = i;
+            }
+        }
+        if (found < 0)
+        {
+            fprintf(stderr, "Bad --mix item %s, names: page, status, scan, credentials, profiles, probe\n", item);
+            return -1;
+        }
+        stLoadConfig.weights[found] = (uint32_t)strtoul(equal + 1, NULL, 10);
+        total += stLoadConfig.weights[found];
+        item = (comma != NULL) ? comma + 1 : NULL;
+    }
+    return (total > 0) ? 0 : -1;
+}
+
+/**
+  * @Func       : ma_load_random
+  * @brief      : xorshift64*, independent of random() used by the Api
+  * @pre-cond.  : u64LoadRandom not 0
+  * @post-cond. : None
+  * @parameters : in_range: Number of values
+  * @retval     : 0 to in_range - 1
+  */
+static uint32_t ma_load_random(uint32_t in_range)
+{
+    u64LoadRandom ^= u64LoadRandom >> 12;
+    u64LoadRandom ^= u64LoadRandom << 25;
+    u64LoadRandom ^= u64LoadRandom >> 27;
+    return (uint32_t)((u64LoadRandom * 2685821657736338717ull) >> 32) % in_range;
+}
+
+/**
+  * @Func       : ma_load_client_start
+  * @brief      : Chooses the next request of a phone and how it is sent; connects if needed
+  * @pre-cond.  : Client idle, requests left
+  * @post-cond. : Client sending, or still idle if the backlog of the portal is full
+  * @parameters : io_client: Phone
+  * @retval     : None
+  */
+static void ma_load_client_start(st_load_client_t *io_client)
+{
+    io_client->reused = (io_client->socket != NULL);
+    if (!ma_load_client_connect(io_client))
+    {
+        return;
+    }
+
+    uint32_t total = 0;
+    for (int i = 0; i < eLOAD_REQUEST_COUNT; i++)
+    {
+        total += stLoadConfig.weights[i];
+    }
+    uint32_t pick = ma_load_random(total);
+    int request = 0;
+    while (pick >= stLoadConfig.weights[request])
+    {
+        pick -= stLoadConfig.weights[request];
+        request++;
+    }
+
+    uint32_t behaviour = ma_load_random(100);
+    io_client->send = (behaviour < stLoadConfig.dripPercent) ? eLOAD_SEND_DRIP :
+                      (behaviour < stLoadConfig.dripPercent + stLoadConfig.disconnectPercent) ? eLOAD_SEND_ABORT :
+                      eLOAD_SEND_AT_ONCE;
+    io_client->requestLength = (uint16_t)snprintf(io_client->request, sizeof(io_client->request),
+        "GET %s HTTP/1.1\r\nHost: 192.168.123.123\r\nUser-Agent: ma_portal_load\r\nAccept-Encoding: gzip\r\n%s\r\n",
+        cLoadRequestPaths[request], stLoadConfig.close ? "Connection: close\r\n" : "");
+    io_client->sent = 0;
+    io_client->startUs = ma_host_clock_us();
+    io_client->nextSendUs = (io_client->readyUs > io_client->startUs) ? io_client->readyUs : io_client->startUs;
+    io_client->headLength = 0;
+    io_client->headEnd = -1;
+    io_client->bodyReceived = 0;
+    io_client->contentLength = -1;
+    io_client->chunked = false;
+    io_client->close = false;
+    memset(io_client->chunkTail, 0, sizeof(io_client->chunkTail));
+    io_client->state = eLOAD_CLIENT_SENDING;
+    stLoadResult.issued++;
+}
+
+/**
+  * @Func       : ma_load_client_send
+  * @brief      : Sends the request, all at once or the next piece of it
+  * @pre-cond.  : Client sending
+  * @post-cond. : Client waiting once the request is sent; idle without a socket after an abort.
+  *               Still sending if the connection of a retry was refused.
+  * @parameters : io_client: Phone
+  * @retval     : None
+  */
+static void ma_load_client_send(st_load_client_t *io_client)
+{
+    if (!ma_load_client_connect(io_client))
+    {
+        return;
+    }
+    uint16_t length = io_client->requestLength - io_client->sent;
+
+    if (ma_host_clock_us() < io_client->readyUs)
+    {
+        return;
+    }
+    if (io_client->send == eLOAD_SEND_DRIP)
+    {
+        if (ma_host_clock_us() < io_client->nextSendUs)
+        {
+            return;
+        }
+        length = (length < stLoadConfig.dripBytes) ? length : (uint16_t)stLoadConfig.dripBytes;
+        io_client->nextSendUs += (uint64_t)stLoadConfig.dripMs * 1000u;
+    }
+    else if (io_client->send == eLOAD_SEND_ABORT)
+    {
+        length = io_client->requestLength / 2;
+    }
+
+    io_client->sent += (uint16_t)ma_host_net_send(io_client->socket, io_client->request + io_client->sent, length);
+    if (io_client->send == eLOAD_SEND_ABORT)
+    {
+        stLoadResult.aborted++;
+        ma_load_client_end(io_client, false);
+    }
+    else if (io_client->sent >= io_client->requestLength)
+    {
+        io_client->state = eLOAD_CLIENT_WAITING;
+    }
+    else if (ma_host_net_is_closed(io_client->socket))
+    {
+        // 408 or eviction while the request was drip-fed
+        io_client->state = eLOAD_CLIENT_WAITING;
+    }
+}
+
+/**
+  * @Func       : ma_load_client_receive
+  * @brief      : Reads what the portal sent and ends the request when the response is complete
+  *               or the portal closed the connection
+  * @pre-cond.  : Client waiting
+  * @post-cond. : Client idle when the request ended
+  * @parameters : io_client: Phone
+  * @retval     : None
+  */
+static void ma_load_client_receive(st_load_client_t *io_client)
+{
+    char data[2048];
+    size_t length;
+
+    while ((length = ma_host_net_recv(io_client->socket, data, sizeof(data))) > 0)
+    {
+        stLoadResult.bytesReceived += length;
+        ma_load_response_data(io_client, data, length);
+    }
+
+    bool closed = ma_host_net_is_closed(io_client->socket) && ma_host_net_pending(io_client->socket) == 0;
+    bool complete = ma_load_response_complete(io_client);
+    if (!complete && !closed)
+    {
+        return;
+    }
+
+    if (io_client->headEnd < 0 && io_client->headLength == 0 && io_client->reused)
+    {
+        // The portal closed the kept connection while the request was on its way: like a browser, the
+        // phone sends it again on a new connection (RFC 9112, 9.3.1)
+        stLoadResult.retried++;
+        ma_load_client_end(io_client, false);
+        io_client->reused = false;
+        io_client->sent = 0;
+        io_client->state = eLOAD_CLIENT_SENDING;
+        return;
+    }
+    if (io_client->headEnd < 0)
+    {
+        stLoadResult.dropped++;
+    }
+    else
+    {
+        int status = atoi(io_client->head + 9);
+        pu32LoadLatenciesUs[stLoadResult.completed++] = (uint32_t)(ma_host_clock_us() - io_client->startUs);
+        stLoadResult.ok += (status >= 200 && status < 400) ? 1 : 0;
+        stLoadResult.timedOut += (status == 408) ? 1 : 0;
+        stLoadResult.otherErrors += (status >= 400 && status != 408) ? 1 : 0;
+    }
+    ma_load_client_end(io_client, complete && !closed && !io_client->close && !stLoadConfig.close);
+}
+
+/**
+  * @Func       : ma_load_client_connect
+  * @brief      : Opens the connection of a phone that has none
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : io_client: Phone
+  * @retval     : false if the backlog of the portal is full
+  */
+static bool ma_load_client_connect(st_load_client_t *io_client)
+{
+    if (io_client->socket == NULL)
+    {
+        io_client->socket = ma_host_net_connect(DF_WIFI_HTTP_PORT);
+        if (io_client->socket == NULL)
+        {
+            stLoadResult.refused++;
+            return false;
+        }
+        stLoadResult.connections++;
+        io_client->readyUs = ma_host_clock_us() + (uint64_t)stLoadConfig.connectMs * 1000u;
+    }
+    return true;
+}
+
+/**
+  * @Func       : ma_load_client_end
+  * @brief      : Ends the request of a phone
+  * @pre-cond.  : None
+  * @post-cond. : Client idle; its socket is closed and released unless kept for the next request
+  * @parameters :
+  *       - io_client: Phone
+  *       - in_keepSocket: Keep the connection
+  * @retval     : None
+  */
+static void ma_load_client_end(st_load_client_t *io_client, bool in_keepSocket)
+{
+    if (io_client->socket != NULL && !in_keepSocket)
+    {
+        ma_host_net_close(io_client->socket);
+        ma_host_net_release(io_client->socket);
+        io_client->socket = NULL;
+    }
+    io_client->state = eLOAD_CLIENT_IDLE;
+}
+
+/**
+  * @Func       : ma_load_response_data
+  * @brief      : Keeps the status line and the headers, counts the body
+  * @pre-cond.  : None
+  * @post-cond. : headEnd, contentLength and chunked set once the headers are complete
+  * @parameters :
+  *       - io_client: Phone
+  *       - in_data, in_length: Bytes received
+  * @retval     : None
+  */
+static void ma_load_response_data(st_load_client_t *io_client, const char *in_data, size_t in_length)
+{
+    if (io_client->headEnd < 0)
+    {
+        size_t space = sizeof(io_client->head) - 1 - io_client->headLength;
+        size_t copied = (in_length < space) ? in_length : space;
+        memcpy(io_client->head + io_client->headLength, in_data, copied);
+        io_client->headLength += (uint16_t)copied;
+        io_client->head[io_client->headLength] = '\0';
+        ma_load_response_parse_head(io_client);
+        if (io_client->headEnd < 0)
+        {
+            return;
+        }
+        // The first body bytes were kept with the headers
+        ma_load_response_body(io_client, io_client->head + io_client->headEnd, (size_t)(io_client->headLength - io_client->headEnd));
+        in_data += copied;
+        in_length -= copied;
+    }
+    ma_load_response_body(io_client, in_data, in_length);
+}
+
+/**
+  * @Func       : ma_load_response_body
+  * @brief      : Counts body bytes and keeps the last ones of a chunked body
+  * @pre-cond.  : Headers complete
+  * @post-cond. : None
+  * @parameters :
+  *       - io_client: Phone
+  *       - in_data, in_length: Body bytes
+  * @retval     : None
+  */
+static void ma_load_response_body(st_load_client_t *io_client, const char *in_data, size_t in_length)
+{
+    io_client->bodyReceived += (uint32_t)in_length;
+    // The end of a chunked body is "0\r\n\r\n"
+    for (size_t i = 0; io_client->chunked && i < in_length; i++)
+    {
+        memmove(io_client->chunkTail, io_client->chunkTail + 1, sizeof(io_client->chunkTail) - 1);
+        io_client->chunkTail[sizeof(io_client->chunkTail) - 1] = in_data[i];
+    }
+}
+
+/**
+  * @Func       : ma_load_response_parse_head
+  * @brief      : Finds the end of the headers and the framing of the body
+  * @pre-cond.  : head holds the first bytes of the response, null terminated
+  * @post-cond. : headEnd, contentLength, chunked and close set when "\r\n\r\n" was received
+  * @parameters : io_client: Phone
+  * @retval     : None
+  */
+static void ma_load_response_parse_head(st_load_client_t *io_client)
+{
+    const char *end = strstr(io_client->head, "\r\n\r\n");
+    if (end == NULL)
+    {
+        return;
+    }
+    io_client->headEnd = (int16_t)(end + 4 - io_client->head);
+
+    for (const char *line = strstr(io_client->head, "\r\n"); line != NULL && line < end; line = strstr(line + 2, "\r\n"))
+    {
+        if (strncasecmp(line + 2, "Content-Length:", 15) == 0)
+        {
+            io_client->contentLength = atoi(line + 17);
+        }
+        else if (strncasecmp(line + 2, "Transfer-Encoding: chunked", 26) == 0)
+        {
+            io_client->chunked = true;
+        }
+        else if (strncasecmp(line + 2, "Connection: close", 17) == 0)
+        {
+            io_client->close = true;
+        }
+    }
+}
+
+/**
+  * @Func       : ma_load_response_complete
+  * @brief      : Tells if the whole response was received, from its framing
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_client: Phone
+  * @retval     : true when complete; a response framed by the close is never complete
+  */
+static bool ma_load_response_complete(const st_load_client_t *in_client)
+{
+    if (in_client->headEnd < 0)
+    {
+        return false;
+    }
+    if (in_client->chunked)
+    {
+        return memcmp(in_client->chunkTail, "0\r\n\r\n", 5) == 0;
+    }
+    if (in_client->contentLength >= 0)
+    {
+        return in_client->bodyReceived >= (uint32_t)in_client->contentLength;
+    }
+    int status = atoi(in_client->head + 9);
+    return status == 204 || status == 304 || (status >= 100 && status < 200);
+}
+
+static int ma_load_compare(const void *in_a, const void *in_b)
+{
+    uint32_t a = *(const uint32_t *)in_a;
+    uint32_t b = *(const uint32_t *)in_b;
+    return (a > b) - (a < b);
+}
+
+/**
+  * @Func       : ma_load_percentile
+  * @brief      : Nearest-rank percentile of the sorted latencies
+  * @pre-cond.  : pu32LoadLatenciesUs sorted
+  * @post-cond. : None
+  * @parameters :
+  *       - in_count: Latencies
+  *       - in_percent: 1 to 100
+  * @retval     : Latency in us, 0 without latencies
+  */
+static uint32_t ma_load_percentile(uint32_t in_count, uint32_t in_percent)
+{
+    if (in_count == 0)
+    {
+        return 0;
+    }
+    uint32_t rank = (in_count * in_percent + 99) / 100;
+    return pu32LoadLatenciesUs[(rank > 0) ? rank - 1 : 0];
+}
+
+/*****************************END OF FILE**************************************/
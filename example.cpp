@@ -1,44 +1,44 @@
 #include <Arduino.h>
 #include <WiFi.h>
-#include <FS.h>
-#include <SPIFFS.h>
 #include <stdlib.h>
 #include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_trace.h" // Build with -DTRACE_ENABLE -DPRINT_ENABLE to get the boot timeline on Serial, and on /metrics
 
-#define DF_FORMAT_SPIFFS_IF_FAILED true //true or false
-WiFiClient wifiClient;
 void setup() {
 //Necessary when ESP32 or Devkit does not have a capacitor strong enough to withstand peak communications consumption (WiFi)
 #ifdef BROWNOT_OFF
   WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0); //disable brownout detector. 
 #endif
   Serial.begin(115200);
-  if(!SPIFFS.begin(DF_FORMAT_SPIFFS_IF_FAILED))
-  {
-    Serial.println("SPIFFS Mount Failed");
-    return;
-  }
+  // No SPIFFS.begin(): the saved networks are read from RTC memory or NVS, SPIFFS is only mounted once to move older ones
 
-  st_wifi_station_credential_t stWifiCredential;
-  ma_api_wifi_read_network_credentials(&stWifiCredential);
-  if(stWifiCredential.stringSsid.length() < 5 || stWifiCredential.stringPassword.length() < 5)
-  {
-    //Aqui deve de ativar o modo Activo
-    ma_api_wifi_setup_access_point(stWifiCredential); // Enable AP mode with WebServer to get news credentials if is necessary
-    
-    while(1)
-    {
-      ma_api_wifi_process_client_request(&wifiClient, stWifiCredential.stringSsid, stWifiCredential.stringPassword, 60);
-    }
-  }
-  ma_api_wifi_setup_station(stWifiCredential, 3);
+  ma_api_wifi_portal_set_timeout(60);
+  ma_api_wifi_link_monitor_set_timeout(60); // Portal back in AP + Station mode after 60 s without link
+  // Joins the best saved network in range, or starts the portal (AP mode with WebServer) to get new credentials.
+  // Runs in its own task, setup() returns at once.
+  ma_api_wifi_manager_start(NULL);
 }
 
 void loop() 
 {
-
+  st_wifi_event_t stEvent;
+  while(ma_api_wifi_get_event(&stEvent))
+  {
+    if(stEvent.type == eWIFI_EVENT_CONNECTED)
+    {
+      st_wifi_connect_stats_t stConnectStats = ma_api_wifi_get_connect_stats();
+      Serial.printf("Connected (path %d) in %u ms, %u ms after boot\n", 
+                    stConnectStats.path, stConnectStats.connectMs, stConnectStats.bootToConnectedMs);
+      if(stConnectStats.provisionToOnlineMs != 0)
+      {
+        Serial.printf("Online %u ms after the network was saved on the portal\n", stConnectStats.provisionToOnlineMs);
+      }
+    }
+    else if(stEvent.type == eWIFI_EVENT_DISCONNECTED)
+    {
+      Serial.printf("WiFi link lost, reason %u\n", stEvent.detail);
+    }
+  }
+  // The application does its own work here, e.g. reads the sensors
+  delay(10);
 }
-
-
-
-
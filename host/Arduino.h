@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : Arduino.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the part of the Arduino core used by the WiFi
+  *               Api: clock, String, Print, Serial, ESP and esp_restart()
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_ARDUINO_H
+#define __MA_HOST_ARDUINO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Define --------------------------------------------------------------------*/
+// Placement attributes of the ESP32, plain RAM and flash on a PC
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+#define PROGMEM
+
+#define HEX 16
+#define DEC 10
+
+#define DF_HOST_STRING_SSO_SIZE         11      // Short strings are kept in the object, as by the ESP32 core
+
+/* Typedef -------------------------------------------------------------------*/
+typedef bool boolean;
+typedef uint8_t byte;
+
+class String;
+
+// Output of bytes and text, the base of Serial and WiFiClient
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t in_byte) = 0;
+    virtual size_t write(const uint8_t *in_buffer, size_t in_size);
+    size_t write(const char *in_text) { return (in_text != NULL) ? write((const uint8_t *)in_text, strlen(in_text)) : 0; }
+    size_t write(const char *in_buffer, size_t in_size) { return write((const uint8_t *)in_buffer, in_size); }
+    virtual void flush(void) {}
+
+    size_t print(const char *in_text) { return write(in_text); }
+    size_t print(const String &in_text);
+    size_t print(char in_char) { return write((uint8_t)in_char); }
+    size_t print(long in_value, int in_base = DEC);
+    size_t print(unsigned long in_value, int in_base = DEC);
+    size_t print(int in_value, int in_base = DEC) { return print((long)in_value, in_base); }
+    size_t print(unsigned int in_value, int in_base = DEC) { return print((unsigned long)in_value, in_base); }
+    size_t println(void) { return write("\r\n"); }
+    template <typename T> size_t println(const T &in_value) { return print(in_value) + println(); }
+    size_t printf(const char *in_format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Input of bytes on top of Print
+class Stream : public Print
+{
+public:
+    virtual int available(void) = 0;
+    virtual int read(void) = 0;
+    virtual int peek(void) = 0;
+    void setTimeout(unsigned long in_timeoutMs) { ulTimeoutMs = in_timeoutMs; }
+    size_t readBytes(uint8_t *out_buffer, size_t in_length);
+    size_t readBytes(char *out_buffer, size_t in_length) { return readBytes((uint8_t *)out_buffer, in_length); }
+
+protected:
+    unsigned long ulTimeoutMs = 1000;
+};
+
+// Serial port 0. The output is dropped unless ma_host_serial_echo(true), then it goes to stdout.
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long in_baud) { (void)in_baud; }
+    void end(void) {}
+    int available(void) override { return 0; }
+    int read(void) override { return -1; }
+    int peek(void) override { return -1; }
+    size_t write(uint8_t in_byte) override { return write(&in_byte, 1); }
+    size_t write(const uint8_t *in_buffer, size_t in_size) override;
+    using Print::write;
+    operator bool() const { return true; }
+};
+
+// Heap counters of the ESP32, computed from the allocations counted by the host build
+class EspClass
+{
+public:
+    uint32_t getFreeHeap(void);
+    uint32_t getMinFreeHeap(void);
+    uint32_t getMaxAllocHeap(void);
+    uint32_t getHeapSize(void);
+    void restart(void) __attribute__((noreturn));
+};
+
+// Arduino String, the buffer is on the heap and is counted by ma_host_get_stats()
+class String
+{
+public:
+    String(const char *in_text = "");
+    String(const char *in_text, size_t in_length);
+    String(const String &in_other);
+    String(String &&io_other) noexcept;
+    explicit String(char in_char);
+    explicit String(int in_value, unsigned char in_base = DEC);
+    explicit String(unsigned int in_value, unsigned char in_base = DEC);
+    explicit String(long in_value, unsigned char in_base = DEC);
+    explicit String(unsigned long in_value, unsigned char in_base = DEC);
+    ~String();
+
+    String &operator=(const String &in_other);
+    String &operator=(String &&io_other) noexcept;
+    String &operator=(const char *in_text);
+
+    bool reserve(size_t in_size);
+    size_t length(void) const { return uLength; }
+    const char *c_str(void) const { return (pcHeap != NULL) ? pcHeap : cInline; }
+    bool isEmpty(void) const { return uLength == 0; }
+
+    bool concat(const char *in_text, size_t in_length);
+    bool concat(const char *in_text) { return concat(in_text, strlen(in_text)); }
+    bool concat(const String &in_other) { return concat(in_other.c_str(), in_other.length()); }
+    bool concat(char in_char) { return concat(&in_char, 1); }
+    String &operator+=(const String &in_other) { concat(in_other); return *this; }
+    String &operator+=(const char *in_text) { concat(in_text); return *this; }
+    String &operator+=(char in_char) { concat(in_char); return *this; }
+
+    bool equals(const char *in_text) const { return strcmp(c_str(), in_text) == 0; }
+    bool operator==(const String &in_other) const { return uLength == in_other.uLength && equals(in_other.c_str()); }
+    bool operator==(const char *in_text) const { return equals(in_text); }
+    bool operator!=(const String &in_other) const { return !(*this == in_other); }
+    bool operator!=(const char *in_text) const { return !equals(in_text); }
+    bool startsWith(const char *in_prefix) const { return strncmp(c_str(), in_prefix, strlen(in_prefix)) == 0; }
+
+    char charAt(size_t in_index) const { return (in_index < uLength) ? c_str()[in_index] : '\0'; }
+    char operator[](size_t in_index) const { return charAt(in_index); }
+    char &operator[](size_t in_index);
+    int indexOf(char in_char, size_t in_from = 0) const;
+    int indexOf(const char *in_text, size_t in_from = 0) const;
+    int indexOf(const String &in_text, size_t in_from = 0) const { return indexOf(in_text.c_str(), in_from); }
+    String substring(size_t in_begin) const { return substring(in_begin, uLength); }
+    String substring(size_t in_begin, size_t in_end) const;
+    void trim(void);
+    long toInt(void) const { return atol(c_str()); }
+
+private:
+    char *buffer(void) { return (pcHeap != NULL) ? pcHeap : cInline; }
+
+    char *pcHeap = NULL;                        // NULL while the text fits in cInline
+    char cInline[DF_HOST_STRING_SSO_SIZE] = "";
+    size_t uLength = 0;
+    size_t uCapacity = DF_HOST_STRING_SSO_SIZE - 1;
+};
+
+String operator+(const String &in_left, const String &in_right);
+String operator+(const String &in_left, const char *in_right);
+
+/* Public objects ------------------------------------------------------------*/
+extern HardwareSerial Serial;
+extern EspClass ESP;
+
+// Virtual clock, see ma_host.h. delay() moves it forward and runs the WiFi events that became due.
+extern unsigned long millis(void);
+extern unsigned long micros(void);
+extern void delay(uint32_t in_ms);
+extern void delayMicroseconds(uint32_t in_us);
+extern void yield(void);
+
+// Deterministic, seeded by ma_host_reset()
+extern long random(long in_max);
+extern long random(long in_min, long in_max);
+extern void randomSeed(unsigned long in_seed);
+extern uint32_t esp_random(void);
+
+// Counted and turned into a ma_host_restart_t exception, so the caller of the Api sees that control did not come back
+extern void esp_restart(void) __attribute__((noreturn));
+
+#endif /* __MA_HOST_ARDUINO_H */
+
+/*****************************END OF FILE**************************************/
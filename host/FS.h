@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : FS.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the file system classes of the Arduino core.
+  *               The files are real files in a directory of the PC.
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_FS_H
+#define __MA_HOST_FS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Arduino.h"
+
+/* Typedef -------------------------------------------------------------------*/
+struct st_host_file_t;
+
+namespace fs
+{
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+// Open file. Copies share it and the last one closes it, as on the ESP32.
+class File : public Stream
+{
+public:
+    File(void) {}
+    explicit File(st_host_file_t *in_file) : pstFile(in_file) {}
+    File(const File &in_other);
+    File &operator=(const File &in_other);
+    ~File();
+
+    size_t write(uint8_t in_byte) override { return write(&in_byte, 1); }
+    size_t write(const uint8_t *in_buffer, size_t in_size) override;
+    using Print::write;
+    int available(void) override;
+    int read(void) override;
+    size_t read(uint8_t *out_buffer, size_t in_size);
+    int peek(void) override;
+    void flush(void) override {}
+    bool seek(uint32_t in_position, SeekMode in_mode = SeekSet);
+    size_t position(void) const;
+    size_t size(void) const;
+    void close(void);
+    operator bool() const { return pstFile != NULL; }
+
+private:
+    st_host_file_t *pstFile = NULL;
+};
+
+class FS
+{
+public:
+    virtual ~FS() {}
+    File open(const char *in_path, const char *in_mode = "r", bool in_create = false);
+    File open(const String &in_path, const char *in_mode = "r", bool in_create = false) { return open(in_path.c_str(), in_mode, in_create); }
+    bool exists(const char *in_path);
+    bool exists(const String &in_path) { return exists(in_path.c_str()); }
+    bool remove(const char *in_path);
+    bool remove(const String &in_path) { return remove(in_path.c_str()); }
+    bool rename(const char *in_from, const char *in_to);
+};
+
+}
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif /* __MA_HOST_FS_H */
+
+/*****************************END OF FILE**************************************/
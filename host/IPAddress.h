@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : IPAddress.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the IPv4 address of the Arduino core
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_IPADDRESS_H
+#define __MA_HOST_IPADDRESS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+/* Typedef -------------------------------------------------------------------*/
+// As on the ESP32, the uint32_t value holds the first byte in its lowest byte
+class IPAddress
+{
+public:
+    IPAddress(void) { memset(u8Bytes, 0, sizeof(u8Bytes)); }
+    IPAddress(uint8_t in_b0, uint8_t in_b1, uint8_t in_b2, uint8_t in_b3)
+    {
+        u8Bytes[0] = in_b0;
+        u8Bytes[1] = in_b1;
+        u8Bytes[2] = in_b2;
+        u8Bytes[3] = in_b3;
+    }
+    IPAddress(uint32_t in_address)
+    {
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            u8Bytes[i] = (uint8_t)(in_address >> (8 * i));
+        }
+    }
+
+    operator uint32_t() const
+    {
+        return (uint32_t)u8Bytes[0] | ((uint32_t)u8Bytes[1] << 8) | ((uint32_t)u8Bytes[2] << 16) | ((uint32_t)u8Bytes[3] << 24);
+    }
+    bool operator==(const IPAddress &in_other) const { return memcmp(u8Bytes, in_other.u8Bytes, sizeof(u8Bytes)) == 0; }
+    bool operator!=(const IPAddress &in_other) const { return !(*this == in_other); }
+    uint8_t operator[](int in_index) const { return u8Bytes[in_index]; }
+    uint8_t &operator[](int in_index) { return u8Bytes[in_index]; }
+
+private:
+    uint8_t u8Bytes[4];
+};
+
+/* Public objects ------------------------------------------------------------*/
+extern const IPAddress INADDR_NONE;
+
+#endif /* __MA_HOST_IPADDRESS_H */
+
+/*****************************END OF FILE**************************************/
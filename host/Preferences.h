@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : Preferences.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the NVS key-value store of the Arduino core
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_PREFERENCES_H
+#define __MA_HOST_PREFERENCES_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Typedef -------------------------------------------------------------------*/
+// One namespace of the NVS partition. The partition is a fixed table in RAM, it survives
+// ma_host_reset() as NVS survives a reboot; ma_host_nvs_erase() empties it.
+class Preferences
+{
+public:
+    bool begin(const char *in_name, bool in_readOnly = false, const char *in_partitionLabel = NULL);
+    void end(void);
+    bool clear(void);
+    bool remove(const char *in_key);
+    bool isKey(const char *in_key);
+    size_t putBytes(const char *in_key, const void *in_value, size_t in_length);
+    size_t getBytes(const char *in_key, void *out_buffer, size_t in_maxLength);
+    size_t getBytesLength(const char *in_key);
+
+private:
+    char cNamespace[16] = "";
+    bool bStarted = false;
+    bool bReadOnly = false;
+};
+
+#endif /* __MA_HOST_PREFERENCES_H */
+
+/*****************************END OF FILE**************************************/
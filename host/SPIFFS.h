@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : SPIFFS.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the SPIFFS file system of the Arduino core
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_SPIFFS_H
+#define __MA_HOST_SPIFFS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "FS.h"
+
+/* Typedef -------------------------------------------------------------------*/
+namespace fs
+{
+
+// The partition. Files can only be used once it is mounted; the mount and the format take the time set
+// with ma_host_fs_set_costs() on the virtual clock.
+class SPIFFSFS : public FS
+{
+public:
+    bool begin(bool in_formatOnFail = false, const char *in_basePath = "/spiffs", uint8_t in_maxOpenFiles = 10, const char *in_partitionLabel = NULL);
+    bool format(void);
+    size_t totalBytes(void);
+    size_t usedBytes(void);
+    void end(void);
+};
+
+}
+
+/* Public objects ------------------------------------------------------------*/
+extern fs::SPIFFSFS SPIFFS;
+
+#endif /* __MA_HOST_SPIFFS_H */
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : WiFi.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the WiFi library of the Arduino core: a
+  *               simulated radio with its events, and TCP clients and server
+  *               over in-memory sockets
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_WIFI_H
+#define __MA_HOST_WIFI_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+/* Define --------------------------------------------------------------------*/
+#define WIFI_OFF                        WIFI_MODE_NULL
+#define WIFI_STA                        WIFI_MODE_STA
+#define WIFI_AP                         WIFI_MODE_AP
+#define WIFI_AP_STA                     WIFI_MODE_APSTA
+
+#define WIFI_SCAN_RUNNING               (-1)
+#define WIFI_SCAN_FAILED                (-2)
+
+/* Typedef -------------------------------------------------------------------*/
+typedef enum {
+  WIFI_MODE_NULL = 0,
+  WIFI_MODE_STA,
+  WIFI_MODE_AP,
+  WIFI_MODE_APSTA,
+  WIFI_MODE_MAX
+}wifi_mode_t;
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL,
+  WL_SCAN_COMPLETED,
+  WL_CONNECTED,
+  WL_CONNECT_FAILED,
+  WL_CONNECTION_LOST,
+  WL_DISCONNECTED,
+  WL_NO_SHIELD = 255
+}wl_status_t;
+
+// Same order as the Arduino core 2.x
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0,
+  ARDUINO_EVENT_WIFI_SCAN_DONE,
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP6,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+  ARDUINO_EVENT_WIFI_AP_START,
+  ARDUINO_EVENT_WIFI_AP_STOP,
+  ARDUINO_EVENT_WIFI_AP_STACONNECTED,
+  ARDUINO_EVENT_WIFI_AP_STADISCONNECTED,
+  ARDUINO_EVENT_MAX
+}arduino_event_id_t;
+
+// wifi_err_reason_t of ESP-IDF
+typedef enum {
+  WIFI_REASON_UNSPECIFIED = 1,
+  WIFI_REASON_AUTH_EXPIRE = 2,
+  WIFI_REASON_AUTH_LEAVE = 3,
+  WIFI_REASON_ASSOC_EXPIRE = 4,
+  WIFI_REASON_ASSOC_LEAVE = 8,
+  WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+  WIFI_REASON_BEACON_TIMEOUT = 200,
+  WIFI_REASON_NO_AP_FOUND = 201,
+  WIFI_REASON_AUTH_FAIL = 202,
+  WIFI_REASON_ASSOC_FAIL = 203,
+  WIFI_REASON_HANDSHAKE_TIMEOUT = 204,
+  WIFI_REASON_CONNECTION_FAIL = 205
+}wifi_err_reason_t;
+
+typedef enum {
+  WIFI_AUTH_OPEN = 0,
+  WIFI_AUTH_WEP,
+  WIFI_AUTH_WPA_PSK,
+  WIFI_AUTH_WPA2_PSK,
+  WIFI_AUTH_WPA_WPA2_PSK,
+  WIFI_AUTH_WPA2_ENTERPRISE,
+  WIFI_AUTH_WPA3_PSK,
+  WIFI_AUTH_MAX
+}wifi_auth_mode_t;
+
+typedef struct {
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+  uint8_t bssid[6];
+  uint8_t reason;                   // wifi_err_reason_t
+}wifi_event_sta_disconnected_t;
+
+typedef struct {
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+  uint8_t bssid[6];
+  uint8_t channel;
+  wifi_auth_mode_t authmode;
+}wifi_event_sta_connected_t;
+
+typedef union {
+  wifi_event_sta_disconnected_t wifi_sta_disconnected;
+  wifi_event_sta_connected_t wifi_sta_connected;
+}arduino_event_info_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+typedef arduino_event_info_t WiFiEventInfo_t;
+typedef void (*WiFiEventFuncCb)(arduino_event_id_t in_event, arduino_event_info_t in_info);
+typedef int wifi_event_id_t;
+
+// Scan result, as given by WiFi.getScanInfoByIndex()
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t ssid[33];
+  uint8_t primary;                  // Channel
+  int8_t rssi;
+  wifi_auth_mode_t authmode;
+}wifi_ap_record_t;
+
+struct st_host_socket_t;
+
+// Device side of a TCP connection. Copies share the socket, as on the ESP32.
+class WiFiClient : public Stream
+{
+public:
+    WiFiClient(void) {}
+    explicit WiFiClient(st_host_socket_t *in_socket);
+    WiFiClient(const WiFiClient &in_other);
+    WiFiClient &operator=(const WiFiClient &in_other);
+    ~WiFiClient();
+
+    uint8_t connected(void);
+    int available(void) override;
+    int read(void) override;
+    int read(uint8_t *out_buffer, size_t in_size);
+    int peek(void) override;
+    size_t write(uint8_t in_byte) override { return write(&in_byte, 1); }
+    size_t write(const uint8_t *in_buffer, size_t in_size) override;
+    using Print::write;
+    void flush(void) override {}
+    void stop(void);
+    int setNoDelay(bool in_noDelay) { (void)in_noDelay; return 0; }
+    IPAddress remoteIP(void) const;
+    operator bool() { return connected(); }
+    bool operator==(const WiFiClient &in_other) const { return pstSocket == in_other.pstSocket; }
+
+private:
+    st_host_socket_t *pstSocket = NULL;
+};
+
+// Listening socket. Connections are opened by ma_host_net_connect().
+class WiFiServer
+{
+public:
+    explicit WiFiServer(uint16_t in_port = 80, uint8_t in_maxClients = 4) : u16Port(in_port) { (void)in_maxClients; }
+    ~WiFiServer() { end(); }
+    void begin(uint16_t in_port = 0);
+    void end(void);
+    void close(void) { end(); }
+    void stop(void) { end(); }
+    WiFiClient accept(void);
+    WiFiClient available(void) { return accept(); }
+    bool hasClient(void);
+    void setNoDelay(bool in_noDelay) { (void)in_noDelay; }
+    operator bool() { return bListening; }
+
+private:
+    uint16_t u16Port;
+    bool bListening = false;
+};
+
+// The radio, simulated by ma_host_wifi.cpp. The access points around are set with ma_host_wifi_add_ap().
+class WiFiClass
+{
+public:
+    bool mode(wifi_mode_t in_mode);
+    wifi_mode_t getMode(void);
+
+    bool softAP(const char *in_ssid, const char *in_password = NULL, int in_channel = 1, int in_hidden = 0, int in_maxConnections = 4);
+    bool softAPConfig(IPAddress in_ip, IPAddress in_gateway, IPAddress in_mask);
+    bool softAPdisconnect(bool in_wifiOff = false);
+    IPAddress softAPIP(void);
+
+    wl_status_t begin(const char *in_ssid, const char *in_password = NULL, int32_t in_channel = 0, const uint8_t *in_bssid = NULL, bool in_connect = true);
+    bool config(IPAddress in_ip, IPAddress in_gateway, IPAddress in_mask, IPAddress in_dns1 = (uint32_t)0, IPAddress in_dns2 = (uint32_t)0);
+    bool disconnect(bool in_wifiOff = false, bool in_eraseAp = false);
+    bool setAutoReconnect(bool in_autoReconnect);
+    wl_status_t status(void);
+    IPAddress localIP(void);
+    IPAddress gatewayIP(void);
+    IPAddress subnetMask(void);
+    IPAddress dnsIP(uint8_t in_index = 0);
+    uint8_t *BSSID(void);
+    int32_t channel(void);
+    int8_t RSSI(void);
+
+    int16_t scanNetworks(bool in_async = false, bool in_showHidden = false, bool in_passive = false, uint32_t in_maxMsPerChannel = 300, uint8_t in_channel = 0);
+    int16_t scanComplete(void);
+    void scanDelete(void);
+    void *getScanInfoByIndex(int in_index);
+
+    wifi_event_id_t onEvent(WiFiEventFuncCb in_callback, arduino_event_id_t in_event = ARDUINO_EVENT_MAX);
+    void removeEvent(wifi_event_id_t in_id);
+};
+
+/* Public objects ------------------------------------------------------------*/
+extern WiFiClass WiFi;
+
+#endif /* __MA_HOST_WIFI_H */
+
+/*****************************END OF FILE**************************************/
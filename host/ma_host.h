@@ -0,0 +1,145 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_host.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Control of the host build of the Arduino core, used by the
+  *               tests, the benchmarks and the load simulator
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_H
+#define __MA_HOST_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+/* Define --------------------------------------------------------------------*/
+#define DF_HOST_HEAP_SIZE               (320 * 1024)    // Heap reported by ESP.getHeapSize(), as on an ESP32 with WiFi up
+#define DF_HOST_SOCKET_BUFFER_SIZE      (32 * 1024)     // Bytes queued in each direction of a socket
+#define DF_HOST_SOCKET_WRITE_LOG_SIZE   128             // Writes of the device whose size is kept, see st_host_socket_stats_t
+
+// connectMs, fastConnectMs, dhcpMs, scanMs, reconnectMs: times measured on an ESP32 and a home router
+#define DF_HOST_WIFI_TIMING_DEFAULT     {1500, 250, 600, 2200, 1000}
+
+/* Typedef -------------------------------------------------------------------*/
+// Counted since the start of the program, see ma_host_get_stats()
+typedef struct {
+  uint64_t allocations;             // operator new and String buffers
+  uint64_t frees;
+  uint64_t bytesAllocated;
+  uint64_t bytesCopied;             // memcpy and memmove calls, only where the build wraps them (-Wl,--wrap)
+  size_t bytesInUse;
+  size_t peakBytesInUse;            // Since ma_host_reset_peak()
+}st_host_stats_t;
+
+// Thrown by esp_restart(), the caller of the Api catches it where the device would reboot
+typedef struct {
+  uint32_t count;                   // Restarts so far, this one included
+}ma_host_restart_t;
+
+// Timings of the simulated radio, on the virtual clock
+typedef struct {
+  uint32_t connectMs;               // Scan of the channels, association and handshake of WiFi.begin(ssid, password)
+  uint32_t fastConnectMs;           // Association when the channel and the BSSID are given
+  uint32_t dhcpMs;                  // Address from DHCP, skipped after WiFi.config() with an address
+  uint32_t scanMs;                  // WiFi.scanNetworks()
+  uint32_t reconnectMs;             // Reconnection of the driver after a link loss, with setAutoReconnect(true)
+}st_host_wifi_timing_t;
+
+typedef struct {
+  uint32_t begins;                  // WiFi.begin() calls
+  uint32_t fastBegins;              // ... with channel and BSSID
+  uint32_t scans;                   // WiFi.scanNetworks() calls
+  uint32_t disconnects;             // WiFi.disconnect() calls
+  uint32_t eventsDispatched;
+}st_host_wifi_stats_t;
+
+// One side of a TCP connection, seen from the phone
+typedef struct {
+  uint32_t writeCalls;              // WiFiClient::write() calls of the device, each one a TCP segment or more
+  uint32_t bytesWritten;
+  uint32_t readCalls;               // WiFiClient::read() calls of the device
+  uint32_t bytesRead;
+  uint16_t writeSizes[DF_HOST_SOCKET_WRITE_LOG_SIZE];   // Size of the first writes
+}st_host_socket_stats_t;
+
+typedef struct {
+  uint32_t mounts;                  // SPIFFS.begin() that mounted
+  uint32_t formats;
+  uint32_t opens;
+  uint32_t writes;                  // Files opened for writing
+  uint32_t removes;
+  uint32_t bytesRead;
+  uint32_t bytesWritten;
+}st_host_fs_stats_t;
+
+typedef struct {
+  uint32_t reads;
+  uint32_t writes;                  // putBytes() calls, the wear of the partition
+  uint32_t erases;
+  uint32_t bytesWritten;
+}st_host_nvs_stats_t;
+
+/* Public objects ------------------------------------------------------------*/
+// Program. ma_host_reset() puts the clock, the radio, the sockets and the random numbers back to
+// power on; the files and the NVS are kept, as through a reboot.
+extern void ma_host_reset(void);
+extern void ma_host_get_stats(st_host_stats_t *out_stats);
+extern void ma_host_reset_peak(void);
+extern void ma_host_serial_echo(bool in_echo);
+extern uint32_t ma_host_restart_count(void);
+
+// Virtual clock, starts at 0. Moving it runs the WiFi events that became due, in order.
+extern uint64_t ma_host_clock_us(void);
+extern void ma_host_clock_advance(uint32_t in_ms);
+extern void ma_host_clock_advance_us(uint64_t in_us);
+
+// Radio: access points around, failures and link loss
+extern void ma_host_wifi_reset(void);
+extern void ma_host_wifi_set_timing(const st_host_wifi_timing_t *in_timing);
+extern int ma_host_wifi_add_ap(const char *in_ssid, const char *in_password, int8_t in_rssi, uint8_t in_channel);
+extern void ma_host_wifi_set_ap_in_range(int in_index, bool in_inRange);
+extern void ma_host_wifi_fail_next(uint8_t in_reason, uint8_t in_count);
+extern void ma_host_wifi_fail_scans(bool in_fail);
+extern void ma_host_wifi_drop_link(uint8_t in_reason);
+extern bool ma_host_wifi_ap_running(void);
+extern void ma_host_wifi_get_stats(st_host_wifi_stats_t *out_stats);
+
+// Network: the phone side of the TCP connections to a WiFiServer
+extern st_host_socket_t *ma_host_net_connect(uint16_t in_port);
+extern size_t ma_host_net_send(st_host_socket_t *io_socket, const void *in_data, size_t in_length);
+extern size_t ma_host_net_recv(st_host_socket_t *io_socket, void *out_buffer, size_t in_size);
+extern size_t ma_host_net_pending(st_host_socket_t *in_socket);
+extern void ma_host_net_close(st_host_socket_t *io_socket);
+extern bool ma_host_net_is_closed(st_host_socket_t *in_socket);
+extern void ma_host_net_release(st_host_socket_t *io_socket);
+extern void ma_host_net_get_stats(st_host_socket_t *in_socket, st_host_socket_stats_t *out_stats);
+extern uint32_t ma_host_net_open_sockets(void);
+
+// SPIFFS: files in a directory of the PC, with power loss and corruption
+extern void ma_host_fs_set_root(const char *in_path);
+extern void ma_host_fs_erase(void);
+extern void ma_host_fs_set_costs(uint32_t in_mountMs, uint32_t in_formatMs, uint32_t in_fileUs);
+extern void ma_host_fs_set_corrupt(bool in_corrupt);
+extern void ma_host_fs_power_fail_after(size_t in_bytes);
+extern void ma_host_fs_power_restore(void);
+extern bool ma_host_fs_is_mounted(void);
+extern void ma_host_fs_get_stats(st_host_fs_stats_t *out_stats);
+
+// NVS
+extern void ma_host_nvs_erase(void);
+extern void ma_host_nvs_set_corrupt(bool in_corrupt);
+extern void ma_host_nvs_set_costs(uint32_t in_readUs, uint32_t in_writeUs);
+extern void ma_host_nvs_get_stats(st_host_nvs_stats_t *out_stats);
+
+#endif /* __MA_HOST_H */
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,868 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_host_arduino.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the Arduino core: virtual clock, counted heap,
+  *               String, Print, Serial, ESP and esp_restart()
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <ctype.h>
+#include <new>
+#include <atomic>
+#include <thread>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "ma_host.h"
+#include "ma_host_private.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	Nothing runs in real time. The clock starts at 0 and only moves with
+    delay(), delayMicroseconds() and ma_host_clock_advance(); the WiFi
+    events that became due are dispatched on the way, in time order, on
+    the thread that moved the clock. A test is therefore as fast as the
+    CPU and gives the same result on every run.
+
+2.  Every operator new and every String buffer goes through a counted
+    block with a small header, so ma_host_get_stats() gives the
+    allocations, the bytes in use and the peak. ESP.getFreeHeap() and
+    ESP.getMinFreeHeap() are DF_HOST_HEAP_SIZE minus these.
+
+3.  String keeps up to DF_HOST_STRING_SSO_SIZE - 1 characters in the
+    object and grows its buffer to the exact length asked, as the String
+    of the ESP32 core does, so the allocation counts match the device.
+
+4.  esp_restart() throws ma_host_restart_t: the test catches it where the
+    device would reboot, then calls ma_host_reset() and the setup again.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_HOST_BLOCK_HEADER            16      // Keeps the alignment of malloc()
+#define DF_HOST_PRINTF_BUFFER           64      // Longer output is formatted in a heap buffer, as by the core
+#define DF_HOST_RANDOM_SEED             0x9E3779B97F4A7C15ULL
+
+/* Private macros ------------------------------------------------------------*/
+#ifdef MA_HOST_WRAP_COPIES
+// The build counts memcpy(), see ma_host_copy.cpp
+extern "C" void *__real_memcpy(void *out_destination, const void *in_source, size_t in_length);
+#define HOST_RAW_MEMCPY(destination, source, length) __real_memcpy(destination, source, length)
+#else
+#define HOST_RAW_MEMCPY(destination, source, length) memcpy(destination, source, length)
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static std::atomic<uint64_t> u64HostAllocations(0);
+static std::atomic<uint64_t> u64HostFrees(0);
+static std::atomic<uint64_t> u64HostBytesAllocated(0);
+static std::atomic<uint64_t> u64HostBytesCopied(0);
+static std::atomic<size_t> uHostBytesInUse(0);
+static std::atomic<size_t> uHostPeakBytesInUse(0);
+static std::atomic<size_t> uHostLifetimePeak(0);
+
+static std::atomic<uint64_t> u64HostClockUs(0);
+static std::atomic<uint64_t> u64HostRandomState(DF_HOST_RANDOM_SEED);
+static std::atomic<uint32_t> u32HostRestarts(0);
+static std::atomic<bool> bHostSerialEcho(false);
+
+/* Public objects ------------------------------------------------------------*/
+HardwareSerial Serial;
+EspClass ESP;
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+/* Private function prototypes -----------------------------------------------*/
+static void ma_host_raise_peak(std::atomic<size_t> &io_peak, size_t in_value);
+static void ma_host_clock_move_to(uint64_t in_us);
+static void ma_host_format_number(char *out_text, unsigned long in_value, unsigned in_base);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_host_heap_alloc
+  * @brief      : Allocates a counted block
+  * @pre-cond.  : None
+  * @post-cond. : The block is counted in use until ma_host_heap_free()
+  * @parameters : in_size: Bytes for the caller
+  * @retval     : The block, NULL when out of memory
+  */
+void *ma_host_heap_alloc(size_t in_size)
+{
+    uint8_t *block = (uint8_t *)malloc(DF_HOST_BLOCK_HEADER + in_size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    *(size_t *)block = in_size;
+    u64HostAllocations.fetch_add(1, std::memory_order_relaxed);
+    u64HostBytesAllocated.fetch_add(in_size, std::memory_order_relaxed);
+    size_t inUse = uHostBytesInUse.fetch_add(in_size, std::memory_order_relaxed) + in_size;
+    ma_host_raise_peak(uHostPeakBytesInUse, inUse);
+    ma_host_raise_peak(uHostLifetimePeak, inUse);
+    return block + DF_HOST_BLOCK_HEADER;
+}
+
+/**
+  * @Func       : ma_host_heap_realloc
+  * @brief      : Moves a counted block to a new size, counted as a new block and a free
+  * @pre-cond.  : io_block is NULL or from ma_host_heap_alloc()
+  * @post-cond. : The content is kept up to the smaller size
+  * @parameters :
+  *       - io_block: Block to grow, NULL to allocate
+  *       - in_size: New size
+  * @retval     : The new block, NULL when out of memory (io_block is then kept)
+  */
+void *ma_host_heap_realloc(void *io_block, size_t in_size)
+{
+    void *block = ma_host_heap_alloc(in_size);
+    if (block == NULL || io_block == NULL)
+    {
+        return block;
+    }
+    size_t oldSize = *(size_t *)((uint8_t *)io_block - DF_HOST_BLOCK_HEADER);
+    memcpy(block, io_block, (oldSize < in_size) ? oldSize : in_size);
+    ma_host_heap_free(io_block);
+    return block;
+}
+
+/**
+  * @Func       : ma_host_heap_free
+  * @brief      : Frees a counted block
+  * @pre-cond.  : io_block is NULL or from ma_host_heap_alloc()
+  * @post-cond. : None
+  * @parameters : io_block: Block to free
+  * @retval     : None
+  */
+void ma_host_heap_free(void *io_block)
+{
+    if (io_block == NULL)
+    {
+        return;
+    }
+    uint8_t *block = (uint8_t *)io_block - DF_HOST_BLOCK_HEADER;
+    u64HostFrees.fetch_add(1, std::memory_order_relaxed);
+    uHostBytesInUse.fetch_sub(*(size_t *)block, std::memory_order_relaxed);
+    free(block);
+}
+
+/**
+  * @Func       : ma_host_count_copy
+  * @brief      : Counts the bytes of a memcpy() or memmove(), see ma_host_copy.cpp
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_bytes: Bytes copied
+  * @retval     : None
+  */
+void ma_host_count_copy(size_t in_bytes)
+{
+    u64HostBytesCopied.fetch_add(in_bytes, std::memory_order_relaxed);
+}
+
+/**
+  * @Func       : ma_host_copy_uncounted
+  * @brief      : memcpy() left out of bytesCopied, for the phone side of the sockets
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - out_destination: Destination
+  *       - in_source: Source
+  *       - in_length: Bytes
+  * @retval     : None
+  */
+void ma_host_copy_uncounted(void *out_destination, const void *in_source, size_t in_length)
+{
+    HOST_RAW_MEMCPY(out_destination, in_source, in_length);
+}
+
+/**
+  * @Func       : ma_host_get_stats
+  * @brief      : Gives the heap and copy counters
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : out_stats: Counters since the start of the program
+  * @retval     : None
+  */
+void ma_host_get_stats(st_host_stats_t *out_stats)
+{
+    out_stats->allocations = u64HostAllocations.load();
+    out_stats->frees = u64HostFrees.load();
+    out_stats->bytesAllocated = u64HostBytesAllocated.load();
+    out_stats->bytesCopied = u64HostBytesCopied.load();
+    out_stats->bytesInUse = uHostBytesInUse.load();
+    out_stats->peakBytesInUse = uHostPeakBytesInUse.load();
+}
+
+/**
+  * @Func       : ma_host_reset_peak
+  * @brief      : Starts a new peak of the bytes in use from the current value
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_host_reset_peak(void)
+{
+    uHostPeakBytesInUse.store(uHostBytesInUse.load());
+}
+
+/**
+  * @Func       : ma_host_serial_echo
+  * @brief      : Sends the output of Serial to stdout or drops it
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_echo: true to print
+  * @retval     : None
+  */
+void ma_host_serial_echo(bool in_echo)
+{
+    bHostSerialEcho.store(in_echo);
+}
+
+/**
+  * @Func       : ma_host_restart_count
+  * @brief      : Gives the esp_restart() calls since the start of the program
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Number of restarts
+  */
+uint32_t ma_host_restart_count(void)
+{
+    return u32HostRestarts.load();
+}
+
+/**
+  * @Func       : ma_host_reset
+  * @brief      : Power on: clock at 0, radio off, no sockets, random numbers from the seed
+  * @pre-cond.  : No thread of the Api is running
+  * @post-cond. : The files and the NVS are kept, SPIFFS is not mounted
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_host_reset(void)
+{
+    u64HostClockUs.store(0);
+    u64HostRandomState.store(DF_HOST_RANDOM_SEED);
+    ma_host_wifi_reset();
+    ma_host_net_reset();
+    ma_host_fs_reset();
+}
+
+/**
+  * @Func       : ma_host_clock_us
+  * @brief      : Gives the virtual clock
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Microseconds since ma_host_reset()
+  */
+uint64_t ma_host_clock_us(void)
+{
+    return u64HostClockUs.load();
+}
+
+/**
+  * @Func       : ma_host_clock_advance
+  * @brief      : Moves the virtual clock, see ma_host_clock_advance_us()
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_ms: Milliseconds
+  * @retval     : None
+  */
+void ma_host_clock_advance(uint32_t in_ms)
+{
+    ma_host_clock_advance_us((uint64_t)in_ms * 1000u);
+}
+
+/**
+  * @Func       : ma_host_clock_advance_us
+  * @brief      : Moves the virtual clock and runs the WiFi events due on the way
+  * @pre-cond.  : Not called from a WiFi event callback
+  * @post-cond. : Each event runs with the clock at its due time
+  * @parameters : in_us: Microseconds, 0 runs the events already due
+  * @retval     : None
+  */
+void ma_host_clock_advance_us(uint64_t in_us)
+{
+    uint64_t target = u64HostClockUs.load() + in_us;
+    uint64_t dueUs;
+
+    while (ma_host_wifi_next_due(&dueUs) && dueUs <= target)
+    {
+        ma_host_clock_move_to(dueUs);
+        ma_host_wifi_run(dueUs);
+    }
+    ma_host_clock_move_to(target);
+}
+
+unsigned long millis(void)
+{
+    return (unsigned long)(u64HostClockUs.load() / 1000u);
+}
+
+unsigned long micros(void)
+{
+    return (unsigned long)u64HostClockUs.load();
+}
+
+void delay(uint32_t in_ms)
+{
+    ma_host_clock_advance(in_ms);
+    // Lets the other threads of a test run, as the scheduler of the ESP32 does
+    std::this_thread::yield();
+}
+
+void delayMicroseconds(uint32_t in_us)
+{
+    ma_host_clock_advance_us(in_us);
+}
+
+void yield(void)
+{
+    std::this_thread::yield();
+}
+
+uint32_t esp_random(void)
+{
+    // xorshift64*, the same numbers on every run
+    uint64_t x = u64HostRandomState.load();
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    u64HostRandomState.store(x);
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+long random(long in_max)
+{
+    if (in_max <= 0)
+    {
+        return 0;
+    }
+    return (long)(esp_random() % (uint32_t)in_max);
+}
+
+long random(long in_min, long in_max)
+{
+    if (in_min >= in_max)
+    {
+        return in_min;
+    }
+    return in_min + random(in_max - in_min);
+}
+
+void randomSeed(unsigned long in_seed)
+{
+    if (in_seed != 0)
+    {
+        u64HostRandomState.store(in_seed);
+    }
+}
+
+void esp_restart(void)
+{
+    ma_host_restart_t restart;
+    restart.count = u32HostRestarts.fetch_add(1) + 1;
+    throw restart;
+}
+
+/* Print ---------------------------------------------------------------------*/
+size_t Print::write(const uint8_t *in_buffer, size_t in_size)
+{
+    size_t written = 0;
+    while (written < in_size && write(in_buffer[written]) == 1)
+    {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::print(const String &in_text)
+{
+    return write(in_text.c_str(), in_text.length());
+}
+
+size_t Print::print(long in_value, int in_base)
+{
+    if (in_base == DEC && in_value < 0)
+    {
+        return print('-') + print((unsigned long)-in_value, DEC);
+    }
+    return print((unsigned long)in_value, in_base);
+}
+
+size_t Print::print(unsigned long in_value, int in_base)
+{
+    char text[8 * sizeof(unsigned long) + 1];
+    ma_host_format_number(text, in_value, (unsigned)in_base);
+    return write(text);
+}
+
+size_t Print::printf(const char *in_format, ...)
+{
+    char stackBuffer[DF_HOST_PRINTF_BUFFER];
+    va_list args;
+
+    va_start(args, in_format);
+    int length = vsnprintf(stackBuffer, sizeof(stackBuffer), in_format, args);
+    va_end(args);
+    if (length < 0)
+    {
+        return 0;
+    }
+    if ((size_t)length < sizeof(stackBuffer))
+    {
+        return write((const uint8_t *)stackBuffer, (size_t)length);
+    }
+
+    char *heapBuffer = new char[length + 1];
+    va_start(args, in_format);
+    vsnprintf(heapBuffer, length + 1, in_format, args);
+    va_end(args);
+    size_t written = write((const uint8_t *)heapBuffer, (size_t)length);
+    delete[] heapBuffer;
+    return written;
+}
+
+size_t Stream::readBytes(uint8_t *out_buffer, size_t in_length)
+{
+    // The bytes of a test are all there or will never come: no waiting for ulTimeoutMs
+    size_t count = 0;
+    while (count < in_length)
+    {
+        int c = read();
+        if (c < 0)
+        {
+            break;
+        }
+        out_buffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+size_t HardwareSerial::write(const uint8_t *in_buffer, size_t in_size)
+{
+    if (bHostSerialEcho.load())
+    {
+        fwrite(in_buffer, 1, in_size, stdout);
+    }
+    return in_size;
+}
+
+/* ESP -----------------------------------------------------------------------*/
+uint32_t EspClass::getFreeHeap(void)
+{
+    size_t inUse = uHostBytesInUse.load();
+    return (inUse < DF_HOST_HEAP_SIZE) ? (uint32_t)(DF_HOST_HEAP_SIZE - inUse) : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap(void)
+{
+    size_t peak = uHostLifetimePeak.load();
+    return (peak < DF_HOST_HEAP_SIZE) ? (uint32_t)(DF_HOST_HEAP_SIZE - peak) : 0;
+}
+
+uint32_t EspClass::getMaxAllocHeap(void)
+{
+    return getFreeHeap();
+}
+
+uint32_t EspClass::getHeapSize(void)
+{
+    return DF_HOST_HEAP_SIZE;
+}
+
+void EspClass::restart(void)
+{
+    esp_restart();
+}
+
+/* String --------------------------------------------------------------------*/
+String::String(const char *in_text)
+{
+    if (in_text != NULL)
+    {
+        concat(in_text, strlen(in_text));
+    }
+}
+
+String::String(const char *in_text, size_t in_length)
+{
+    if (in_text != NULL)
+    {
+        concat(in_text, in_length);
+    }
+}
+
+String::String(const String &in_other)
+{
+    concat(in_other.c_str(), in_other.uLength);
+}
+
+String::String(String &&io_other) noexcept
+{
+    *this = static_cast<String &&>(io_other);
+}
+
+String::String(char in_char)
+{
+    concat(&in_char, 1);
+}
+
+String::String(int in_value, unsigned char in_base)
+{
+    char text[8 * sizeof(long) + 2];
+    if (in_base == DEC && in_value < 0)
+    {
+        text[0] = '-';
+        ma_host_format_number(text + 1, (unsigned long)-(long)in_value, DEC);
+    }
+    else
+    {
+        ma_host_format_number(text, (unsigned long)(unsigned int)in_value, in_base);
+    }
+    concat(text);
+}
+
+String::String(unsigned int in_value, unsigned char in_base)
+{
+    char text[8 * sizeof(long) + 1];
+    ma_host_format_number(text, in_value, in_base);
+    concat(text);
+}
+
+String::String(long in_value, unsigned char in_base)
+{
+    char text[8 * sizeof(long) + 2];
+    if (in_base == DEC && in_value < 0)
+    {
+        text[0] = '-';
+        ma_host_format_number(text + 1, (unsigned long)-in_value, DEC);
+    }
+    else
+    {
+        ma_host_format_number(text, (unsigned long)in_value, in_base);
+    }
+    concat(text);
+}
+
+String::String(unsigned long in_value, unsigned char in_base)
+{
+    char text[8 * sizeof(long) + 1];
+    ma_host_format_number(text, in_value, in_base);
+    concat(text);
+}
+
+String::~String()
+{
+    ma_host_heap_free(pcHeap);
+}
+
+String &String::operator=(const String &in_other)
+{
+    if (this != &in_other)
+    {
+        uLength = 0;
+        buffer()[0] = '\0';
+        concat(in_other.c_str(), in_other.uLength);
+    }
+    return *this;
+}
+
+String &String::operator=(String &&io_other) noexcept
+{
+    if (this == &io_other)
+    {
+        return *this;
+    }
+    ma_host_heap_free(pcHeap);
+    pcHeap = io_other.pcHeap;
+    memcpy(cInline, io_other.cInline, sizeof(cInline));
+    uLength = io_other.uLength;
+    uCapacity = io_other.uCapacity;
+
+    io_other.pcHeap = NULL;
+    io_other.cInline[0] = '\0';
+    io_other.uLength = 0;
+    io_other.uCapacity = DF_HOST_STRING_SSO_SIZE - 1;
+    return *this;
+}
+
+String &String::operator=(const char *in_text)
+{
+    if (in_text >= c_str() && in_text <= c_str() + uLength)
+    {
+        // A part of this string: move it to the front
+        size_t length = strlen(in_text);
+        memmove(buffer(), in_text, length + 1);
+        uLength = length;
+        return *this;
+    }
+    uLength = 0;
+    buffer()[0] = '\0';
+    if (in_text != NULL)
+    {
+        concat(in_text, strlen(in_text));
+    }
+    return *this;
+}
+
+bool String::reserve(size_t in_size)
+{
+    if (in_size <= uCapacity)
+    {
+        return true;
+    }
+    char *block = (char *)ma_host_heap_realloc(pcHeap, in_size + 1);
+    if (block == NULL)
+    {
+        return false;
+    }
+    if (pcHeap == NULL)
+    {
+        memcpy(block, cInline, uLength + 1);
+    }
+    pcHeap = block;
+    uCapacity = in_size;
+    return true;
+}
+
+bool String::concat(const char *in_text, size_t in_length)
+{
+    if (in_length == 0)
+    {
+        return true;
+    }
+    // The text may be a part of this string, its place can move with the buffer
+    const char *current = c_str();
+    bool inside = (in_text >= current && in_text < current + uLength);
+    size_t offset = (size_t)(in_text - current);
+
+    if (!reserve(uLength + in_length))
+    {
+        return false;
+    }
+    char *text = buffer();
+    memmove(text + uLength, inside ? text + offset : in_text, in_length);
+    uLength += in_length;
+    text[uLength] = '\0';
+    return true;
+}
+
+char &String::operator[](size_t in_index)
+{
+    static char dummy;
+    if (in_index >= uLength)
+    {
+        dummy = '\0';
+        return dummy;
+    }
+    return buffer()[in_index];
+}
+
+int String::indexOf(char in_char, size_t in_from) const
+{
+    if (in_from >= uLength)
+    {
+        return -1;
+    }
+    const char *found = strchr(c_str() + in_from, in_char);
+    return (found != NULL) ? (int)(found - c_str()) : -1;
+}
+
+int String::indexOf(const char *in_text, size_t in_from) const
+{
+    if (in_from > uLength)
+    {
+        return -1;
+    }
+    const char *found = strstr(c_str() + in_from, in_text);
+    return (found != NULL) ? (int)(found - c_str()) : -1;
+}
+
+String String::substring(size_t in_begin, size_t in_end) const
+{
+    if (in_begin > in_end)
+    {
+        size_t swap = in_begin;
+        in_begin = in_end;
+        in_end = swap;
+    }
+    if (in_end > uLength)
+    {
+        in_end = uLength;
+    }
+    if (in_begin >= in_end)
+    {
+        return String();
+    }
+    return String(c_str() + in_begin, in_end - in_begin);
+}
+
+void String::trim(void)
+{
+    char *text = buffer();
+    size_t begin = 0;
+    size_t end = uLength;
+
+    while (begin < end && isspace((unsigned char)text[begin]))
+    {
+        begin++;
+    }
+    while (end > begin && isspace((unsigned char)text[end - 1]))
+    {
+        end--;
+    }
+    uLength = end - begin;
+    memmove(text, text + begin, uLength);
+    text[uLength] = '\0';
+}
+
+String operator+(const String &in_left, const String &in_right)
+{
+    String result(in_left);
+    result.concat(in_right);
+    return result;
+}
+
+String operator+(const String &in_left, const char *in_right)
+{
+    String result(in_left);
+    result.concat(in_right);
+    return result;
+}
+
+/* Counted operator new and delete -------------------------------------------*/
+void *operator new(size_t in_size)
+{
+    void *block = ma_host_heap_alloc(in_size);
+    if (block == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void *operator new[](size_t in_size)
+{
+    return operator new(in_size);
+}
+
+void *operator new(size_t in_size, const std::nothrow_t &) noexcept
+{
+    return ma_host_heap_alloc(in_size);
+}
+
+void *operator new[](size_t in_size, const std::nothrow_t &) noexcept
+{
+    return ma_host_heap_alloc(in_size);
+}
+
+void operator delete(void *io_block) noexcept
+{
+    ma_host_heap_free(io_block);
+}
+
+void operator delete[](void *io_block) noexcept
+{
+    ma_host_heap_free(io_block);
+}
+
+void operator delete(void *io_block, size_t) noexcept
+{
+    ma_host_heap_free(io_block);
+}
+
+void operator delete[](void *io_block, size_t) noexcept
+{
+    ma_host_heap_free(io_block);
+}
+
+void operator delete(void *io_block, const std::nothrow_t &) noexcept
+{
+    ma_host_heap_free(io_block);
+}
+
+void operator delete[](void *io_block, const std::nothrow_t &) noexcept
+{
+    ma_host_heap_free(io_block);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_host_raise_peak
+  * @brief      : Raises a peak counter to in_value if it is lower
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - io_peak: Counter
+  *       - in_value: New value
+  * @retval     : None
+  */
+static void ma_host_raise_peak(std::atomic<size_t> &io_peak, size_t in_value)
+{
+    size_t peak = io_peak.load(std::memory_order_relaxed);
+    while (peak < in_value && !io_peak.compare_exchange_weak(peak, in_value, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+  * @Func       : ma_host_clock_move_to
+  * @brief      : Moves the clock forward to in_us, never back
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_us: Time
+  * @retval     : None
+  */
+static void ma_host_clock_move_to(uint64_t in_us)
+{
+    uint64_t now = u64HostClockUs.load();
+    while (now < in_us && !u64HostClockUs.compare_exchange_weak(now, in_us))
+    {
+    }
+}
+
+/**
+  * @Func       : ma_host_format_number
+  * @brief      : Writes an unsigned number in a base from 2 to 16
+  * @pre-cond.  : out_text holds 8 * sizeof(long) + 1 characters
+  * @post-cond. : None
+  * @parameters :
+  *       - out_text: Text, ended by a '\0'
+  *       - in_value: Number
+  *       - in_base: Base, 10 when out of range
+  * @retval     : None
+  */
+static void ma_host_format_number(char *out_text, unsigned long in_value, unsigned in_base)
+{
+    char reversed[8 * sizeof(unsigned long)];
+    size_t count = 0;
+
+    if (in_base < 2 || in_base > 16)
+    {
+        in_base = DEC;
+    }
+    do
+    {
+        unsigned digit = (unsigned)(in_value % in_base);
+        reversed[count++] = (char)((digit < 10) ? '0' + digit : 'A' + digit - 10);
+        in_value /= in_base;
+    } while (in_value != 0);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        out_text[i] = reversed[count - 1 - i];
+    }
+    out_text[count] = '\0';
+}
+
+/*****************************END OF FILE**************************************/
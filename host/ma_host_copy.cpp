@@ -0,0 +1,36 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_host_copy.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Counts the bytes moved by memcpy() and memmove(). Only linked
+  *               in the builds made with -Wl,--wrap=memcpy,--wrap=memmove and
+  *               -fno-builtin-memcpy -fno-builtin-memmove, see CMakeLists.txt
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+
+#include "ma_host_private.h"
+
+/* Public objects ------------------------------------------------------------*/
+extern "C" void *__real_memcpy(void *out_destination, const void *in_source, size_t in_length);
+extern "C" void *__real_memmove(void *out_destination, const void *in_source, size_t in_length);
+
+/* Body of public functions --------------------------------------------------*/
+extern "C" void *__wrap_memcpy(void *out_destination, const void *in_source, size_t in_length)
+{
+    ma_host_count_copy(in_length);
+    return __real_memcpy(out_destination, in_source, in_length);
+}
+
+extern "C" void *__wrap_memmove(void *out_destination, const void *in_source, size_t in_length)
+{
+    ma_host_count_copy(in_length);
+    return __real_memmove(out_destination, in_source, in_length);
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,700 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_host_fs.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of SPIFFS, on files of the PC, and of the NVS
+  *               partition behind Preferences
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <mutex>
+
+#include "FS.h"
+#include "SPIFFS.h"
+#include "Preferences.h"
+#include "ma_host.h"
+#include "ma_host_private.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	SPIFFS is flat: each file is a file of the root directory, set with
+    ma_host_fs_set_root() or made with mkdtemp() on first use. A '/' after
+    the first character of a name becomes a '_'. The files stay there
+    through ma_host_reset(), as the flash does through a reboot.
+
+2.  Nothing works before SPIFFS.begin(), which takes mountMs of the
+    virtual clock. ma_host_fs_set_corrupt(true) makes the mount fail;
+    SPIFFS.begin(true) then formats, which takes formatMs and erases all
+    the files. Each open, write, read and remove takes fileUs.
+
+3.  ma_host_fs_power_fail_after(n) lets n more bytes reach the files: the
+    write that crosses the limit is cut, the ones after it write nothing,
+    as if the power went off. ma_host_fs_power_restore() ends it.
+
+4.  The NVS partition is a table in RAM with the same life as the files.
+    A read takes readUs, a write or an erase writeUs.
+    ma_host_nvs_set_corrupt(true) makes Preferences::begin() fail, as
+    nvs_open() on a partition that can not be read; the entries are kept.
+
+5.  The open files and the NVS table are not on the counted heap.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_HOST_FS_PATH_SIZE            256
+#define DF_HOST_FS_TOTAL_BYTES          (1472 * 1024)   // Default spiffs partition of a 4 MB ESP32
+#define DF_HOST_FS_MOUNT_MS             40              // Mount of an almost empty partition
+#define DF_HOST_FS_FORMAT_MS            5000
+#define DF_HOST_FS_FILE_US              1500
+#define DF_HOST_NVS_READ_US             100
+#define DF_HOST_NVS_WRITE_US            1200
+#define DF_HOST_NVS_MAX_ENTRIES         32
+#define DF_HOST_NVS_MAX_VALUE           2048
+#define DF_HOST_NVS_NAME_SIZE           16              // 15 characters and the terminator
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  char space[DF_HOST_NVS_NAME_SIZE];
+  char key[DF_HOST_NVS_NAME_SIZE];
+  uint8_t value[DF_HOST_NVS_MAX_VALUE];
+  size_t length;
+  bool used;
+}st_host_nvs_entry_t;
+
+/* Public objects ------------------------------------------------------------*/
+struct st_host_file_t
+{
+  int fd;
+  uint32_t references;
+};
+
+fs::SPIFFSFS SPIFFS;
+
+/* Private variables ---------------------------------------------------------*/
+static std::recursive_mutex clsFsMutex;
+static char cHostFsRoot[DF_HOST_FS_PATH_SIZE] = "";
+static bool bHostFsMounted = false;
+static bool bHostFsCorrupt = false;
+static bool bHostFsPowerFailArmed = false;
+static size_t uHostFsPowerBudget = 0;
+static uint32_t u32HostFsMountMs = DF_HOST_FS_MOUNT_MS;
+static uint32_t u32HostFsFormatMs = DF_HOST_FS_FORMAT_MS;
+static uint32_t u32HostFsFileUs = DF_HOST_FS_FILE_US;
+static st_host_fs_stats_t stHostFsStats;
+
+static st_host_nvs_entry_t stHostNvs[DF_HOST_NVS_MAX_ENTRIES];
+static uint32_t u32HostNvsReadUs = DF_HOST_NVS_READ_US;
+static uint32_t u32HostNvsWriteUs = DF_HOST_NVS_WRITE_US;
+static bool bHostNvsCorrupt = false;
+static st_host_nvs_stats_t stHostNvsStats;
+
+/* Private function prototypes -----------------------------------------------*/
+static const char *ma_host_fs_root(void);
+static bool ma_host_fs_path(const char *in_name, char *out_path);
+static void ma_host_fs_wipe(void);
+static st_host_nvs_entry_t *ma_host_nvs_find(const char *in_space, const char *in_key);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_host_fs_set_root
+  * @brief      : Sets the directory that holds the files of SPIFFS
+  * @pre-cond.  : The directory exists
+  * @post-cond. : SPIFFS is unmounted
+  * @parameters : in_path: Directory
+  * @retval     : None
+  */
+void ma_host_fs_set_root(const char *in_path)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    strncpy(cHostFsRoot, in_path, sizeof(cHostFsRoot) - 1);
+    bHostFsMounted = false;
+}
+
+void ma_host_fs_erase(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    ma_host_fs_wipe();
+    bHostFsCorrupt = false;
+}
+
+void ma_host_fs_set_costs(uint32_t in_mountMs, uint32_t in_formatMs, uint32_t in_fileUs)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    u32HostFsMountMs = in_mountMs;
+    u32HostFsFormatMs = in_formatMs;
+    u32HostFsFileUs = in_fileUs;
+}
+
+void ma_host_fs_set_corrupt(bool in_corrupt)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    bHostFsCorrupt = in_corrupt;
+    if (in_corrupt)
+    {
+        bHostFsMounted = false;
+    }
+}
+
+void ma_host_fs_power_fail_after(size_t in_bytes)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    bHostFsPowerFailArmed = true;
+    uHostFsPowerBudget = in_bytes;
+}
+
+void ma_host_fs_power_restore(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    bHostFsPowerFailArmed = false;
+}
+
+bool ma_host_fs_is_mounted(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    return bHostFsMounted;
+}
+
+void ma_host_fs_get_stats(st_host_fs_stats_t *out_stats)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    *out_stats = stHostFsStats;
+}
+
+/**
+  * @Func       : ma_host_fs_reset
+  * @brief      : Unmounts SPIFFS, as a reboot does
+  * @pre-cond.  : No file is open
+  * @post-cond. : The files and the statistics are kept
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_host_fs_reset(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    bHostFsMounted = false;
+}
+
+void ma_host_nvs_erase(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    memset(stHostNvs, 0, sizeof(stHostNvs));
+}
+
+void ma_host_nvs_set_corrupt(bool in_corrupt)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    bHostNvsCorrupt = in_corrupt;
+}
+
+void ma_host_nvs_set_costs(uint32_t in_readUs, uint32_t in_writeUs)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    u32HostNvsReadUs = in_readUs;
+    u32HostNvsWriteUs = in_writeUs;
+}
+
+void ma_host_nvs_get_stats(st_host_nvs_stats_t *out_stats)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    *out_stats = stHostNvsStats;
+}
+
+/* SPIFFS --------------------------------------------------------------------*/
+bool fs::SPIFFSFS::begin(bool in_formatOnFail, const char *in_basePath, uint8_t in_maxOpenFiles, const char *in_partitionLabel)
+{
+    (void)in_basePath;
+    (void)in_maxOpenFiles;
+    (void)in_partitionLabel;
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (bHostFsMounted)
+    {
+        return true;
+    }
+    ma_host_clock_advance(u32HostFsMountMs);
+    if (bHostFsCorrupt)
+    {
+        if (!in_formatOnFail)
+        {
+            return false;
+        }
+        format();
+    }
+    bHostFsMounted = true;
+    stHostFsStats.mounts++;
+    return true;
+}
+
+bool fs::SPIFFSFS::format(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    ma_host_clock_advance(u32HostFsFormatMs);
+    ma_host_fs_wipe();
+    bHostFsCorrupt = false;
+    stHostFsStats.formats++;
+    return true;
+}
+
+size_t fs::SPIFFSFS::totalBytes(void)
+{
+    return DF_HOST_FS_TOTAL_BYTES;
+}
+
+size_t fs::SPIFFSFS::usedBytes(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    DIR *directory = opendir(ma_host_fs_root());
+    size_t used = 0;
+    if (directory == NULL)
+    {
+        return 0;
+    }
+    for (struct dirent *entry = readdir(directory); entry != NULL; entry = readdir(directory))
+    {
+        char path[DF_HOST_FS_PATH_SIZE + 256];
+        struct stat info;
+        snprintf(path, sizeof(path), "%s/%s", ma_host_fs_root(), entry->d_name);
+        if (entry->d_name[0] != '.' && stat(path, &info) == 0)
+        {
+            used += (size_t)info.st_size;
+        }
+    }
+    closedir(directory);
+    return used;
+}
+
+void fs::SPIFFSFS::end(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    bHostFsMounted = false;
+}
+
+/* FS ------------------------------------------------------------------------*/
+fs::File fs::FS::open(const char *in_path, const char *in_mode, bool in_create)
+{
+    (void)in_create;
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    char path[DF_HOST_FS_PATH_SIZE];
+    int flags;
+
+    if (!bHostFsMounted || !ma_host_fs_path(in_path, path))
+    {
+        return File();
+    }
+    switch (in_mode[0])
+    {
+        case 'w': flags = O_CREAT | O_TRUNC | ((in_mode[1] == '+') ? O_RDWR : O_WRONLY); break;
+        case 'a': flags = O_CREAT | O_APPEND | ((in_mode[1] == '+') ? O_RDWR : O_WRONLY); break;
+        default:  flags = (in_mode[1] == '+') ? O_RDWR : O_RDONLY; break;
+    }
+    // With the power gone, nothing reaches the flash anymore
+    if (bHostFsPowerFailArmed && uHostFsPowerBudget == 0 && (flags & O_ACCMODE) != O_RDONLY)
+    {
+        return File();
+    }
+
+    ma_host_clock_advance_us(u32HostFsFileUs);
+    int fd = ::open(path, flags, 0644);
+    if (fd < 0)
+    {
+        return File();
+    }
+    stHostFsStats.opens++;
+    if (in_mode[0] != 'r' || in_mode[1] == '+')
+    {
+        stHostFsStats.writes++;
+    }
+    st_host_file_t *file = (st_host_file_t *)malloc(sizeof(st_host_file_t));
+    file->fd = fd;
+    file->references = 1;
+    return File(file);
+}
+
+bool fs::FS::exists(const char *in_path)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    char path[DF_HOST_FS_PATH_SIZE];
+    return bHostFsMounted && ma_host_fs_path(in_path, path) && access(path, F_OK) == 0;
+}
+
+bool fs::FS::remove(const char *in_path)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    char path[DF_HOST_FS_PATH_SIZE];
+    if (!bHostFsMounted || !ma_host_fs_path(in_path, path) || (bHostFsPowerFailArmed && uHostFsPowerBudget == 0))
+    {
+        return false;
+    }
+    ma_host_clock_advance_us(u32HostFsFileUs);
+    if (unlink(path) != 0)
+    {
+        return false;
+    }
+    stHostFsStats.removes++;
+    return true;
+}
+
+bool fs::FS::rename(const char *in_from, const char *in_to)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    char from[DF_HOST_FS_PATH_SIZE];
+    char to[DF_HOST_FS_PATH_SIZE];
+    if (!bHostFsMounted || !ma_host_fs_path(in_from, from) || !ma_host_fs_path(in_to, to))
+    {
+        return false;
+    }
+    ma_host_clock_advance_us(u32HostFsFileUs);
+    return ::rename(from, to) == 0;
+}
+
+/* File ----------------------------------------------------------------------*/
+fs::File::File(const File &in_other) : Stream(in_other), pstFile(in_other.pstFile)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (pstFile != NULL)
+    {
+        pstFile->references++;
+    }
+}
+
+fs::File &fs::File::operator=(const File &in_other)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (in_other.pstFile != NULL)
+    {
+        in_other.pstFile->references++;
+    }
+    close();
+    pstFile = in_other.pstFile;
+    return *this;
+}
+
+fs::File::~File()
+{
+    close();
+}
+
+size_t fs::File::write(const uint8_t *in_buffer, size_t in_size)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (pstFile == NULL)
+    {
+        return 0;
+    }
+    size_t length = in_size;
+    if (bHostFsPowerFailArmed)
+    {
+        length = (length < uHostFsPowerBudget) ? length : uHostFsPowerBudget;
+        uHostFsPowerBudget -= length;
+    }
+    ssize_t written = (length > 0) ? ::write(pstFile->fd, in_buffer, length) : 0;
+    if (written <= 0)
+    {
+        return 0;
+    }
+    stHostFsStats.bytesWritten += (uint32_t)written;
+    return (size_t)written;
+}
+
+int fs::File::available(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    return (pstFile != NULL) ? (int)(size() - position()) : 0;
+}
+
+int fs::File::read(void)
+{
+    uint8_t byte;
+    return (read(&byte, 1) == 1) ? byte : -1;
+}
+
+size_t fs::File::read(uint8_t *out_buffer, size_t in_size)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (pstFile == NULL)
+    {
+        return 0;
+    }
+    ssize_t count = ::read(pstFile->fd, out_buffer, in_size);
+    if (count <= 0)
+    {
+        return 0;
+    }
+    stHostFsStats.bytesRead += (uint32_t)count;
+    return (size_t)count;
+}
+
+int fs::File::peek(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    uint8_t byte;
+    if (pstFile == NULL || pread(pstFile->fd, &byte, 1, lseek(pstFile->fd, 0, SEEK_CUR)) != 1)
+    {
+        return -1;
+    }
+    return byte;
+}
+
+bool fs::File::seek(uint32_t in_position, SeekMode in_mode)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    int whence = (in_mode == SeekCur) ? SEEK_CUR : (in_mode == SeekEnd) ? SEEK_END : SEEK_SET;
+    return pstFile != NULL && lseek(pstFile->fd, (off_t)in_position, whence) >= 0;
+}
+
+size_t fs::File::position(void) const
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    return (pstFile != NULL) ? (size_t)lseek(pstFile->fd, 0, SEEK_CUR) : 0;
+}
+
+size_t fs::File::size(void) const
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    struct stat info;
+    return (pstFile != NULL && fstat(pstFile->fd, &info) == 0) ? (size_t)info.st_size : 0;
+}
+
+void fs::File::close(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (pstFile == NULL)
+    {
+        return;
+    }
+    if (--pstFile->references == 0)
+    {
+        ::close(pstFile->fd);
+        free(pstFile);
+    }
+    pstFile = NULL;
+}
+
+/* Preferences ---------------------------------------------------------------*/
+bool Preferences::begin(const char *in_name, bool in_readOnly, const char *in_partitionLabel)
+{
+    (void)in_partitionLabel;
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (bHostNvsCorrupt || bStarted || in_name == NULL || strlen(in_name) >= sizeof(cNamespace))
+    {
+        return false;
+    }
+    // As nvs_open(): a namespace opened read-only must exist
+    if (in_readOnly && ma_host_nvs_find(in_name, NULL) == NULL)
+    {
+        return false;
+    }
+    strcpy(cNamespace, in_name);
+    bReadOnly = in_readOnly;
+    bStarted = true;
+    return true;
+}
+
+void Preferences::end(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    bStarted = false;
+}
+
+bool Preferences::clear(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (!bStarted || bReadOnly)
+    {
+        return false;
+    }
+    for (st_host_nvs_entry_t *entry = ma_host_nvs_find(cNamespace, NULL); entry != NULL; entry = ma_host_nvs_find(cNamespace, NULL))
+    {
+        entry->used = false;
+    }
+    ma_host_clock_advance_us(u32HostNvsWriteUs);
+    stHostNvsStats.erases++;
+    return true;
+}
+
+bool Preferences::remove(const char *in_key)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    st_host_nvs_entry_t *entry = bStarted ? ma_host_nvs_find(cNamespace, in_key) : NULL;
+    if (entry == NULL || bReadOnly)
+    {
+        return false;
+    }
+    ma_host_clock_advance_us(u32HostNvsWriteUs);
+    entry->used = false;
+    stHostNvsStats.erases++;
+    return true;
+}
+
+bool Preferences::isKey(const char *in_key)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    return bStarted && ma_host_nvs_find(cNamespace, in_key) != NULL;
+}
+
+size_t Preferences::putBytes(const char *in_key, const void *in_value, size_t in_length)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    if (!bStarted || bReadOnly || in_key == NULL || strlen(in_key) >= DF_HOST_NVS_NAME_SIZE || in_length > DF_HOST_NVS_MAX_VALUE)
+    {
+        return 0;
+    }
+    st_host_nvs_entry_t *entry = ma_host_nvs_find(cNamespace, in_key);
+    for (uint8_t i = 0; entry == NULL && i < DF_HOST_NVS_MAX_ENTRIES; i++)
+    {
+        if (!stHostNvs[i].used)
+        {
+            entry = &stHostNvs[i];
+            strcpy(entry->space, cNamespace);
+            strcpy(entry->key, in_key);
+        }
+    }
+    if (entry == NULL)
+    {
+        return 0;
+    }
+    ma_host_clock_advance_us(u32HostNvsWriteUs);
+    memcpy(entry->value, in_value, in_length);
+    entry->length = in_length;
+    entry->used = true;
+    stHostNvsStats.writes++;
+    stHostNvsStats.bytesWritten += (uint32_t)in_length;
+    return in_length;
+}
+
+size_t Preferences::getBytes(const char *in_key, void *out_buffer, size_t in_maxLength)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    st_host_nvs_entry_t *entry = bStarted ? ma_host_nvs_find(cNamespace, in_key) : NULL;
+    if (entry == NULL || entry->length > in_maxLength)
+    {
+        return 0;
+    }
+    ma_host_clock_advance_us(u32HostNvsReadUs);
+    memcpy(out_buffer, entry->value, entry->length);
+    stHostNvsStats.reads++;
+    return entry->length;
+}
+
+size_t Preferences::getBytesLength(const char *in_key)
+{
+    std::lock_guard<std::recursive_mutex> lock(clsFsMutex);
+    st_host_nvs_entry_t *entry = bStarted ? ma_host_nvs_find(cNamespace, in_key) : NULL;
+    return (entry != NULL) ? entry->length : 0;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_host_fs_root
+  * @brief      : Gives the directory of the files, made on first use if none was set
+  * @pre-cond.  : clsFsMutex held
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : The directory
+  */
+static const char *ma_host_fs_root(void)
+{
+    if (cHostFsRoot[0] == '\0')
+    {
+        strcpy(cHostFsRoot, "/tmp/ma_host_spiffs_XXXXXX");
+        if (mkdtemp(cHostFsRoot) == NULL)
+        {
+            strcpy(cHostFsRoot, ".");
+        }
+    }
+    return cHostFsRoot;
+}
+
+/**
+  * @Func       : ma_host_fs_path
+  * @brief      : Gives the file of the PC for a SPIFFS name
+  * @pre-cond.  : clsFsMutex held
+  * @post-cond. : None
+  * @parameters :
+  *       - in_name: SPIFFS name, starts with '/'
+  *       - out_path: DF_HOST_FS_PATH_SIZE characters
+  * @retval     : false if the name is not valid or too long
+  */
+static bool ma_host_fs_path(const char *in_name, char *out_path)
+{
+    if (in_name == NULL || in_name[0] != '/' || in_name[1] == '\0')
+    {
+        return false;
+    }
+    int length = snprintf(out_path, DF_HOST_FS_PATH_SIZE, "%s/", ma_host_fs_root());
+    for (const char *c = in_name + 1; *c != '\0'; c++)
+    {
+        if (length >= DF_HOST_FS_PATH_SIZE - 1)
+        {
+            return false;
+        }
+        out_path[length++] = (*c == '/') ? '_' : *c;
+    }
+    out_path[length] = '\0';
+    return true;
+}
+
+/**
+  * @Func       : ma_host_fs_wipe
+  * @brief      : Removes all the files of the root directory
+  * @pre-cond.  : clsFsMutex held
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+static void ma_host_fs_wipe(void)
+{
+    DIR *directory = opendir(ma_host_fs_root());
+    if (directory == NULL)
+    {
+        return;
+    }
+    for (struct dirent *entry = readdir(directory); entry != NULL; entry = readdir(directory))
+    {
+        char path[DF_HOST_FS_PATH_SIZE + 256];
+        if (entry->d_name[0] != '.')
+        {
+            snprintf(path, sizeof(path), "%s/%s", ma_host_fs_root(), entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(directory);
+}
+
+/**
+  * @Func       : ma_host_nvs_find
+  * @brief      : Finds an entry of the NVS table
+  * @pre-cond.  : clsFsMutex held
+  * @post-cond. : None
+  * @parameters :
+  *       - in_space: Namespace
+  *       - in_key: Key, NULL for any key of the namespace
+  * @retval     : The entry, NULL if none
+  */
+static st_host_nvs_entry_t *ma_host_nvs_find(const char *in_space, const char *in_key)
+{
+    for (uint8_t i = 0; i < DF_HOST_NVS_MAX_ENTRIES; i++)
+    {
+        st_host_nvs_entry_t *entry = &stHostNvs[i];
+        if (entry->used && strcmp(entry->space, in_space) == 0 && (in_key == NULL || strcmp(entry->key, in_key) == 0))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_host_private.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Links between the files of the host build, not for the tests
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_HOST_PRIVATE_H
+#define __MA_HOST_PRIVATE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Public objects ------------------------------------------------------------*/
+// ma_host_arduino.cpp: heap blocks counted with the operator new ones
+extern void *ma_host_heap_alloc(size_t in_size);
+extern void *ma_host_heap_realloc(void *io_block, size_t in_size);
+extern void ma_host_heap_free(void *io_block);
+extern void ma_host_count_copy(size_t in_bytes);
+extern void ma_host_copy_uncounted(void *out_destination, const void *in_source, size_t in_length);
+
+// ma_host_wifi.cpp: radio events on the virtual clock
+extern bool ma_host_wifi_next_due(uint64_t *out_dueUs);
+extern void ma_host_wifi_run(uint64_t in_nowUs);
+extern void ma_host_net_reset(void);
+
+// ma_host_fs.cpp
+extern void ma_host_fs_reset(void);
+
+#endif /* __MA_HOST_PRIVATE_H */
+
+/*****************************END OF FILE**************************************/
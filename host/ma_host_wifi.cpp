@@ -0,0 +1,1394 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_host_wifi.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Host build of the WiFi library: simulated radio, events on
+  *               the virtual clock, and in-memory TCP sockets
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+
+#include "WiFi.h"
+#include "ma_host.h"
+#include "ma_host_private.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	The access points around the device are added with
+    ma_host_wifi_add_ap(). WiFi.begin() looks for the SSID (and the BSSID
+    when given) among the ones in range and queues the events the ESP32
+    would send, at the times of st_host_wifi_timing_t:
+      - found, right password: STA_CONNECTED after connectMs
+        (fastConnectMs with a channel and a BSSID), STA_GOT_IP dhcpMs
+        later, or at once after WiFi.config() with an address;
+      - not found: STA_DISCONNECTED, WIFI_REASON_NO_AP_FOUND;
+      - wrong password: STA_DISCONNECTED, WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT;
+      - ma_host_wifi_fail_next(): STA_DISCONNECTED with the given reason.
+    WiFi.begin() and WiFi.disconnect() cancel the attempt in progress and
+    send STA_DISCONNECTED with WIFI_REASON_ASSOC_LEAVE, as the driver does.
+
+2.  The events run when the virtual clock passes their time, see
+    ma_host_clock_advance_us(), on the thread that moves it. No lock of
+    this file is held while a callback runs, so a callback may call the
+    WiFi functions again.
+
+3.  ma_host_wifi_drop_link() is a link loss. With setAutoReconnect(true)
+    the driver connects again reconnectMs later if the AP is in range.
+
+4.  WiFi.scanNetworks(true) answers WIFI_SCAN_RUNNING, the results (the
+    APs in range, strongest first) come scanMs later with SCAN_DONE.
+
+5.  A WiFiServer that listens takes the connections made with
+    ma_host_net_connect(). Each socket has a buffer of
+    DF_HOST_SOCKET_BUFFER_SIZE bytes in each direction: a write of the
+    device that does not fit is partial, as a full TCP window is. The
+    buffers stand for the TCP stack, they are not counted in the heap of
+    the device. A socket is freed when the phone released it and no
+    WiFiClient holds it.
+
+6.  Nothing in this file allocates on the counted heap, so the counts of
+    ma_host_get_stats() are the ones of the Api.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_HOST_WIFI_MAX_APS            16
+#define DF_HOST_WIFI_MAX_EVENTS         64
+#define DF_HOST_WIFI_MAX_CALLBACKS      8
+#define DF_HOST_NET_MAX_LISTENERS       4
+#define DF_HOST_NET_BACKLOG             16
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  char ssid[33];
+  char password[65];
+  uint8_t bssid[6];
+  int8_t rssi;
+  uint8_t channel;
+  bool inRange;
+}st_host_ap_t;
+
+// What an event changes in the radio when it runs
+typedef enum {
+  eHOST_ACTION_NONE = 0,
+  eHOST_ACTION_ASSOCIATED,          // Station attempt: associated to the AP
+  eHOST_ACTION_GOT_IP,              // Station attempt: address given
+  eHOST_ACTION_FAILED,              // Station attempt: failed
+  eHOST_ACTION_LINK_LOST,
+  eHOST_ACTION_RECONNECT,           // Station attempt of the driver after a link loss
+  eHOST_ACTION_SCAN_DONE
+}e_host_action_t;
+
+typedef struct {
+  uint64_t dueUs;
+  uint32_t order;                   // Keeps the events of the same time in the order they were queued
+  e_host_action_t action;
+  arduino_event_id_t id;            // ARDUINO_EVENT_MAX: nothing to dispatch
+  arduino_event_info_t info;
+  int ap;
+}st_host_event_t;
+
+typedef enum {
+  eHOST_STATION_IDLE = 0,
+  eHOST_STATION_CONNECTING,
+  eHOST_STATION_ASSOCIATED,
+  eHOST_STATION_CONNECTED
+}e_host_station_t;
+
+typedef struct {
+  WiFiEventFuncCb callback;
+  arduino_event_id_t filter;
+}st_host_callback_t;
+
+typedef struct {
+  uint8_t *data;
+  size_t head;
+  size_t count;
+}st_host_ring_t;
+
+typedef struct {
+  uint16_t port;
+  bool active;
+  st_host_socket_t *backlog[DF_HOST_NET_BACKLOG];
+  uint8_t count;
+}st_host_listener_t;
+
+/* Public objects ------------------------------------------------------------*/
+struct st_host_socket_t
+{
+  st_host_ring_t toDevice;
+  st_host_ring_t toPhone;
+  bool phoneClosed;                 // FIN from the phone
+  bool phoneReleased;
+  bool deviceClosed;                // WiFiClient::stop() or the server ended
+  uint32_t references;              // Phone, backlog and WiFiClient copies
+  uint8_t remoteHost;
+  st_host_socket_stats_t stats;
+  st_host_socket_t *next;
+};
+
+WiFiClass WiFi;
+
+/* Private variables ---------------------------------------------------------*/
+static std::mutex clsRadioMutex;
+static st_host_wifi_timing_t stHostTiming = DF_HOST_WIFI_TIMING_DEFAULT;
+static st_host_ap_t stHostAps[DF_HOST_WIFI_MAX_APS];
+static uint8_t u8HostApCount = 0;
+static st_host_event_t stHostEvents[DF_HOST_WIFI_MAX_EVENTS];
+static uint8_t u8HostEventCount = 0;
+static uint32_t u32HostEventOrder = 0;
+static st_host_callback_t stHostCallbacks[DF_HOST_WIFI_MAX_CALLBACKS];
+static st_host_wifi_stats_t stHostWifiStats;
+
+static wifi_mode_t eHostMode = WIFI_MODE_NULL;
+static bool bHostApRunning = false;
+static IPAddress clsHostApIp(192, 168, 4, 1);
+
+static e_host_station_t eHostStation = eHOST_STATION_IDLE;
+static wl_status_t eHostStatus = WL_IDLE_STATUS;
+static int iHostStationAp = -1;
+static char cHostStationSsid[33];
+static char cHostStationPassword[65];
+static bool bHostAutoReconnect = true;
+static bool bHostStaticIp = false;
+static IPAddress clsHostStaticIp;
+static IPAddress clsHostStaticGateway;
+static IPAddress clsHostStaticMask;
+static IPAddress clsHostStaticDns;
+static uint8_t u8HostFailReason = 0;
+static uint8_t u8HostFailCount = 0;
+static bool bHostFailScans = false;
+static uint8_t u8HostBssid[6];
+
+static int16_t i16HostScanState = WIFI_SCAN_FAILED;
+static wifi_ap_record_t stHostScanResults[DF_HOST_WIFI_MAX_APS];
+
+static std::mutex clsNetMutex;
+static st_host_listener_t stHostListeners[DF_HOST_NET_MAX_LISTENERS];
+static st_host_socket_t *pstHostSockets = NULL;
+static uint8_t u8HostNextRemote = 2;
+
+/* Private function prototypes -----------------------------------------------*/
+static void ma_host_wifi_queue(uint64_t in_dueUs, e_host_action_t in_action, arduino_event_id_t in_id, uint8_t in_reason, int in_ap);
+static void ma_host_wifi_cancel_attempt(void);
+static void ma_host_wifi_leave(uint64_t in_nowUs);
+static void ma_host_wifi_schedule_attempt(uint64_t in_nowUs, uint32_t in_delayMs, const uint8_t *in_bssid);
+static int ma_host_wifi_find_ap(const char *in_ssid, const uint8_t *in_bssid);
+static void ma_host_wifi_apply(const st_host_event_t *in_event);
+static void ma_host_wifi_fill_scan(void);
+static size_t ma_host_ring_put(st_host_ring_t *io_ring, const uint8_t *in_data, size_t in_length, bool in_counted);
+static size_t ma_host_ring_get(st_host_ring_t *io_ring, uint8_t *out_data, size_t in_size, bool in_peek, bool in_counted);
+static void ma_host_net_unref(st_host_socket_t *io_socket);
+static st_host_listener_t *ma_host_net_find_listener(uint16_t in_port);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_host_wifi_reset
+  * @brief      : No access point around, default timings, no failure, radio off, no event pending
+  * @pre-cond.  : None
+  * @post-cond. : The event callbacks are kept, they belong to the program
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_host_wifi_reset(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    const st_host_wifi_timing_t defaultTiming = DF_HOST_WIFI_TIMING_DEFAULT;
+
+    stHostTiming = defaultTiming;
+    u8HostApCount = 0;
+    u8HostEventCount = 0;
+    memset(&stHostWifiStats, 0, sizeof(stHostWifiStats));
+    eHostMode = WIFI_MODE_NULL;
+    bHostApRunning = false;
+    clsHostApIp = IPAddress(192, 168, 4, 1);
+    eHostStation = eHOST_STATION_IDLE;
+    eHostStatus = WL_IDLE_STATUS;
+    iHostStationAp = -1;
+    bHostAutoReconnect = true;
+    bHostStaticIp = false;
+    u8HostFailCount = 0;
+    bHostFailScans = false;
+    i16HostScanState = WIFI_SCAN_FAILED;
+}
+
+void ma_host_wifi_set_timing(const st_host_wifi_timing_t *in_timing)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    stHostTiming = *in_timing;
+}
+
+/**
+  * @Func       : ma_host_wifi_add_ap
+  * @brief      : Adds an access point in range
+  * @pre-cond.  : None
+  * @post-cond. : Its BSSID is 24:0A:C4:00:00:<index + 1>
+  * @parameters :
+  *       - in_ssid: SSID
+  *       - in_password: WPA2 password, "" or NULL for an open network
+  *       - in_rssi: Signal in dBm
+  *       - in_channel: Channel
+  * @retval     : Index of the AP, -1 if the table is full
+  */
+int ma_host_wifi_add_ap(const char *in_ssid, const char *in_password, int8_t in_rssi, uint8_t in_channel)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (u8HostApCount >= DF_HOST_WIFI_MAX_APS)
+    {
+        return -1;
+    }
+    st_host_ap_t *ap = &stHostAps[u8HostApCount];
+    memset(ap, 0, sizeof(*ap));
+    strncpy(ap->ssid, in_ssid, sizeof(ap->ssid) - 1);
+    strncpy(ap->password, (in_password != NULL) ? in_password : "", sizeof(ap->password) - 1);
+    const uint8_t bssid[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, (uint8_t)(u8HostApCount + 1)};
+    memcpy(ap->bssid, bssid, sizeof(bssid));
+    ap->rssi = in_rssi;
+    ap->channel = in_channel;
+    ap->inRange = true;
+    return u8HostApCount++;
+}
+
+/**
+  * @Func       : ma_host_wifi_set_ap_in_range
+  * @brief      : Moves an AP in or out of range. Out of range, the station linked to it loses the link.
+  * @pre-cond.  : in_index from ma_host_wifi_add_ap()
+  * @post-cond. : None
+  * @parameters :
+  *       - in_index: AP
+  *       - in_inRange: false to make it disappear
+  * @retval     : None
+  */
+void ma_host_wifi_set_ap_in_range(int in_index, bool in_inRange)
+{
+    bool linked;
+    {
+        std::lock_guard<std::mutex> lock(clsRadioMutex);
+        if (in_index < 0 || in_index >= u8HostApCount)
+        {
+            return;
+        }
+        stHostAps[in_index].inRange = in_inRange;
+        linked = (iHostStationAp == in_index && eHostStation >= eHOST_STATION_ASSOCIATED);
+    }
+    if (!in_inRange && linked)
+    {
+        ma_host_wifi_drop_link(WIFI_REASON_BEACON_TIMEOUT);
+    }
+}
+
+void ma_host_wifi_fail_next(uint8_t in_reason, uint8_t in_count)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    u8HostFailReason = in_reason;
+    u8HostFailCount = in_count;
+}
+
+void ma_host_wifi_fail_scans(bool in_fail)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    bHostFailScans = in_fail;
+}
+
+/**
+  * @Func       : ma_host_wifi_drop_link
+  * @brief      : Link loss of the station, STA_DISCONNECTED with in_reason now
+  * @pre-cond.  : None
+  * @post-cond. : The driver reconnects by itself with setAutoReconnect(true)
+  * @parameters : in_reason: wifi_err_reason_t
+  * @retval     : None
+  */
+void ma_host_wifi_drop_link(uint8_t in_reason)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (eHostStation < eHOST_STATION_ASSOCIATED)
+    {
+        return;
+    }
+    ma_host_wifi_cancel_attempt();
+    ma_host_wifi_queue(ma_host_clock_us(), eHOST_ACTION_LINK_LOST, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, in_reason, iHostStationAp);
+}
+
+bool ma_host_wifi_ap_running(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    return bHostApRunning;
+}
+
+void ma_host_wifi_get_stats(st_host_wifi_stats_t *out_stats)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    *out_stats = stHostWifiStats;
+}
+
+/**
+  * @Func       : ma_host_wifi_next_due
+  * @brief      : Gives the time of the next event
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : out_dueUs: Its time on the virtual clock
+  * @retval     : false when no event is pending
+  */
+bool ma_host_wifi_next_due(uint64_t *out_dueUs)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (u8HostEventCount == 0)
+    {
+        return false;
+    }
+    *out_dueUs = stHostEvents[0].dueUs;
+    return true;
+}
+
+/**
+  * @Func       : ma_host_wifi_run
+  * @brief      : Runs the events due at in_nowUs or before, in order
+  * @pre-cond.  : None
+  * @post-cond. : The callbacks ran without a lock of this file held
+  * @parameters : in_nowUs: Virtual clock
+  * @retval     : None
+  */
+void ma_host_wifi_run(uint64_t in_nowUs)
+{
+    for (;;)
+    {
+        st_host_event_t event;
+        st_host_callback_t callbacks[DF_HOST_WIFI_MAX_CALLBACKS];
+        {
+            std::lock_guard<std::mutex> lock(clsRadioMutex);
+            if (u8HostEventCount == 0 || stHostEvents[0].dueUs > in_nowUs)
+            {
+                return;
+            }
+            event = stHostEvents[0];
+            u8HostEventCount--;
+            memmove(&stHostEvents[0], &stHostEvents[1], u8HostEventCount * sizeof(st_host_event_t));
+            ma_host_wifi_apply(&event);
+            memcpy(callbacks, stHostCallbacks, sizeof(callbacks));
+            if (event.id != ARDUINO_EVENT_MAX)
+            {
+                stHostWifiStats.eventsDispatched++;
+            }
+        }
+
+        if (event.id == ARDUINO_EVENT_MAX)
+        {
+            continue;
+        }
+        for (uint8_t i = 0; i < DF_HOST_WIFI_MAX_CALLBACKS; i++)
+        {
+            if (callbacks[i].callback != NULL && (callbacks[i].filter == ARDUINO_EVENT_MAX || callbacks[i].filter == event.id))
+            {
+                callbacks[i].callback(event.id, event.info);
+            }
+        }
+    }
+}
+
+/* WiFiClass -----------------------------------------------------------------*/
+bool WiFiClass::mode(wifi_mode_t in_mode)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if ((in_mode & WIFI_MODE_STA) == 0)
+    {
+        ma_host_wifi_leave(ma_host_clock_us());
+    }
+    if ((in_mode & WIFI_MODE_AP) == 0)
+    {
+        bHostApRunning = false;
+    }
+    eHostMode = in_mode;
+    return true;
+}
+
+wifi_mode_t WiFiClass::getMode(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    return eHostMode;
+}
+
+bool WiFiClass::softAP(const char *in_ssid, const char *in_password, int in_channel, int in_hidden, int in_maxConnections)
+{
+    (void)in_channel;
+    (void)in_hidden;
+    (void)in_maxConnections;
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    // The driver refuses a WPA2 password shorter than 8 characters
+    if (in_ssid == NULL || in_ssid[0] == '\0' || (in_password != NULL && in_password[0] != '\0' && strlen(in_password) < 8))
+    {
+        return false;
+    }
+    eHostMode = (wifi_mode_t)(eHostMode | WIFI_MODE_AP);
+    bHostApRunning = true;
+    return true;
+}
+
+bool WiFiClass::softAPConfig(IPAddress in_ip, IPAddress in_gateway, IPAddress in_mask)
+{
+    (void)in_gateway;
+    (void)in_mask;
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    clsHostApIp = in_ip;
+    return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool in_wifiOff)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    bHostApRunning = false;
+    if (in_wifiOff)
+    {
+        eHostMode = (wifi_mode_t)(eHostMode & ~WIFI_MODE_AP);
+    }
+    return true;
+}
+
+IPAddress WiFiClass::softAPIP(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    return bHostApRunning ? clsHostApIp : IPAddress();
+}
+
+wl_status_t WiFiClass::begin(const char *in_ssid, const char *in_password, int32_t in_channel, const uint8_t *in_bssid, bool in_connect)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    uint64_t nowUs = ma_host_clock_us();
+    bool fast = (in_channel != 0 && in_bssid != NULL);
+
+    stHostWifiStats.begins++;
+    if (fast)
+    {
+        stHostWifiStats.fastBegins++;
+    }
+    if (in_ssid == NULL || in_ssid[0] == '\0' || strlen(in_ssid) >= sizeof(cHostStationSsid))
+    {
+        return WL_CONNECT_FAILED;
+    }
+    eHostMode = (wifi_mode_t)(eHostMode | WIFI_MODE_STA);
+    ma_host_wifi_leave(nowUs);
+    strncpy(cHostStationSsid, in_ssid, sizeof(cHostStationSsid) - 1);
+    strncpy(cHostStationPassword, (in_password != NULL) ? in_password : "", sizeof(cHostStationPassword) - 1);
+    if (in_connect)
+    {
+        ma_host_wifi_schedule_attempt(nowUs, fast ? stHostTiming.fastConnectMs : stHostTiming.connectMs, fast ? in_bssid : NULL);
+    }
+    return WL_DISCONNECTED;
+}
+
+bool WiFiClass::config(IPAddress in_ip, IPAddress in_gateway, IPAddress in_mask, IPAddress in_dns1, IPAddress in_dns2)
+{
+    (void)in_dns2;
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    bHostStaticIp = ((uint32_t)in_ip != 0);
+    clsHostStaticIp = in_ip;
+    clsHostStaticGateway = in_gateway;
+    clsHostStaticMask = in_mask;
+    clsHostStaticDns = ((uint32_t)in_dns1 != 0) ? in_dns1 : in_gateway;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool in_wifiOff, bool in_eraseAp)
+{
+    (void)in_eraseAp;
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    stHostWifiStats.disconnects++;
+    ma_host_wifi_leave(ma_host_clock_us());
+    if (in_wifiOff)
+    {
+        eHostMode = (wifi_mode_t)(eHostMode & ~WIFI_MODE_STA);
+    }
+    return true;
+}
+
+bool WiFiClass::setAutoReconnect(bool in_autoReconnect)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    bHostAutoReconnect = in_autoReconnect;
+    return true;
+}
+
+wl_status_t WiFiClass::status(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    return (eHostStation == eHOST_STATION_CONNECTED) ? WL_CONNECTED : eHostStatus;
+}
+
+IPAddress WiFiClass::localIP(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (eHostStation != eHOST_STATION_CONNECTED)
+    {
+        return IPAddress();
+    }
+    return bHostStaticIp ? clsHostStaticIp : IPAddress(192, 168, 1, 50);
+}
+
+IPAddress WiFiClass::gatewayIP(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (eHostStation != eHOST_STATION_CONNECTED)
+    {
+        return IPAddress();
+    }
+    return bHostStaticIp ? clsHostStaticGateway : IPAddress(192, 168, 1, 1);
+}
+
+IPAddress WiFiClass::subnetMask(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (eHostStation != eHOST_STATION_CONNECTED)
+    {
+        return IPAddress();
+    }
+    return bHostStaticIp ? clsHostStaticMask : IPAddress(255, 255, 255, 0);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t in_index)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (eHostStation != eHOST_STATION_CONNECTED || in_index != 0)
+    {
+        return IPAddress();
+    }
+    return bHostStaticIp ? clsHostStaticDns : IPAddress(192, 168, 1, 1);
+}
+
+uint8_t *WiFiClass::BSSID(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (eHostStation < eHOST_STATION_ASSOCIATED)
+    {
+        return NULL;
+    }
+    memcpy(u8HostBssid, stHostAps[iHostStationAp].bssid, sizeof(u8HostBssid));
+    return u8HostBssid;
+}
+
+int32_t WiFiClass::channel(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    return (eHostStation >= eHOST_STATION_ASSOCIATED) ? stHostAps[iHostStationAp].channel : 1;
+}
+
+int8_t WiFiClass::RSSI(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    return (eHostStation >= eHOST_STATION_ASSOCIATED) ? stHostAps[iHostStationAp].rssi : 0;
+}
+
+int16_t WiFiClass::scanNetworks(bool in_async, bool in_showHidden, bool in_passive, uint32_t in_maxMsPerChannel, uint8_t in_channel)
+{
+    (void)in_showHidden;
+    (void)in_passive;
+    (void)in_maxMsPerChannel;
+    (void)in_channel;
+    uint32_t scanMs;
+    {
+        std::lock_guard<std::mutex> lock(clsRadioMutex);
+        stHostWifiStats.scans++;
+        if (i16HostScanState == WIFI_SCAN_RUNNING)
+        {
+            return WIFI_SCAN_RUNNING;
+        }
+        if (bHostFailScans)
+        {
+            return WIFI_SCAN_FAILED;
+        }
+        // The scan runs on the station interface
+        eHostMode = (wifi_mode_t)(eHostMode | WIFI_MODE_STA);
+        i16HostScanState = WIFI_SCAN_RUNNING;
+        scanMs = stHostTiming.scanMs;
+        ma_host_wifi_queue(ma_host_clock_us() + (uint64_t)scanMs * 1000u, eHOST_ACTION_SCAN_DONE, ARDUINO_EVENT_WIFI_SCAN_DONE, 0, -1);
+    }
+    if (in_async)
+    {
+        return WIFI_SCAN_RUNNING;
+    }
+    ma_host_clock_advance(scanMs);
+    return scanComplete();
+}
+
+int16_t WiFiClass::scanComplete(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    return i16HostScanState;
+}
+
+void WiFiClass::scanDelete(void)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (i16HostScanState != WIFI_SCAN_RUNNING)
+    {
+        i16HostScanState = WIFI_SCAN_FAILED;
+    }
+}
+
+void *WiFiClass::getScanInfoByIndex(int in_index)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (in_index < 0 || in_index >= i16HostScanState)
+    {
+        return NULL;
+    }
+    return &stHostScanResults[in_index];
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb in_callback, arduino_event_id_t in_event)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    for (uint8_t i = 0; i < DF_HOST_WIFI_MAX_CALLBACKS; i++)
+    {
+        if (stHostCallbacks[i].callback == NULL)
+        {
+            stHostCallbacks[i].callback = in_callback;
+            stHostCallbacks[i].filter = in_event;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t in_id)
+{
+    std::lock_guard<std::mutex> lock(clsRadioMutex);
+    if (in_id >= 1 && in_id <= DF_HOST_WIFI_MAX_CALLBACKS)
+    {
+        stHostCallbacks[in_id - 1].callback = NULL;
+    }
+}
+
+/* Network, phone side -------------------------------------------------------*/
+
+/**
+  * @Func       : ma_host_net_connect
+  * @brief      : Opens a connection to the server listening on in_port
+  * @pre-cond.  : None
+  * @post-cond. : The server gets it from accept(); the caller must ma_host_net_release() it
+  * @parameters : in_port: Port of the WiFiServer
+  * @retval     : The socket, NULL if nothing listens or the backlog is full
+  */
+st_host_socket_t *ma_host_net_connect(uint16_t in_port)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    st_host_listener_t *listener = ma_host_net_find_listener(in_port);
+    if (listener == NULL || listener->count >= DF_HOST_NET_BACKLOG)
+    {
+        return NULL;
+    }
+
+    st_host_socket_t *socket = (st_host_socket_t *)calloc(1, sizeof(st_host_socket_t));
+    socket->toDevice.data = (uint8_t *)malloc(DF_HOST_SOCKET_BUFFER_SIZE);
+    socket->toPhone.data = (uint8_t *)malloc(DF_HOST_SOCKET_BUFFER_SIZE);
+    socket->references = 2;         // Phone and backlog
+    socket->remoteHost = u8HostNextRemote;
+    u8HostNextRemote = (u8HostNextRemote >= 254) ? 2 : u8HostNextRemote + 1;
+    socket->next = pstHostSockets;
+    pstHostSockets = socket;
+    listener->backlog[listener->count++] = socket;
+    return socket;
+}
+
+size_t ma_host_net_send(st_host_socket_t *io_socket, const void *in_data, size_t in_length)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (io_socket->phoneClosed || io_socket->deviceClosed)
+    {
+        return 0;
+    }
+    return ma_host_ring_put(&io_socket->toDevice, (const uint8_t *)in_data, in_length, false);
+}
+
+size_t ma_host_net_recv(st_host_socket_t *io_socket, void *out_buffer, size_t in_size)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    return ma_host_ring_get(&io_socket->toPhone, (uint8_t *)out_buffer, in_size, false, false);
+}
+
+size_t ma_host_net_pending(st_host_socket_t *in_socket)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    return in_socket->toPhone.count;
+}
+
+void ma_host_net_close(st_host_socket_t *io_socket)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    io_socket->phoneClosed = true;
+}
+
+bool ma_host_net_is_closed(st_host_socket_t *in_socket)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    return in_socket->deviceClosed;
+}
+
+void ma_host_net_release(st_host_socket_t *io_socket)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    io_socket->phoneClosed = true;
+    io_socket->phoneReleased = true;
+    ma_host_net_unref(io_socket);
+}
+
+void ma_host_net_get_stats(st_host_socket_t *in_socket, st_host_socket_stats_t *out_stats)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    *out_stats = in_socket->stats;
+}
+
+uint32_t ma_host_net_open_sockets(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    uint32_t count = 0;
+    for (st_host_socket_t *socket = pstHostSockets; socket != NULL; socket = socket->next)
+    {
+        count += socket->deviceClosed ? 0 : 1;
+    }
+    return count;
+}
+
+/**
+  * @Func       : ma_host_net_reset
+  * @brief      : Closes every socket and listener, as a reboot does
+  * @pre-cond.  : None
+  * @post-cond. : The sockets still held are freed by their last holder
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_host_net_reset(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    for (uint8_t i = 0; i < DF_HOST_NET_MAX_LISTENERS; i++)
+    {
+        st_host_listener_t *listener = &stHostListeners[i];
+        for (uint8_t j = 0; j < listener->count; j++)
+        {
+            listener->backlog[j]->deviceClosed = true;
+            ma_host_net_unref(listener->backlog[j]);
+        }
+        listener->count = 0;
+        listener->active = false;
+    }
+    for (st_host_socket_t *socket = pstHostSockets; socket != NULL; socket = socket->next)
+    {
+        socket->deviceClosed = true;
+        socket->phoneClosed = true;
+    }
+}
+
+/* WiFiServer ----------------------------------------------------------------*/
+void WiFiServer::begin(uint16_t in_port)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (in_port != 0)
+    {
+        u16Port = in_port;
+    }
+    if (ma_host_net_find_listener(u16Port) != NULL)
+    {
+        bListening = true;
+        return;
+    }
+    for (uint8_t i = 0; i < DF_HOST_NET_MAX_LISTENERS; i++)
+    {
+        if (!stHostListeners[i].active)
+        {
+            stHostListeners[i].active = true;
+            stHostListeners[i].port = u16Port;
+            stHostListeners[i].count = 0;
+            bListening = true;
+            return;
+        }
+    }
+}
+
+void WiFiServer::end(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    st_host_listener_t *listener = bListening ? ma_host_net_find_listener(u16Port) : NULL;
+    bListening = false;
+    if (listener == NULL)
+    {
+        return;
+    }
+    // Connections never accepted are refused
+    for (uint8_t i = 0; i < listener->count; i++)
+    {
+        listener->backlog[i]->deviceClosed = true;
+        ma_host_net_unref(listener->backlog[i]);
+    }
+    listener->count = 0;
+    listener->active = false;
+}
+
+WiFiClient WiFiServer::accept(void)
+{
+    st_host_socket_t *socket = NULL;
+    {
+        std::lock_guard<std::mutex> lock(clsNetMutex);
+        st_host_listener_t *listener = bListening ? ma_host_net_find_listener(u16Port) : NULL;
+        if (listener == NULL || listener->count == 0)
+        {
+            return WiFiClient();
+        }
+        socket = listener->backlog[0];
+        listener->count--;
+        memmove(&listener->backlog[0], &listener->backlog[1], listener->count * sizeof(listener->backlog[0]));
+    }
+    // The reference of the backlog goes to the client
+    WiFiClient client(socket);
+    {
+        std::lock_guard<std::mutex> lock(clsNetMutex);
+        ma_host_net_unref(socket);
+    }
+    return client;
+}
+
+bool WiFiServer::hasClient(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    st_host_listener_t *listener = bListening ? ma_host_net_find_listener(u16Port) : NULL;
+    return listener != NULL && listener->count > 0;
+}
+
+/* WiFiClient ----------------------------------------------------------------*/
+WiFiClient::WiFiClient(st_host_socket_t *in_socket) : pstSocket(in_socket)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (pstSocket != NULL)
+    {
+        pstSocket->references++;
+    }
+}
+
+WiFiClient::WiFiClient(const WiFiClient &in_other) : Stream(in_other), pstSocket(in_other.pstSocket)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (pstSocket != NULL)
+    {
+        pstSocket->references++;
+    }
+}
+
+WiFiClient &WiFiClient::operator=(const WiFiClient &in_other)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (in_other.pstSocket != NULL)
+    {
+        in_other.pstSocket->references++;
+    }
+    if (pstSocket != NULL)
+    {
+        ma_host_net_unref(pstSocket);
+    }
+    pstSocket = in_other.pstSocket;
+    return *this;
+}
+
+WiFiClient::~WiFiClient()
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (pstSocket != NULL)
+    {
+        ma_host_net_unref(pstSocket);
+    }
+}
+
+uint8_t WiFiClient::connected(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    // As on the ESP32: the data received before the FIN can still be read
+    return pstSocket != NULL && !pstSocket->deviceClosed && (!pstSocket->phoneClosed || pstSocket->toDevice.count > 0);
+}
+
+int WiFiClient::available(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    return (pstSocket != NULL && !pstSocket->deviceClosed) ? (int)pstSocket->toDevice.count : 0;
+}
+
+int WiFiClient::read(void)
+{
+    uint8_t byte;
+    return (read(&byte, 1) == 1) ? byte : -1;
+}
+
+int WiFiClient::read(uint8_t *out_buffer, size_t in_size)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (pstSocket == NULL || pstSocket->deviceClosed)
+    {
+        return -1;
+    }
+    size_t count = ma_host_ring_get(&pstSocket->toDevice, out_buffer, in_size, false, true);
+    if (count == 0 && pstSocket->phoneClosed)
+    {
+        return -1;
+    }
+    pstSocket->stats.readCalls++;
+    pstSocket->stats.bytesRead += count;
+    return (int)count;
+}
+
+int WiFiClient::peek(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    uint8_t byte;
+    if (pstSocket == NULL || pstSocket->deviceClosed || ma_host_ring_get(&pstSocket->toDevice, &byte, 1, true, true) == 0)
+    {
+        return -1;
+    }
+    return byte;
+}
+
+size_t WiFiClient::write(const uint8_t *in_buffer, size_t in_size)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (pstSocket == NULL || pstSocket->deviceClosed || pstSocket->phoneReleased)
+    {
+        return 0;
+    }
+    st_host_socket_stats_t *stats = &pstSocket->stats;
+    if (stats->writeCalls < DF_HOST_SOCKET_WRITE_LOG_SIZE)
+    {
+        stats->writeSizes[stats->writeCalls] = (uint16_t)((in_size > 0xFFFF) ? 0xFFFF : in_size);
+    }
+    stats->writeCalls++;
+    size_t written = ma_host_ring_put(&pstSocket->toPhone, in_buffer, in_size, true);
+    stats->bytesWritten += written;
+    return written;
+}
+
+void WiFiClient::stop(void)
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    if (pstSocket == NULL)
+    {
+        return;
+    }
+    pstSocket->deviceClosed = true;
+    ma_host_net_unref(pstSocket);
+    pstSocket = NULL;
+}
+
+IPAddress WiFiClient::remoteIP(void) const
+{
+    std::lock_guard<std::mutex> lock(clsNetMutex);
+    return (pstSocket != NULL) ? IPAddress(192, 168, 4, pstSocket->remoteHost) : IPAddress();
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_host_wifi_queue
+  * @brief      : Queues an event, after the ones of the same time
+  * @pre-cond.  : clsRadioMutex held
+  * @post-cond. : The oldest event is lost if the queue is full
+  * @parameters :
+  *       - in_dueUs: Time on the virtual clock
+  *       - in_action: Change of the radio
+  *       - in_id: Event to dispatch, ARDUINO_EVENT_MAX for none
+  *       - in_reason: Reason of a STA_DISCONNECTED
+  *       - in_ap: AP of a station event
+  * @retval     : None
+  */
+static void ma_host_wifi_queue(uint64_t in_dueUs, e_host_action_t in_action, arduino_event_id_t in_id, uint8_t in_reason, int in_ap)
+{
+    st_host_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.dueUs = in_dueUs;
+    event.order = u32HostEventOrder++;
+    event.action = in_action;
+    event.id = in_id;
+    event.ap = in_ap;
+
+    if (in_ap >= 0)
+    {
+        const st_host_ap_t *ap = &stHostAps[in_ap];
+        size_t ssidLength = strlen(ap->ssid);
+        if (in_id == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
+        {
+            memcpy(event.info.wifi_sta_disconnected.ssid, ap->ssid, ssidLength);
+            event.info.wifi_sta_disconnected.ssid_len = (uint8_t)ssidLength;
+            memcpy(event.info.wifi_sta_disconnected.bssid, ap->bssid, 6);
+        }
+        else if (in_id == ARDUINO_EVENT_WIFI_STA_CONNECTED)
+        {
+            memcpy(event.info.wifi_sta_connected.ssid, ap->ssid, ssidLength);
+            event.info.wifi_sta_connected.ssid_len = (uint8_t)ssidLength;
+            memcpy(event.info.wifi_sta_connected.bssid, ap->bssid, 6);
+            event.info.wifi_sta_connected.channel = ap->channel;
+            event.info.wifi_sta_connected.authmode = (ap->password[0] != '\0') ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+        }
+    }
+    if (in_id == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
+    {
+        event.info.wifi_sta_disconnected.reason = in_reason;
+    }
+
+    if (u8HostEventCount >= DF_HOST_WIFI_MAX_EVENTS)
+    {
+        u8HostEventCount--;
+        memmove(&stHostEvents[0], &stHostEvents[1], u8HostEventCount * sizeof(st_host_event_t));
+    }
+    uint8_t position = u8HostEventCount;
+    while (position > 0 && stHostEvents[position - 1].dueUs > in_dueUs)
+    {
+        position--;
+    }
+    memmove(&stHostEvents[position + 1], &stHostEvents[position], (u8HostEventCount - position) * sizeof(st_host_event_t));
+    stHostEvents[position] = event;
+    u8HostEventCount++;
+}
+
+/**
+  * @Func       : ma_host_wifi_cancel_attempt
+  * @brief      : Removes the pending events of the station attempt
+  * @pre-cond.  : clsRadioMutex held
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+static void ma_host_wifi_cancel_attempt(void)
+{
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < u8HostEventCount; i++)
+    {
+        e_host_action_t action = stHostEvents[i].action;
+        if (action == eHOST_ACTION_NONE || action == eHOST_ACTION_SCAN_DONE)
+        {
+            stHostEvents[kept++] = stHostEvents[i];
+        }
+    }
+    u8HostEventCount = kept;
+}
+
+/**
+  * @Func       : ma_host_wifi_leave
+  * @brief      : Stops the station: the attempt in progress is cancelled, a link is left with
+  *               STA_DISCONNECTED and WIFI_REASON_ASSOC_LEAVE
+  * @pre-cond.  : clsRadioMutex held
+  * @post-cond. : Station idle
+  * @parameters : in_nowUs: Virtual clock
+  * @retval     : None
+  */
+static void ma_host_wifi_leave(uint64_t in_nowUs)
+{
+    if (eHostStation != eHOST_STATION_IDLE)
+    {
+        ma_host_wifi_queue(in_nowUs, eHOST_ACTION_NONE, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE, iHostStationAp);
+    }
+    ma_host_wifi_cancel_attempt();
+    eHostStation = eHOST_STATION_IDLE;
+    eHostStatus = WL_DISCONNECTED;
+    iHostStationAp = -1;
+}
+
+/**
+  * @Func       : ma_host_wifi_schedule_attempt
+  * @brief      : Queues the events of a station attempt with cHostStationSsid and cHostStationPassword
+  * @pre-cond.  : clsRadioMutex held, station idle
+  * @post-cond. : Station connecting
+  * @parameters :
+  *       - in_nowUs: Virtual clock
+  *       - in_delayMs: Time to the association
+  *       - in_bssid: BSSID to join, NULL for any AP with the SSID
+  * @retval     : None
+  */
+static void ma_host_wifi_schedule_attempt(uint64_t in_nowUs, uint32_t in_delayMs, const uint8_t *in_bssid)
+{
+    uint64_t dueUs = in_nowUs + (uint64_t)in_delayMs * 1000u;
+    int ap = ma_host_wifi_find_ap(cHostStationSsid, in_bssid);
+
+    eHostStation = eHOST_STATION_CONNECTING;
+    if (u8HostFailCount > 0)
+    {
+        u8HostFailCount--;
+        ma_host_wifi_queue(dueUs, eHOST_ACTION_FAILED, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, u8HostFailReason, ap);
+    }
+    else if (ap < 0)
+    {
+        // The full scan of the channels is needed to find out that nothing answers
+        ma_host_wifi_queue(in_nowUs + (uint64_t)stHostTiming.connectMs * 1000u, eHOST_ACTION_FAILED, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_NO_AP_FOUND, -1);
+    }
+    else if (strcmp(stHostAps[ap].password, cHostStationPassword) != 0)
+    {
+        ma_host_wifi_queue(dueUs, eHOST_ACTION_FAILED, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, ap);
+    }
+    else
+    {
+        ma_host_wifi_queue(dueUs, eHOST_ACTION_ASSOCIATED, ARDUINO_EVENT_WIFI_STA_CONNECTED, 0, ap);
+        dueUs += bHostStaticIp ? 0 : (uint64_t)stHostTiming.dhcpMs * 1000u;
+        ma_host_wifi_queue(dueUs, eHOST_ACTION_GOT_IP, ARDUINO_EVENT_WIFI_STA_GOT_IP, 0, ap);
+    }
+}
+
+/**
+  * @Func       : ma_host_wifi_find_ap
+  * @brief      : Finds an AP in range
+  * @pre-cond.  : clsRadioMutex held
+  * @post-cond. : None
+  * @parameters :
+  *       - in_ssid: SSID
+  *       - in_bssid: BSSID, NULL for the strongest AP with the SSID
+  * @retval     : Index of the AP, -1 if none
+  */
+static int ma_host_wifi_find_ap(const char *in_ssid, const uint8_t *in_bssid)
+{
+    int found = -1;
+    for (uint8_t i = 0; i < u8HostApCount; i++)
+    {
+        const st_host_ap_t *ap = &stHostAps[i];
+        if (!ap->inRange || strcmp(ap->ssid, in_ssid) != 0 || (in_bssid != NULL && memcmp(ap->bssid, in_bssid, 6) != 0))
+        {
+            continue;
+        }
+        if (found < 0 || ap->rssi > stHostAps[found].rssi)
+        {
+            found = i;
+        }
+    }
+    return found;
+}
+
+/**
+  * @Func       : ma_host_wifi_apply
+  * @brief      : Changes the radio as the event says, before it is dispatched
+  * @pre-cond.  : clsRadioMutex held
+  * @post-cond. : None
+  * @parameters : in_event: Event
+  * @retval     : None
+  */
+static void ma_host_wifi_apply(const st_host_event_t *in_event)
+{
+    switch (in_event->action)
+    {
+        case eHOST_ACTION_ASSOCIATED:
+            eHostStation = eHOST_STATION_ASSOCIATED;
+            iHostStationAp = in_event->ap;
+            break;
+
+        case eHOST_ACTION_GOT_IP:
+            eHostStation = eHOST_STATION_CONNECTED;
+            eHostStatus = WL_CONNECTED;
+            break;
+
+        case eHOST_ACTION_FAILED:
+            eHostStation = eHOST_STATION_IDLE;
+            iHostStationAp = -1;
+            eHostStatus = (in_event->info.wifi_sta_disconnected.reason == WIFI_REASON_NO_AP_FOUND) ? WL_NO_SSID_AVAIL : WL_CONNECT_FAILED;
+            break;
+
+        case eHOST_ACTION_LINK_LOST:
+            eHostStation = eHOST_STATION_IDLE;
+            iHostStationAp = -1;
+            eHostStatus = WL_CONNECTION_LOST;
+            if (bHostAutoReconnect)
+            {
+                ma_host_wifi_queue(in_event->dueUs + (uint64_t)stHostTiming.reconnectMs * 1000u, eHOST_ACTION_RECONNECT, ARDUINO_EVENT_MAX, 0, -1);
+            }
+            break;
+
+        case eHOST_ACTION_RECONNECT:
+            if (ma_host_wifi_find_ap(cHostStationSsid, NULL) >= 0)
+            {
+                ma_host_wifi_schedule_attempt(in_event->dueUs, stHostTiming.connectMs, NULL);
+            }
+            else if (bHostAutoReconnect)
+            {
+                ma_host_wifi_queue(in_event->dueUs + (uint64_t)stHostTiming.reconnectMs * 1000u, eHOST_ACTION_RECONNECT, ARDUINO_EVENT_MAX, 0, -1);
+            }
+            break;
+
+        case eHOST_ACTION_SCAN_DONE:
+            ma_host_wifi_fill_scan();
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+  * @Func       : ma_host_wifi_fill_scan
+  * @brief      : Puts the APs in range in the scan results, strongest first
+  * @pre-cond.  : clsRadioMutex held
+  * @post-cond. : scanComplete() gives their number
+  * @parameters : None
+  * @retval     : None
+  */
+static void ma_host_wifi_fill_scan(void)
+{
+    int16_t count = 0;
+    for (uint8_t i = 0; i < u8HostApCount; i++)
+    {
+        const st_host_ap_t *ap = &stHostAps[i];
+        if (!ap->inRange)
+        {
+            continue;
+        }
+        wifi_ap_record_t record;
+        memset(&record, 0, sizeof(record));
+        memcpy(record.bssid, ap->bssid, sizeof(record.bssid));
+        snprintf((char *)record.ssid, sizeof(record.ssid), "%s", ap->ssid);
+        record.primary = ap->channel;
+        record.rssi = ap->rssi;
+        record.authmode = (ap->password[0] != '\0') ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+
+        int16_t position = count;
+        while (position > 0 && stHostScanResults[position - 1].rssi < record.rssi)
+        {
+            stHostScanResults[position] = stHostScanResults[position - 1];
+            position--;
+        }
+        stHostScanResults[position] = record;
+        count++;
+    }
+    i16HostScanState = count;
+}
+
+/**
+  * @Func       : ma_host_ring_put
+  * @brief      : Appends to a socket buffer what fits
+  * @pre-cond.  : clsNetMutex held
+  * @post-cond. : None
+  * @parameters :
+  *       - io_ring: Buffer
+  *       - in_data: Bytes
+  *       - in_length: Number of bytes
+  *       - in_counted: false for the copies of the phone, left out of bytesCopied
+  * @retval     : Bytes appended
+  */
+static size_t ma_host_ring_put(st_host_ring_t *io_ring, const uint8_t *in_data, size_t in_length, bool in_counted)
+{
+    size_t count = 0;
+    while (count < in_length && io_ring->count < DF_HOST_SOCKET_BUFFER_SIZE)
+    {
+        size_t tail = (io_ring->head + io_ring->count) % DF_HOST_SOCKET_BUFFER_SIZE;
+        size_t chunk = (tail >= io_ring->head) ? DF_HOST_SOCKET_BUFFER_SIZE - tail : io_ring->head - tail;
+        if (chunk > in_length - count)
+        {
+            chunk = in_length - count;
+        }
+        if (in_counted)
+        {
+            memcpy(io_ring->data + tail, in_data + count, chunk);
+        }
+        else
+        {
+            ma_host_copy_uncounted(io_ring->data + tail, in_data + count, chunk);
+        }
+        io_ring->count += chunk;
+        count += chunk;
+    }
+    return count;
+}
+
+/**
+  * @Func       : ma_host_ring_get
+  * @brief      : Takes bytes from the front of a socket buffer
+  * @pre-cond.  : clsNetMutex held
+  * @post-cond. : None
+  * @parameters :
+  *       - io_ring: Buffer
+  *       - out_data: Bytes
+  *       - in_size: Room in out_data
+  *       - in_peek: true to leave the bytes in the buffer
+  *       - in_counted: false for the copies of the phone, left out of bytesCopied
+  * @retval     : Bytes taken
+  */
+static size_t ma_host_ring_get(st_host_ring_t *io_ring, uint8_t *out_data, size_t in_size, bool in_peek, bool in_counted)
+{
+    size_t count = 0;
+    size_t head = io_ring->head;
+    size_t left = io_ring->count;
+
+    while (count < in_size && left > 0)
+    {
+        size_t chunk = DF_HOST_SOCKET_BUFFER_SIZE - head;
+        if (chunk > left)
+        {
+            chunk = left;
+        }
+        if (chunk > in_size - count)
+        {
+            chunk = in_size - count;
+        }
+        if (in_counted)
+        {
+            memcpy(out_data + count, io_ring->data + head, chunk);
+        }
+        else
+        {
+            ma_host_copy_uncounted(out_data + count, io_ring->data + head, chunk);
+        }
+        head = (head + chunk) % DF_HOST_SOCKET_BUFFER_SIZE;
+        left -= chunk;
+        count += chunk;
+    }
+    if (!in_peek)
+    {
+        io_ring->head = head;
+        io_ring->count = left;
+    }
+    return count;
+}
+
+/**
+  * @Func       : ma_host_net_unref
+  * @brief      : Drops a reference to a socket, frees it with the last one
+  * @pre-cond.  : clsNetMutex held
+  * @post-cond. : None
+  * @parameters : io_socket: Socket
+  * @retval     : None
+  */
+static void ma_host_net_unref(st_host_socket_t *io_socket)
+{
+    if (--io_socket->references != 0)
+    {
+        return;
+    }
+    for (st_host_socket_t **link = &pstHostSockets; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == io_socket)
+        {
+            *link = io_socket->next;
+            break;
+        }
+    }
+    free(io_socket->toDevice.data);
+    free(io_socket->toPhone.data);
+    free(io_socket);
+}
+
+/**
+  * @Func       : ma_host_net_find_listener
+  * @brief      : Finds the listener of a port
+  * @pre-cond.  : clsNetMutex held
+  * @post-cond. : None
+  * @parameters : in_port: Port
+  * @retval     : The listener, NULL if nothing listens on the port
+  */
+static st_host_listener_t *ma_host_net_find_listener(uint16_t in_port)
+{
+    for (uint8_t i = 0; i < DF_HOST_NET_MAX_LISTENERS; i++)
+    {
+        if (stHostListeners[i].active && stHostListeners[i].port == in_port)
+        {
+            return &stHostListeners[i];
+        }
+    }
+    return NULL;
+}
+
+/*****************************END OF FILE**************************************/
@@ -11,419 +11,3086 @@
 
 /* Includes ------------------------------------------------------------------*/ 
 // C language standard library
+#include <atomic>
+#include <mutex>
 
 // Mauro Almeida driver library
 
 // API library
 #include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+#include "ma_api_wifi_dns.h"
+#include "ma_api_wifi_events.h"
+#include "ma_api_wifi_http.h"
+#include "ma_api_wifi_portal_page.h"
+#include "ma_api_wifi_profiles.h"
+#include "ma_api_wifi_scan.h"
+#include "ma_api_wifi_stream.h"
+#include "ma_api_wifi_storage.h"
+#include "ma_api_wifi_task.h"
+#include "ma_api_wifi_trace.h"
 
 /*******************************************************************************
 							HOW TO USE THIS API
 ********************************************************************************
 
-1. 	First, you should include in your .c file the 
-    "ma_api_rain_sensor.h" file.
+1. 	First, you should include in your .cpp file the 
+    "ma_api_wifi_auto_ap_station.h" file. The networks are saved in RTC 
+    memory and NVS and read from the cheapest one, so a wake from deep 
+    sleep reads no flash (see ma_api_wifi_storage.cpp). SPIFFS is only 
+    mounted once, to move the networks saved there by older versions; 
+    SPIFFS.begin() is not needed anymore.
 
-2.  Call ma_api_rain_sensor_init(DESIRED-PIN) to initialize and setup 
-    the sensor parameters.
+2.  Call ma_api_wifi_read_network_credentials() to know if a network is 
+    saved. Up to DF_WIFI_MAX_PROFILES networks are kept, each one with a 
+    priority, see ma_api_wifi_profile_add().
 
-3.  Call ma_api_rain_sensor_value() to get the sensor raw value.
+3.  If there are no valid credentials, call ma_api_wifi_setup_access_point()
+    and then call ma_api_wifi_portal_poll() from loop(). Each call does a 
+    bounded amount of work and returns, so several clients are served at once.
+    The portal adds, lists and deletes the saved networks, and offers the
+    networks around, scanned in the background and cached (/scan.json).
+    While the portal runs, a DNS responder answers every name with the AP
+    address and the connectivity checks of the phones are redirected to the
+    portal, so the sign-in sheet opens by itself.
+    Connections are kept open between requests (HTTP/1.1 keep-alive, up to
+    DF_PORTAL_MAX_REQUESTS each, closed after DF_PORTAL_KEEP_ALIVE_TIMEOUT_MS
+    idle) and pipelined requests are answered in order, so the page and its
+    JSON fetches do not pay a TCP handshake each on the AP link.
 
-4.  Call ma_api_rain_sensor_average_percentage_value() to get the sensor 
-    average in percentage value.
+4.  Otherwise call ma_api_wifi_setup_station_profiles() to connect to the 
+    best saved network in range, or ma_api_wifi_setup_station() to connect to
+    one given network. Credentials are passed in a st_wifi_credential_t, a 
+    fixed size structure filled by ma_api_wifi_credential_set(), so nothing
+    is allocated. The String versions of older releases are kept as wrappers
+    at the end of this file.
+
+5.  A network saved on the portal is tested with the AP still up (AP + 
+    Station mode) and saved only if it connects, without a restart. The page
+    follows the test on /status.json. ma_api_wifi_portal_set_hot_apply(false)
+    restores the save and restart of older versions.
+    The ESP32 has one radio: in AP + Station mode the AP moves to the channel
+    of the network being joined, so the phone may drop and rejoin the AP.
+
+6.  While connected, ma_api_wifi_station_poll() watches the link. If it stays
+    down for the link monitor timeout, the portal comes back in AP + Station
+    mode and goes away when the link returns. Call ma_api_wifi_station_poll()
+    and ma_api_wifi_portal_poll() from loop() all the time.
+
+7.  Or call ma_api_wifi_manager_start() instead of 2. to 4.: a FreeRTOS task
+    does the polling and loop() reads ma_api_wifi_get_event(). Every public 
+    function takes the same recursive lock, so they can be called from any
+    core meanwhile; the blocking ones release it while they wait.
+
+8.  The AP name, password and address, the web server port and the features
+    (DNS responder, scan, several networks, /metrics) are -D build flags, 
+    see ma_api_wifi_config.h. They are checked at compile time and the code
+    of a disabled feature is left out of the firmware. The portal answers
+    the paths of stPortalRoutes only, any other path gets 404.
+    tools/footprint.py builds each set of features and reports its size.
 
 *******************************************************************************/
 
 /* Private define ------------------------------------------------------------*/
-#define DF_CREDENTIALS_FILE_NAME           "/wifi_credentials.txt"
+#define DF_LEGACY_CREDENTIALS_FILE_NAME    "/wifi_credentials.txt"   // Text file of older versions, migrated on read
+#define DF_LEGACY_CREDENTIALS_MAX_SIZE     160
 
-#define DF_IP_ADDRESS                   IPAddress(192, 168, 123, 123)
-#define DF_IP_MASK                      IPAddress(255, 255, 255, 0)
+#define DF_CREDENTIALS_RECORD_MAGIC        0x4357414D  // "MAWC"
+#define DF_CREDENTIALS_RECORD_VERSION      1
 
-#define DF_SSID_AP                      "SOBREIRO_MONITOR"
-#define DF_PASSWORD_AP                  "12345678"
+#define DF_PROFILES_RECORD_NAME            "/wifi_prof"
+#define DF_PROFILES_RECORD_MAGIC           0x5057414D  // "MAWP"
+#define DF_PROFILES_RECORD_VERSION         1
+
+#define DF_FAST_RECONNECT_RECORD_NAME      "/wifi_fast"
+#define DF_FAST_RECONNECT_RECORD_MAGIC     0x4657414D  // "MAWF"
+#define DF_FAST_RECONNECT_RECORD_VERSION   1
+#define DF_FAST_RECONNECT_TIMEOUT_MS       3000        // Targeted join + static IP, longer means the cache is stale
+#define DF_STATION_EVENT_GOT_IP            0x01
+#define DF_STATION_EVENT_DISCONNECTED      0x02
+#define DF_STATION_WAIT_POLL_MS            1           // Poll period of the blocking ma_api_wifi_setup_station()
+#define DF_LINK_MONITOR_TIMEOUT_SECONDS    60          // Default link loss before the portal comes back, 0 disables
+#define DF_APPLY_AP_LINGER_MS              30000       // AP kept after a hot apply, so the browser can read the result
+#define DF_PROVISION_RTC_MAGIC             0x5250414D  // "MAPR", provisioning time kept across esp_restart()
 
 #define DF_MILIS_TO_SECONDS_FACTOR 1000
+
+#define DF_WIFI_PRIORITY_BUFFER_SIZE    4       // "0" to "255" + terminator
+
+#define DF_PORTAL_MAX_CONNECTIONS       4       // Size of the connection table
+#define DF_PORTAL_READ_BUDGET_BYTES     512     // Max bytes read from one connection per poll
+#define DF_PORTAL_TIMEOUT_SECONDS       60      // Default idle time before a connection is dropped
+#define DF_PORTAL_REQUEST_TIMEOUT_MS    10000   // Whole request, so a client sending a byte at a time cannot hold a slot
+#define DF_PORTAL_EVICT_IDLE_MS         1000    // A connection idle this long is closed when a new client needs its slot
+#define DF_PORTAL_KEEP_ALIVE_TIMEOUT_MS 5000    // Idle time of a kept connection before it is closed
+#define DF_PORTAL_MAX_REQUESTS          32      // Requests per connection, the last response closes it
+#define DF_PORTAL_SCAN_TTL_MS           30000   // Age of the scan after which /scan.json starts a new one
 /* Private macros ------------------------------------------------------------*/
+// Held by every public function, so the Api can be called from the background task and from loop() at once
+#define API_LOCK()                      std::lock_guard<std::recursive_mutex> apiLock(clsApiMutex)
+
+// Entry of stPortalRoutes. A disabled route keeps its path but not its handler, so the linker drops the handler.
+#define PORTAL_ROUTE(path, handler, enabled)    {path, sizeof(path) - 1, (enabled) ? handler : NULL}
 
 /* Private typedef -----------------------------------------------------------*/
+// Fixed layout of the credentials saved in flash, fields are length prefixed
+typedef struct {
+  uint8_t ssidLength;
+  char ssid[DF_WIFI_SSID_BUFFER_SIZE - 1];
+  uint8_t passwordLength;
+  char password[DF_WIFI_PASSWORD_BUFFER_SIZE - 1];
+}st_wifi_credential_record_t;
+
+// Last successful association and DHCP lease, saved next to the credentials
+typedef struct {
+  uint32_t credentialCrc;           // CRC32 of SSID and password the cache belongs to
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t mask;
+  uint32_t dns;
+}st_wifi_fast_reconnect_record_t;
+
+static_assert(sizeof(st_wifi_profile_store_t) <= DF_STORAGE_MAX_PAYLOAD_SIZE, "DF_WIFI_MAX_PROFILES too big for one record");
+
+// Selection of the saved network, runs on top of the station state machine
+typedef enum {
+  eWIFI_PROFILES_IDLE = 0,        // Not connecting through the profiles
+  eWIFI_PROFILES_FAST,            // Trying the network of the fast reconnect cache, no scan
+  eWIFI_PROFILES_SCANNING,        // Waiting for the scan
+  eWIFI_PROFILES_CONNECTING       // Trying the ranked networks one by one
+}e_wifi_profiles_state_t;
+
+// Test of the network saved on the portal, see ma_api_wifi_portal_set_hot_apply()
+typedef enum {
+  eWIFI_APPLY_IDLE = 0,
+  eWIFI_APPLY_TESTING,            // Joining the new network, the AP stays up
+  eWIFI_APPLY_SUCCEEDED,          // Joined and saved, the AP stops after DF_APPLY_AP_LINGER_MS
+  eWIFI_APPLY_FAILED              // Not saved, the portal keeps running
+}e_wifi_apply_state_t;
+
+typedef enum {
+  eWIFI_PORTAL_CONN_FREE = 0,     // Slot not in use
+  eWIFI_PORTAL_CONN_READING,      // Receiving the HTTP request, or kept open waiting for the next one
+  eWIFI_PORTAL_CONN_RESPONDING,   // Header complete, response pending
+  eWIFI_PORTAL_CONN_CLOSING       // Response sent, connection must be stopped
+}e_wifi_portal_conn_state_t;
+
+typedef struct {
+  WiFiClient client;
+  e_wifi_portal_conn_state_t state;
+  unsigned long lastActivityMs;
+  unsigned long requestStartMs;     // Accept, or first byte of the request on a kept connection
+  uint8_t requestCount;             // Requests answered on this connection
+  st_wifi_http_request_t request;
+}st_wifi_portal_connection_t;
+
+// Answers one portal route, the response is sent when it returns
+typedef void (*ma_api_wifi_route_handler_t)(st_wifi_portal_connection_t *io_connection);
+
+typedef struct {
+  const char *path;
+  uint8_t pathLength;               // Compared before the text, most paths differ in length
+  ma_api_wifi_route_handler_t handler;  // NULL when the feature of the route is not built, the path gets 404
+}st_wifi_portal_route_t;
 
 /* Private variables ---------------------------------------------------------*/
 
-// Set web server port number to 80
-WiFiServer clsWifiServer(80);
+// Serializes the public functions, recursive because callbacks may call the Api again
+std::recursive_mutex clsApiMutex;
+
+// Events for the application. Pushed with clsApiMutex held, read by ma_api_wifi_get_event() without it.
+st_wifi_event_queue_t stEventQueue;
+
+// Portal web server, on DF_WIFI_HTTP_PORT
+WiFiServer clsWifiServer(stWifiBuildConfig.httpPort);
+
+// Variable to store the Wifi Credentials currently saved in memory
+st_wifi_credential_t stWifiStationCredential;
+
+// Last credentials given to ma_api_wifi_process_client_request(), copied only when the caller changes them
+st_wifi_credential_t stWrapperCallerCredential;
+bool bWrapperCallerCredentialSet = false;
+
+// Connection table of the portal web server
+st_wifi_portal_connection_t stPortalConnections[DF_PORTAL_MAX_CONNECTIONS];
+
+// How the last connection went
+st_wifi_connect_stats_t stConnectStats = {eWIFI_CONNECT_PATH_NONE, eWIFI_CONNECT_RESULT_CANCELLED, 0, 0, 0, 0, 0};
+
+// Station connection state machine, driven by ma_api_wifi_station_poll()
+e_wifi_station_state_t eStationState = eWIFI_STATION_IDLE;
+st_wifi_connect_config_t stStationConfig = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+ma_api_wifi_connect_callback_t pfStationCallback = NULL;
+char cStationSsid[DF_WIFI_SSID_BUFFER_SIZE];
+char cStationPassword[DF_WIFI_PASSWORD_BUFFER_SIZE];
+unsigned long ulStationStartMs = 0;
+unsigned long ulStationAttemptStartMs = 0;
+unsigned long ulStationBackoffMs = 0;
+uint8_t u8StationFatalCount = 0;
+e_wifi_connect_result_t eStationLastFatal = eWIFI_CONNECT_RESULT_CONNECTED;
+bool bStationEventRegistered = false;
+
+// Saved networks, loaded from flash on first use
+st_wifi_profile_store_t stProfileStore;
+bool bProfileStoreLoaded = false;
+
+// Profile selection, driven by the station state machine callback
+e_wifi_profiles_state_t eProfilesState = eWIFI_PROFILES_IDLE;
+st_wifi_connect_config_t stProfilesConfig = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+ma_api_wifi_connect_callback_t pfProfilesCallback = NULL;
+uint8_t u8ProfileOrder[DF_WIFI_MAX_PROFILES];
+uint8_t u8ProfileOrderCount = 0;
+uint8_t u8ProfileOrderNext = 0;
+int8_t i8ProfileCurrent = -1;
+int8_t i8ProfileFast = -1;
+unsigned long ulProfilesStartMs = 0;
+
+// Portal running, and whether the link monitor started it
+bool bPortalActive = false;
+bool bPortalFallback = false;
+
+// Hot apply of the network saved on the portal
+bool bPortalHotApply = true;
+e_wifi_apply_state_t eApplyState = eWIFI_APPLY_IDLE;
+e_wifi_connect_result_t eApplyResult = eWIFI_CONNECT_RESULT_CANCELLED;
+unsigned long ulApplyStartMs = 0;
+unsigned long ulApplyDoneMs = 0;
+
+// Link monitor, runs while the station is connected
+unsigned long ulLinkTimeoutMs = DF_LINK_MONITOR_TIMEOUT_SECONDS * DF_MILIS_TO_SECONDS_FACTOR;
+unsigned long ulLinkLostMs = 0;
+
+// Time from the portal save to esp_restart() on the reboot path, RTC memory survives the restart
+RTC_DATA_ATTR uint32_t u32RtcProvisionMagic;
+RTC_DATA_ATTR uint32_t u32RtcProvisionMs;
+
+// Set by the WiFi event task, consumed by ma_api_wifi_station_poll()
+std::atomic<uint32_t> u32StationEvents(0);
+std::atomic<uint8_t> u8StationDisconnectReason(0);
+
+// Buffered writer shared by all portal responses, they are sent one at a time
+st_wifi_stream_t stPortalStream;
+
+// The response being written keeps the connection open, read by ma_api_wifi_connection_header()
+bool bPortalKeepAlive = false;
 
-// Variable to store the HTTP request
-String clsStringHeader;
+// Networks found by the last scan, of the profiles or of the portal. The portal scans when it starts
+// and when /scan.json finds the results older than DF_PORTAL_SCAN_TTL_MS.
+st_wifi_scan_cache_t stScanCache;
+bool bPortalScanWanted = false;
 
-// Variable to store the Wifi Credentials
-st_wifi_station_credential_t stWifiStationCredential;
+// Time without traffic before a portal connection is dropped
+unsigned long ulPortalTimeoutMs = DF_PORTAL_TIMEOUT_SECONDS * DF_MILIS_TO_SECONDS_FACTOR;
 
 /* Private function prototypes -----------------------------------------------*/  
-void ma_api_wifi_get_token(String in_header, String *out_ssid, String *out_password);
+int8_t ma_api_wifi_get_token(const st_wifi_http_request_t *in_request, char *out_ssid, char *out_password, char *out_priority);
+void ma_api_wifi_keep_saved_password(const char *in_ssid, char *io_password);
+int8_t ma_api_wifi_parse_priority(const st_wifi_http_request_t *in_request, const char *in_text, uint8_t *out_priority);
+void ma_api_wifi_portal_accept(void);
+void ma_api_wifi_portal_read(st_wifi_portal_connection_t *in_connection);
+void ma_api_wifi_portal_respond(st_wifi_portal_connection_t *in_connection);
+void ma_api_wifi_portal_close(st_wifi_portal_connection_t *in_connection);
+void ma_api_wifi_send_http_status(WiFiClient &in_client, const char *in_status);
+void ma_api_wifi_send_portal_redirect(WiFiClient &in_client);
+ma_api_wifi_route_handler_t ma_api_wifi_portal_find_route(const st_wifi_http_request_t *in_request);
+void ma_api_wifi_route_page(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_save_data(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_credentials(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_status(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_scan(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_profiles(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_profile_add(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_profile_delete(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_metrics(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_route_redirect(st_wifi_portal_connection_t *io_connection);
+void ma_api_wifi_send_http_response(st_wifi_stream_t *io_stream, const st_wifi_http_request_t *in_request);
+void ma_api_wifi_send_credentials_json(st_wifi_stream_t *io_stream);
+void ma_api_wifi_send_profiles_json(st_wifi_stream_t *io_stream);
+void ma_api_wifi_send_metrics_json(st_wifi_stream_t *io_stream);
+void ma_api_wifi_send_status_json(st_wifi_stream_t *io_stream);
+void ma_api_wifi_send_scan_json(st_wifi_stream_t *io_stream);
+void ma_api_wifi_portal_scan_poll(void);
+void ma_api_wifi_scan_collect(int16_t in_networkCount);
+void ma_api_wifi_portal_start_ap(wifi_mode_t in_mode);
+void ma_api_wifi_portal_stop(void);
+void ma_api_wifi_apply_start(const char *in_ssid, const char *in_password, unsigned long in_startMs);
+void ma_api_wifi_apply_on_result(e_wifi_connect_result_t in_result);
+void ma_api_wifi_link_monitor(uint32_t in_events, unsigned long in_nowMs);
+wifi_mode_t ma_api_wifi_station_wifi_mode(void);
+void ma_api_wifi_push_event(e_wifi_event_type_t in_type, uint8_t in_detail);
+void ma_api_wifi_manager_step(void);
+void ma_api_wifi_manager_on_result(e_wifi_connect_result_t in_result);
+void ma_api_wifi_send_json_string(st_wifi_stream_t *io_stream, const char *in_text);
+void ma_api_wifi_send_json_headers(st_wifi_stream_t *io_stream);
+const char *ma_api_wifi_connection_header(void);
+void ma_api_wifi_portal_parsed(st_wifi_portal_connection_t *io_connection, e_wifi_http_parse_result_t in_result);
+int8_t ma_api_wifi_read_legacy_credentials(st_wifi_credential_record_t *out_record);
+int8_t ma_api_wifi_profiles_load(void);
+int8_t ma_api_wifi_profiles_save(void);
+int8_t ma_api_wifi_profiles_fast_index(void);
+void ma_api_wifi_profiles_start_scan(void);
+void ma_api_wifi_profiles_scan_done(int16_t in_networkCount);
+void ma_api_wifi_profiles_start(uint8_t in_index, e_wifi_profiles_state_t in_state);
+void ma_api_wifi_profiles_on_result(e_wifi_connect_result_t in_result);
+int8_t ma_api_wifi_connect_start(const char *in_ssid, size_t in_ssidLength, const char *in_password, size_t in_passwordLength, const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback);
+void ma_api_wifi_station_event(WiFiEvent_t in_event, WiFiEventInfo_t in_info);
+void ma_api_wifi_station_start_attempt(void);
+void ma_api_wifi_station_attempt_failed(uint8_t in_reason, unsigned long in_nowMs);
+void ma_api_wifi_station_finish(e_wifi_connect_result_t in_result, e_wifi_connect_path_t in_path);
+e_wifi_connect_result_t ma_api_wifi_classify_reason(uint8_t in_reason);
+uint32_t ma_api_wifi_credential_crc(const char *in_ssid, size_t in_ssidLength, const char *in_password, size_t in_passwordLength);
+int8_t ma_api_wifi_fast_reconnect_begin(void);
+void ma_api_wifi_fast_reconnect_drop(void);
+void ma_api_wifi_save_fast_reconnect(void);
+
+// Routes of the portal, fixed at compile time. Any other path gets 404.
+static constexpr st_wifi_portal_route_t stPortalRoutes[] = {
+    PORTAL_ROUTE("/", ma_api_wifi_route_page, true),
+    PORTAL_ROUTE("/save_data", ma_api_wifi_route_save_data, true),
+    PORTAL_ROUTE("/credentials.json", ma_api_wifi_route_credentials, true),
+    PORTAL_ROUTE("/status.json", ma_api_wifi_route_status, true),
+    PORTAL_ROUTE("/scan.json", ma_api_wifi_route_scan, stWifiBuildConfig.scan),
+    PORTAL_ROUTE("/profiles.json", ma_api_wifi_route_profiles, stWifiBuildConfig.profiles),
+    PORTAL_ROUTE("/profile_add", ma_api_wifi_route_profile_add, stWifiBuildConfig.profiles),
+    PORTAL_ROUTE("/profile_delete", ma_api_wifi_route_profile_delete, stWifiBuildConfig.profiles),
+    PORTAL_ROUTE("/metrics", ma_api_wifi_route_metrics, stWifiBuildConfig.metrics),
+    // Connectivity checks of the operating systems, they only reach the portal through the DNS responder
+    PORTAL_ROUTE("/generate_204", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),                // Android, Chrome OS
+    PORTAL_ROUTE("/gen_204", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),                     // Android
+    PORTAL_ROUTE("/hotspot-detect.html", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),         // iOS, macOS
+    PORTAL_ROUTE("/library/test/success.html", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),   // Older iOS
+    PORTAL_ROUTE("/connecttest.txt", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),             // Windows 10 and later
+    PORTAL_ROUTE("/ncsi.txt", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),                    // Older Windows
+    PORTAL_ROUTE("/redirect", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),                    // Windows
+    PORTAL_ROUTE("/canonical.html", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),              // Firefox
+    PORTAL_ROUTE("/success.txt", ma_api_wifi_route_redirect, stWifiBuildConfig.dns),                 // Firefox
+    PORTAL_ROUTE("/kindle-wifi/wifistub.html", ma_api_wifi_route_redirect, stWifiBuildConfig.dns)   // Kindle
+};
 
 /* Public objects ------------------------------------------------------------*/
 
 
 /* Body of private functions -------------------------------------------------*/
 
-int8_t ma_api_wifi_setup_station(st_wifi_station_credential_t in_wifiCredentials, int maxAttempts) 
+/**
+  * @Func       : ma_api_wifi_setup_station
+  * @brief      : Connects to the network in Station mode and waits for the result. It is a blocking
+  *               wrapper of ma_api_wifi_connect_async(), see it for details. The lock is not held while it waits.
+  * @pre-cond.  : None
+  * @post-cond. : WiFi connected on success. See ma_api_wifi_get_connect_stats() for the path and time taken.
+  * @parameters : 
+  *       - in_credential: SSID and password of the network
+  *       - maxAttempts: Number of full connection attempts
+  * @retval     : 0 on success, -1 if the connection failed
+  */
+int8_t ma_api_wifi_setup_station(const st_wifi_credential_t &in_credential, int maxAttempts) 
 {
-    PRINTF("Connecting on:\n   SSID: %s    PASSWORD: %s\n", in_wifiCredentials.stringSsid, in_wifiCredentials.stringPassword);
-
-    int attempts = 0;
+    st_wifi_connect_config_t config = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+    config.maxAttempts = (uint8_t)maxAttempts;
 
-    while (attempts < maxAttempts) 
+    if (ma_api_wifi_connect_async(in_credential, &config, NULL) != 0) 
     {
-        WiFi.begin(in_wifiCredentials.stringSsid.c_str(), in_wifiCredentials.stringPassword.c_str());
-        int attempt = 0;
-        while (attempt < 10 && WiFi.status() != WL_CONNECTED)
-        {
-            delay(500);
-            PRINTF(".");
-            attempt++;
-        }
+        return -1;
+    }
 
-        if (WiFi.status() == WL_CONNECTED) 
-        {
-            PRINTF("\nWiFi conected\n");
-            return  0;
-        } 
-        else 
-        {
-            PRINTF("\nFail to conect. Retry...\n");
-            attempts++;
-        }
+    // Each call takes the lock on its own, so the other tasks are not held off while this one waits
+    e_wifi_station_state_t state = ma_api_wifi_get_station_state();
+    while (state != eWIFI_STATION_CONNECTED && state != eWIFI_STATION_FAILED) 
+    {
+        delay(DF_STATION_WAIT_POLL_MS);
+        ma_api_wifi_station_poll();
+        state = ma_api_wifi_get_station_state();
     }
 
-    return -1; // Erro: falha na conexão após o número máximo de tentativas
+    return (state == eWIFI_STATION_CONNECTED) ? 0 : -1;
 }
 
-
 /**
-  * @Func       : ma_api_wifi_check_credentials  
-  * @brief      : This function initializes the WiFi module in either Station mode or Access Point (AP) mode based on 
-  *                 the provided mode.
-  * 
-  * @pre-cond.  : Installation of SPIFFS and FS library and SPIFFS.begin() must be called before using this function.
-  * @post-cond. : WiFi is initialized and ready to be used.
-  * @parameters : eWIFI_MODE: The WiFi mode to initialize (WIFI_MODE_STA for Station mode, WIFI_MODE_AP for AP mode).
-  * @retval     : None
+  * @Func       : ma_api_wifi_setup_station_profiles
+  * @brief      : Connects to the best saved network in range and waits for the result. It is a blocking
+  *               wrapper of ma_api_wifi_connect_profiles_async(), see it for details. The lock is not held while it waits.
+  * @pre-cond.  : None
+  * @post-cond. : WiFi connected on success. See ma_api_wifi_get_connect_stats() for the path and time taken.
+  * @parameters : maxAttempts: Number of full connection attempts on each network
+  * @retval     : 0 on success, -1 if no saved network could be joined
   */
-void ma_api_wifi_setup_access_point(st_wifi_station_credential_t in_credentials) 
+int8_t ma_api_wifi_setup_station_profiles(int maxAttempts) 
 {
-    PRINTF("Setting AP (Access Point)… Only to set SSID and PASSWORD.\n");
-    WiFi.mode(WIFI_AP); 
-    WiFi.softAP(DF_SSID_AP, DF_PASSWORD_AP);   //launch the access point
-    PRINTF("Wait 100 ms for AP_START...\n");
-    delay(100);
-    PRINTF("Setting the AP\n");
-    WiFi.softAPConfig(DF_IP_ADDRESS, DF_IP_ADDRESS, DF_IP_MASK);
-    clsWifiServer.begin();
-}
+    st_wifi_connect_config_t config = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+    config.maxAttempts = (uint8_t)maxAttempts;
+
+    if (ma_api_wifi_connect_profiles_async(&config, NULL) != 0) 
+    {
+        return -1;
+    }
 
+    // Each call takes the lock on its own, so the other tasks are not held off while this one waits
+    e_wifi_station_state_t state = ma_api_wifi_get_station_state();
+    while (state != eWIFI_STATION_CONNECTED && state != eWIFI_STATION_FAILED) 
+    {
+        delay(DF_STATION_WAIT_POLL_MS);
+        ma_api_wifi_station_poll();
+        state = ma_api_wifi_get_station_state();
+    }
 
+    return (state == eWIFI_STATION_CONNECTED) ? 0 : -1;
+}
 
 /**
-  * @Func       : ma_api_wifi_send_http_response
-  * @brief      : This function sends an HTTP response containing an HTML page to the client
-  * @pre-cond.  : The client must be connected and ready to receive the response
-  * @post-cond. : The HTTP response is sent to the client
-  * @parameters : in_client: The WiFiClient object representing the client to which the response will be sent
-  * @retval     : None
-  */
-void ma_api_wifi_send_http_response(WiFiClient in_client) 
-{
-  in_client.println("HTTP/1.1 200 OK");
-  in_client.println("Content-type:text/html");
-  in_client.println("Connection: close");
-  in_client.println();
-  in_client.println("<!DOCTYPE html><html>");
-  in_client.println("<head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">");
-  in_client.println("<link rel=\"icon\" href=\"data:,\">");
-  in_client.println("<style>html { font-family: Helvetica; display: inline-block; margin: 0px auto; text-align: center;}");
-  in_client.println(".button { background-color: #4CAF50; border: none; color: white; padding: 16px 40px;");
-  in_client.println("text-decoration: none; font-size: 30px; margin: 2px; cursor: pointer;}");
-  in_client.println(".button2 {background-color: #555555;}</style></head>");
-  in_client.println("<body><h1>Sobreiro Monitor</h1>");
-  in_client.println("<form id=\"formSalvar\" action=\"/save_data\" method=\"post\">");
-  in_client.println("<p>Digite o SSID: </p>");
-  in_client.println("<p><input type=\"text\" name=\"user\" value=\"" + stWifiStationCredential.stringSsid + "\"><p>");
-  in_client.println("<p>Digite a SENHA: </p>");
-  in_client.println("<p><input type=\"password\" name=\"password\" id=\"password\" value=\"" + stWifiStationCredential.stringPassword + "\"></p>");
-  in_client.println("<button type=\"button\" onclick=\"togglePasswordVisibility()\">Mostrar/Ocultar Senha</button>");
-  in_client.println("<p><input type=\"submit\" value=\"Salvar\"></p>");
-  in_client.println("</form>");
-  in_client.println("<script>");
-  in_client.println("function togglePasswordVisibility() {");
-  in_client.println("  var passwordField = document.getElementById('password');");
-  in_client.println("  if (passwordField.type === 'password') {");
-  in_client.println("    passwordField.type = 'text';");
-  in_client.println("  } else {");
-  in_client.println("    passwordField.type = 'password';");
-  in_client.println("  }");
-  in_client.println("}");
-
-  in_client.println("document.getElementById('formSalvar').addEventListener('submit', function(event) {");
-  in_client.println("  event.preventDefault();"); // Evita que o formulário seja enviado automaticamente
-  in_client.println("  var ssid = document.getElementsByName('user')[0].value;");
-  in_client.println("  var password = document.getElementsByName('password')[0].value;");
-  in_client.println("  var form = document.getElementById('formSalvar');");
-  in_client.println("  var url = '/save_data?ssid=' + encodeURIComponent(ssid) + '&password=' + encodeURIComponent(password);");
-  in_client.println("  form.action = url;"); // Define a URL com os parâmetros ssid e password como o atributo action do formulário
-  in_client.println("  form.submit();"); // Envia o formulário
-  in_client.println("});");
-
-  in_client.println("</script>");
-  in_client.println("</body></html>");
+  * @Func       : ma_api_wifi_connect_async
+  * @brief      : Starts connecting to the network in Station mode and returns at once. The progress is made
+  *               by ma_api_wifi_station_poll(), which reacts to the WiFi system events:
+  *                 1. The channel, BSSID and IP configuration of the last successful connection are tried
+  *                    first, which skips the scan and the DHCP exchange.
+  *                 2. Full attempts follow, separated by a jittered exponential backoff.
+  *                 3. Wrong password and AP not found end the connection after fatalFailureLimit
+  *                    consecutive failures, the other failures use all maxAttempts.
+  * @pre-cond.  : None
+  * @post-cond. : Connection in progress. in_callback, if not NULL, is called by ma_api_wifi_station_poll()
+  *               with the result.
+  * @parameters : 
+  *       - in_credential: SSID and password of the network, copied
+  *       - in_config: Attempts, timeouts and backoff, or NULL for DF_WIFI_CONNECT_CONFIG_DEFAULT
+  *       - in_callback: Called once with the result, may be NULL
+  * @retval     : 0 if the connection started, -1 if the credentials do not fit
+  */
+int8_t ma_api_wifi_connect_async(const st_wifi_credential_t &in_credential, const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    eProfilesState = eWIFI_PROFILES_IDLE;
+    return ma_api_wifi_connect_start(in_credential.ssid, in_credential.ssidLength, in_credential.psk, in_credential.pskLength, 
+                                     in_config, in_callback);
 }
 
+/**
+  * @Func       : ma_api_wifi_connect_profiles_async
+  * @brief      : Starts connecting to one of the saved networks and returns at once:
+  *                 1. If the fast reconnect cache belongs to a saved network, that network is tried first
+  *                    and no scan is made.
+  *                 2. Otherwise one scan is made and the saved networks found are tried by priority, 
+  *                    signal strength and last success (see ma_api_wifi_profiles_rank()).
+  *               Each network is joined as in ma_api_wifi_connect_async(). The progress is made by 
+  *               ma_api_wifi_station_poll().
+  * @pre-cond.  : None
+  * @post-cond. : Connection in progress. in_callback, if not NULL, is called once with the result of the
+  *               last network tried.
+  * @parameters : 
+  *       - in_config: Attempts, timeouts and backoff used on each network, or NULL for DF_WIFI_CONNECT_CONFIG_DEFAULT
+  *       - in_callback: Called once with the result, may be NULL
+  * @retval     : 0 if the connection started, -1 if there is no saved network
+  */
+int8_t ma_api_wifi_connect_profiles_async(const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    const st_wifi_connect_config_t defaultConfig = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+
+    if (ma_api_wifi_profiles_load() != 0 || ma_api_wifi_profiles_best(&stProfileStore) < 0) 
+    {
+        return -1;
+    }
 
+    stProfilesConfig = (in_config != NULL) ? *in_config : defaultConfig;
+    pfProfilesCallback = in_callback;
+    u8ProfileOrderCount = 0;
+    u8ProfileOrderNext = 0;
+    ulProfilesStartMs = millis();
 
+    i8ProfileFast = ma_api_wifi_profiles_fast_index();
+    if (i8ProfileFast >= 0) 
+    {
+        ma_api_wifi_profiles_start((uint8_t)i8ProfileFast, eWIFI_PROFILES_FAST);
+    } 
+    else 
+    {
+        ma_api_wifi_profiles_start_scan();
+    }
+    return 0;
+}
 
 /**
-  * @Func       : ma_api_wifi_process_client_request
-  * @brief      : This function processes the client request and sends an HTTP response
-  * @pre-cond.  : The client must be connected and ready to receive the response
-  * @post-cond. : The HTTP response is sent to the client
+  * @Func       : ma_api_wifi_connect_start
+  * @brief      : Copies the credentials and starts the station state machine, see ma_api_wifi_connect_async()
+  * @pre-cond.  : None
+  * @post-cond. : Connection in progress
   * @parameters : 
-  *       - in_oldSsid: The old SSID stored in memory
-  *       - in_oldPassword: The old password stored in memory
+  *       - in_ssid: SSID, not null terminated
+  *       - in_ssidLength: Length of the SSID
+  *       - in_password: Password, not null terminated
+  *       - in_passwordLength: Length of the password
+  *       - in_config: Attempts, timeouts and backoff, or NULL for DF_WIFI_CONNECT_CONFIG_DEFAULT
+  *       - in_callback: Called once with the result, may be NULL
+  * @retval     : 0 if the connection started, -1 if the credentials do not fit
+  */
+int8_t ma_api_wifi_connect_start(const char *in_ssid, size_t in_ssidLength, const char *in_password, size_t in_passwordLength, const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback) 
+{
+    const st_wifi_connect_config_t defaultConfig = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+
+    if (in_ssidLength >= sizeof(cStationSsid) || in_passwordLength >= sizeof(cStationPassword)) 
+    {
+        return -1;
+    }
+
+    memcpy(cStationSsid, in_ssid, in_ssidLength);
+    cStationSsid[in_ssidLength] = '\0';
+    memcpy(cStationPassword, in_password, in_passwordLength);
+    cStationPassword[in_passwordLength] = '\0';
+    PRINTF("Connecting on:\n   SSID: %s    PASSWORD: %u characters\n", cStationSsid, (unsigned)strlen(cStationPassword));
+    stStationConfig = (in_config != NULL) ? *in_config : defaultConfig;
+    pfStationCallback = in_callback;
+
+    if (!bStationEventRegistered) 
+    {
+        WiFi.onEvent(ma_api_wifi_station_event);
+        bStationEventRegistered = true;
+    }
+
+    // Retries are made by the state machine, not by the driver
+    WiFi.mode(ma_api_wifi_station_wifi_mode());
+    WiFi.setAutoReconnect(false);
+
+    stConnectStats.attempts = 0;
+    stConnectStats.lastReason = 0;
+    u8StationFatalCount = 0;
+    ulStationStartMs = millis();
+    u32StationEvents.store(0);
+
+    if (ma_api_wifi_fast_reconnect_begin() == 0) 
+    {
+        eStationState = eWIFI_STATION_FAST_CONNECTING;
+        ulStationAttemptStartMs = millis();
+    } 
+    else 
+    {
+        ma_api_wifi_station_start_attempt();
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_station_poll
+  * @brief      : Runs the station connection state machine. It only looks at the events received since the
+  *               last call and at the clock, so it returns in microseconds. Once connected, it runs the link
+  *               monitor, see ma_api_wifi_link_monitor_set_timeout().
+  * @pre-cond.  : ma_api_wifi_connect_async() must be called before using this function
+  * @post-cond. : State updated. The callback is called when the connection ends.
+  * @parameters : None
   * @retval     : None
   */
-void ma_api_wifi_process_client_request(WiFiClient *in_wifiClient, String in_oldSsid, String in_oldPassword, uint16_t in_timeToWaitSeconds) 
+void ma_api_wifi_station_poll(void) 
 {
-    String header = "";
-    String currentLine = "";
-    *in_wifiClient = clsWifiServer.available();
-    unsigned long waitStartTime = millis();
-    // Ler o cabeçalho HTTP linha por linha
-    while (in_wifiClient->connected()) 
+    API_LOCK();
+    TRACE_POLL_SPAN();
+    uint32_t events = u32StationEvents.exchange(0);
+    unsigned long nowMs = millis();
+
+    switch (eStationState) 
     {
-        if(millis() - waitStartTime > (in_timeToWaitSeconds * DF_MILIS_TO_SECONDS_FACTOR))
+        case eWIFI_STATION_SCANNING:
         {
+            int16_t networkCount = WiFi.scanComplete();
+            if (networkCount != WIFI_SCAN_RUNNING) 
+            {
+                ma_api_wifi_profiles_scan_done(networkCount);
+            }
             break;
         }
-        else if (in_wifiClient->available()) 
-        {
-            char c = in_wifiClient->read();
-            //Serial.write(c);                    // print it out the serial monitor
-            header += c;
-            if (c == '\n') 
+
+        case eWIFI_STATION_FAST_CONNECTING:
+        case eWIFI_STATION_CONNECTING:
+            if (events & DF_STATION_EVENT_GOT_IP) 
+            {
+                TRACE_RECORD_MS((eStationState == eWIFI_STATION_FAST_CONNECTING) ? "wifi_fast_attempt" : "wifi_attempt", 
+                                ulStationAttemptStartMs);
+                ma_api_wifi_station_finish(eWIFI_CONNECT_RESULT_CONNECTED, 
+                                           (eStationState == eWIFI_STATION_FAST_CONNECTING) ? eWIFI_CONNECT_PATH_FAST : eWIFI_CONNECT_PATH_FULL);
+            } 
+            else if (events & DF_STATION_EVENT_DISCONNECTED) 
             {
-                if (currentLine.length() == 0) 
-                {
-                    // Cabeçalho HTTP completo recebido
-                    in_wifiClient->println("HTTP/1.1 200 OK");
-                    in_wifiClient->println("Content-type:text/html");
-                    in_wifiClient->println("Connection: close");
-                    in_wifiClient->println();
-
-                    // Enviar resposta HTTP
-                    ma_api_wifi_send_http_response(*in_wifiClient);
-                    break;
-                } 
-                else 
-                {
-                currentLine = "";
-                }
+                ma_api_wifi_station_attempt_failed(u8StationDisconnectReason.load(), nowMs);
             } 
-            else if (c != '\r') 
+            else if (nowMs - ulStationAttemptStartMs > ((eStationState == eWIFI_STATION_FAST_CONNECTING) ? 
+                                                        DF_FAST_RECONNECT_TIMEOUT_MS : stStationConfig.attemptTimeoutMs)) 
             {
-                currentLine += c;
+                ma_api_wifi_station_attempt_failed(0, nowMs);
             }
-        }
+            break;
+
+        case eWIFI_STATION_BACKOFF:
+            if (nowMs - ulStationAttemptStartMs >= ulStationBackoffMs) 
+            {
+                ma_api_wifi_station_start_attempt();
+            }
+            break;
+
+        case eWIFI_STATION_CONNECTED:
+            ma_api_wifi_link_monitor(events, nowMs);
+            break;
 
+        default:
+            break;
     }
-    ma_api_wifi_get_token(header, &stWifiStationCredential.stringSsid, &stWifiStationCredential.stringPassword);
+}
 
-    if(stWifiStationCredential.stringSsid.length() >= 5 && stWifiStationCredential.stringPassword.length() >= 5 &&  
-        (in_oldSsid != stWifiStationCredential.stringSsid || in_oldPassword != stWifiStationCredential.stringPassword))
+/**
+  * @Func       : ma_api_wifi_connect_cancel
+  * @brief      : Stops a connection in progress
+  * @pre-cond.  : None
+  * @post-cond. : State eWIFI_STATION_FAILED, the callback is called with eWIFI_CONNECT_RESULT_CANCELLED.
+  *               A scan in progress ends on its own, its result is ignored.
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_connect_cancel(void) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    if (eStationState == eWIFI_STATION_SCANNING || eStationState == eWIFI_STATION_FAST_CONNECTING || 
+        eStationState == eWIFI_STATION_CONNECTING || eStationState == eWIFI_STATION_BACKOFF) 
     {
-        PRINTF("DEBUG - stWifiStationCredential.clsStringSsid.length(): %d\n", stWifiStationCredential.stringSsid.length());
-        PRINTF("DEBUG - stWifiStationCredential.clsStringPassword.length(): %d\n", stWifiStationCredential.stringPassword.length());
-        ma_api_wifi_update_network_credentials(stWifiStationCredential.stringSsid, stWifiStationCredential.stringPassword);
-        esp_restart(); //Force reboot
+        WiFi.disconnect();
+        ma_api_wifi_station_finish(eWIFI_CONNECT_RESULT_CANCELLED, eWIFI_CONNECT_PATH_FAILED);
     }
-    in_wifiClient->stop();
 }
 
 /**
-  * @Func       : ma_api_wifi_get_token
-  * @brief      : Extracts SSID and password from the URL parameters in the header
-  * @pre-cond.  : Client connected and send data via Method POST
-  * @post-cond. : SSID and password are extracted from the URL parameters
+  * @Func       : ma_api_wifi_get_station_state
+  * @brief      : Returns the state of the station connection
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : See e_wifi_station_state_t
+  */
+e_wifi_station_state_t ma_api_wifi_get_station_state(void) 
+{
+    API_LOCK();
+    TRACE_POLL_SPAN();
+    return eStationState;
+}
+
+/**
+  * @Func       : ma_api_wifi_get_connect_stats
+  * @brief      : Returns how the last connection ended and how long it took
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Path used, result, attempts, connect time and time from boot to connected
+  */
+st_wifi_connect_stats_t ma_api_wifi_get_connect_stats(void) 
+{
+    API_LOCK();
+    TRACE_POLL_SPAN();
+    return stConnectStats;
+}
+
+/**
+  * @Func       : ma_api_wifi_station_event
+  * @brief      : WiFi event handler. Runs in the WiFi event task, so it only records the event.
+  * @pre-cond.  : Registered with WiFi.onEvent()
+  * @post-cond. : Event kept for ma_api_wifi_station_poll()
   * @parameters : 
-  *       - in_header: The header string containing the URL parameters
-  *       - out_ssid: Pointer to a string to store the extracted SSID
-  *       - out_password: Pointer to a string to store the extracted password
+  *       - in_event: The event
+  *       - in_info: Event data
   * @retval     : None
   */
-void ma_api_wifi_get_token(String in_header, String *out_ssid, String *out_password) 
+void ma_api_wifi_station_event(WiFiEvent_t in_event, WiFiEventInfo_t in_info) 
 {
-    // Find the position of the first '?' in the URL (if any)
-    int index = in_header.indexOf('?');
-    if (index != -1) 
+    switch (in_event) 
     {
-        // Get the part of the URL after the '?' (which contains the parameters)
-        String params = in_header.substring(index + 1);
-
-        // Find the position of the start of the SSID in the parameters string
-        int ssidIndex = params.indexOf("ssid=");
-        if (ssidIndex != -1) 
-        {
-            // Extract the value of the SSID (after "ssid=")
-            int delimiterIndex[5];
-            delimiterIndex[0] = params.indexOf('&', ssidIndex);
-            delimiterIndex[1] = params.indexOf(' ', ssidIndex);
-            delimiterIndex[2] = params.indexOf('\n', ssidIndex);
-            delimiterIndex[3] = params.indexOf('\r', ssidIndex);
-            delimiterIndex[4] = params.indexOf('/', ssidIndex);
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            u32StationEvents.fetch_or(DF_STATION_EVENT_GOT_IP);
+            break;
 
-            // Find the next delimiter ('&', ' ', '\n', '\r', or '/') after the SSID
-            int ssidEndIndex = params.length(); // Initialize with the length of the string to ensure a default value
-            for (int i = 0; i < 5; i++) 
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            // Our own WiFi.disconnect() before a retry is not a failure of the next attempt
+            if (in_info.wifi_sta_disconnected.reason != WIFI_REASON_ASSOC_LEAVE) 
             {
-                if (delimiterIndex[i] != -1 && delimiterIndex[i] < ssidEndIndex) 
-                {
-                    ssidEndIndex = delimiterIndex[i];
-                }
+                u8StationDisconnectReason.store(in_info.wifi_sta_disconnected.reason);
+                u32StationEvents.fetch_or(DF_STATION_EVENT_DISCONNECTED);
             }
+            break;
 
-            *out_ssid = params.substring(ssidIndex + 5, ssidEndIndex);
-            String newSsid = params.substring(ssidIndex + 5, ssidEndIndex);
-            if(newSsid[newSsid.length() -1] == '\r')
-            {
-                newSsid[newSsid.length() -1] = '\0';
-            }
-            *out_ssid = newSsid;
-            PRINTF("Found SSID: %s\n", *out_ssid);
-        }
+        default:
+            break;
+    }
+}
 
-        // Find the position of the start of the password in the parameters string
-        int passwordIndex = params.indexOf("password=");
-        if (passwordIndex != -1) 
-        {
-            // Extract the value of the password (after "password=")
-            int delimiterIndex[5];
-            delimiterIndex[0] = params.indexOf('&', passwordIndex);
-            delimiterIndex[1] = params.indexOf(' ', passwordIndex);
-            delimiterIndex[2] = params.indexOf('\n', passwordIndex);
-            delimiterIndex[3] = params.indexOf('\r', passwordIndex);
-            delimiterIndex[4] = params.indexOf('/', passwordIndex);
+/**
+  * @Func       : ma_api_wifi_station_start_attempt
+  * @brief      : Starts one full connection attempt with DHCP
+  * @pre-cond.  : None
+  * @post-cond. : State eWIFI_STATION_CONNECTING
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_station_start_attempt(void) 
+{
+    stConnectStats.attempts++;
+    PRINTF("Connection attempt %d\n", stConnectStats.attempts);
+    u32StationEvents.store(0);
+    WiFi.begin(cStationSsid, cStationPassword);
+    ulStationAttemptStartMs = millis();
+    eStationState = eWIFI_STATION_CONNECTING;
+}
 
-            // Find the next delimiter ('&', ' ', '\n', '\r', or '/') after the password
-            int passwordEndIndex = params.length(); // Initialize with the length of the string to ensure a default value
-            for (int i = 0; i < 5; i++) 
-            {
-                if (delimiterIndex[i] != -1 && delimiterIndex[i] < passwordEndIndex) 
-                {
-                    passwordEndIndex = delimiterIndex[i];
-                }
-            }
+/**
+  * @Func       : ma_api_wifi_station_attempt_failed
+  * @brief      : Decides what follows a failed attempt: full attempt after a failed fast attempt, end of
+  *               the connection on repeated fatal failures or when attempts are exhausted, or backoff.
+  * @pre-cond.  : State eWIFI_STATION_FAST_CONNECTING or eWIFI_STATION_CONNECTING
+  * @post-cond. : Next state set
+  * @parameters : 
+  *       - in_reason: Disconnect reason, 0 when the attempt timed out
+  *       - in_nowMs: millis() of this poll
+  * @retval     : None
+  */
+void ma_api_wifi_station_attempt_failed(uint8_t in_reason, unsigned long in_nowMs) 
+{
+    stConnectStats.lastReason = in_reason;
+    PRINTF("Fail to conect, reason %d.\n", in_reason);
+    TRACE_RECORD_MS((eStationState == eWIFI_STATION_FAST_CONNECTING) ? "wifi_fast_attempt" : "wifi_attempt", ulStationAttemptStartMs);
+    TRACE_CONNECT_FAILURE(in_reason);
 
-            String newPassword = params.substring(passwordIndex + 9, passwordEndIndex);
-            if(newPassword[newPassword.length() -1] == '\r')
-            {
-            newPassword[newPassword.length() -1] = '\0';
-            }
-            *out_password = newPassword;
-            PRINTF("Found Password: %s\n", *out_password);
+    if (eStationState == eWIFI_STATION_FAST_CONNECTING) 
+    {
+        ma_api_wifi_fast_reconnect_drop();
+        ma_api_wifi_station_start_attempt();
+        return;
+    }
+
+    e_wifi_connect_result_t failure = ma_api_wifi_classify_reason(in_reason);
+    if (failure != eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED) 
+    {
+        u8StationFatalCount = (failure == eStationLastFatal) ? u8StationFatalCount + 1 : 1;
+        eStationLastFatal = failure;
+        if (u8StationFatalCount >= stStationConfig.fatalFailureLimit) 
+        {
+            WiFi.disconnect();
+            ma_api_wifi_station_finish(failure, eWIFI_CONNECT_PATH_FAILED);
+            return;
         }
     } 
     else 
     {
-        //PRINTF("Don't have parameters in URL.\n");
+        u8StationFatalCount = 0;
+    }
+
+    WiFi.disconnect();
+    if (stConnectStats.attempts >= stStationConfig.maxAttempts) 
+    {
+        ma_api_wifi_station_finish(eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED, eWIFI_CONNECT_PATH_FAILED);
+        return;
     }
-}
 
+    // Exponential backoff with equal jitter: half fixed, half random, so devices that lost the same AP 
+    // do not retry in lock step
+    uint32_t backoffMs = stStationConfig.backoffBaseMs;
+    for (uint8_t i = 1; i < stConnectStats.attempts && backoffMs < stStationConfig.backoffMaxMs; i++) 
+    {
+        backoffMs *= 2;
+    }
+    if (backoffMs > stStationConfig.backoffMaxMs) 
+    {
+        backoffMs = stStationConfig.backoffMaxMs;
+    }
+    ulStationBackoffMs = backoffMs / 2 + random(backoffMs / 2 + 1);
+    ulStationAttemptStartMs = in_nowMs;
+    eStationState = eWIFI_STATION_BACKOFF;
+    PRINTF("Retry in %lu ms\n", ulStationBackoffMs);
+}
 
 /**
-  * @Func       : ma_api_wifi_update_network_credentials
-  * @brief      : Updates and saves network credentials to SPIFFS
-  * @pre-cond.  : SPIFFS must be initialized and the file system must be accessible
-  * @post-cond. : Network credentials are updated and saved to SPIFFS
+  * @Func       : ma_api_wifi_station_finish
+  * @brief      : Ends the connection, records the statistics and calls the callback
+  * @pre-cond.  : None
+  * @post-cond. : State eWIFI_STATION_CONNECTED or eWIFI_STATION_FAILED
   * @parameters : 
-  *       - in_ssid: The new SSID to be saved
-  *       - in_password: The new password to be saved
+  *       - in_result: Result of the connection
+  *       - in_path: Path that ended the connection
   * @retval     : None
   */
-void ma_api_wifi_update_network_credentials(const String in_ssid, const String in_password) 
+void ma_api_wifi_station_finish(e_wifi_connect_result_t in_result, e_wifi_connect_path_t in_path) 
 {
-    // Open the file for writing to SPIFFS
-    File file = SPIFFS.open(DF_CREDENTIALS_FILE_NAME, "w+");
-    if (!file) {
-        PRINTF("Error opening file for writing.\n");
-        return;
-    }
+    unsigned long nowMs = millis();
 
-    // Write the credentials to the file
-    file.print("SSID: ");
-    file.println(in_ssid);
-    file.print("Password: ");
-    file.println(in_password);
+    stConnectStats.path = in_path;
+    stConnectStats.result = in_result;
+    stConnectStats.connectMs = nowMs - ulStationStartMs;
+    stConnectStats.bootToConnectedMs = (in_result == eWIFI_CONNECT_RESULT_CONNECTED) ? nowMs : 0;
+    stConnectStats.provisionToOnlineMs = 0;
+    PRINTF("Connect path %d result %d: %lu ms, boot to connected %lu ms\n", (int)in_path, (int)in_result, 
+           (unsigned long)stConnectStats.connectMs, (unsigned long)stConnectStats.bootToConnectedMs);
 
-    // Close the file
-    file.close();
+    if (in_result == eWIFI_CONNECT_RESULT_CONNECTED) 
+    {
+        PRINTF("WiFi conected\n");
+        eStationState = eWIFI_STATION_CONNECTED;
+        ulLinkLostMs = 0;
+        WiFi.setAutoReconnect(true);
+        if (u32RtcProvisionMagic == DF_PROVISION_RTC_MAGIC) 
+        {
+            // First connection after the reboot that followed a portal save. millis() does not count
+            // the boot loader, so this is slightly short.
+            stConnectStats.provisionToOnlineMs = u32RtcProvisionMs + nowMs;
+            u32RtcProvisionMagic = 0;
+        }
+        if (in_path == eWIFI_CONNECT_PATH_FULL) 
+        {
+            ma_api_wifi_save_fast_reconnect();
+        }
+    } 
+    else 
+    {
+        eStationState = eWIFI_STATION_FAILED;
+    }
+
+    if (pfStationCallback != NULL) 
+    {
+        pfStationCallback(in_result);
+    }
 
-    PRINTF("New credentials saved in SPIFFS.\n      SSID: %s Password: %s\n", in_ssid, in_password);
+    // Reported once the callback did not move on to another network
+    if (eStationState == eWIFI_STATION_CONNECTED) 
+    {
+        ma_api_wifi_push_event(eWIFI_EVENT_CONNECTED, (uint8_t)in_path);
+    } 
+    else if (eStationState == eWIFI_STATION_FAILED) 
+    {
+        ma_api_wifi_push_event(eWIFI_EVENT_CONNECT_FAILED, (uint8_t)in_result);
+    }
 }
 
+/**
+  * @Func       : ma_api_wifi_classify_reason
+  * @brief      : Sorts a disconnect reason into failures that retrying cannot fix and transient ones
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_reason: Disconnect reason (wifi_err_reason_t), 0 for a timeout
+  * @retval     : eWIFI_CONNECT_RESULT_WRONG_PASSWORD, eWIFI_CONNECT_RESULT_AP_NOT_FOUND, or
+  *               eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED for a transient failure
+  */
+e_wifi_connect_result_t ma_api_wifi_classify_reason(uint8_t in_reason) 
+{
+    switch (in_reason) 
+    {
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+            return eWIFI_CONNECT_RESULT_WRONG_PASSWORD;
+
+        case WIFI_REASON_NO_AP_FOUND:
+            return eWIFI_CONNECT_RESULT_AP_NOT_FOUND;
+
+        default:
+            return eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED;
+    }
+}
 
 /**
-  * @Func       : ma_api_wifi_read_network_credentials
-  * @brief      : Reads network credentials from SPIFFS and updates the provided structure
-  * @pre-cond.  : SPIFFS must be initialized and the file system must be accessible
-  * @post-cond. : Network credentials are read from SPIFFS and updated in the structure
-  * @parameters : 
-  *       - out_credentials: Pointer to the structure where the credentials will be stored
-  * @retval     : None
+  * @Func       : ma_api_wifi_fast_reconnect_begin
+  * @brief      : Starts joining the cached BSSID on the cached channel with the cached IP configuration.
+  *               The IP is reused without asking DHCP, so the DHCP server lease time should be longer than
+  *               the time the device sleeps.
+  * @pre-cond.  : WiFi in Station mode, credentials in cStationSsid and cStationPassword
+  * @post-cond. : Association started if there is a cache for these credentials
+  * @parameters : None
+  * @retval     : 0 if the fast attempt started, -1 if there is no cache
   */
-int8_t ma_api_wifi_read_network_credentials(st_wifi_station_credential_t *out_credentials) 
+int8_t ma_api_wifi_fast_reconnect_begin(void) 
 {
-    // Open the file for reading from SPIFFS
-    File file = SPIFFS.open(DF_CREDENTIALS_FILE_NAME, "r");
-    if (!file)
+    st_wifi_fast_reconnect_record_t record;
+
+    if (ma_api_wifi_storage_read(DF_FAST_RECONNECT_RECORD_NAME, DF_FAST_RECONNECT_RECORD_MAGIC, 
+                                 DF_FAST_RECONNECT_RECORD_VERSION, &record, sizeof(record)) != 0 ||
+        record.credentialCrc != ma_api_wifi_credential_crc(cStationSsid, strlen(cStationSsid), cStationPassword, strlen(cStationPassword))) 
     {
-        PRINTF("Erro ao abrir o arquivo para leitura.\n");
         return -1;
     }
 
-    // Read lines from the file and extract the credentials
-    String line;
-    bool ssidFound = false;
-    bool passwordFound = false;
-    while (file.available()) 
+    PRINTF("Fast reconnect on channel %d\n", record.channel);
+    WiFi.config(IPAddress(record.ip), IPAddress(record.gateway), IPAddress(record.mask), IPAddress(record.dns));
+    WiFi.begin(cStationSsid, cStationPassword, record.channel, record.bssid);
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_fast_reconnect_drop
+  * @brief      : Forgets a stale cache after a failed fast attempt and goes back to scan + DHCP
+  * @pre-cond.  : None
+  * @post-cond. : Cache removed, DHCP enabled, WiFi disconnected
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_fast_reconnect_drop(void) 
+{
+    PRINTF("Fast reconnect failed, cache dropped.\n");
+    WiFi.disconnect();
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    ma_api_wifi_storage_erase(DF_FAST_RECONNECT_RECORD_NAME);
+}
+
+/**
+  * @Func       : ma_api_wifi_save_fast_reconnect
+  * @brief      : Saves BSSID, channel and IP configuration of the current connection. Nothing is written
+  *               if the cache already holds the same values.
+  * @pre-cond.  : WiFi connected
+  * @post-cond. : Cache saved
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_save_fast_reconnect(void) 
+{
+    st_wifi_fast_reconnect_record_t record;
+    st_wifi_fast_reconnect_record_t saved;
+    const uint8_t *bssid = WiFi.BSSID();
+
+    if (bssid == NULL) 
     {
-        line = file.readStringUntil('\n');
-        line.trim();
-        if (line.startsWith("SSID: ")) 
-        {
-            out_credentials->stringSsid = line.substring(6); // Remove "SSID: " from the line
-            ssidFound = true;
-        } 
-        else if (line.startsWith("Password: ")) 
-        {
-            out_credentials->stringPassword = line.substring(10); // Remove "Password: " from the line
-            passwordFound = true;
-        }
+        return;
     }
 
-    // Close the file
-    file.close();
+    memset(&record, 0, sizeof(record));
+    record.credentialCrc = ma_api_wifi_credential_crc(cStationSsid, strlen(cStationSsid), cStationPassword, strlen(cStationPassword));
+    memcpy(record.bssid, bssid, sizeof(record.bssid));
+    record.channel = (uint8_t)WiFi.channel();
+    record.ip = (uint32_t)WiFi.localIP();
+    record.gateway = (uint32_t)WiFi.gatewayIP();
+    record.mask = (uint32_t)WiFi.subnetMask();
+    record.dns = (uint32_t)WiFi.dnsIP(0);
 
-    if (!ssidFound || !passwordFound)
+    if (ma_api_wifi_storage_read(DF_FAST_RECONNECT_RECORD_NAME, DF_FAST_RECONNECT_RECORD_MAGIC, 
+                                 DF_FAST_RECONNECT_RECORD_VERSION, &saved, sizeof(saved)) == 0 &&
+        memcmp(&saved, &record, sizeof(record)) == 0) 
     {
-        PRINTF("Erro ao ler as credenciais da SPIFFS.\n");
-        out_credentials->hasCredentials = false;
-        return -1;
+        return;
     }
 
-    PRINTF("Credenciais lidas da SPIFFS e atualizadas na estrutura de credenciais.\n     SSID: %s SENHA: %s\n", 
-            out_credentials->stringSsid, out_credentials->stringPassword);
-    out_credentials->hasCredentials = true;
-    return 0;
+    ma_api_wifi_storage_write(DF_FAST_RECONNECT_RECORD_NAME, DF_FAST_RECONNECT_RECORD_MAGIC, 
+                              DF_FAST_RECONNECT_RECORD_VERSION, &record, sizeof(record));
+}
+
+/**
+  * @Func       : ma_api_wifi_credential_crc
+  * @brief      : CRC32 of an SSID and password, used to tie a cache to its credentials
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : 
+  *       - in_ssid: SSID, not null terminated
+  *       - in_ssidLength: Length of the SSID
+  *       - in_password: Password, not null terminated
+  *       - in_passwordLength: Length of the password
+  * @retval     : The CRC
+  */
+uint32_t ma_api_wifi_credential_crc(const char *in_ssid, size_t in_ssidLength, const char *in_password, size_t in_passwordLength) 
+{
+    // A NUL separates SSID and password, so "ab"+"c" and "a"+"bc" do not give the same CRC and a cache
+    // saved for one network is never used with another
+    uint32_t crc = ma_api_wifi_storage_crc32(0, in_ssid, in_ssidLength);
+    crc = ma_api_wifi_storage_crc32(crc, "", 1);
+    return ma_api_wifi_storage_crc32(crc, in_password, in_passwordLength);
 }
 
+/**
+  * @Func       : ma_api_wifi_profiles_fast_index
+  * @brief      : Finds the saved network the fast reconnect cache belongs to
+  * @pre-cond.  : Profiles loaded
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Index of the profile, -1 if there is no cache or it belongs to no saved network
+  */
+int8_t ma_api_wifi_profiles_fast_index(void) 
+{
+    st_wifi_fast_reconnect_record_t record;
+
+    if (ma_api_wifi_storage_read(DF_FAST_RECONNECT_RECORD_NAME, DF_FAST_RECONNECT_RECORD_MAGIC, 
+                                 DF_FAST_RECONNECT_RECORD_VERSION, &record, sizeof(record)) != 0) 
+    {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < DF_WIFI_MAX_PROFILES; i++) 
+    {
+        const st_wifi_profile_t *profile = &stProfileStore.profiles[i];
+        if (profile->inUse && 
+            ma_api_wifi_credential_crc(profile->ssid, profile->ssidLength, profile->password, profile->passwordLength) == record.credentialCrc) 
+        {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_start_scan
+  * @brief      : Starts the scan used to rank the saved networks. The scan runs in the background.
+  * @pre-cond.  : None
+  * @post-cond. : State eWIFI_STATION_SCANNING, ma_api_wifi_station_poll() waits for the result
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_profiles_start_scan(void) 
+{
+    PRINTF("Scanning for the saved networks\n");
+    WiFi.mode(ma_api_wifi_station_wifi_mode());
+    WiFi.scanDelete();
+    eProfilesState = eWIFI_PROFILES_SCANNING;
+    eStationState = eWIFI_STATION_SCANNING;
+    ulStationAttemptStartMs = millis();
+    ma_api_wifi_scan_begin(&stScanCache, ulStationAttemptStartMs);
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) 
+    {
+        ma_api_wifi_profiles_scan_done(WIFI_SCAN_FAILED);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_scan_done
+  * @brief      : Joins the scan results with the saved networks and tries the first one of the ranking. 
+  *               The network already tried through the fast reconnect cache is left out. The results also
+  *               refresh the scan cache served on /scan.json.
+  * @pre-cond.  : State eWIFI_STATION_SCANNING
+  * @post-cond. : First network being joined, or the connection ends with eWIFI_CONNECT_RESULT_AP_NOT_FOUND
+  * @parameters : in_networkCount: Value of WiFi.scanComplete(), negative if the scan failed
+  * @retval     : None
+  */
+void ma_api_wifi_profiles_scan_done(int16_t in_networkCount) 
+{
+    ma_api_wifi_scan_collect(in_networkCount);
+
+    // A failed scan ranks nothing, so every profile is tried
+    uint8_t order[DF_WIFI_MAX_PROFILES];
+    uint8_t count = ma_api_wifi_profiles_rank(&stProfileStore, stScanCache.results, 
+                                              (in_networkCount >= 0) ? stScanCache.count : 0, order);
+    u8ProfileOrderCount = 0;
+    u8ProfileOrderNext = 0;
+    for (uint8_t i = 0; i < count; i++) 
+    {
+        if ((int8_t)order[i] != i8ProfileFast) 
+        {
+            u8ProfileOrder[u8ProfileOrderCount++] = order[i];
+        }
+    }
+
+    if (u8ProfileOrderCount == 0) 
+    {
+        pfStationCallback = ma_api_wifi_profiles_on_result;
+        ulStationStartMs = ulProfilesStartMs;
+        ma_api_wifi_station_finish(eWIFI_CONNECT_RESULT_AP_NOT_FOUND, eWIFI_CONNECT_PATH_FAILED);
+        return;
+    }
+    ma_api_wifi_profiles_start(u8ProfileOrder[u8ProfileOrderNext++], eWIFI_PROFILES_CONNECTING);
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_start
+  * @brief      : Starts joining one saved network
+  * @pre-cond.  : in_index is a profile in use
+  * @post-cond. : Station state machine running, its result goes to ma_api_wifi_profiles_on_result()
+  * @parameters : 
+  *       - in_index: Index of the profile
+  *       - in_state: eWIFI_PROFILES_FAST or eWIFI_PROFILES_CONNECTING
+  * @retval     : None
+  */
+void ma_api_wifi_profiles_start(uint8_t in_index, e_wifi_profiles_state_t in_state) 
+{
+    const st_wifi_profile_t *profile = &stProfileStore.profiles[in_index];
+
+    i8ProfileCurrent = (int8_t)in_index;
+    eProfilesState = in_state;
+    ma_api_wifi_connect_start(profile->ssid, profile->ssidLength, profile->password, profile->passwordLength, 
+                              &stProfilesConfig, ma_api_wifi_profiles_on_result);
+    // The connect time covers the scan and the networks tried before
+    ulStationStartMs = ulProfilesStartMs;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_on_result
+  * @brief      : Result of one network. A failure moves to the scan after the cached network, or to the 
+  *               next network of the ranking. A success is recorded in the profile.
+  * @pre-cond.  : Called by ma_api_wifi_station_finish()
+  * @post-cond. : Next network being joined, or the user callback called with the final result
+  * @parameters : in_result: Result of the network just tried
+  * @retval     : None
+  */
+void ma_api_wifi_profiles_on_result(e_wifi_connect_result_t in_result) 
+{
+    if (in_result != eWIFI_CONNECT_RESULT_CONNECTED && in_result != eWIFI_CONNECT_RESULT_CANCELLED) 
+    {
+        if (eProfilesState == eWIFI_PROFILES_FAST) 
+        {
+            ma_api_wifi_profiles_start_scan();
+            return;
+        }
+        if (eProfilesState == eWIFI_PROFILES_CONNECTING && u8ProfileOrderNext < u8ProfileOrderCount) 
+        {
+            ma_api_wifi_profiles_start(u8ProfileOrder[u8ProfileOrderNext++], eWIFI_PROFILES_CONNECTING);
+            return;
+        }
+    }
+
+    if (in_result == eWIFI_CONNECT_RESULT_CONNECTED && i8ProfileCurrent >= 0 && 
+        ma_api_wifi_profiles_mark_success(&stProfileStore, (uint8_t)i8ProfileCurrent)) 
+    {
+        ma_api_wifi_profiles_save();
+    }
+
+    eProfilesState = eWIFI_PROFILES_IDLE;
+    if (pfProfilesCallback != NULL) 
+    {
+        pfProfilesCallback(in_result);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_setup_access_point  
+  * @brief      : Starts the Access Point (AP) and the portal web server used to set SSID and password.
+  * 
+  * @pre-cond.  : None
+  * @post-cond. : AP is running. ma_api_wifi_portal_poll() must be called periodically to serve the clients.
+  * @parameters : in_credential: The credentials currently saved in memory, shown on the portal page.
+  * @retval     : None
+  */
+void ma_api_wifi_setup_access_point(const st_wifi_credential_t &in_credential) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    PRINTF("Setting AP (Access Point)… Only to set SSID and PASSWORD.\n");
+    ma_api_wifi_portal_start_ap(WIFI_AP);
+    stWifiStationCredential = in_credential;
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_start_ap
+  * @brief      : Starts the AP, the portal web server and the DNS responder
+  * @pre-cond.  : None
+  * @post-cond. : Portal active
+  * @parameters : in_mode: WIFI_AP, or WIFI_AP_STA to keep the station running
+  * @retval     : None
+  */
+void ma_api_wifi_portal_start_ap(wifi_mode_t in_mode) 
+{
+    const IPAddress apIp(stWifiBuildConfig.apIp[0], stWifiBuildConfig.apIp[1], stWifiBuildConfig.apIp[2], stWifiBuildConfig.apIp[3]);
+    const IPAddress apMask(stWifiBuildConfig.apMask[0], stWifiBuildConfig.apMask[1], stWifiBuildConfig.apMask[2], stWifiBuildConfig.apMask[3]);
+
+    WiFi.mode(in_mode); 
+    WiFi.softAP(stWifiBuildConfig.apSsid, stWifiBuildConfig.apPassword);   //launch the access point
+    PRINTF("Wait 100 ms for AP_START...\n");
+    {
+        TRACE_NAMED_SPAN("ap_start_wait");
+        delay(100);
+    }
+    PRINTF("Setting the AP\n");
+    WiFi.softAPConfig(apIp, apIp, apMask);
+    clsWifiServer.begin();
+
+    // Every name resolves to the AP, so the connectivity checks of the phone reach the portal
+    if (stWifiBuildConfig.dns && ma_api_wifi_dns_start(DF_WIFI_DNS_PORT, stWifiBuildConfig.apIp) != 0) 
+    {
+        PRINTF("DNS responder not started.\n");
+    }
+    bPortalActive = true;
+    bPortalScanWanted = stWifiBuildConfig.scan;   // The page lists the networks around, scanned in the background
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_stop
+  * @brief      : Closes the portal connections, stops the DNS responder and the AP. The station keeps running.
+  * @pre-cond.  : None
+  * @post-cond. : Portal inactive, WiFi in Station mode
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_portal_stop(void) 
+{
+    PRINTF("Stopping the portal.\n");
+    for (uint8_t i = 0; i < DF_PORTAL_MAX_CONNECTIONS; i++) 
+    {
+        if (stPortalConnections[i].state != eWIFI_PORTAL_CONN_FREE) 
+        {
+            ma_api_wifi_portal_close(&stPortalConnections[i]);
+        }
+    }
+    clsWifiServer.end();
+    if (stWifiBuildConfig.dns) 
+    {
+        ma_api_wifi_dns_stop();
+    }
+    WiFi.softAPdisconnect(true);
+    bPortalActive = false;
+    bPortalFallback = false;
+    eApplyState = eWIFI_APPLY_IDLE;
+}
+
+/**
+  * @Func       : ma_api_wifi_station_wifi_mode
+  * @brief      : WiFi mode used to run the station. A running AP is kept.
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : WIFI_AP_STA while the portal is active, WIFI_STA otherwise
+  */
+wifi_mode_t ma_api_wifi_station_wifi_mode(void) 
+{
+    return bPortalActive ? WIFI_AP_STA : WIFI_STA;
+}
+
+/**
+  * @Func       : ma_api_wifi_apply_start
+  * @brief      : Joins the network received on the portal while the AP stays up. Nothing is saved until 
+  *               the connection succeeds, see ma_api_wifi_apply_on_result(). The browser follows the test
+  *               on /status.json. The AP moves to the channel of the network, so the phone may reconnect.
+  * @pre-cond.  : Portal active
+  * @post-cond. : WiFi in AP + Station mode, connection in progress
+  * @parameters : 
+  *       - in_ssid: SSID, null terminated
+  *       - in_password: Password, null terminated
+  *       - in_startMs: millis() when the save request arrived
+  * @retval     : None
+  */
+void ma_api_wifi_apply_start(const char *in_ssid, const char *in_password, unsigned long in_startMs) 
+{
+    const st_wifi_connect_config_t config = DF_WIFI_APPLY_CONFIG;
+
+    PRINTF("Testing the new network, the portal stays up.\n");
+    eProfilesState = eWIFI_PROFILES_IDLE;
+    eApplyState = eWIFI_APPLY_TESTING;
+    ulApplyStartMs = in_startMs;
+    if (ma_api_wifi_connect_start(in_ssid, strlen(in_ssid), in_password, strlen(in_password), &config, 
+                                  ma_api_wifi_apply_on_result) != 0) 
+    {
+        eApplyState = eWIFI_APPLY_FAILED;
+        eApplyResult = eWIFI_CONNECT_RESULT_CANCELLED;
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_apply_on_result
+  * @brief      : Result of the test of a new network. On success the network is saved as a profile; on 
+  *               failure nothing is saved, so a wrong password never replaces a working network.
+  * @pre-cond.  : Called by ma_api_wifi_station_finish()
+  * @post-cond. : eApplyState is eWIFI_APPLY_SUCCEEDED or eWIFI_APPLY_FAILED
+  * @parameters : in_result: Result of the connection
+  * @retval     : None
+  */
+void ma_api_wifi_apply_on_result(e_wifi_connect_result_t in_result) 
+{
+    unsigned long nowMs = millis();
+
+    eApplyResult = in_result;
+    ulApplyDoneMs = nowMs;
+    if (in_result != eWIFI_CONNECT_RESULT_CONNECTED) 
+    {
+        PRINTF("New network failed, not saved.\n");
+        eApplyState = eWIFI_APPLY_FAILED;
+        WiFi.disconnect();
+        if (bPortalFallback) 
+        {
+            // The link monitor started the portal: keep trying the saved networks behind it
+            ma_api_wifi_connect_profiles_async(NULL, NULL);
+        }
+        else 
+        {
+            // Back to the AP alone, so its channel no longer follows the network
+            WiFi.mode(WIFI_AP);
+        }
+        return;
+    }
+
+    if (ma_api_wifi_profiles_load() == 0) 
+    {
+        int8_t index = ma_api_wifi_profiles_add(&stProfileStore, cStationSsid, strlen(cStationSsid), cStationPassword, 
+                                                strlen(cStationPassword), DF_WIFI_PROFILE_DEFAULT_PRIORITY);
+        if (index >= 0) 
+        {
+            ma_api_wifi_profiles_mark_success(&stProfileStore, (uint8_t)index);
+            if (ma_api_wifi_profiles_save() == 0) 
+            {
+                ma_api_wifi_push_event(eWIFI_EVENT_CREDENTIALS_SAVED, (uint8_t)index);
+            }
+        }
+    }
+    ma_api_wifi_credential_set(&stWifiStationCredential, cStationSsid, cStationPassword);
+    stConnectStats.provisionToOnlineMs = nowMs - ulApplyStartMs;
+    eApplyState = eWIFI_APPLY_SUCCEEDED;
+    PRINTF("New network saved, online %lu ms after the save.\n", (unsigned long)stConnectStats.provisionToOnlineMs);
+}
+
+/**
+  * @Func       : ma_api_wifi_link_monitor
+  * @brief      : Watches the link of a connected station. The driver reconnects on its own; if the link
+  *               stays down for the link monitor timeout, the portal is started in AP + Station mode. It is
+  *               stopped again when the link is back.
+  * @pre-cond.  : State eWIFI_STATION_CONNECTED
+  * @post-cond. : None
+  * @parameters : 
+  *       - in_events: Events received since the last poll
+  *       - in_nowMs: millis() of this poll
+  * @retval     : None
+  */
+void ma_api_wifi_link_monitor(uint32_t in_events, unsigned long in_nowMs) 
+{
+    if (in_events != 0) 
+    {
+        if (WiFi.status() == WL_CONNECTED) 
+        {
+            ulLinkLostMs = 0;
+        } 
+        else if (ulLinkLostMs == 0) 
+        {
+            PRINTF("Link lost.\n");
+            ulLinkLostMs = (in_nowMs != 0) ? in_nowMs : 1;
+            ma_api_wifi_push_event(eWIFI_EVENT_DISCONNECTED, u8StationDisconnectReason.load());
+        }
+    }
+
+    if (ulLinkLostMs == 0) 
+    {
+        if (bPortalFallback && eApplyState != eWIFI_APPLY_SUCCEEDED) 
+        {
+            ma_api_wifi_portal_stop();
+        }
+        return;
+    }
+
+    if (!bPortalActive && ulLinkTimeoutMs != 0 && in_nowMs - ulLinkLostMs >= ulLinkTimeoutMs) 
+    {
+        PRINTF("Link down for %lu ms, starting the portal.\n", in_nowMs - ulLinkLostMs);
+        ma_api_wifi_read_network_credentials(&stWifiStationCredential);
+        ma_api_wifi_portal_start_ap(WIFI_AP_STA);
+        bPortalFallback = true;
+    }
+}
+
+
+/**
+  * @Func       : ma_api_wifi_send_http_response
+  * @brief      : This function sends the portal page to the client. The page is stored gzip-compressed in
+  *               flash (see ma_api_wifi_portal_page.h). If the client already has the current page, only 
+  *               "304 Not Modified" is sent.
+  * @pre-cond.  : ma_api_wifi_stream_begin() was called with the client that receives the response
+  * @post-cond. : The HTTP response is in the stream, ma_api_wifi_stream_end() must be called
+  * @parameters : 
+  *       - io_stream: The stream of the client to which the response will be sent
+  *       - in_request: The parsed request, used to check If-None-Match
+  * @retval     : None
+  */
+void ma_api_wifi_send_http_response(st_wifi_stream_t *io_stream, const st_wifi_http_request_t *in_request) 
+{
+    if (ma_api_wifi_http_etag_matches(in_request, DF_PORTAL_PAGE_ETAG)) 
+    {
+        ma_api_wifi_stream_printf(io_stream, 
+                                  "HTTP/1.1 304 Not Modified\r\n"
+                                  "ETag: " DF_PORTAL_PAGE_ETAG "\r\n"
+                                  "Connection: %s\r\n\r\n",
+                                  ma_api_wifi_connection_header());
+        return;
+    }
+
+    // no-cache: the browser keeps the page but asks again, so a new firmware page is never stale
+    ma_api_wifi_stream_printf(io_stream,
+                              "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: text/html; charset=utf-8\r\n"
+                              "Content-Encoding: gzip\r\n"
+                              "Content-Length: %u\r\n"
+                              "ETag: " DF_PORTAL_PAGE_ETAG "\r\n"
+                              "Cache-Control: no-cache\r\n"
+                              "Connection: %s\r\n\r\n",
+                              (unsigned)sizeof(u8PortalPageGzip), ma_api_wifi_connection_header());
+    ma_api_wifi_stream_write(io_stream, u8PortalPageGzip, sizeof(u8PortalPageGzip));
+}
+
+/**
+  * @Func       : ma_api_wifi_send_credentials_json
+  * @brief      : Sends the network saved in memory as {"ssid":"...","hasPassword":true}. The password never
+  *               leaves the device: the page leaves its field empty, and an empty password on /save_data or
+  *               /profile_add keeps the saved one. The page itself never changes and can be cached. The body
+  *               is escaped straight into the stream, its length is found by ma_api_wifi_stream_start_body().
+  * @pre-cond.  : ma_api_wifi_stream_begin() was called with the client that receives the response
+  * @post-cond. : The HTTP response is in the stream, ma_api_wifi_stream_end() must be called
+  * @parameters : io_stream: The stream of the client to which the response will be sent
+  * @retval     : None
+  */
+void ma_api_wifi_send_credentials_json(st_wifi_stream_t *io_stream) 
+{
+    ma_api_wifi_send_json_headers(io_stream);
+    ma_api_wifi_stream_print(io_stream, "{\"ssid\":");
+    ma_api_wifi_send_json_string(io_stream, stWifiStationCredential.ssid);
+    ma_api_wifi_stream_print(io_stream, (stWifiStationCredential.psk[0] != '\0') ? ",\"hasPassword\":true}" : ",\"hasPassword\":false}");
+}
+
+/**
+  * @Func       : ma_api_wifi_send_profiles_json
+  * @brief      : Sends the saved networks as [{"ssid":"...","priority":n,"lastSuccess":n},...]. The passwords
+  *               are not sent.
+  * @pre-cond.  : ma_api_wifi_stream_begin() was called with the client that receives the response
+  * @post-cond. : The HTTP response is in the stream, ma_api_wifi_stream_end() must be called
+  * @parameters : io_stream: The stream of the client to which the response will be sent
+  * @retval     : None
+  */
+void ma_api_wifi_send_profiles_json(st_wifi_stream_t *io_stream) 
+{
+    st_wifi_profile_info_t profiles[DF_WIFI_MAX_PROFILES];
+    uint8_t count = ma_api_wifi_profile_list(profiles, DF_WIFI_MAX_PROFILES);
+
+    ma_api_wifi_send_json_headers(io_stream);
+    ma_api_wifi_stream_print(io_stream, "[");
+    for (uint8_t i = 0; i < count; i++) 
+    {
+        ma_api_wifi_stream_print(io_stream, (i == 0) ? "{\"ssid\":" : ",{\"ssid\":");
+        ma_api_wifi_send_json_string(io_stream, profiles[i].ssid);
+        ma_api_wifi_stream_printf(io_stream, ",\"priority\":%u,\"lastSuccess\":%lu}", 
+                                  (unsigned)profiles[i].priority, (unsigned long)profiles[i].lastSuccess);
+    }
+    ma_api_wifi_stream_print(io_stream, "]");
+}
+
+/**
+  * @Func       : ma_api_wifi_send_status_json
+  * @brief      : Sends {"mode":"ap|sta|ap_sta","station":n,"apply":"idle|testing|connected|failed","result":n,
+  *               "ssid":"...","ip":"a.b.c.d","provisionToOnlineMs":n}. station is e_wifi_station_state_t and
+  *               result is e_wifi_connect_result_t of the last hot apply.
+  * @pre-cond.  : ma_api_wifi_stream_begin() was called with the client that receives the response
+  * @post-cond. : The HTTP response is in the stream, ma_api_wifi_stream_end() must be called
+  * @parameters : io_stream: The stream of the client to which the response will be sent
+  * @retval     : None
+  */
+void ma_api_wifi_send_status_json(st_wifi_stream_t *io_stream) 
+{
+    static const char *const modeNames[] = {"off", "sta", "ap", "ap_sta"};
+    static const char *const applyNames[] = {"idle", "testing", "connected", "failed"};
+    wifi_mode_t mode = WiFi.getMode();
+    IPAddress ip = WiFi.localIP();
+
+    ma_api_wifi_send_json_headers(io_stream);
+    ma_api_wifi_stream_printf(io_stream, "{\"mode\":\"%s\",\"station\":%d,\"apply\":\"%s\",\"result\":%d,\"ssid\":",
+                              ((unsigned)mode < 4) ? modeNames[mode] : "off", (int)eStationState, applyNames[eApplyState], 
+                              (int)eApplyResult);
+    ma_api_wifi_send_json_string(io_stream, cStationSsid);
+    ma_api_wifi_stream_printf(io_stream, ",\"ip\":\"%u.%u.%u.%u\",\"provisionToOnlineMs\":%lu}", 
+                              ip[0], ip[1], ip[2], ip[3], (unsigned long)stConnectStats.provisionToOnlineMs);
+}
+
+/**
+  * @Func       : ma_api_wifi_send_scan_json
+  * @brief      : Sends {"scanning":b,"ageMs":n,"durationMs":n,"networks":[{"ssid":"...","rssi":n,"secure":b}]}
+  *               from the scan cache, strongest first. ageMs is null before the first scan.
+  * @pre-cond.  : ma_api_wifi_stream_begin() was called with the client that receives the response
+  * @post-cond. : The HTTP response is in the stream, ma_api_wifi_stream_end() must be called
+  * @parameters : io_stream: The stream of the client to which the response will be sent
+  * @retval     : None
+  */
+void ma_api_wifi_send_scan_json(st_wifi_stream_t *io_stream) 
+{
+    ma_api_wifi_send_json_headers(io_stream);
+    ma_api_wifi_stream_printf(io_stream, "{\"scanning\":%s,\"ageMs\":", (stScanCache.scanning || bPortalScanWanted) ? "true" : "false");
+    if (stScanCache.hasResult) 
+    {
+        ma_api_wifi_stream_printf(io_stream, "%lu", (unsigned long)ma_api_wifi_scan_age(&stScanCache, millis()));
+    } 
+    else 
+    {
+        ma_api_wifi_stream_print(io_stream, "null");
+    }
+    ma_api_wifi_stream_printf(io_stream, ",\"durationMs\":%lu,\"networks\":[", (unsigned long)stScanCache.durationMs);
+    for (uint8_t i = 0; i < stScanCache.count; i++) 
+    {
+        const st_wifi_scan_result_t *result = &stScanCache.results[i];
+        ma_api_wifi_stream_print(io_stream, (i == 0) ? "{\"ssid\":" : ",{\"ssid\":");
+        ma_api_wifi_send_json_string(io_stream, result->ssid);
+        ma_api_wifi_stream_printf(io_stream, ",\"rssi\":%d,\"secure\":%s}", result->rssi, result->secure ? "true" : "false");
+    }
+    ma_api_wifi_stream_print(io_stream, "]}");
+}
+
+#ifdef TRACE_ENABLE
+/**
+  * @Func       : ma_api_wifi_send_metrics_json
+  * @brief      : Sends the trace counters and timeline as compact JSON:
+  *               {"uptimeUs":n,"heapFree":n,"heapLowWater":n,"requests":n,"connections":n,"bytesReceived":n,"bytesSent":n,
+  *                "latencyP50Ms":n,"latencyP99Ms":n,"evicted":n,"waiting":n,"timedOut":n,"connectFailures":n,"failureReasons":{"<reason>":n,...},
+  *                "dnsAnswered":n,"dnsEmpty":n,"dnsDropped":n,"storage":[["<backend>",reads,hits,writes,erases,failures,readUs,writeUs],...],
+  *                "spans":[["<name>",startUs,us],...]}
+  * @pre-cond.  : ma_api_wifi_stream_begin() was called with the client that receives the response
+  * @post-cond. : The HTTP response is in the stream, ma_api_wifi_stream_end() must be called
+  * @parameters : io_stream: The stream of the client to which the response will be sent
+  * @retval     : None
+  */
+void ma_api_wifi_send_metrics_json(st_wifi_stream_t *io_stream) 
+{
+    st_wifi_trace_span_t spans[DF_TRACE_SPAN_COUNT];
+    uint8_t count = ma_api_wifi_trace_get_spans(spans, DF_TRACE_SPAN_COUNT);
+
+    ma_api_wifi_send_json_headers(io_stream);
+    ma_api_wifi_stream_printf(io_stream, 
+                              "{\"uptimeUs\":%lu,\"heapFree\":%u,\"heapLowWater\":%u,\"requests\":%lu,\"connections\":%lu,"
+                              "\"bytesReceived\":%lu,\"bytesSent\":%lu,\"latencyP50Ms\":%lu,\"latencyP99Ms\":%lu,"
+                              "\"evicted\":%lu,\"waiting\":%lu,\"timedOut\":%lu,\"connectFailures\":%lu,\"failureReasons\":{",
+                              (unsigned long)micros(), (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(),
+                              (unsigned long)stTraceCounters.requestsServed, (unsigned long)stTraceCounters.connectionsAccepted,
+                              (unsigned long)stTraceCounters.bytesReceived, (unsigned long)stTraceCounters.bytesSent,
+                              (unsigned long)ma_api_wifi_trace_latency_percentile(50),
+                              (unsigned long)ma_api_wifi_trace_latency_percentile(99), (unsigned long)stTraceCounters.connectionsEvicted,
+                              (unsigned long)stTraceCounters.connectionsWaiting, (unsigned long)stTraceCounters.connectionsTimedOut,
+                              (unsigned long)stTraceCounters.connectFailures);
+    for (uint8_t i = 0; i < DF_TRACE_REASON_SLOTS && stTraceCounters.failureReasons[i].count > 0; i++) 
+    {
+        ma_api_wifi_stream_printf(io_stream, "%s\"%u\":%u", (i == 0) ? "" : ",", 
+                                  stTraceCounters.failureReasons[i].reason, stTraceCounters.failureReasons[i].count);
+    }
+    st_wifi_dns_stats_t dnsStats = ma_api_wifi_dns_get_stats();
+    ma_api_wifi_stream_printf(io_stream, "},\"dnsAnswered\":%lu,\"dnsEmpty\":%lu,\"dnsDropped\":%lu,\"storage\":[",
+                              (unsigned long)dnsStats.answered, (unsigned long)dnsStats.empty, (unsigned long)dnsStats.dropped);
+    // [name, reads, hits, writes, erases, failures, readUs, writeUs] per backend, the cheapest first
+    st_wifi_storage_stats_t storageStats;
+    bool first = true;
+    for (uint8_t i = 0; i < DF_STORAGE_MAX_BACKENDS; i++) 
+    {
+        if (ma_api_wifi_storage_get_stats(i, &storageStats) == 0) 
+        {
+            ma_api_wifi_stream_printf(io_stream, "%s[\"%s\",%lu,%lu,%lu,%lu,%lu,%lu,%lu]", first ? "" : ",", storageStats.name, 
+                                      (unsigned long)storageStats.reads, (unsigned long)storageStats.hits, 
+                                      (unsigned long)storageStats.writes, (unsigned long)storageStats.erases, 
+                                      (unsigned long)storageStats.failures, (unsigned long)storageStats.readUs, 
+                                      (unsigned long)storageStats.writeUs);
+            first = false;
+        }
+    }
+    ma_api_wifi_stream_print(io_stream, "],\"spans\":[");
+    for (uint8_t i = 0; i < count; i++) 
+    {
+        ma_api_wifi_stream_printf(io_stream, "%s[\"%s\",%lu,%lu]", (i == 0) ? "" : ",", spans[i].name, 
+                                  (unsigned long)spans[i].startUs, (unsigned long)spans[i].durationUs);
+    }
+    ma_api_wifi_stream_print(io_stream, "]}");
+}
+#endif
+
+/**
+  * @Func       : ma_api_wifi_send_json_headers
+  * @brief      : Writes the headers of a JSON response and starts its body. The length is not known yet,
+  *               the stream adds Content-Length or chunked framing when the body ends.
+  * @pre-cond.  : ma_api_wifi_stream_begin() was called with the client that receives the response
+  * @post-cond. : The body can be written
+  * @parameters : io_stream: The stream
+  * @retval     : None
+  */
+void ma_api_wifi_send_json_headers(st_wifi_stream_t *io_stream) 
+{
+    ma_api_wifi_stream_printf(io_stream,
+                              "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Cache-Control: no-store\r\n"
+                              "Connection: %s\r\n",
+                              ma_api_wifi_connection_header());
+    ma_api_wifi_stream_start_body(io_stream);
+}
+
+/**
+  * @Func       : ma_api_wifi_connection_header
+  * @brief      : Value of the Connection header of the response being written
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : "keep-alive" when ma_api_wifi_portal_respond() keeps the connection, "close" otherwise
+  */
+const char *ma_api_wifi_connection_header(void) 
+{
+    return bPortalKeepAlive ? "keep-alive" : "close";
+}
+
+/**
+  * @Func       : ma_api_wifi_send_json_string
+  * @brief      : Writes a text as a quoted and escaped JSON string
+  * @pre-cond.  : ma_api_wifi_stream_begin() must be called before using this function
+  * @post-cond. : The string is in the stream
+  * @parameters : 
+  *       - io_stream: The stream
+  *       - in_text: Null terminated text
+  * @retval     : None
+  */
+void ma_api_wifi_send_json_string(st_wifi_stream_t *io_stream, const char *in_text) 
+{
+    const char *run = in_text;
+
+    ma_api_wifi_stream_print(io_stream, "\"");
+    for (const char *c = in_text; *c != '\0'; c++) 
+    {
+        if (*c != '"' && *c != '\\' && (uint8_t)*c >= 0x20) 
+        {
+            continue;
+        }
+
+        // Plain characters are written in runs, only the escaped ones one by one
+        ma_api_wifi_stream_write(io_stream, (const uint8_t *)run, c - run);
+        if (*c == '"' || *c == '\\') 
+        {
+            ma_api_wifi_stream_printf(io_stream, "\\%c", *c);
+        } 
+        else 
+        {
+            ma_api_wifi_stream_printf(io_stream, "\\u%04x", (uint8_t)*c);
+        }
+        run = c + 1;
+    }
+    ma_api_wifi_stream_print(io_stream, run);
+    ma_api_wifi_stream_print(io_stream, "\"");
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_poll
+  * @brief      : Serves the portal clients without blocking. Each call accepts at most one new
+  *               connection and does a bounded amount of work on every open connection. Returns at once
+  *               when the portal is not active, so it can be called from loop() all the time.
+  * @pre-cond.  : None
+  * @post-cond. : Pending requests progress; complete requests are answered and closed
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_portal_poll(void) 
+{
+    API_LOCK();
+    TRACE_POLL_SPAN();
+    if (!bPortalActive) 
+    {
+        return;
+    }
+
+    if (eApplyState == eWIFI_APPLY_SUCCEEDED && millis() - ulApplyDoneMs > DF_APPLY_AP_LINGER_MS) 
+    {
+        ma_api_wifi_portal_stop();
+        return;
+    }
+
+    if (stWifiBuildConfig.dns) 
+    {
+        ma_api_wifi_dns_poll();
+    }
+    if (stWifiBuildConfig.scan) 
+    {
+        ma_api_wifi_portal_scan_poll();
+    }
+    ma_api_wifi_portal_accept();
+
+    for (uint8_t i = 0; i < DF_PORTAL_MAX_CONNECTIONS; i++) 
+    {
+        st_wifi_portal_connection_t *connection = &stPortalConnections[i];
+
+        switch (connection->state) 
+        {
+            case eWIFI_PORTAL_CONN_READING:
+                ma_api_wifi_portal_read(connection);
+                break;
+
+            case eWIFI_PORTAL_CONN_RESPONDING:
+                ma_api_wifi_portal_respond(connection);
+                ma_api_wifi_push_event(eWIFI_EVENT_PORTAL_CLIENT_SERVED, i);
+                break;
+
+            case eWIFI_PORTAL_CONN_CLOSING:
+                ma_api_wifi_portal_close(connection);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_scan_poll
+  * @brief      : Runs the background scan of the portal. A scan is started when one was asked for and the
+  *               station is idle, connected or failed, since a scan would disturb a connection in progress.
+  *               The AP stays up; it leaves its channel for a few ms per channel scanned.
+  * @pre-cond.  : Portal active
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_portal_scan_poll(void) 
+{
+    if (stScanCache.scanning) 
+    {
+        // The scan of the profiles is collected by ma_api_wifi_station_poll()
+        if (eStationState != eWIFI_STATION_SCANNING) 
+        {
+            int16_t networkCount = WiFi.scanComplete();
+            if (networkCount != WIFI_SCAN_RUNNING) 
+            {
+                ma_api_wifi_scan_collect(networkCount);
+            }
+        }
+        return;
+    }
+
+    if (!bPortalScanWanted || eApplyState == eWIFI_APPLY_TESTING || 
+        (eStationState != eWIFI_STATION_IDLE && eStationState != eWIFI_STATION_CONNECTED && 
+         eStationState != eWIFI_STATION_FAILED)) 
+    {
+        return;
+    }
+
+    bPortalScanWanted = false;
+    if ((WiFi.getMode() & WIFI_STA) == 0) 
+    {
+        WiFi.mode(WIFI_AP_STA);   // The scan runs on the station interface
+    }
+    WiFi.scanDelete();
+    ma_api_wifi_scan_begin(&stScanCache, millis());
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) 
+    {
+        ma_api_wifi_scan_abort(&stScanCache);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_scan_collect
+  * @brief      : Moves the results of the driver to the scan cache and frees them
+  * @pre-cond.  : The scan started with ma_api_wifi_scan_begin() has ended
+  * @post-cond. : Scan cache updated, or kept as it was if the scan failed
+  * @parameters : in_networkCount: Value of WiFi.scanComplete(), negative if the scan failed
+  * @retval     : None
+  */
+void ma_api_wifi_scan_collect(int16_t in_networkCount) 
+{
+    if (in_networkCount < 0) 
+    {
+        ma_api_wifi_scan_abort(&stScanCache);
+        WiFi.scanDelete();
+        return;
+    }
+
+    ma_api_wifi_scan_done(&stScanCache, millis());
+    for (int16_t i = 0; i < in_networkCount; i++) 
+    {
+        const wifi_ap_record_t *record = (const wifi_ap_record_t *)WiFi.getScanInfoByIndex(i);
+        if (record != NULL) 
+        {
+            ma_api_wifi_scan_add(&stScanCache, (const char *)record->ssid, strnlen((const char *)record->ssid, sizeof(record->ssid)), 
+                                 record->rssi, record->authmode != WIFI_AUTH_OPEN);
+        }
+    }
+    WiFi.scanDelete();
+    PRINTF("Scan found %d networks, %u kept\n", in_networkCount, stScanCache.count);
+    TRACE_RECORD_MS("wifi_scan", stScanCache.startMs);
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_set_timeout
+  * @brief      : Sets the time a portal connection may stay idle before it is dropped
+  * @pre-cond.  : None
+  * @post-cond. : New value is used by the next ma_api_wifi_portal_poll()
+  * @parameters : in_timeToWaitSeconds: Idle time in seconds
+  * @retval     : None
+  */
+void ma_api_wifi_portal_set_timeout(uint16_t in_timeToWaitSeconds) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    ulPortalTimeoutMs = (unsigned long)in_timeToWaitSeconds * DF_MILIS_TO_SECONDS_FACTOR;
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_set_hot_apply
+  * @brief      : Chooses what happens when a network is saved on the portal:
+  *                 - enabled (default): the network is tested in AP + Station mode and saved only if it 
+  *                   connects. The portal stays up and reports the result on /status.json.
+  *                 - disabled: the network is saved and the device restarts, as in older versions.
+  *               provisionToOnlineMs of ma_api_wifi_get_connect_stats() measures both paths.
+  * @pre-cond.  : None
+  * @post-cond. : Used by the next save
+  * @parameters : in_enable: true for hot apply
+  * @retval     : None
+  */
+void ma_api_wifi_portal_set_hot_apply(bool in_enable) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    bPortalHotApply = in_enable;
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_is_active
+  * @brief      : Tells if the portal is running, started at boot or by the link monitor
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : true while the AP and the web server are up
+  */
+bool ma_api_wifi_portal_is_active(void) 
+{
+    API_LOCK();
+    TRACE_POLL_SPAN();
+    return bPortalActive;
+}
+
+/**
+  * @Func       : ma_api_wifi_link_monitor_set_timeout
+  * @brief      : Sets how long the link of a connected station may stay down before the portal is started
+  *               in AP + Station mode. The driver keeps reconnecting meanwhile, and the portal stops when
+  *               the link is back. ma_api_wifi_station_poll() and ma_api_wifi_portal_poll() must be called
+  *               from loop().
+  * @pre-cond.  : None
+  * @post-cond. : Used from the next poll
+  * @parameters : in_timeoutSeconds: Time in seconds, 0 disables the fallback
+  * @retval     : None
+  */
+void ma_api_wifi_link_monitor_set_timeout(uint16_t in_timeoutSeconds) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    ulLinkTimeoutMs = (unsigned long)in_timeoutSeconds * DF_MILIS_TO_SECONDS_FACTOR;
+}
+
+/**
+  * @Func       : ma_api_wifi_manager_start
+  * @brief      : Runs the provisioning and the connection in a background task, so setup() and loop() never
+  *               block. With a saved network it joins the best one in range, otherwise, or if none connects,
+  *               it starts the portal.
+  *               The task then calls ma_api_wifi_station_poll() and ma_api_wifi_portal_poll(), and the 
+  *               application follows what happens with ma_api_wifi_get_event().
+  * @pre-cond.  : The task is not running.
+  * @post-cond. : Task running. The other functions of the Api can still be called, from any core.
+  * @parameters : in_config: Stack, priority, core and poll period, NULL for DF_WIFI_TASK_CONFIG_DEFAULT
+  * @retval     : 0 on success, -1 if the task could not be created
+  */
+int8_t ma_api_wifi_manager_start(const st_wifi_task_config_t *in_config) 
+{
+    {
+        API_LOCK();
+        TRACE_SPAN();
+        st_wifi_credential_t credentials;
+
+        if (ma_api_wifi_read_network_credentials(&credentials) == 0) 
+        {
+            ma_api_wifi_connect_profiles_async(NULL, ma_api_wifi_manager_on_result);
+        } 
+        else 
+        {
+            ma_api_wifi_setup_access_point(credentials);
+        }
+    }
+    // Outside the lock: the task takes it on its first step
+    return ma_api_wifi_task_start(in_config, ma_api_wifi_manager_step);
+}
+
+/**
+  * @Func       : ma_api_wifi_manager_stop
+  * @brief      : Stops the background task. The connection and the portal stay as they are, and can be 
+  *               polled from loop() again.
+  * @pre-cond.  : Not called from a connection callback
+  * @post-cond. : Task deleted
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_manager_stop(void) 
+{
+    ma_api_wifi_task_stop();
+}
+
+/**
+  * @Func       : ma_api_wifi_get_event
+  * @brief      : Takes the oldest event of the Api: connected, connection failed, link lost, credentials 
+  *               saved or portal client served. It does not lock, so it never waits for the background task.
+  * @pre-cond.  : Always called from the same task, usually loop()
+  * @post-cond. : None
+  * @parameters : out_event: Receives the event
+  * @retval     : true if an event was taken, false if there is none
+  */
+bool ma_api_wifi_get_event(st_wifi_event_t *out_event) 
+{
+    return ma_api_wifi_events_pop(&stEventQueue, out_event);
+}
+
+/**
+  * @Func       : ma_api_wifi_print_trace
+  * @brief      : Prints the counters and the timeline of the trace, e.g. on eWIFI_EVENT_CONNECTED. The trace is
+  *               copied under the lock and printed without it, so a slow output does not hold off the task.
+  *               Does nothing unless TRACE_ENABLE is defined.
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : out_output: Where to print, e.g. &Serial
+  * @retval     : None
+  */
+void ma_api_wifi_print_trace(Print *out_output) 
+{
+#ifdef TRACE_ENABLE
+    st_wifi_trace_snapshot_t snapshot;
+    {
+        API_LOCK();
+        ma_api_wifi_trace_snapshot(&snapshot);
+    }
+    ma_api_wifi_trace_print(out_output, &snapshot);
+#else
+    (void)out_output;
+#endif
+}
+
+/**
+  * @Func       : ma_api_wifi_manager_step
+  * @brief      : One step of the background task
+  * @pre-cond.  : Called by the task of ma_api_wifi_manager_start()
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_manager_step(void) 
+{
+    ma_api_wifi_station_poll();
+    ma_api_wifi_portal_poll();
+}
+
+/**
+  * @Func       : ma_api_wifi_manager_on_result
+  * @brief      : Starts the portal when no saved network connected at start-up
+  * @pre-cond.  : Called by ma_api_wifi_station_finish()
+  * @post-cond. : Portal active on failure
+  * @parameters : in_result: Result of the connection
+  * @retval     : None
+  */
+void ma_api_wifi_manager_on_result(e_wifi_connect_result_t in_result) 
+{
+    if (in_result != eWIFI_CONNECT_RESULT_CONNECTED && !bPortalActive) 
+    {
+        ma_api_wifi_read_network_credentials(&stWifiStationCredential);
+        ma_api_wifi_portal_start_ap(WIFI_AP);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_push_event
+  * @brief      : Queues an event for ma_api_wifi_get_event(). It is dropped if the application does not
+  *               read the queue.
+  * @pre-cond.  : clsApiMutex held, which makes the callers a single producer
+  * @post-cond. : None
+  * @parameters : 
+  *       - in_type: Event
+  *       - in_detail: See e_wifi_event_type_t
+  * @retval     : None
+  */
+void ma_api_wifi_push_event(e_wifi_event_type_t in_type, uint8_t in_detail) 
+{
+    ma_api_wifi_events_push(&stEventQueue, (uint8_t)in_type, in_detail, millis());
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_accept
+  * @brief      : Takes one pending client from the server and stores it in a free slot. When the table is
+  *               full, the reading connection idle for longest is closed if it has been idle for at least
+  *               DF_PORTAL_EVICT_IDLE_MS, so stalled clients cannot lock out the others. Otherwise the
+  *               client is left in the backlog of the server until a slot is freed: closing it would
+  *               lose its request.
+  * @pre-cond.  : The server must be started
+  * @post-cond. : The new client is in eWIFI_PORTAL_CONN_READING state, or still pending if every
+  *               connection is busy
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_portal_accept(void) 
+{
+    if (!clsWifiServer.hasClient()) 
+    {
+        return;
+    }
+
+    unsigned long nowMs = millis();
+    st_wifi_portal_connection_t *slot = NULL;
+    st_wifi_portal_connection_t *idlest = NULL;
+    for (uint8_t i = 0; i < DF_PORTAL_MAX_CONNECTIONS && slot == NULL; i++) 
+    {
+        st_wifi_portal_connection_t *connection = &stPortalConnections[i];
+        if (connection->state == eWIFI_PORTAL_CONN_FREE) 
+        {
+            slot = connection;
+        } 
+        else if (connection->state == eWIFI_PORTAL_CONN_READING && 
+                 (idlest == NULL || nowMs - connection->lastActivityMs > nowMs - idlest->lastActivityMs)) 
+        {
+            idlest = connection;
+        }
+    }
+
+    if (slot == NULL && idlest != NULL && nowMs - idlest->lastActivityMs >= DF_PORTAL_EVICT_IDLE_MS) 
+    {
+        PRINTF("Portal connection table full, evicting an idle client.\n");
+        TRACE_COUNT(connectionsEvicted, 1);
+        ma_api_wifi_portal_close(idlest);
+        slot = idlest;
+    }
+    if (slot == NULL) 
+    {
+        TRACE_COUNT(connectionsWaiting, 1);
+        return;
+    }
+
+    WiFiClient client = clsWifiServer.available();
+    if (!client) 
+    {
+        return;
+    }
+
+    TRACE_COUNT(connectionsAccepted, 1);
+    slot->client = client;
+    slot->state = eWIFI_PORTAL_CONN_READING;
+    slot->lastActivityMs = nowMs;
+    slot->requestStartMs = nowMs;
+    slot->requestCount = 0;
+    ma_api_wifi_http_reset(&slot->request);
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_read
+  * @brief      : Reads up to DF_PORTAL_READ_BUDGET_BYTES of the HTTP request of one connection straight
+  *               into its receive buffer and runs the incremental parser on the new bytes
+  * @pre-cond.  : Connection in eWIFI_PORTAL_CONN_READING state
+  * @post-cond. : Connection moves to eWIFI_PORTAL_CONN_RESPONDING when the request is complete,
+  *               or to eWIFI_PORTAL_CONN_CLOSING on error, disconnection or timeout. The request times out
+  *               when the client is idle for the portal timeout, or when it is not complete after
+  *               DF_PORTAL_REQUEST_TIMEOUT_MS even if bytes keep arriving. A kept connection with nothing
+  *               received is closed without a response after DF_PORTAL_KEEP_ALIVE_TIMEOUT_MS.
+  * @parameters : in_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_portal_read(st_wifi_portal_connection_t *in_connection) 
+{
+    if (!in_connection->client.connected()) 
+    {
+        in_connection->state = eWIFI_PORTAL_CONN_CLOSING;
+        return;
+    }
+
+    int available = in_connection->client.available();
+    if (available > 0) 
+    {
+        uint16_t space;
+        char *rxBuffer = ma_api_wifi_http_get_rx_buffer(&in_connection->request, &space);
+        uint16_t toRead = (available < DF_PORTAL_READ_BUDGET_BYTES) ? available : DF_PORTAL_READ_BUDGET_BYTES;
+        if (toRead > space) 
+        {
+            toRead = space;
+        }
+
+        int received = in_connection->client.read((uint8_t *)rxBuffer, toRead);
+        if (received > 0) 
+        {
+            TRACE_COUNT(bytesReceived, received);
+            in_connection->lastActivityMs = millis();
+            if (in_connection->requestCount > 0 && in_connection->request.length == 0) 
+            {
+                in_connection->requestStartMs = in_connection->lastActivityMs;
+            }
+            ma_api_wifi_portal_parsed(in_connection, ma_api_wifi_http_parse(&in_connection->request, (uint16_t)received));
+            if (in_connection->state != eWIFI_PORTAL_CONN_READING) 
+            {
+                return;
+            }
+        }
+    }
+
+    unsigned long nowMs = millis();
+    if (in_connection->requestCount > 0 && in_connection->request.length == 0) 
+    {
+        if (nowMs - in_connection->lastActivityMs > DF_PORTAL_KEEP_ALIVE_TIMEOUT_MS) 
+        {
+            in_connection->state = eWIFI_PORTAL_CONN_CLOSING;
+        }
+        return;
+    }
+    if (nowMs - in_connection->lastActivityMs > ulPortalTimeoutMs || 
+        nowMs - in_connection->requestStartMs > DF_PORTAL_REQUEST_TIMEOUT_MS) 
+    {
+        PRINTF("Portal client timeout.\n");
+        TRACE_COUNT(connectionsTimedOut, 1);
+        ma_api_wifi_send_http_status(in_connection->client, "408 Request Timeout");
+        in_connection->state = eWIFI_PORTAL_CONN_CLOSING;
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_parsed
+  * @brief      : Moves the connection on from the result of the parser
+  * @pre-cond.  : Connection in eWIFI_PORTAL_CONN_READING state
+  * @post-cond. : eWIFI_PORTAL_CONN_RESPONDING when the request is complete, eWIFI_PORTAL_CONN_CLOSING
+  *               after a 400, 413 or 501, unchanged while the request is incomplete
+  * @parameters : 
+  *       - io_connection: The connection
+  *       - in_result: Result of ma_api_wifi_http_parse() or ma_api_wifi_http_next()
+  * @retval     : None
+  */
+void ma_api_wifi_portal_parsed(st_wifi_portal_connection_t *io_connection, e_wifi_http_parse_result_t in_result) 
+{
+    switch (in_result) 
+    {
+        case eWIFI_HTTP_PARSE_DONE:
+            io_connection->state = eWIFI_PORTAL_CONN_RESPONDING;
+            break;
+
+        case eWIFI_HTTP_PARSE_BAD_REQUEST:
+            ma_api_wifi_send_http_status(io_connection->client, "400 Bad Request");
+            io_connection->state = eWIFI_PORTAL_CONN_CLOSING;
+            break;
+
+        case eWIFI_HTTP_PARSE_TOO_LARGE:
+            ma_api_wifi_send_http_status(io_connection->client, "413 Content Too Large");
+            io_connection->state = eWIFI_PORTAL_CONN_CLOSING;
+            break;
+
+        case eWIFI_HTTP_PARSE_NOT_IMPLEMENTED:
+            ma_api_wifi_send_http_status(io_connection->client, "501 Not Implemented");
+            io_connection->state = eWIFI_PORTAL_CONN_CLOSING;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_respond
+  * @brief      : Looks up the path in stPortalRoutes and calls its handler. A path not in the table, or
+  *               whose feature is not built, gets 404 without reading the query or the body.
+  *               The connection is kept for the next request when the client allows it (HTTP/1.1 or
+  *               "Connection: keep-alive") and it answered less than DF_PORTAL_MAX_REQUESTS. Requests that
+  *               arrived with this one (pipelining) are already parsed, the next one is answered on the
+  *               next poll, after the other connections had their turn.
+  * @pre-cond.  : Connection in eWIFI_PORTAL_CONN_RESPONDING state
+  * @post-cond. : Connection moves to eWIFI_PORTAL_CONN_READING, or to eWIFI_PORTAL_CONN_RESPONDING when the
+  *               next request is already complete, or to eWIFI_PORTAL_CONN_CLOSING. The device restarts
+  *               if a new network was saved through /save_data with hot apply disabled
+  * @parameters : in_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_portal_respond(st_wifi_portal_connection_t *in_connection) 
+{
+    TRACE_SPAN();
+    ma_api_wifi_route_handler_t handler = ma_api_wifi_portal_find_route(&in_connection->request);
+
+    in_connection->requestCount++;
+    bPortalKeepAlive = in_connection->request.keepAlive && in_connection->requestCount < DF_PORTAL_MAX_REQUESTS;
+    TRACE_COUNT(requestsServed, 1);
+    if (handler == NULL) 
+    {
+        ma_api_wifi_send_http_status(in_connection->client, "404 Not Found");
+    } 
+    else 
+    {
+        handler(in_connection);
+    }
+    TRACE_REQUEST_LATENCY(millis() - in_connection->requestStartMs);
+
+    bool keepAlive = bPortalKeepAlive;
+    bPortalKeepAlive = false;
+    if (!keepAlive) 
+    {
+        in_connection->state = eWIFI_PORTAL_CONN_CLOSING;
+        return;
+    }
+
+    in_connection->state = eWIFI_PORTAL_CONN_READING;
+    in_connection->lastActivityMs = millis();
+    in_connection->requestStartMs = in_connection->lastActivityMs;
+    ma_api_wifi_portal_parsed(in_connection, ma_api_wifi_http_next(&in_connection->request));
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_find_route
+  * @brief      : Finds the handler of the request path. The lengths are compared first, so most entries
+  *               are skipped without touching the request buffer.
+  * @pre-cond.  : Request parsed
+  * @post-cond. : None
+  * @parameters : in_request: The request
+  * @retval     : The handler, NULL if the path is unknown or its feature is not built
+  */
+ma_api_wifi_route_handler_t ma_api_wifi_portal_find_route(const st_wifi_http_request_t *in_request) 
+{
+    const char *path = &in_request->buffer[in_request->path.offset];
+
+    for (size_t i = 0; i < sizeof(stPortalRoutes) / sizeof(stPortalRoutes[0]); i++) 
+    {
+        const st_wifi_portal_route_t *route = &stPortalRoutes[i];
+        if (route->pathLength == in_request->path.length && memcmp(route->path, path, route->pathLength) == 0) 
+        {
+            return route->handler;
+        }
+    }
+    return NULL;
+}
+
+/**
+  * @Func       : ma_api_wifi_route_page
+  * @brief      : Route /, the portal page
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_page(st_wifi_portal_connection_t *io_connection) 
+{
+    ma_api_wifi_stream_begin(&stPortalStream, &io_connection->client);
+    ma_api_wifi_send_http_response(&stPortalStream, &io_connection->request);
+    ma_api_wifi_stream_end(&stPortalStream);
+}
+
+/**
+  * @Func       : ma_api_wifi_route_save_data
+  * @brief      : Route /save_data?ssid=..&password=.., also as a form body. Answers with the portal page, then
+  *               tests the network received and saves it if it connects, or saves it and restarts when hot
+  *               apply is disabled. An empty password keeps the one saved for the SSID. A new network sent
+  *               while the previous one is being tested gets 409 instead of the page: /status.json still
+  *               reports the previous test, so the browser must send it again once that one is over. With
+  *               hot apply disabled, a network that could not be saved gets 500 and the device stays in the
+  *               portal. A field too long for its buffer gets 400.
+  * @pre-cond.  : None
+  * @post-cond. : Response sent. The device restarts if a new network was saved with hot apply disabled
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_save_data(st_wifi_portal_connection_t *io_connection) 
+{
+    char newSsid[DF_WIFI_SSID_BUFFER_SIZE];
+    char newPassword[DF_WIFI_PASSWORD_BUFFER_SIZE];
+    char newPriority[DF_WIFI_PRIORITY_BUFFER_SIZE];
+
+    if (ma_api_wifi_get_token(&io_connection->request, newSsid, newPassword, newPriority) != 0) 
+    {
+        ma_api_wifi_send_http_status(io_connection->client, "400 Bad Request");
+        return;
+    }
+    ma_api_wifi_keep_saved_password(newSsid, newPassword);
+    bool changed = strlen(newSsid) >= 5 && strlen(newPassword) >= 5 && 
+                   (strcmp(stWifiStationCredential.ssid, newSsid) != 0 || strcmp(stWifiStationCredential.psk, newPassword) != 0);
+
+    if (changed && bPortalHotApply && eApplyState == eWIFI_APPLY_TESTING) 
+    {
+        ma_api_wifi_send_http_status(io_connection->client, "409 Conflict");
+        return;
+    }
+    if (changed && !bPortalHotApply && ma_api_wifi_profile_add(newSsid, newPassword, DF_WIFI_PROFILE_DEFAULT_PRIORITY) != 0) 
+    {
+        ma_api_wifi_send_http_status(io_connection->client, "500 Internal Server Error");
+        return;
+    }
+    ma_api_wifi_route_page(io_connection);
+
+    if (!changed) 
+    {
+        return;
+    }
+    if (bPortalHotApply) 
+    {
+        ma_api_wifi_apply_start(newSsid, newPassword, io_connection->requestStartMs);
+        return;
+    }
+    u32RtcProvisionMs = millis() - io_connection->requestStartMs;
+    u32RtcProvisionMagic = DF_PROVISION_RTC_MAGIC;
+    io_connection->client.stop();
+    esp_restart(); //Force reboot
+}
+
+/**
+  * @Func       : ma_api_wifi_route_credentials
+  * @brief      : Route /credentials.json, the preferred saved network
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_credentials(st_wifi_portal_connection_t *io_connection) 
+{
+    ma_api_wifi_stream_begin(&stPortalStream, &io_connection->client);
+    ma_api_wifi_send_credentials_json(&stPortalStream);
+    ma_api_wifi_stream_end(&stPortalStream);
+}
+
+/**
+  * @Func       : ma_api_wifi_route_status
+  * @brief      : Route /status.json, WiFi mode, station state and result of the last hot apply
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_status(st_wifi_portal_connection_t *io_connection) 
+{
+    ma_api_wifi_stream_begin(&stPortalStream, &io_connection->client);
+    ma_api_wifi_send_status_json(&stPortalStream);
+    ma_api_wifi_stream_end(&stPortalStream);
+}
+
+/**
+  * @Func       : ma_api_wifi_route_scan
+  * @brief      : Route /scan.json, the networks around from the cache. A stale cache is refreshed in the
+  *               background, the response never waits for the scan.
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_scan(st_wifi_portal_connection_t *io_connection) 
+{
+    if (ma_api_wifi_scan_is_stale(&stScanCache, millis(), DF_PORTAL_SCAN_TTL_MS)) 
+    {
+        bPortalScanWanted = true;
+    }
+    ma_api_wifi_stream_begin(&stPortalStream, &io_connection->client);
+    ma_api_wifi_send_scan_json(&stPortalStream);
+    ma_api_wifi_stream_end(&stPortalStream);
+}
+
+/**
+  * @Func       : ma_api_wifi_route_profiles
+  * @brief      : Route /profiles.json, the list of saved networks
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_profiles(st_wifi_portal_connection_t *io_connection) 
+{
+    ma_api_wifi_stream_begin(&stPortalStream, &io_connection->client);
+    ma_api_wifi_send_profiles_json(&stPortalStream);
+    ma_api_wifi_stream_end(&stPortalStream);
+}
+
+/**
+  * @Func       : ma_api_wifi_route_profile_add
+  * @brief      : Route /profile_add?ssid=..&password=..&priority=.., adds or updates a saved network. An empty
+  *               password keeps the one saved for the SSID, so the priority can be changed alone. A priority
+  *               other than 0 to 255 is refused with 400, nothing is saved.
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_profile_add(st_wifi_portal_connection_t *io_connection) 
+{
+    char newSsid[DF_WIFI_SSID_BUFFER_SIZE];
+    char newPassword[DF_WIFI_PASSWORD_BUFFER_SIZE];
+    char newPriority[DF_WIFI_PRIORITY_BUFFER_SIZE];
+    uint8_t priority;
+
+    bool received = ma_api_wifi_get_token(&io_connection->request, newSsid, newPassword, newPriority) == 0;
+    ma_api_wifi_keep_saved_password(newSsid, newPassword);
+    bool added = received && ma_api_wifi_parse_priority(&io_connection->request, newPriority, &priority) == 0 &&
+                 strlen(newSsid) >= 5 && strlen(newPassword) >= 5 && 
+                 ma_api_wifi_profile_add(newSsid, newPassword, priority) == 0;
+    ma_api_wifi_send_http_status(io_connection->client, added ? "204 No Content" : "400 Bad Request");
+}
+
+/**
+  * @Func       : ma_api_wifi_parse_priority
+  * @brief      : Reads the priority field of a request. The page limits it to 0..255, the portal checks it
+  *               again: a sign, a non-digit or a value above 255 is refused.
+  * @pre-cond.  : None
+  * @post-cond. : out_priority is set when 0 is returned
+  * @parameters : 
+  *       - in_request: The parsed request, to tell an empty field from one too long for its buffer
+  *       - in_text: Priority received, DF_WIFI_PRIORITY_BUFFER_SIZE bytes, empty if none
+  *       - out_priority: The priority, DF_WIFI_PROFILE_DEFAULT_PRIORITY if the field is absent or empty
+  * @retval     : 0 on success, -1 if the priority is not a number from 0 to 255
+  */
+int8_t ma_api_wifi_parse_priority(const st_wifi_http_request_t *in_request, const char *in_text, uint8_t *out_priority) 
+{
+    char *end;
+
+    if (in_text[0] == '\0') 
+    {
+        *out_priority = DF_WIFI_PROFILE_DEFAULT_PRIORITY;
+        return ma_api_wifi_http_has_value(in_request, "priority") ? -1 : 0;
+    }
+    // strtoul() would skip spaces and take a sign, "-1" becoming ULONG_MAX
+    if (in_text[0] < '0' || in_text[0] > '9') 
+    {
+        return -1;
+    }
+    unsigned long value = strtoul(in_text, &end, 10);
+    if (*end != '\0' || value > UINT8_MAX) 
+    {
+        return -1;
+    }
+    *out_priority = (uint8_t)value;
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_keep_saved_password
+  * @brief      : Puts the saved password of a network in an empty password field. The portal never sends
+  *               the password to the page, so an empty field means "keep the saved one".
+  * @pre-cond.  : None
+  * @post-cond. : io_password unchanged if it is not empty or the SSID is not saved
+  * @parameters : 
+  *       - in_ssid: SSID received, null terminated
+  *       - io_password: Password received, DF_WIFI_PASSWORD_BUFFER_SIZE bytes
+  * @retval     : None
+  */
+void ma_api_wifi_keep_saved_password(const char *in_ssid, char *io_password) 
+{
+    if (io_password[0] != '\0' || in_ssid[0] == '\0') 
+    {
+        return;
+    }
+    if (strcmp(in_ssid, stWifiStationCredential.ssid) == 0) 
+    {
+        memcpy(io_password, stWifiStationCredential.psk, stWifiStationCredential.pskLength + 1);
+        return;
+    }
+    if (ma_api_wifi_profiles_load() == 0) 
+    {
+        int8_t index = ma_api_wifi_profiles_find(&stProfileStore, in_ssid, strlen(in_ssid));
+        if (index >= 0) 
+        {
+            const st_wifi_profile_t *profile = &stProfileStore.profiles[index];
+            memcpy(io_password, profile->password, profile->passwordLength);
+            io_password[profile->passwordLength] = '\0';
+        }
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_route_profile_delete
+  * @brief      : Route /profile_delete?ssid=.., removes a saved network. An SSID too long for its buffer gets 400.
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_profile_delete(st_wifi_portal_connection_t *io_connection) 
+{
+    char newSsid[DF_WIFI_SSID_BUFFER_SIZE];
+    char newPassword[DF_WIFI_PASSWORD_BUFFER_SIZE];
+    char newPriority[DF_WIFI_PRIORITY_BUFFER_SIZE];
+
+    if (ma_api_wifi_get_token(&io_connection->request, newSsid, newPassword, newPriority) != 0) 
+    {
+        ma_api_wifi_send_http_status(io_connection->client, "400 Bad Request");
+        return;
+    }
+    ma_api_wifi_send_http_status(io_connection->client, 
+                                 (ma_api_wifi_profile_delete(newSsid) == 0) ? "204 No Content" : "404 Not Found");
+}
+
+/**
+  * @Func       : ma_api_wifi_route_metrics
+  * @brief      : Route /metrics, counters and timeline. In the table only with DF_WIFI_FEATURE_METRICS,
+  *               which needs TRACE_ENABLE.
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_metrics(st_wifi_portal_connection_t *io_connection) 
+{
+#ifdef TRACE_ENABLE
+    ma_api_wifi_stream_begin(&stPortalStream, &io_connection->client);
+    ma_api_wifi_send_metrics_json(&stPortalStream);
+    ma_api_wifi_stream_end(&stPortalStream);
+#endif
+}
+
+/**
+  * @Func       : ma_api_wifi_route_redirect
+  * @brief      : Routes of the connectivity checks of the operating systems, redirected to the portal page.
+  *               The phone then opens its sign-in sheet as soon as it joins the AP.
+  * @pre-cond.  : None
+  * @post-cond. : Response sent
+  * @parameters : io_connection: The connection to be served
+  * @retval     : None
+  */
+void ma_api_wifi_route_redirect(st_wifi_portal_connection_t *io_connection) 
+{
+    ma_api_wifi_send_portal_redirect(io_connection->client);
+}
+
+/**
+  * @Func       : ma_api_wifi_portal_close
+  * @brief      : Stops the client and releases its slot in the connection table
+  * @pre-cond.  : None
+  * @post-cond. : Connection in eWIFI_PORTAL_CONN_FREE state
+  * @parameters : in_connection: The connection to be closed
+  * @retval     : None
+  */
+void ma_api_wifi_portal_close(st_wifi_portal_connection_t *in_connection) 
+{
+    in_connection->client.stop();
+    in_connection->state = eWIFI_PORTAL_CONN_FREE;
+}
+
+/**
+  * @Func       : ma_api_wifi_send_http_status
+  * @brief      : Sends a response without body, used for errors and for requests that only change data
+  * @pre-cond.  : The client must be connected
+  * @post-cond. : The client can be stopped
+  * @parameters : 
+  *       - in_client: The client to which the response will be sent
+  *       - in_status: Status code and reason phrase, e.g. "400 Bad Request"
+  * @retval     : None
+  */
+void ma_api_wifi_send_http_status(WiFiClient &in_client, const char *in_status) 
+{
+    ma_api_wifi_stream_begin(&stPortalStream, &in_client);
+    ma_api_wifi_stream_printf(&stPortalStream, 
+                              "HTTP/1.1 %s\r\n"
+                              "Content-Length: 0\r\n"
+                              "Connection: %s\r\n\r\n",
+                              in_status, ma_api_wifi_connection_header());
+    ma_api_wifi_stream_end(&stPortalStream);
+}
+
+/**
+  * @Func       : ma_api_wifi_send_portal_redirect
+  * @brief      : Sends a 302 to the portal page, on the AP address and port of stWifiBuildConfig
+  * @pre-cond.  : Client connected
+  * @post-cond. : Response written, the caller closes the connection
+  * @parameters : in_client: The client
+  * @retval     : None
+  */
+void ma_api_wifi_send_portal_redirect(WiFiClient &in_client) 
+{
+    const uint8_t *ip = stWifiBuildConfig.apIp;
+
+    ma_api_wifi_stream_begin(&stPortalStream, &in_client);
+    ma_api_wifi_stream_printf(&stPortalStream, "HTTP/1.1 302 Found\r\nLocation: http://%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    if (stWifiBuildConfig.httpPort != 80) 
+    {
+        ma_api_wifi_stream_printf(&stPortalStream, ":%u", (unsigned)stWifiBuildConfig.httpPort);
+    }
+    ma_api_wifi_stream_printf(&stPortalStream, 
+                              "/\r\n"
+                              "Cache-Control: no-store\r\n"
+                              "Content-Length: 0\r\n"
+                              "Connection: %s\r\n\r\n",
+                              ma_api_wifi_connection_header());
+    ma_api_wifi_stream_end(&stPortalStream);
+}
+
+/**
+  * @Func       : ma_api_wifi_get_token
+  * @brief      : Extracts SSID, password and priority from the query string and from a form body, in a 
+  *               single pass over each one. Values are percent-decoded.
+  * @pre-cond.  : The request is completely parsed
+  * @post-cond. : Values are copied to the buffers, or left empty if not found
+  * @parameters : 
+  *       - in_request: The parsed request
+  *       - out_ssid: Buffer of DF_WIFI_SSID_BUFFER_SIZE bytes to store the extracted SSID
+  *       - out_password: Buffer of DF_WIFI_PASSWORD_BUFFER_SIZE bytes to store the extracted password
+  *       - out_priority: Buffer of DF_WIFI_PRIORITY_BUFFER_SIZE bytes to store the extracted priority
+  * @retval     : 0 on success, -1 if a field was refused: too long for its buffer or with a null byte
+  */
+int8_t ma_api_wifi_get_token(const st_wifi_http_request_t *in_request, char *out_ssid, char *out_password, char *out_priority) 
+{
+    st_wifi_form_field_t fields[] = {
+        {"ssid", out_ssid, DF_WIFI_SSID_BUFFER_SIZE, -1},
+        {"password", out_password, DF_WIFI_PASSWORD_BUFFER_SIZE, -1},
+        {"priority", out_priority, DF_WIFI_PRIORITY_BUFFER_SIZE, -1}
+    };
+
+    ma_api_wifi_http_get_fields(in_request, fields, sizeof(fields) / sizeof(fields[0]));
+
+    if (fields[0].length >= 0) 
+    {
+        PRINTF("Found SSID: %s\n", out_ssid);
+    }
+    if (fields[1].length >= 0) 
+    {
+        PRINTF("Found Password: %u characters\n", (unsigned)fields[1].length);
+    }
+    for (uint8_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) 
+    {
+        if (fields[i].length == -2) 
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_update_network_credentials
+  * @brief      : Saves a network with the default priority, see ma_api_wifi_profile_add(). A saved network 
+  *               with the same SSID gets the new password.
+  * @pre-cond.  : None
+  * @post-cond. : Network saved
+  * @parameters : in_credential: The network to be saved
+  * @retval     : 0 on success, -1 if the write failed
+  */
+int8_t ma_api_wifi_update_network_credentials(const st_wifi_credential_t &in_credential) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    if (ma_api_wifi_profile_add(in_credential.ssid, in_credential.psk, DF_WIFI_PROFILE_DEFAULT_PRIORITY) != 0) 
+    {
+        PRINTF("Error saving the credentials.\n");
+        return -1;
+    }
+
+    PRINTF("New credentials saved.\n      SSID: %s Password: %u characters\n", in_credential.ssid, (unsigned)strlen(in_credential.psk));
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_read_network_credentials
+  * @brief      : Reads the preferred saved network: highest priority, then most recent success. The 
+  *               single network saved by older versions is converted to a profile on the first read.
+  * @pre-cond.  : None
+  * @post-cond. : Network credentials are read and updated in the structure
+  * @parameters : 
+  *       - out_credential: Pointer to the structure where the credentials will be stored, emptied if there
+  *                         are none
+  * @retval     : 0 on success, -1 if there are no valid credentials
+  */
+int8_t ma_api_wifi_read_network_credentials(st_wifi_credential_t *out_credential) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    int8_t best = (ma_api_wifi_profiles_load() == 0) ? ma_api_wifi_profiles_best(&stProfileStore) : -1;
+
+    memset(out_credential, 0, sizeof(*out_credential));
+    if (best < 0)
+    {
+        PRINTF("Erro ao ler as credenciais salvas.\n");
+        return -1;
+    }
+
+    const st_wifi_profile_t *profile = &stProfileStore.profiles[best];
+    out_credential->ssidLength = profile->ssidLength;
+    memcpy(out_credential->ssid, profile->ssid, profile->ssidLength);
+    out_credential->pskLength = profile->passwordLength;
+    memcpy(out_credential->psk, profile->password, profile->passwordLength);
+
+    PRINTF("Credenciais lidas e atualizadas na estrutura de credenciais.\n     SSID: %s SENHA: %u caracteres\n", 
+            out_credential->ssid, (unsigned)out_credential->pskLength);
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_credential_set
+  * @brief      : Fills a credential from two C strings
+  * @pre-cond.  : None
+  * @post-cond. : out_credential holds the network, or is empty on failure
+  * @parameters : 
+  *       - out_credential: The credential
+  *       - in_ssid: SSID, null terminated, 1 to 32 bytes
+  *       - in_psk: Passphrase or PSK in hex, null terminated, up to 64 bytes
+  * @retval     : 0 on success, -1 if a field does not fit
+  */
+int8_t ma_api_wifi_credential_set(st_wifi_credential_t *out_credential, const char *in_ssid, const char *in_psk) 
+{
+    size_t ssidLength = strnlen(in_ssid, DF_WIFI_SSID_BUFFER_SIZE);
+    size_t pskLength = strnlen(in_psk, DF_WIFI_PASSWORD_BUFFER_SIZE);
+
+    memset(out_credential, 0, sizeof(*out_credential));
+    if (ssidLength == 0 || ssidLength >= DF_WIFI_SSID_BUFFER_SIZE || pskLength >= DF_WIFI_PASSWORD_BUFFER_SIZE) 
+    {
+        return -1;
+    }
+
+    out_credential->ssidLength = (uint8_t)ssidLength;
+    memcpy(out_credential->ssid, in_ssid, ssidLength);
+    out_credential->pskLength = (uint8_t)pskLength;
+    memcpy(out_credential->psk, in_psk, pskLength);
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_profile_add
+  * @brief      : Saves a network, or updates the password and priority of a saved one. When all 
+  *               DF_WIFI_MAX_PROFILES slots are in use, the network with the lowest priority and the oldest
+  *               success is replaced.
+  * @pre-cond.  : None
+  * @post-cond. : Profiles saved, eWIFI_EVENT_CREDENTIALS_SAVED queued
+  * @parameters : 
+  *       - in_ssid: SSID, null terminated
+  *       - in_password: Password, null terminated
+  *       - in_priority: Higher is tried first, DF_WIFI_PROFILE_DEFAULT_PRIORITY if there is no preference
+  * @retval     : 0 on success, -1 if a field is too long or the write failed
+  */
+int8_t ma_api_wifi_profile_add(const char *in_ssid, const char *in_password, uint8_t in_priority) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    if (ma_api_wifi_profiles_load() != 0 || 
+        ma_api_wifi_profiles_add(&stProfileStore, in_ssid, strlen(in_ssid), in_password, strlen(in_password), in_priority) < 0 || 
+        ma_api_wifi_profiles_save() != 0) 
+    {
+        return -1;
+    }
+    ma_api_wifi_push_event(eWIFI_EVENT_CREDENTIALS_SAVED, 0);
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_profile_delete
+  * @brief      : Removes a saved network
+  * @pre-cond.  : None
+  * @post-cond. : Profiles saved
+  * @parameters : in_ssid: SSID, null terminated
+  * @retval     : 0 on success, -1 if the network is not saved or the write failed
+  */
+int8_t ma_api_wifi_profile_delete(const char *in_ssid) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    if (ma_api_wifi_profiles_load() != 0 || 
+        ma_api_wifi_profiles_delete(&stProfileStore, in_ssid, strlen(in_ssid)) != 0) 
+    {
+        return -1;
+    }
+    return ma_api_wifi_profiles_save();
+}
+
+/**
+  * @Func       : ma_api_wifi_profile_list
+  * @brief      : Lists the saved networks, without the passwords
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : 
+  *       - out_profiles: Array that receives the networks
+  *       - in_maxProfiles: Size of the array
+  * @retval     : Number of networks in out_profiles
+  */
+uint8_t ma_api_wifi_profile_list(st_wifi_profile_info_t *out_profiles, uint8_t in_maxProfiles) 
+{
+    API_LOCK();
+    TRACE_SPAN();
+    uint8_t count = 0;
+
+    if (ma_api_wifi_profiles_load() != 0) 
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < DF_WIFI_MAX_PROFILES && count < in_maxProfiles; i++) 
+    {
+        const st_wifi_profile_t *profile = &stProfileStore.profiles[i];
+        if (profile->inUse) 
+        {
+            memcpy(out_profiles[count].ssid, profile->ssid, profile->ssidLength);
+            out_profiles[count].ssid[profile->ssidLength] = '\0';
+            out_profiles[count].priority = profile->priority;
+            out_profiles[count].lastSuccess = profile->lastSuccess;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_load
+  * @brief      : Reads the saved networks once and keeps them in RAM. If there is no profile record yet, 
+  *               the single network of older versions (binary record or text file) is converted in RAM
+  *               to the first profile. Only the profile store is written, then the old record is removed;
+  *               a power loss in between leaves the old record, migrated again on the next boot. The empty
+  *               store is saved only when the storage confirms there is no old record: if one could not
+  *               be read, e.g. SPIFFS did not mount, nothing is written and the next call reads again.
+  * @pre-cond.  : None
+  * @post-cond. : stProfileStore holds the saved networks, possibly none, once 0 is returned. Until then
+  *               ma_api_wifi_profiles_save() writes nothing, so a read error never overwrites the saved networks.
+  * @parameters : None
+  * @retval     : 0 on success, -1 if the saved networks could not be read or the migrated ones saved
+  */
+int8_t ma_api_wifi_profiles_load(void) 
+{
+    st_wifi_credential_record_t record;
+
+    if (bProfileStoreLoaded) 
+    {
+        return 0;
+    }
+
+    int8_t result = ma_api_wifi_storage_read(DF_PROFILES_RECORD_NAME, DF_PROFILES_RECORD_MAGIC, 
+                                             DF_PROFILES_RECORD_VERSION, &stProfileStore, sizeof(stProfileStore));
+    if (result == 0) 
+    {
+        for (uint8_t i = 0; i < DF_WIFI_MAX_PROFILES; i++) 
+        {
+            st_wifi_profile_t *profile = &stProfileStore.profiles[i];
+            if (profile->ssidLength > sizeof(profile->ssid) || profile->passwordLength > sizeof(profile->password)) 
+            {
+                profile->inUse = 0;
+            }
+        }
+        bProfileStoreLoaded = true;
+        return 0;
+    }
+
+    ma_api_wifi_profiles_clear(&stProfileStore);
+
+    bool fromTextFile = false;
+    if (result == -1) 
+    {
+        result = ma_api_wifi_storage_read(stWifiBuildConfig.credentialsRecordName, DF_CREDENTIALS_RECORD_MAGIC, 
+                                          DF_CREDENTIALS_RECORD_VERSION, &record, sizeof(record));
+    }
+    if (result == -1) 
+    {
+        result = ma_api_wifi_read_legacy_credentials(&record);
+        fromTextFile = (result == 0);
+    }
+    if (result == -2) 
+    {
+        PRINTF("Error reading the saved networks, nothing is saved until they are read.\n");
+        return -1;
+    }
+    // Saved even with nothing to migrate, so the next boots find the profile record and never look for
+    // older versions
+    bool migrated = (result == 0 && 
+                     ma_api_wifi_profiles_add(&stProfileStore, record.ssid, record.ssidLength, record.password, 
+                                              record.passwordLength, DF_WIFI_PROFILE_DEFAULT_PRIORITY) >= 0);
+    bProfileStoreLoaded = true;
+    if (ma_api_wifi_profiles_save() != 0) 
+    {
+        bProfileStoreLoaded = false;
+        return -1;
+    }
+    if (!migrated) 
+    {
+        return 0;
+    }
+    if (fromTextFile) 
+    {
+        PRINTF("Credentials migrated from %s.\n", DF_LEGACY_CREDENTIALS_FILE_NAME);
+        SPIFFS.remove(DF_LEGACY_CREDENTIALS_FILE_NAME);
+    } 
+    else 
+    {
+        PRINTF("Credentials migrated to the profile store.\n");
+        ma_api_wifi_storage_erase(stWifiBuildConfig.credentialsRecordName);
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_save
+  * @brief      : Saves the profile store with ma_api_wifi_storage_write()
+  * @pre-cond.  : None
+  * @post-cond. : Record saved
+  * @parameters : None
+  * @retval     : 0 on success, -1 if the saved networks were never read, see ma_api_wifi_profiles_load(),
+  *               or the write failed
+  */
+int8_t ma_api_wifi_profiles_save(void) 
+{
+    if (!bProfileStoreLoaded) 
+    {
+        return -1;
+    }
+    return ma_api_wifi_storage_write(DF_PROFILES_RECORD_NAME, DF_PROFILES_RECORD_MAGIC, 
+                                     DF_PROFILES_RECORD_VERSION, &stProfileStore, sizeof(stProfileStore));
+}
+
+/**
+  * @Func       : ma_api_wifi_read_legacy_credentials
+  * @brief      : Reads the "SSID: ...\nPassword: ...\n" text file of older versions into a credential record.
+  *               Nothing is written and the file is kept, see ma_api_wifi_profiles_load().
+  * @pre-cond.  : None, SPIFFS is mounted here
+  * @post-cond. : None
+  * @parameters : 
+  *       - out_record: The credentials read from the text file
+  * @retval     : 0 on success, -1 if there is no valid text file, -2 if SPIFFS did not mount or the file
+  *               could not be opened
+  */
+int8_t ma_api_wifi_read_legacy_credentials(st_wifi_credential_record_t *out_record) 
+{
+    char text[DF_LEGACY_CREDENTIALS_MAX_SIZE + 1];
+
+    if (!stWifiBuildConfig.storageSpiffs) 
+    {
+        return -1;
+    }
+    if (ma_api_wifi_storage_spiffs_mount() != 0) 
+    {
+        return -2;
+    }
+    if (!SPIFFS.exists(DF_LEGACY_CREDENTIALS_FILE_NAME)) 
+    {
+        return -1;
+    }
+    File file = SPIFFS.open(DF_LEGACY_CREDENTIALS_FILE_NAME, "r");
+    if (!file)
+    {
+        return -2;
+    }
+    size_t length = file.read((uint8_t *)text, DF_LEGACY_CREDENTIALS_MAX_SIZE);
+    file.close();
+    text[length] = '\0';
+
+    const char *ssid = NULL;
+    const char *password = NULL;
+    size_t ssidLength = 0;
+    size_t passwordLength = 0;
+    for (char *line = text; line != NULL && *line != '\0'; ) 
+    {
+        char *next = strchr(line, '\n');
+        char *end = (next != NULL) ? next : line + strlen(line);
+        while (end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) 
+        {
+            end--;
+        }
+
+        if (strncmp(line, "SSID: ", 6) == 0) 
+        {
+            ssid = line + 6;
+            ssidLength = (end > ssid) ? end - ssid : 0;
+        } 
+        else if (strncmp(line, "Password: ", 10) == 0) 
+        {
+            password = line + 10;
+            passwordLength = (end > password) ? end - password : 0;
+        }
+        line = (next != NULL) ? next + 1 : NULL;
+    }
+
+    if (ssid == NULL || password == NULL || 
+        ssidLength > sizeof(out_record->ssid) || passwordLength > sizeof(out_record->password)) 
+    {
+        return -1;
+    }
+
+    memset(out_record, 0, sizeof(*out_record));
+    out_record->ssidLength = (uint8_t)ssidLength;
+    memcpy(out_record->ssid, ssid, ssidLength);
+    out_record->passwordLength = (uint8_t)passwordLength;
+    memcpy(out_record->password, password, passwordLength);
+    return 0;
+}
+
+/* Compatibility wrappers ----------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_setup_station
+  * @brief      : String version of ma_api_wifi_setup_station(const st_wifi_credential_t &, int)
+  * @pre-cond.  : None
+  * @post-cond. : See ma_api_wifi_setup_station(const st_wifi_credential_t &, int)
+  * @parameters : 
+  *       - in_wifiCredentials: SSID and password of the network
+  *       - maxAttempts: Number of full connection attempts
+  * @retval     : 0 on success, -1 if the connection failed or the credentials do not fit
+  */
+int8_t ma_api_wifi_setup_station(st_wifi_station_credential_t in_wifiCredentials, int maxAttempts) 
+{
+    st_wifi_credential_t credential;
+
+    if (ma_api_wifi_credential_set(&credential, in_wifiCredentials.stringSsid.c_str(), in_wifiCredentials.stringPassword.c_str()) != 0) 
+    {
+        return -1;
+    }
+    return ma_api_wifi_setup_station(credential, maxAttempts);
+}
+
+/**
+  * @Func       : ma_api_wifi_connect_async
+  * @brief      : String version of ma_api_wifi_connect_async(const st_wifi_credential_t &, ...)
+  * @pre-cond.  : None
+  * @post-cond. : See ma_api_wifi_connect_async(const st_wifi_credential_t &, ...)
+  * @parameters : 
+  *       - in_credentials: SSID and password of the network, copied
+  *       - in_config: Attempts, timeouts and backoff, or NULL for DF_WIFI_CONNECT_CONFIG_DEFAULT
+  *       - in_callback: Called once with the result, may be NULL
+  * @retval     : 0 if the connection started, -1 if the credentials do not fit
+  */
+int8_t ma_api_wifi_connect_async(const st_wifi_station_credential_t *in_credentials, const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback) 
+{
+    st_wifi_credential_t credential;
+
+    if (ma_api_wifi_credential_set(&credential, in_credentials->stringSsid.c_str(), in_credentials->stringPassword.c_str()) != 0) 
+    {
+        return -1;
+    }
+    return ma_api_wifi_connect_async(credential, in_config, in_callback);
+}
+
+/**
+  * @Func       : ma_api_wifi_setup_access_point
+  * @brief      : String version of ma_api_wifi_setup_access_point(const st_wifi_credential_t &)
+  * @pre-cond.  : None
+  * @post-cond. : AP is running. ma_api_wifi_portal_poll() must be called periodically to serve the clients.
+  * @parameters : in_credentials: The credentials currently saved in memory, shown on the portal page.
+  * @retval     : None
+  */
+void ma_api_wifi_setup_access_point(st_wifi_station_credential_t in_credentials) 
+{
+    st_wifi_credential_t credential;
+
+    ma_api_wifi_credential_set(&credential, in_credentials.stringSsid.c_str(), in_credentials.stringPassword.c_str());
+    ma_api_wifi_setup_access_point(credential);
+}
+
+/**
+  * @Func       : ma_api_wifi_update_network_credentials
+  * @brief      : String version of ma_api_wifi_update_network_credentials(const st_wifi_credential_t &)
+  * @pre-cond.  : None
+  * @post-cond. : Network saved
+  * @parameters : 
+  *       - in_ssid: The new SSID to be saved
+  *       - in_password: The new password to be saved
+  * @retval     : None
+  */
+void ma_api_wifi_update_network_credentials(const String in_ssid, const String in_password) 
+{
+    st_wifi_credential_t credential;
+
+    if (ma_api_wifi_credential_set(&credential, in_ssid.c_str(), in_password.c_str()) != 0) 
+    {
+        PRINTF("Error saving the credentials.\n");
+        return;
+    }
+    ma_api_wifi_update_network_credentials(credential);
+}
+
+/**
+  * @Func       : ma_api_wifi_read_network_credentials
+  * @brief      : String version of ma_api_wifi_read_network_credentials(st_wifi_credential_t *)
+  * @pre-cond.  : None
+  * @post-cond. : Network credentials are read and updated in the structure
+  * @parameters : 
+  *       - out_credentials: Pointer to the structure where the credentials will be stored
+  * @retval     : 0 on success, -1 if there are no valid credentials
+  */
+int8_t ma_api_wifi_read_network_credentials(st_wifi_station_credential_t *out_credentials) 
+{
+    st_wifi_credential_t credential;
+    int8_t result = ma_api_wifi_read_network_credentials(&credential);
+
+    out_credentials->stringSsid = credential.ssid;
+    out_credentials->stringPassword = credential.psk;
+    out_credentials->hasCredentials = (result == 0);
+    return result;
+}
+
+/**
+  * @Func       : ma_api_wifi_process_client_request
+  * @brief      : Kept for compatibility. Runs one ma_api_wifi_portal_poll(), it no longer waits for a
+  *               client. The credentials shown by the portal are updated only when in_oldSsid or
+  *               in_oldPassword differ from the previous call: a caller that keeps passing the network it
+  *               read at boot does not undo a hot apply.
+  * @pre-cond.  : ma_api_wifi_setup_access_point() must be called before using this function
+  * @post-cond. : See ma_api_wifi_portal_poll()
+  * @parameters : 
+  *       - in_wifiClient: Not used, connections are kept in the portal connection table
+  *       - in_oldSsid: The old SSID stored in memory
+  *       - in_oldPassword: The old password stored in memory
+  *       - in_timeToWaitSeconds: Idle time before a connection is dropped
+  * @retval     : None
+  */
+void ma_api_wifi_process_client_request(WiFiClient *in_wifiClient, String in_oldSsid, String in_oldPassword, uint16_t in_timeToWaitSeconds) 
+{
+    API_LOCK();
+    TRACE_POLL_SPAN();
+    st_wifi_credential_t callerCredential;
+
+    (void)in_wifiClient;
+    ma_api_wifi_credential_set(&callerCredential, in_oldSsid.c_str(), in_oldPassword.c_str());
+    if (!bWrapperCallerCredentialSet || memcmp(&callerCredential, &stWrapperCallerCredential, sizeof(callerCredential)) != 0) 
+    {
+        stWrapperCallerCredential = callerCredential;
+        bWrapperCallerCredentialSet = true;
+        stWifiStationCredential = callerCredential;
+    }
+    ma_api_wifi_portal_set_timeout(in_timeToWaitSeconds);
+    ma_api_wifi_portal_poll();
+}
 
 /*****************************END OF FILE**************************************/
\ No newline at end of file
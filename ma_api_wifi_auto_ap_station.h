@@ -20,6 +20,9 @@
 #include <SPIFFS.h>
 #include <stdlib.h>
 
+#include "ma_api_wifi_events.h"
+#include "ma_api_wifi_task.h"
+
 #ifdef BROWNOT_OFF
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
@@ -31,15 +34,112 @@
 #else 
 #define PRINTF(...)
 #endif
+
+#define DF_WIFI_SSID_BUFFER_SIZE        33      // 802.11 SSID: up to 32 bytes + terminator
+#define DF_WIFI_PASSWORD_BUFFER_SIZE    65      // WPA2 passphrase (63) or PSK in hex (64) + terminator
+
 /* Typedef -------------------------------------------------------------------*/
+// Credentials of a network in fixed buffers, copied without touching the heap. Pass by const reference.
+typedef struct {
+  uint8_t ssidLength;
+  uint8_t pskLength;
+  char ssid[DF_WIFI_SSID_BUFFER_SIZE];          // Null terminated
+  char psk[DF_WIFI_PASSWORD_BUFFER_SIZE];       // Null terminated, empty for an open network
+}st_wifi_credential_t;
+
+// Kept for compatibility, every use copies the strings on the heap. Prefer st_wifi_credential_t.
 typedef struct {
   String stringSsid;
   String stringPassword;
   bool hasCredentials;
 }st_wifi_station_credential_t;
 
+typedef enum {
+  eWIFI_CONNECT_PATH_NONE = 0,      // No connection attempted yet
+  eWIFI_CONNECT_PATH_FAST,          // Cached BSSID, channel and IP were used
+  eWIFI_CONNECT_PATH_FULL,          // Scan, association and DHCP
+  eWIFI_CONNECT_PATH_FAILED         // All attempts failed
+}e_wifi_connect_path_t;
+
+typedef enum {
+  eWIFI_CONNECT_RESULT_CONNECTED = 0,
+  eWIFI_CONNECT_RESULT_WRONG_PASSWORD,      // Authentication failed, retrying does not help
+  eWIFI_CONNECT_RESULT_AP_NOT_FOUND,        // The SSID is not in range
+  eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED,  // Transient failures on every attempt
+  eWIFI_CONNECT_RESULT_CANCELLED
+}e_wifi_connect_result_t;
+
+typedef enum {
+  eWIFI_STATION_IDLE = 0,
+  eWIFI_STATION_SCANNING,           // Looking for the saved networks, see ma_api_wifi_connect_profiles_async()
+  eWIFI_STATION_FAST_CONNECTING,    // Trying the cached BSSID, channel and IP
+  eWIFI_STATION_CONNECTING,         // Full attempt: scan, association and DHCP
+  eWIFI_STATION_BACKOFF,            // Waiting before the next attempt
+  eWIFI_STATION_CONNECTED,
+  eWIFI_STATION_FAILED
+}e_wifi_station_state_t;
+
+typedef struct {
+  uint8_t maxAttempts;              // Full attempts before eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED
+  uint32_t attemptTimeoutMs;        // Time for one association + DHCP
+  uint32_t backoffBaseMs;           // Wait after the first failed attempt, doubled on each failure
+  uint32_t backoffMaxMs;            // Upper limit of the wait
+  uint8_t fatalFailureLimit;        // Consecutive wrong password / AP not found failures before giving up
+}st_wifi_connect_config_t;
+
+#define DF_WIFI_CONNECT_CONFIG_DEFAULT  {3, 5000, 500, 8000, 2}
+
+// Used to test the network saved on the portal before it is committed to flash
+#define DF_WIFI_APPLY_CONFIG            {2, 10000, 500, 2000, 1}
+
+typedef void (*ma_api_wifi_connect_callback_t)(e_wifi_connect_result_t in_result);
+
+typedef struct {
+  e_wifi_connect_path_t path;
+  e_wifi_connect_result_t result;
+  uint8_t attempts;                 // Full attempts done, the fast attempt is not counted
+  uint8_t lastReason;               // Last disconnect reason (wifi_err_reason_t)
+  uint32_t connectMs;               // Time from the start of the connection to the IP address
+  uint32_t bootToConnectedMs;       // millis() when the connection was up, 0 on failure
+  uint32_t provisionToOnlineMs;     // From the portal save to the connection up, 0 if not provisioned just now
+}st_wifi_connect_stats_t;
+
+// A saved network as listed by ma_api_wifi_profile_list(), the password is not exposed
+typedef struct {
+  char ssid[33];
+  uint8_t priority;                 // Higher is tried first
+  uint32_t lastSuccess;             // Order of the last successful connection, higher is more recent, 0 if never
+}st_wifi_profile_info_t;
+
 /* Public objects ------------------------------------------------------------*/
+extern int8_t ma_api_wifi_credential_set(st_wifi_credential_t *out_credential, const char *in_ssid, const char *in_psk);
+extern int8_t ma_api_wifi_setup_station(const st_wifi_credential_t &in_credential, int maxAttempts);
+extern int8_t ma_api_wifi_setup_station_profiles(int maxAttempts);
+extern int8_t ma_api_wifi_connect_async(const st_wifi_credential_t &in_credential, const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback);
+extern int8_t ma_api_wifi_connect_profiles_async(const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback);
+extern void ma_api_wifi_station_poll(void);
+extern void ma_api_wifi_connect_cancel(void);
+extern e_wifi_station_state_t ma_api_wifi_get_station_state(void);
+extern st_wifi_connect_stats_t ma_api_wifi_get_connect_stats(void);
+extern void ma_api_wifi_setup_access_point(const st_wifi_credential_t &in_credential);
+extern int8_t ma_api_wifi_update_network_credentials(const st_wifi_credential_t &in_credential);
+extern int8_t ma_api_wifi_read_network_credentials(st_wifi_credential_t *out_credential);
+extern int8_t ma_api_wifi_profile_add(const char *in_ssid, const char *in_password, uint8_t in_priority);
+extern int8_t ma_api_wifi_profile_delete(const char *in_ssid);
+extern uint8_t ma_api_wifi_profile_list(st_wifi_profile_info_t *out_profiles, uint8_t in_maxProfiles);
+extern void ma_api_wifi_portal_poll(void);
+extern void ma_api_wifi_portal_set_timeout(uint16_t in_timeToWaitSeconds);
+extern void ma_api_wifi_portal_set_hot_apply(bool in_enable);
+extern bool ma_api_wifi_portal_is_active(void);
+extern void ma_api_wifi_link_monitor_set_timeout(uint16_t in_timeoutSeconds);
+extern int8_t ma_api_wifi_manager_start(const st_wifi_task_config_t *in_config);
+extern void ma_api_wifi_manager_stop(void);
+extern bool ma_api_wifi_get_event(st_wifi_event_t *out_event);
+extern void ma_api_wifi_print_trace(Print *out_output);
+
+// Compatibility wrappers of the functions above, built on String
 extern int8_t ma_api_wifi_setup_station(st_wifi_station_credential_t in_wifiCredentials, int maxAttempts);
+extern int8_t ma_api_wifi_connect_async(const st_wifi_station_credential_t *in_credentials, const st_wifi_connect_config_t *in_config, ma_api_wifi_connect_callback_t in_callback);
 extern void ma_api_wifi_setup_access_point(st_wifi_station_credential_t in_credentials);
 extern void ma_api_wifi_update_network_credentials(const String in_ssid, const String in_password);
 extern int8_t ma_api_wifi_read_network_credentials(st_wifi_station_credential_t *out_credentials);
@@ -0,0 +1,160 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_config.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Build configuration of the WiFi Api. Every value can be changed
+    *               with a -D build flag, e.g. -DDF_WIFI_FEATURE_DNS=0 or
+    *               -DDF_WIFI_AP_SSID=\"MY_DEVICE\", and is checked at compile time.
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_CONFIG_H
+#define __MA_API_WIFI_CONFIG_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Define --------------------------------------------------------------------*/
+// Features, 1 to build and 0 to leave out. A disabled feature has no route on the portal, so the linker
+// drops the code only that route called.
+#ifndef DF_WIFI_FEATURE_DNS
+#define DF_WIFI_FEATURE_DNS             1       // Captive portal DNS responder and the connectivity check redirects
+#endif
+
+#ifndef DF_WIFI_FEATURE_SCAN
+#define DF_WIFI_FEATURE_SCAN            1       // Background scan of the portal and /scan.json
+#endif
+
+#ifndef DF_WIFI_FEATURE_PROFILES
+#define DF_WIFI_FEATURE_PROFILES        1       // Several saved networks, /profiles.json, /profile_add and /profile_delete
+#endif
+
+#ifndef DF_WIFI_FEATURE_METRICS
+#ifdef TRACE_ENABLE
+#define DF_WIFI_FEATURE_METRICS         1       // /metrics, needs TRACE_ENABLE
+#else
+#define DF_WIFI_FEATURE_METRICS         0
+#endif
+#endif
+
+#if DF_WIFI_FEATURE_METRICS && !defined(TRACE_ENABLE)
+#error "DF_WIFI_FEATURE_METRICS needs TRACE_ENABLE"
+#endif
+
+// Without the profiles feature a single network is kept, which also shrinks the saved record
+#if !DF_WIFI_FEATURE_PROFILES && !defined(DF_WIFI_MAX_PROFILES)
+#define DF_WIFI_MAX_PROFILES            1
+#endif
+
+// Access point of the portal
+#ifndef DF_WIFI_AP_SSID
+#define DF_WIFI_AP_SSID                 "SOBREIRO_MONITOR"
+#endif
+
+#ifndef DF_WIFI_AP_PASSWORD
+#define DF_WIFI_AP_PASSWORD             "12345678"      // 8 to 63 characters, or "" for an open AP
+#endif
+
+#ifndef DF_WIFI_AP_IP
+#define DF_WIFI_AP_IP                   192, 168, 123, 123
+#endif
+
+#ifndef DF_WIFI_AP_MASK
+#define DF_WIFI_AP_MASK                 255, 255, 255, 0
+#endif
+
+#ifndef DF_WIFI_HTTP_PORT
+#define DF_WIFI_HTTP_PORT               80
+#endif
+
+#ifndef DF_WIFI_CREDENTIALS_RECORD_NAME
+#define DF_WIFI_CREDENTIALS_RECORD_NAME "/wifi_cred"    // Record of the preferred network, see ma_api_wifi_storage.h
+#endif
+
+// Storage backends of the records, 1 to use and 0 to leave out. A record is read from the cheapest
+// backend holding a valid copy and written to RTC memory and the first persistent backend. SPIFFS after
+// NVS is only read to move the records of older versions, see ma_api_wifi_storage.cpp.
+#ifndef DF_WIFI_STORAGE_RTC
+#define DF_WIFI_STORAGE_RTC             1       // RTC slow memory, kept in deep sleep, lost on power off
+#endif
+
+#ifndef DF_WIFI_STORAGE_NVS
+#define DF_WIFI_STORAGE_NVS             1       // NVS partition, through Preferences
+#endif
+
+#ifndef DF_WIFI_STORAGE_SPIFFS
+#define DF_WIFI_STORAGE_SPIFFS          1       // SPIFFS files, where older versions saved the networks
+#endif
+
+#ifndef DF_WIFI_STORAGE_RTC_SIZE
+#define DF_WIFI_STORAGE_RTC_SIZE        768     // Bytes of RTC slow memory for the records, a record that does not fit is not cached
+#endif
+
+#ifndef DF_WIFI_STORAGE_SPIFFS_FORMAT
+#define DF_WIFI_STORAGE_SPIFFS_FORMAT   1       // Format SPIFFS when it does not mount, only without NVS
+#endif
+
+/* Typedef -------------------------------------------------------------------*/
+typedef struct {
+  const char *apSsid;
+  const char *apPassword;
+  uint8_t apIp[4];
+  uint8_t apMask[4];
+  uint16_t httpPort;
+  const char *credentialsRecordName;
+  uint16_t storageRtcSize;
+  bool storageRtc;
+  bool storageNvs;
+  bool storageSpiffs;
+  bool storageSpiffsFormat;
+  bool dns;
+  bool scan;
+  bool profiles;
+  bool metrics;
+}st_wifi_build_config_t;
+
+/* Public objects ------------------------------------------------------------*/
+// Read with plain if statements: the values are constants, so the compiler removes the branches
+// of the disabled features as an #if would.
+constexpr st_wifi_build_config_t stWifiBuildConfig = {
+    DF_WIFI_AP_SSID,
+    DF_WIFI_AP_PASSWORD,
+    {DF_WIFI_AP_IP},
+    {DF_WIFI_AP_MASK},
+    DF_WIFI_HTTP_PORT,
+    DF_WIFI_CREDENTIALS_RECORD_NAME,
+    DF_WIFI_STORAGE_RTC_SIZE,
+    DF_WIFI_STORAGE_RTC != 0,
+    DF_WIFI_STORAGE_NVS != 0,
+    DF_WIFI_STORAGE_SPIFFS != 0,
+    DF_WIFI_STORAGE_SPIFFS_FORMAT != 0,
+    DF_WIFI_FEATURE_DNS != 0,
+    DF_WIFI_FEATURE_SCAN != 0,
+    DF_WIFI_FEATURE_PROFILES != 0,
+    DF_WIFI_FEATURE_METRICS != 0
+};
+
+// strlen() usable in a static_assert
+constexpr size_t ma_api_wifi_config_length(const char *in_text)
+{
+    return (*in_text == '\0') ? 0 : 1 + ma_api_wifi_config_length(in_text + 1);
+}
+
+static_assert(ma_api_wifi_config_length(stWifiBuildConfig.apSsid) >= 1 &&
+              ma_api_wifi_config_length(stWifiBuildConfig.apSsid) <= 32, "DF_WIFI_AP_SSID must have 1 to 32 characters");
+static_assert(ma_api_wifi_config_length(stWifiBuildConfig.apPassword) == 0 ||
+              (ma_api_wifi_config_length(stWifiBuildConfig.apPassword) >= 8 &&
+               ma_api_wifi_config_length(stWifiBuildConfig.apPassword) <= 63), "DF_WIFI_AP_PASSWORD must have 8 to 63 characters, or none");
+static_assert(stWifiBuildConfig.httpPort != 0, "DF_WIFI_HTTP_PORT can not be 0");
+static_assert(stWifiBuildConfig.credentialsRecordName[0] == '/', "DF_WIFI_CREDENTIALS_RECORD_NAME must start with /");
+static_assert(ma_api_wifi_config_length(stWifiBuildConfig.credentialsRecordName) <= 16, "DF_WIFI_CREDENTIALS_RECORD_NAME must have up to 16 characters, an NVS key has 15 after the /");
+static_assert(stWifiBuildConfig.storageNvs || stWifiBuildConfig.storageSpiffs, "DF_WIFI_STORAGE_NVS or DF_WIFI_STORAGE_SPIFFS is needed, RTC memory is lost on power off");
+static_assert(stWifiBuildConfig.storageRtcSize > 0 && stWifiBuildConfig.storageRtcSize % 4 == 0, "DF_WIFI_STORAGE_RTC_SIZE must be a multiple of 4");
+
+#endif /* __MA_API_WIFI_CONFIG_H */
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,259 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_dns.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Captive portal DNS responder of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <string.h>
+#include <unistd.h>
+
+#ifdef ESP_PLATFORM
+// lwIP
+#include <lwip/sockets.h>
+#else
+// Host build
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+// API library
+#include "ma_api_wifi_dns.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	ma_api_wifi_dns_start() opens a UDP socket on the DNS port. While the 
+    portal runs, every A query is answered with the address of the AP, so a
+    phone that joins the AP opens its captive portal sheet at once.
+
+2.  Call ma_api_wifi_dns_poll() periodically. It answers at most
+    DF_WIFI_DNS_PACKETS_PER_POLL queries and never waits. Each answer is
+    built in place in one static DF_WIFI_DNS_BUFFER_SIZE buffer, nothing is
+    allocated.
+
+3.  Queries other than A (e.g. AAAA) get an empty answer, so the phone 
+    falls back to IPv4 at once instead of waiting for a timeout.
+
+4.  It uses BSD sockets, lwIP on the ESP32, so the same file runs on a PC
+    against a loopback socket, e.g. with tools/dns_probe.py.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_DNS_HEADER_SIZE              12
+#define DF_DNS_ANSWER_SIZE              16      // Name pointer, type, class, TTL, length, IPv4 address
+#define DF_DNS_FLAG_QR                  0x80    // In byte 2
+#define DF_DNS_OPCODE_MASK              0x78    // In byte 2
+#define DF_DNS_FLAG_RD                  0x01    // In byte 2
+#define DF_DNS_FLAG_AA                  0x04    // In byte 2
+#define DF_DNS_FLAG_RA                  0x80    // In byte 3
+#define DF_DNS_RCODE_NOT_IMPLEMENTED    4
+#define DF_DNS_TYPE_A                   1
+#define DF_DNS_TYPE_ANY                 255
+#define DF_DNS_CLASS_IN                 1
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static int iDnsSocket = -1;
+static uint8_t u8DnsIp[4];
+static uint8_t u8DnsBuffer[DF_WIFI_DNS_BUFFER_SIZE];
+static st_wifi_dns_stats_t stDnsStats;
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_dns_start
+  * @brief      : Opens the UDP socket of the responder
+  * @pre-cond.  : The network interface is up
+  * @post-cond. : ma_api_wifi_dns_poll() answers the queries
+  * @parameters :
+  *       - in_port: DF_WIFI_DNS_PORT, or another port for a test on a PC
+  *       - in_ip: Address given in every answer, e.g. the AP address
+  * @retval     : 0 on success, -1 if the socket could not be opened
+  */
+int8_t ma_api_wifi_dns_start(uint16_t in_port, const uint8_t in_ip[4])
+{
+    struct sockaddr_in address;
+
+    ma_api_wifi_dns_stop();
+    memcpy(u8DnsIp, in_ip, sizeof(u8DnsIp));
+
+    iDnsSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (iDnsSocket < 0)
+    {
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(in_port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(iDnsSocket, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        ma_api_wifi_dns_stop();
+        return -1;
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_dns_stop
+  * @brief      : Closes the socket of the responder
+  * @pre-cond.  : None
+  * @post-cond. : No query is answered
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_dns_stop(void)
+{
+    if (iDnsSocket >= 0)
+    {
+        close(iDnsSocket);
+        iDnsSocket = -1;
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_dns_poll
+  * @brief      : Answers the queries waiting on the socket, without blocking
+  * @pre-cond.  : None, does nothing before ma_api_wifi_dns_start()
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Number of queries answered
+  */
+uint8_t ma_api_wifi_dns_poll(void)
+{
+    uint8_t answered = 0;
+
+    for (uint8_t i = 0; iDnsSocket >= 0 && i < DF_WIFI_DNS_PACKETS_PER_POLL; i++)
+    {
+        struct sockaddr_in client;
+        socklen_t clientLength = sizeof(client);
+        ssize_t received = recvfrom(iDnsSocket, u8DnsBuffer, sizeof(u8DnsBuffer), MSG_DONTWAIT, 
+                                    (struct sockaddr *)&client, &clientLength);
+        if (received <= 0)
+        {
+            break;
+        }
+
+        size_t length = ma_api_wifi_dns_build_answer(u8DnsBuffer, (size_t)received, sizeof(u8DnsBuffer), u8DnsIp);
+        if (length > 0)
+        {
+            sendto(iDnsSocket, u8DnsBuffer, length, MSG_DONTWAIT, (struct sockaddr *)&client, clientLength);
+            answered++;
+        }
+    }
+    return answered;
+}
+
+/**
+  * @Func       : ma_api_wifi_dns_get_stats
+  * @brief      : Returns the query counters
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Counters since boot
+  */
+st_wifi_dns_stats_t ma_api_wifi_dns_get_stats(void)
+{
+    return stDnsStats;
+}
+
+/**
+  * @Func       : ma_api_wifi_dns_build_answer
+  * @brief      : Turns a query into its answer, in the same buffer. The header and the question are kept,
+  *               other sections of the query (e.g. EDNS) are dropped and, for an A query of class IN, one
+  *               answer with in_ip follows.
+  * @pre-cond.  : None
+  * @post-cond. : io_message holds the answer
+  * @parameters :
+  *       - io_message: Query received, then the answer
+  *       - in_length: Length of the query
+  *       - in_size: Size of the buffer
+  *       - in_ip: IPv4 address of the answer
+  * @retval     : Length of the answer, 0 if the message must not be answered
+  */
+size_t ma_api_wifi_dns_build_answer(uint8_t *io_message, size_t in_length, size_t in_size, const uint8_t in_ip[4])
+{
+    size_t position = DF_DNS_HEADER_SIZE;
+
+    if (in_length < DF_DNS_HEADER_SIZE || (io_message[2] & DF_DNS_FLAG_QR) != 0)
+    {
+        stDnsStats.dropped++;
+        return 0;
+    }
+
+    // Response, authoritative, recursion available, RD copied from the query
+    io_message[2] = (uint8_t)(DF_DNS_FLAG_QR | (io_message[2] & (DF_DNS_OPCODE_MASK | DF_DNS_FLAG_RD)) | DF_DNS_FLAG_AA);
+    io_message[3] = DF_DNS_FLAG_RA;
+    if ((io_message[2] & DF_DNS_OPCODE_MASK) != 0 || io_message[4] != 0 || io_message[5] != 1)
+    {
+        // Only standard queries with one question: header alone, "not implemented"
+        io_message[3] |= DF_DNS_RCODE_NOT_IMPLEMENTED;
+        memset(&io_message[4], 0, DF_DNS_HEADER_SIZE - 4);
+        stDnsStats.empty++;
+        return DF_DNS_HEADER_SIZE;
+    }
+
+    // Question name: labels up to a zero length one, compression is not used in a question
+    while (position < in_length && io_message[position] != 0)
+    {
+        if ((io_message[position] & 0xC0) != 0)
+        {
+            stDnsStats.dropped++;
+            return 0;
+        }
+        position += io_message[position] + 1;
+    }
+    if (position + 5 > in_length)
+    {
+        stDnsStats.dropped++;
+        return 0;
+    }
+
+    uint16_t type = (uint16_t)((io_message[position + 1] << 8) | io_message[position + 2]);
+    uint16_t dnsClass = (uint16_t)((io_message[position + 3] << 8) | io_message[position + 4]);
+    position += 5;
+
+    // One question, no authority nor additional records
+    memset(&io_message[6], 0, DF_DNS_HEADER_SIZE - 6);
+    if ((type != DF_DNS_TYPE_A && type != DF_DNS_TYPE_ANY) || dnsClass != DF_DNS_CLASS_IN || 
+        position + DF_DNS_ANSWER_SIZE > in_size)
+    {
+        stDnsStats.empty++;
+        return position;
+    }
+
+    uint8_t *answer = &io_message[position];
+    answer[0] = 0xC0;                   // Name: pointer to the question
+    answer[1] = DF_DNS_HEADER_SIZE;
+    answer[2] = 0;
+    answer[3] = DF_DNS_TYPE_A;
+    answer[4] = 0;
+    answer[5] = DF_DNS_CLASS_IN;
+    answer[6] = (uint8_t)(DF_WIFI_DNS_TTL_SECONDS >> 24);
+    answer[7] = (uint8_t)(DF_WIFI_DNS_TTL_SECONDS >> 16);
+    answer[8] = (uint8_t)(DF_WIFI_DNS_TTL_SECONDS >> 8);
+    answer[9] = (uint8_t)DF_WIFI_DNS_TTL_SECONDS;
+    answer[10] = 0;
+    answer[11] = 4;
+    memcpy(&answer[12], in_ip, 4);
+    io_message[7] = 1;                  // ANCOUNT
+    stDnsStats.answered++;
+    return position + DF_DNS_ANSWER_SIZE;
+}
+
+/*****************************END OF FILE**************************************/
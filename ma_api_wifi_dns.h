@@ -0,0 +1,44 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_dns.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the captive portal DNS responder of the WiFi Api
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_DNS_H
+#define __MA_API_WIFI_DNS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Define --------------------------------------------------------------------*/
+#define DF_WIFI_DNS_PORT                53
+#define DF_WIFI_DNS_BUFFER_SIZE         512     // Largest DNS message over UDP without EDNS
+#define DF_WIFI_DNS_TTL_SECONDS         60      // Short, so the phone asks again once it is on the real network
+
+#ifndef DF_WIFI_DNS_PACKETS_PER_POLL
+#define DF_WIFI_DNS_PACKETS_PER_POLL    4       // Queries answered by one ma_api_wifi_dns_poll()
+#endif
+
+/* Typedef -------------------------------------------------------------------*/
+typedef struct {
+  uint32_t answered;                // A queries answered with the portal address
+  uint32_t empty;                   // Other queries, answered without records
+  uint32_t dropped;                 // Malformed or not a query, not answered
+}st_wifi_dns_stats_t;
+
+/* Public objects ------------------------------------------------------------*/
+extern int8_t ma_api_wifi_dns_start(uint16_t in_port, const uint8_t in_ip[4]);
+extern void ma_api_wifi_dns_stop(void);
+extern uint8_t ma_api_wifi_dns_poll(void);
+extern st_wifi_dns_stats_t ma_api_wifi_dns_get_stats(void);
+extern size_t ma_api_wifi_dns_build_answer(uint8_t *io_message, size_t in_length, size_t in_size, const uint8_t in_ip[4]);
+
+#endif /* __MA_API_WIFI_DNS_H */
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,109 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_events.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Lock-free event queue between the WiFi Api and the application
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// API library
+#include "ma_api_wifi_events.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	A st_wifi_event_queue_t is a ring with one producer and one consumer, 
+    each on its own task or core. Neither side locks or waits: a full queue
+    drops the new event and counts it, an empty one returns false.
+
+2.  The producer calls ma_api_wifi_events_push(). Several producers are fine
+    only if they are serialized by the caller, as the WiFi Api does with its
+    API lock.
+
+3.  The consumer calls ma_api_wifi_events_pop() until it returns false.
+
+4.  A global queue is zero-initialized and ready to use. Nothing here 
+    depends on the Arduino framework.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_EVENT_QUEUE_MASK             (DF_WIFI_EVENT_QUEUE_SIZE - 1)
+
+static_assert((DF_WIFI_EVENT_QUEUE_SIZE & DF_EVENT_QUEUE_MASK) == 0 && DF_WIFI_EVENT_QUEUE_SIZE <= 32768, 
+              "DF_WIFI_EVENT_QUEUE_SIZE must be a power of two up to 32768");
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_events_push
+  * @brief      : Adds an event at the head of the queue
+  * @pre-cond.  : Called by the producer only
+  * @post-cond. : The event is visible to the consumer, or counted in dropped
+  * @parameters :
+  *       - io_queue: The queue
+  *       - in_type: e_wifi_event_type_t
+  *       - in_detail: Depends on the type
+  *       - in_timeMs: millis() of the event
+  * @retval     : true if queued, false if the queue was full
+  */
+bool ma_api_wifi_events_push(st_wifi_event_queue_t *io_queue, uint8_t in_type, uint8_t in_detail, uint32_t in_timeMs)
+{
+    uint16_t head = io_queue->head.load(std::memory_order_relaxed);
+    uint16_t tail = io_queue->tail.load(std::memory_order_acquire);
+
+    if ((uint16_t)(head - tail) >= DF_WIFI_EVENT_QUEUE_SIZE)
+    {
+        io_queue->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    st_wifi_event_t *event = &io_queue->events[head & DF_EVENT_QUEUE_MASK];
+    event->type = in_type;
+    event->detail = in_detail;
+    event->timeMs = in_timeMs;
+    // Release: the slot is written before the consumer can see the new head
+    io_queue->head.store((uint16_t)(head + 1), std::memory_order_release);
+    return true;
+}
+
+/**
+  * @Func       : ma_api_wifi_events_pop
+  * @brief      : Takes the oldest event of the queue
+  * @pre-cond.  : Called by the consumer only
+  * @post-cond. : The slot is free for the producer
+  * @parameters :
+  *       - io_queue: The queue
+  *       - out_event: Receives the event
+  * @retval     : true if an event was taken, false if the queue is empty
+  */
+bool ma_api_wifi_events_pop(st_wifi_event_queue_t *io_queue, st_wifi_event_t *out_event)
+{
+    uint16_t tail = io_queue->tail.load(std::memory_order_relaxed);
+    uint16_t head = io_queue->head.load(std::memory_order_acquire);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    *out_event = io_queue->events[tail & DF_EVENT_QUEUE_MASK];
+    // Release: the slot is read before the producer can reuse it
+    io_queue->tail.store((uint16_t)(tail + 1), std::memory_order_release);
+    return true;
+}
+
+/*****************************END OF FILE**************************************/
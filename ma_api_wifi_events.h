@@ -0,0 +1,55 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_events.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the event queue between the WiFi Api and the
+    *               application
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_EVENTS_H
+#define __MA_API_WIFI_EVENTS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <atomic>
+
+/* Define --------------------------------------------------------------------*/
+#ifndef DF_WIFI_EVENT_QUEUE_SIZE
+#define DF_WIFI_EVENT_QUEUE_SIZE        16      // Power of two, events not read are dropped when it is full
+#endif
+
+/* Typedef -------------------------------------------------------------------*/
+typedef enum {
+  eWIFI_EVENT_CONNECTED = 0,        // Station up, detail is e_wifi_connect_path_t
+  eWIFI_EVENT_CONNECT_FAILED,       // Connection given up, detail is e_wifi_connect_result_t
+  eWIFI_EVENT_DISCONNECTED,         // Link lost while connected, the driver keeps reconnecting
+  eWIFI_EVENT_CREDENTIALS_SAVED,    // A network was added to the profiles
+  eWIFI_EVENT_PORTAL_CLIENT_SERVED  // A portal request was answered
+}e_wifi_event_type_t;
+
+typedef struct {
+  uint8_t type;                     // e_wifi_event_type_t
+  uint8_t detail;
+  uint32_t timeMs;                  // millis() when the event happened
+}st_wifi_event_t;
+
+// Single producer, single consumer ring. head and tail run freely and wrap at 65536, 
+// which DF_WIFI_EVENT_QUEUE_SIZE divides.
+typedef struct {
+  std::atomic<uint16_t> head;       // Written by the producer only
+  std::atomic<uint16_t> tail;       // Written by the consumer only
+  std::atomic<uint32_t> dropped;    // Events lost because the queue was full
+  st_wifi_event_t events[DF_WIFI_EVENT_QUEUE_SIZE];
+}st_wifi_event_queue_t;
+
+/* Public objects ------------------------------------------------------------*/
+extern bool ma_api_wifi_events_push(st_wifi_event_queue_t *io_queue, uint8_t in_type, uint8_t in_detail, uint32_t in_timeMs);
+extern bool ma_api_wifi_events_pop(st_wifi_event_queue_t *io_queue, st_wifi_event_t *out_event);
+
+#endif /* __MA_API_WIFI_EVENTS_H */
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,806 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_http.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Incremental HTTP request parser of the WiFi portal
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <string.h>
+
+// API library
+#include "ma_api_wifi_http.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	Call ma_api_wifi_http_reset() before receiving a new request.
+
+2.  Call ma_api_wifi_http_get_rx_buffer() to know where to copy the received
+    bytes and how many bytes still fit, then read from the client directly
+    into that buffer.
+
+3.  Call ma_api_wifi_http_parse() with the number of bytes copied. It only
+    scans the new bytes and returns eWIFI_HTTP_PARSE_DONE when the request
+    is complete. Tokens are kept as spans into the buffer, nothing is copied
+    and nothing is allocated.
+
+    When keepAlive is set the connection can carry more requests. After the
+    response, ma_api_wifi_http_next() moves the bytes already received after
+    the request (pipelined requests) to the start of the buffer and parses
+    them, so a complete next request is found without reading the client.
+
+4.  To read "key=value&..." data (query string or a form body), describe the
+    wanted fields in a st_wifi_form_field_t array and call 
+    ma_api_wifi_http_get_fields(), which reads the query string and a form
+    body. ma_api_wifi_form_clear() and ma_api_wifi_form_decode() do the same
+    on any other source. The values are percent-decoded into the caller 
+    buffers.
+
+5.  This file only needs the C library, so it can be compiled and measured 
+    on a PC with the same sources used on the ESP32.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_HTTP_CONTENT_LENGTH          "content-length"
+#define DF_HTTP_CONTENT_TYPE            "content-type"
+#define DF_HTTP_IF_NONE_MATCH           "if-none-match"
+#define DF_HTTP_CONNECTION              "connection"
+#define DF_HTTP_TRANSFER_ENCODING       "transfer-encoding"
+#define DF_HTTP_VERSION_1_1             "HTTP/1.1"
+#define DF_HTTP_FORM_CONTENT_TYPE       "application/x-www-form-urlencoded"
+
+#define DF_FORM_MAX_KEY_LENGTH          16      // Longer keys never match a field
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static bool ma_api_wifi_http_parse_request_line(st_wifi_http_request_t *io_request, uint16_t in_start, uint16_t in_end);
+static e_wifi_http_parse_result_t ma_api_wifi_http_parse_header(st_wifi_http_request_t *io_request, uint16_t in_start, uint16_t in_end);
+static bool ma_api_wifi_http_parse_content_length(st_wifi_http_request_t *io_request, const char *in_value, const char *in_valueEnd);
+static bool ma_api_wifi_http_name_equals(const char *in_name, uint16_t in_length, const char *in_lowerText);
+static void ma_api_wifi_http_parse_connection(st_wifi_http_request_t *io_request, const char *in_value, const char *in_valueEnd);
+static int16_t ma_api_wifi_form_percent_decode(const char *in_data, uint16_t in_length, char *out_value, uint16_t in_size);
+static bool ma_api_wifi_form_has_value(const char *in_data, uint16_t in_length, const char *in_key);
+static int8_t ma_api_wifi_form_hex_value(char in_char);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_http_reset
+  * @brief      : Clears the request so a new one can be received in the same buffer
+  * @pre-cond.  : None
+  * @post-cond. : Request empty and parser at the request line
+  * @parameters : out_request: The request to be cleared
+  * @retval     : None
+  */
+void ma_api_wifi_http_reset(st_wifi_http_request_t *out_request)
+{
+    out_request->length = 0;
+    out_request->parsed = 0;
+    out_request->lineStart = 0;
+    out_request->contentLength = 0;
+    out_request->hasContentLength = false;
+    out_request->stage = eWIFI_HTTP_STAGE_REQUEST_LINE;
+    out_request->keepAlive = false;
+    out_request->method = {0, 0};
+    out_request->path = {0, 0};
+    out_request->query = {0, 0};
+    out_request->contentType = {0, 0};
+    out_request->ifNoneMatch = {0, 0};
+    out_request->body = {0, 0};
+}
+
+/**
+  * @Func       : ma_api_wifi_http_get_rx_buffer
+  * @brief      : Returns where the next received bytes must be copied
+  * @pre-cond.  : ma_api_wifi_http_reset() must be called before using this function
+  * @post-cond. : None
+  * @parameters :
+  *       - in_request: The request being received
+  *       - out_space: Number of bytes that still fit in the buffer
+  * @retval     : Pointer to the first free byte of the buffer
+  */
+char *ma_api_wifi_http_get_rx_buffer(st_wifi_http_request_t *in_request, uint16_t *out_space)
+{
+    *out_space = DF_HTTP_MAX_REQUEST_SIZE - in_request->length;
+    return &in_request->buffer[in_request->length];
+}
+
+/**
+  * @Func       : ma_api_wifi_http_parse
+  * @brief      : Scans the bytes received since the last call. The parser resumes where it stopped,
+  *               so every byte is looked at only once.
+  * @pre-cond.  : in_received bytes were copied to the pointer given by ma_api_wifi_http_get_rx_buffer()
+  * @post-cond. : method, path, query and body spans are valid when eWIFI_HTTP_PARSE_DONE is returned
+  * @parameters :
+  *       - io_request: The request being received
+  *       - in_received: Number of bytes copied to the buffer
+  * @retval     : Parser state, see e_wifi_http_parse_result_t
+  */
+e_wifi_http_parse_result_t ma_api_wifi_http_parse(st_wifi_http_request_t *io_request, uint16_t in_received)
+{
+    io_request->length += in_received;
+    if (io_request->stage == eWIFI_HTTP_STAGE_DONE)
+    {
+        return eWIFI_HTTP_PARSE_DONE;
+    }
+
+    while (io_request->stage != eWIFI_HTTP_STAGE_BODY && io_request->parsed < io_request->length)
+    {
+        // Look for the end of the current line only in the new bytes
+        const char *lineEnd = (const char *)memchr(&io_request->buffer[io_request->parsed], '\n',
+                                                   io_request->length - io_request->parsed);
+        if (lineEnd == NULL)
+        {
+            io_request->parsed = io_request->length;
+            break;
+        }
+
+        uint16_t start = io_request->lineStart;
+        uint16_t end = (uint16_t)(lineEnd - io_request->buffer);
+        io_request->parsed = end + 1;
+        io_request->lineStart = end + 1;
+        if (end > start && io_request->buffer[end - 1] == '\r')
+        {
+            end--;
+        }
+
+        if (io_request->stage == eWIFI_HTTP_STAGE_REQUEST_LINE)
+        {
+            if (end == start)
+            {
+                continue; // Empty lines before the request line are allowed (RFC 9112)
+            }
+            if (!ma_api_wifi_http_parse_request_line(io_request, start, end))
+            {
+                return eWIFI_HTTP_PARSE_BAD_REQUEST;
+            }
+            io_request->stage = eWIFI_HTTP_STAGE_HEADERS;
+        }
+        else if (end == start)
+        {
+            // Empty line: end of the headers
+            io_request->body.offset = io_request->parsed;
+            if (io_request->contentLength > DF_HTTP_MAX_REQUEST_SIZE - io_request->body.offset)
+            {
+                return eWIFI_HTTP_PARSE_TOO_LARGE;
+            }
+            io_request->stage = eWIFI_HTTP_STAGE_BODY;
+        }
+        else
+        {
+            e_wifi_http_parse_result_t result = ma_api_wifi_http_parse_header(io_request, start, end);
+            if (result != eWIFI_HTTP_PARSE_INCOMPLETE)
+            {
+                return result;
+            }
+        }
+    }
+
+    if (io_request->stage == eWIFI_HTTP_STAGE_BODY &&
+        io_request->length - io_request->body.offset >= io_request->contentLength)
+    {
+        io_request->body.length = io_request->contentLength;
+        io_request->parsed = io_request->body.offset + io_request->body.length;
+        io_request->stage = eWIFI_HTTP_STAGE_DONE;
+    }
+
+    if (io_request->stage == eWIFI_HTTP_STAGE_DONE)
+    {
+        return eWIFI_HTTP_PARSE_DONE;
+    }
+
+    if (io_request->length >= DF_HTTP_MAX_REQUEST_SIZE)
+    {
+        return eWIFI_HTTP_PARSE_TOO_LARGE;
+    }
+
+    return eWIFI_HTTP_PARSE_INCOMPLETE;
+}
+
+/**
+  * @Func       : ma_api_wifi_http_next
+  * @brief      : Starts the next request of a persistent connection. The bytes received after the current
+  *               request are moved to the start of the buffer and parsed.
+  * @pre-cond.  : ma_api_wifi_http_parse() returned eWIFI_HTTP_PARSE_DONE and the response was sent
+  * @post-cond. : The request holds only the bytes of the next request
+  * @parameters : io_request: The request
+  * @retval     : Parser state of the next request, eWIFI_HTTP_PARSE_INCOMPLETE if nothing was received yet
+  */
+e_wifi_http_parse_result_t ma_api_wifi_http_next(st_wifi_http_request_t *io_request)
+{
+    uint16_t end = io_request->body.offset + io_request->body.length;
+    uint16_t leftover = io_request->length - end;
+
+    memmove(io_request->buffer, &io_request->buffer[end], leftover);
+    ma_api_wifi_http_reset(io_request);
+    if (leftover == 0)
+    {
+        return eWIFI_HTTP_PARSE_INCOMPLETE;
+    }
+    return ma_api_wifi_http_parse(io_request, leftover);
+}
+
+/**
+  * @Func       : ma_api_wifi_http_span_equals
+  * @brief      : Compares a span of the request with a text
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_request: The request that owns the span
+  *       - in_span: The span to be compared
+  *       - in_text: Null terminated text
+  * @retval     : true if the span and the text are equal
+  */
+bool ma_api_wifi_http_span_equals(const st_wifi_http_request_t *in_request, st_wifi_http_span_t in_span, const char *in_text)
+{
+    return strlen(in_text) == in_span.length &&
+           memcmp(&in_request->buffer[in_span.offset], in_text, in_span.length) == 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_http_etag_matches
+  * @brief      : Checks the If-None-Match header against the ETag of the resource. The header is "*" alone or
+  *               a comma separated list of quoted tags, each one may have the weak prefix "W/". Tags are 
+  *               compared whole; a list that is not well formed matches nothing.
+  * @pre-cond.  : ma_api_wifi_http_parse() returned eWIFI_HTTP_PARSE_DONE
+  * @post-cond. : None
+  * @parameters :
+  *       - in_request: The parsed request
+  *       - in_etag: Quoted ETag of the resource, e.g. "\"1234\""
+  * @retval     : true if the client copy is current and 304 Not Modified can be sent
+  */
+bool ma_api_wifi_http_etag_matches(const st_wifi_http_request_t *in_request, const char *in_etag)
+{
+    const char *value = &in_request->buffer[in_request->ifNoneMatch.offset];
+    const char *valueEnd = value + in_request->ifNoneMatch.length;
+    size_t etagLength = strlen(in_etag);
+
+    // The parser trimmed the value, so "*" is the whole of it
+    if (valueEnd - value == 1 && *value == '*')
+    {
+        return true;
+    }
+
+    const char *tag = value;
+    while (tag < valueEnd)
+    {
+        if (*tag == ',' || *tag == ' ' || *tag == '\t')
+        {
+            tag++;
+            continue;
+        }
+        if (valueEnd - tag >= 2 && tag[0] == 'W' && tag[1] == '/')
+        {
+            tag += 2;
+        }
+        // A tag is an opaque quoted string, which may hold commas
+        const char *closing = (tag < valueEnd && *tag == '"') ? (const char *)memchr(tag + 1, '"', valueEnd - tag - 1) : NULL;
+        if (closing == NULL)
+        {
+            return false;
+        }
+        size_t tagLength = closing + 1 - tag;
+        if (tagLength == etagLength && memcmp(tag, in_etag, etagLength) == 0)
+        {
+            return true;
+        }
+        tag = closing + 1;
+        if (tag < valueEnd && *tag != ',' && *tag != ' ' && *tag != '\t')
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+  * @Func       : ma_api_wifi_http_has_form_body
+  * @brief      : Checks if the body is "application/x-www-form-urlencoded" data
+  * @pre-cond.  : ma_api_wifi_http_parse() returned eWIFI_HTTP_PARSE_DONE
+  * @post-cond. : None
+  * @parameters : in_request: The parsed request
+  * @retval     : true if the body can be given to ma_api_wifi_form_decode()
+  */
+bool ma_api_wifi_http_has_form_body(const st_wifi_http_request_t *in_request)
+{
+    const uint16_t typeLength = sizeof(DF_HTTP_FORM_CONTENT_TYPE) - 1;
+
+    // Parameters such as "; charset=UTF-8" may follow the media type
+    return in_request->body.length > 0 && in_request->contentType.length >= typeLength &&
+           ma_api_wifi_http_name_equals(&in_request->buffer[in_request->contentType.offset], typeLength,
+                                        DF_HTTP_FORM_CONTENT_TYPE);
+}
+
+/**
+  * @Func       : ma_api_wifi_http_get_fields
+  * @brief      : Extracts fields from the query string and, for a form, from the body. A field found in
+  *               the query string is not read again from the body.
+  * @pre-cond.  : ma_api_wifi_http_parse() returned eWIFI_HTTP_PARSE_DONE
+  * @post-cond. : Values are in the field buffers, length is -1 for the fields not found and -2 for the
+  *               refused ones
+  * @parameters :
+  *       - in_request: The parsed request
+  *       - io_fields: The wanted fields
+  *       - in_fieldCount: Number of fields
+  * @retval     : Number of fields found
+  */
+uint8_t ma_api_wifi_http_get_fields(const st_wifi_http_request_t *in_request, st_wifi_form_field_t *io_fields, uint8_t in_fieldCount)
+{
+    uint8_t found = 0;
+
+    ma_api_wifi_form_clear(io_fields, in_fieldCount);
+    ma_api_wifi_form_decode(&in_request->buffer[in_request->query.offset], in_request->query.length, io_fields, in_fieldCount);
+    if (ma_api_wifi_http_has_form_body(in_request))
+    {
+        ma_api_wifi_form_decode(&in_request->buffer[in_request->body.offset], in_request->body.length, io_fields, in_fieldCount);
+    }
+
+    for (uint8_t i = 0; i < in_fieldCount; i++)
+    {
+        found += (io_fields[i].length >= 0) ? 1 : 0;
+    }
+    return found;
+}
+
+/**
+  * @Func       : ma_api_wifi_http_has_value
+  * @brief      : Checks if the query string or a form body has a key with a value, whatever it is. Tells a
+  *               field that is absent or empty from one refused by ma_api_wifi_http_get_fields() for being
+  *               too long.
+  * @pre-cond.  : ma_api_wifi_http_parse() returned eWIFI_HTTP_PARSE_DONE
+  * @post-cond. : None
+  * @parameters :
+  *       - in_request: The parsed request
+  *       - in_key: Field name, null terminated
+  * @retval     : true if the key was received with a value
+  */
+bool ma_api_wifi_http_has_value(const st_wifi_http_request_t *in_request, const char *in_key)
+{
+    return ma_api_wifi_form_has_value(&in_request->buffer[in_request->query.offset], in_request->query.length, in_key) ||
+           (ma_api_wifi_http_has_form_body(in_request) &&
+            ma_api_wifi_form_has_value(&in_request->buffer[in_request->body.offset], in_request->body.length, in_key));
+}
+
+/**
+  * @Func       : ma_api_wifi_form_clear
+  * @brief      : Marks all fields as not found
+  * @pre-cond.  : None
+  * @post-cond. : length of every field is -1 and its value is empty
+  * @parameters :
+  *       - io_fields: The fields to be cleared
+  *       - in_fieldCount: Number of fields
+  * @retval     : None
+  */
+void ma_api_wifi_form_clear(st_wifi_form_field_t *io_fields, uint8_t in_fieldCount)
+{
+    for (uint8_t i = 0; i < in_fieldCount; i++)
+    {
+        io_fields[i].length = -1;
+        if (io_fields[i].size > 0)
+        {
+            io_fields[i].value[0] = '\0';
+        }
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_form_decode
+  * @brief      : Decodes "key=value&key=value" data in a single pass. Keys and values are percent-decoded
+  *               and '+' is read as a space. Only the wanted fields are copied.
+  * @pre-cond.  : ma_api_wifi_form_clear() must be called before the first source is decoded
+  * @post-cond. : Fields found are filled. A field already found is not overwritten, so the query
+  *               string and the body can be decoded one after the other into the same fields.
+  *               A value that does not fit in its buffer, or that contains a null byte, is refused:
+  *               length is -2 and the later pairs with the same key are skipped too.
+  * @parameters :
+  *       - in_data: The data to be decoded, not null terminated
+  *       - in_length: Length of the data
+  *       - io_fields: The wanted fields
+  *       - in_fieldCount: Number of fields
+  * @retval     : Number of fields found in this call
+  */
+uint8_t ma_api_wifi_form_decode(const char *in_data, uint16_t in_length, st_wifi_form_field_t *io_fields, uint8_t in_fieldCount)
+{
+    uint8_t found = 0;
+    const char *pair = in_data;
+    const char *end = in_data + in_length;
+
+    while (pair < end)
+    {
+        const char *pairEnd = (const char *)memchr(pair, '&', end - pair);
+        if (pairEnd == NULL)
+        {
+            pairEnd = end;
+        }
+
+        const char *equal = (const char *)memchr(pair, '=', pairEnd - pair);
+        const char *keyEnd = (equal != NULL) ? equal : pairEnd;
+        const char *value = (equal != NULL) ? equal + 1 : pairEnd;
+
+        char key[DF_FORM_MAX_KEY_LENGTH + 1];
+        int16_t keyLength = ma_api_wifi_form_percent_decode(pair, (uint16_t)(keyEnd - pair), key, sizeof(key));
+        for (uint8_t i = 0; keyLength > 0 && i < in_fieldCount; i++)
+        {
+            st_wifi_form_field_t *field = &io_fields[i];
+            if (field->length == -1 && strcmp(field->key, key) == 0)
+            {
+                field->length = ma_api_wifi_form_percent_decode(value, (uint16_t)(pairEnd - value), field->value, field->size);
+                if (field->length < 0)
+                {
+                    // Seen: "ssid=<too long>&ssid=x" must not be read as "x"
+                    field->length = -2;
+                    field->value[0] = '\0';
+                    break;
+                }
+                found++;
+                break;
+            }
+        }
+
+        pair = pairEnd + 1;
+    }
+
+    return found;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_http_parse_request_line
+  * @brief      : Splits "METHOD /path?query HTTP/1.x" into method, path and query spans
+  * @pre-cond.  : None
+  * @post-cond. : method, path and query spans are set
+  * @parameters :
+  *       - io_request: The request being received
+  *       - in_start: Offset of the first byte of the line
+  *       - in_end: Offset of the line end, without CR LF
+  * @retval     : false if the line is malformed
+  */
+static bool ma_api_wifi_http_parse_request_line(st_wifi_http_request_t *io_request, uint16_t in_start, uint16_t in_end)
+{
+    const char *line = &io_request->buffer[in_start];
+    uint16_t length = in_end - in_start;
+
+    const char *methodEnd = (const char *)memchr(line, ' ', length);
+    if (methodEnd == NULL || methodEnd == line)
+    {
+        return false;
+    }
+
+    const char *target = methodEnd + 1;
+    const char *targetEnd = (const char *)memchr(target, ' ', (line + length) - target);
+    if (targetEnd == NULL || targetEnd == target || *target != '/')
+    {
+        return false;
+    }
+
+    io_request->method.offset = in_start;
+    io_request->method.length = (uint16_t)(methodEnd - line);
+
+    const char *queryStart = (const char *)memchr(target, '?', targetEnd - target);
+    io_request->path.offset = (uint16_t)(target - io_request->buffer);
+    if (queryStart != NULL)
+    {
+        io_request->path.length = (uint16_t)(queryStart - target);
+        io_request->query.offset = (uint16_t)(queryStart + 1 - io_request->buffer);
+        io_request->query.length = (uint16_t)(targetEnd - queryStart - 1);
+    }
+    else
+    {
+        io_request->path.length = (uint16_t)(targetEnd - target);
+    }
+
+    // Persistent by default in HTTP/1.1 (RFC 9112, 9.3). HTTP/1.0 and anything unknown need "keep-alive".
+    const char *version = targetEnd + 1;
+    io_request->keepAlive = (line + length) - version == sizeof(DF_HTTP_VERSION_1_1) - 1 &&
+                            memcmp(version, DF_HTTP_VERSION_1_1, sizeof(DF_HTTP_VERSION_1_1) - 1) == 0;
+
+    return true;
+}
+
+/**
+  * @Func       : ma_api_wifi_http_parse_header
+  * @brief      : Parses one "Name: value" header line and keeps the headers used by the portal. The body is
+  *               framed by Content-Length only: a request with Transfer-Encoding is refused, since a body
+  *               the parser does not frame would be read as the next request.
+  * @pre-cond.  : None
+  * @post-cond. : contentLength is set when the header is Content-Length
+  * @parameters :
+  *       - io_request: The request being received
+  *       - in_start: Offset of the first byte of the line
+  *       - in_end: Offset of the line end, without CR LF
+  * @retval     : eWIFI_HTTP_PARSE_INCOMPLETE when the line is accepted, eWIFI_HTTP_PARSE_BAD_REQUEST if it is
+  *               malformed, eWIFI_HTTP_PARSE_NOT_IMPLEMENTED for Transfer-Encoding
+  */
+static e_wifi_http_parse_result_t ma_api_wifi_http_parse_header(st_wifi_http_request_t *io_request, uint16_t in_start, uint16_t in_end)
+{
+    const char *line = &io_request->buffer[in_start];
+    uint16_t length = in_end - in_start;
+
+    const char *colon = (const char *)memchr(line, ':', length);
+    if (colon == NULL || colon == line)
+    {
+        return eWIFI_HTTP_PARSE_BAD_REQUEST;
+    }
+
+    uint16_t nameLength = (uint16_t)(colon - line);
+    const char *value = colon + 1;
+    const char *valueEnd = line + length;
+    while (value < valueEnd && (*value == ' ' || *value == '\t'))
+    {
+        value++;
+    }
+    while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t'))
+    {
+        valueEnd--;
+    }
+
+    if (ma_api_wifi_http_name_equals(line, nameLength, DF_HTTP_CONTENT_LENGTH))
+    {
+        if (!ma_api_wifi_http_parse_content_length(io_request, value, valueEnd))
+        {
+            return eWIFI_HTTP_PARSE_BAD_REQUEST;
+        }
+    }
+    else if (ma_api_wifi_http_name_equals(line, nameLength, DF_HTTP_TRANSFER_ENCODING))
+    {
+        return eWIFI_HTTP_PARSE_NOT_IMPLEMENTED;
+    }
+    else if (ma_api_wifi_http_name_equals(line, nameLength, DF_HTTP_CONTENT_TYPE))
+    {
+        io_request->contentType.offset = (uint16_t)(value - io_request->buffer);
+        io_request->contentType.length = (uint16_t)(valueEnd - value);
+    }
+    else if (ma_api_wifi_http_name_equals(line, nameLength, DF_HTTP_IF_NONE_MATCH))
+    {
+        io_request->ifNoneMatch.offset = (uint16_t)(value - io_request->buffer);
+        io_request->ifNoneMatch.length = (uint16_t)(valueEnd - value);
+    }
+    else if (ma_api_wifi_http_name_equals(line, nameLength, DF_HTTP_CONNECTION))
+    {
+        ma_api_wifi_http_parse_connection(io_request, value, valueEnd);
+    }
+
+    return eWIFI_HTTP_PARSE_INCOMPLETE;
+}
+
+/**
+  * @Func       : ma_api_wifi_http_parse_content_length
+  * @brief      : Reads the value of a Content-Length header. Only digits are accepted, and a second header
+  *               must give the same length (RFC 9112, 6.3): a length read differently by a proxy in front
+  *               would put a request in the body of another one.
+  * @pre-cond.  : The value has no leading or trailing white space
+  * @post-cond. : contentLength and hasContentLength are set
+  * @parameters :
+  *       - io_request: The request being received
+  *       - in_value: First byte of the value
+  *       - in_valueEnd: End of the value
+  * @retval     : false if the value is empty, is not a number, or differs from an earlier Content-Length
+  */
+static bool ma_api_wifi_http_parse_content_length(st_wifi_http_request_t *io_request, const char *in_value, const char *in_valueEnd)
+{
+    uint32_t contentLength = 0;
+
+    if (in_value == in_valueEnd)
+    {
+        return false;
+    }
+    for (; in_value < in_valueEnd; in_value++)
+    {
+        if (*in_value < '0' || *in_value > '9')
+        {
+            return false;
+        }
+        contentLength = contentLength * 10 + (*in_value - '0');
+        if (contentLength > DF_HTTP_MAX_REQUEST_SIZE)
+        {
+            contentLength = DF_HTTP_MAX_REQUEST_SIZE; // Will be refused as too large
+        }
+    }
+
+    if (io_request->hasContentLength && io_request->contentLength != contentLength)
+    {
+        return false;
+    }
+    io_request->contentLength = (uint16_t)contentLength;
+    io_request->hasContentLength = true;
+    return true;
+}
+
+/**
+  * @Func       : ma_api_wifi_http_name_equals
+  * @brief      : Case insensitive comparison of a header name
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_name: Header name in the buffer, not null terminated
+  *       - in_length: Length of the header name
+  *       - in_lowerText: Expected name in lower case
+  * @retval     : true if the names are equal
+  */
+static bool ma_api_wifi_http_name_equals(const char *in_name, uint16_t in_length, const char *in_lowerText)
+{
+    for (uint16_t i = 0; i < in_length; i++)
+    {
+        char c = in_name[i];
+        if (c >= 'A' && c <= 'Z')
+        {
+            c = c - 'A' + 'a';
+        }
+        if (in_lowerText[i] == '\0' || c != in_lowerText[i])
+        {
+            return false;
+        }
+    }
+    return in_lowerText[in_length] == '\0';
+}
+
+/**
+  * @Func       : ma_api_wifi_http_parse_connection
+  * @brief      : Reads the comma separated options of the Connection header, "close" and "keep-alive"
+  * @pre-cond.  : The request line was parsed, it sets the default of the version
+  * @post-cond. : keepAlive updated
+  * @parameters :
+  *       - io_request: The request being received
+  *       - in_value: First byte of the value
+  *       - in_valueEnd: End of the value
+  * @retval     : None
+  */
+static void ma_api_wifi_http_parse_connection(st_wifi_http_request_t *io_request, const char *in_value, const char *in_valueEnd)
+{
+    while (in_value < in_valueEnd)
+    {
+        const char *optionEnd = (const char *)memchr(in_value, ',', in_valueEnd - in_value);
+        const char *next = (optionEnd != NULL) ? optionEnd + 1 : in_valueEnd;
+        if (optionEnd == NULL)
+        {
+            optionEnd = in_valueEnd;
+        }
+        while (in_value < optionEnd && (*in_value == ' ' || *in_value == '\t'))
+        {
+            in_value++;
+        }
+        while (optionEnd > in_value && (optionEnd[-1] == ' ' || optionEnd[-1] == '\t'))
+        {
+            optionEnd--;
+        }
+
+        if (ma_api_wifi_http_name_equals(in_value, (uint16_t)(optionEnd - in_value), "close"))
+        {
+            io_request->keepAlive = false;
+            return;     // close wins over any other option
+        }
+        else if (ma_api_wifi_http_name_equals(in_value, (uint16_t)(optionEnd - in_value), "keep-alive"))
+        {
+            io_request->keepAlive = true;
+        }
+        in_value = next;
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_form_percent_decode
+  * @brief      : Percent-decodes one key or value of form data. '+' is read as a space and a '%'
+  *               that is not followed by two hex digits is kept as it is.
+  * @pre-cond.  : None
+  * @post-cond. : out_value is null terminated when the decoded text fits
+  * @parameters :
+  *       - in_data: Encoded text, not null terminated
+  *       - in_length: Length of the encoded text
+  *       - out_value: Buffer that receives the decoded text
+  *       - in_size: Size of out_value, including the terminator
+  * @retval     : Decoded length, or -1 if it does not fit or has a null byte
+  */
+static int16_t ma_api_wifi_form_percent_decode(const char *in_data, uint16_t in_length, char *out_value, uint16_t in_size)
+{
+    uint16_t written = 0;
+
+    for (uint16_t i = 0; i < in_length; i++)
+    {
+        char c = in_data[i];
+        if (c == '+')
+        {
+            c = ' ';
+        }
+        else if (c == '%' && i + 2 < in_length)
+        {
+            int8_t high = ma_api_wifi_form_hex_value(in_data[i + 1]);
+            int8_t low = ma_api_wifi_form_hex_value(in_data[i + 2]);
+            if (high >= 0 && low >= 0)
+            {
+                c = (char)((high << 4) | low);
+                i += 2;
+                if (c == '\0')
+                {
+                    return -1;
+                }
+            }
+        }
+
+        if (written + 1 >= in_size)
+        {
+            return -1;
+        }
+        out_value[written++] = c;
+    }
+
+    out_value[written] = '\0';
+    return (int16_t)written;
+}
+
+/**
+  * @Func       : ma_api_wifi_form_has_value
+  * @brief      : Looks for a key with a non-empty value in "key=value&key=value" data, keys are
+  *               percent-decoded
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_data: The data, not null terminated
+  *       - in_length: Length of the data
+  *       - in_key: The key, null terminated
+  * @retval     : true if a pair has the key and a value
+  */
+static bool ma_api_wifi_form_has_value(const char *in_data, uint16_t in_length, const char *in_key)
+{
+    const char *pair = in_data;
+    const char *end = in_data + in_length;
+
+    while (pair < end)
+    {
+        const char *pairEnd = (const char *)memchr(pair, '&', end - pair);
+        if (pairEnd == NULL)
+        {
+            pairEnd = end;
+        }
+        const char *keyEnd = (const char *)memchr(pair, '=', pairEnd - pair);
+
+        char key[DF_FORM_MAX_KEY_LENGTH + 1];
+        if (keyEnd != NULL && keyEnd + 1 < pairEnd &&
+            ma_api_wifi_form_percent_decode(pair, (uint16_t)(keyEnd - pair), key, sizeof(key)) > 0 && strcmp(key, in_key) == 0)
+        {
+            return true;
+        }
+        pair = pairEnd + 1;
+    }
+    return false;
+}
+
+/**
+  * @Func       : ma_api_wifi_form_hex_value
+  * @brief      : Converts one hexadecimal digit
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_char: The digit
+  * @retval     : Value from 0 to 15, or -1 if in_char is not a hexadecimal digit
+  */
+static int8_t ma_api_wifi_form_hex_value(char in_char)
+{
+    if (in_char >= '0' && in_char <= '9')
+    {
+        return in_char - '0';
+    }
+    if (in_char >= 'a' && in_char <= 'f')
+    {
+        return in_char - 'a' + 10;
+    }
+    if (in_char >= 'A' && in_char <= 'F')
+    {
+        return in_char - 'A' + 10;
+    }
+    return -1;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,86 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_http.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the HTTP request parser used by the WiFi portal
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_HTTP_H
+#define __MA_API_WIFI_HTTP_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Define --------------------------------------------------------------------*/
+#ifndef DF_HTTP_MAX_REQUEST_SIZE
+#define DF_HTTP_MAX_REQUEST_SIZE        1536    // Hard cap of request line + headers + body
+#endif
+
+/* Typedef -------------------------------------------------------------------*/
+typedef enum {
+  eWIFI_HTTP_PARSE_INCOMPLETE = 0,  // More bytes are needed
+  eWIFI_HTTP_PARSE_DONE,            // Request line, headers and body are complete
+  eWIFI_HTTP_PARSE_BAD_REQUEST,     // Malformed request, or a body length that can not be trusted
+  eWIFI_HTTP_PARSE_TOO_LARGE,       // Request does not fit in DF_HTTP_MAX_REQUEST_SIZE
+  eWIFI_HTTP_PARSE_NOT_IMPLEMENTED  // Transfer-Encoding, the body is framed by Content-Length only
+}e_wifi_http_parse_result_t;
+
+typedef enum {
+  eWIFI_HTTP_STAGE_REQUEST_LINE = 0,
+  eWIFI_HTTP_STAGE_HEADERS,
+  eWIFI_HTTP_STAGE_BODY,
+  eWIFI_HTTP_STAGE_DONE
+}e_wifi_http_stage_t;
+
+// Position of a token inside the receive buffer
+typedef struct {
+  uint16_t offset;
+  uint16_t length;
+}st_wifi_http_span_t;
+
+typedef struct {
+  char buffer[DF_HTTP_MAX_REQUEST_SIZE];
+  uint16_t length;                  // Bytes stored in buffer
+  uint16_t parsed;                  // Bytes already scanned by the parser
+  uint16_t lineStart;               // Start of the line being scanned
+  uint16_t contentLength;           // Value of the Content-Length header
+  bool hasContentLength;            // A Content-Length header was received, another one must be equal
+  e_wifi_http_stage_t stage;
+  bool keepAlive;                   // HTTP/1.1 without "Connection: close", or HTTP/1.0 with "Connection: keep-alive"
+  st_wifi_http_span_t method;
+  st_wifi_http_span_t path;
+  st_wifi_http_span_t query;        // Without the leading '?'
+  st_wifi_http_span_t contentType;
+  st_wifi_http_span_t ifNoneMatch;
+  st_wifi_http_span_t body;
+}st_wifi_http_request_t;
+
+// Field to be extracted by ma_api_wifi_form_decode()
+typedef struct {
+  const char *key;                  // Field name, null terminated
+  char *value;                      // Caller buffer that receives the decoded value, null terminated
+  uint16_t size;                    // Size of the value buffer, including the terminator
+  int16_t length;                   // Decoded length, -1 while the field was not found, -2 if its value was refused
+}st_wifi_form_field_t;
+
+/* Public objects ------------------------------------------------------------*/
+extern void ma_api_wifi_http_reset(st_wifi_http_request_t *out_request);
+extern char *ma_api_wifi_http_get_rx_buffer(st_wifi_http_request_t *in_request, uint16_t *out_space);
+extern e_wifi_http_parse_result_t ma_api_wifi_http_parse(st_wifi_http_request_t *io_request, uint16_t in_received);
+extern e_wifi_http_parse_result_t ma_api_wifi_http_next(st_wifi_http_request_t *io_request);
+extern bool ma_api_wifi_http_span_equals(const st_wifi_http_request_t *in_request, st_wifi_http_span_t in_span, const char *in_text);
+extern bool ma_api_wifi_http_etag_matches(const st_wifi_http_request_t *in_request, const char *in_etag);
+extern bool ma_api_wifi_http_has_form_body(const st_wifi_http_request_t *in_request);
+extern bool ma_api_wifi_http_has_value(const st_wifi_http_request_t *in_request, const char *in_key);
+extern void ma_api_wifi_form_clear(st_wifi_form_field_t *io_fields, uint8_t in_fieldCount);
+extern uint8_t ma_api_wifi_http_get_fields(const st_wifi_http_request_t *in_request, st_wifi_form_field_t *io_fields, uint8_t in_fieldCount);
+extern uint8_t ma_api_wifi_form_decode(const char *in_data, uint16_t in_length, st_wifi_form_field_t *io_fields, uint8_t in_fieldCount);
+
+#endif /* __MA_API_WIFI_HTTP_H */
+/*****************************END OF FILE**************************************/
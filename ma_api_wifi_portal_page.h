@@ -0,0 +1,175 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_portal_page.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Portal page, gzip-compressed. GENERATED FILE, DO NOT EDIT.
+    *               Edit portal/index.html and run tools/build_portal_page.py
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_PORTAL_PAGE_H
+#define __MA_API_WIFI_PORTAL_PAGE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Define --------------------------------------------------------------------*/
+#define DF_PORTAL_PAGE_ETAG             "\"739722c653bb85ec\""
+#define DF_PORTAL_PAGE_RAW_SIZE         6385      // Size before compression
+
+/* Public objects ------------------------------------------------------------*/
+static constexpr uint8_t u8PortalPageGzip[2322] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x59, 0x7b, 0x6f, 0x1b, 0x37,
+  0x12, 0xff, 0x5f, 0x9f, 0x62, 0xa2, 0x03, 0xb2, 0x12, 0x2a, 0x4b, 0xb2, 0x1b, 0x1f, 0xae, 0x7a,
+  0xb8, 0x70, 0xfd, 0x40, 0x0c, 0xc4, 0x8d, 0x11, 0xa7, 0x57, 0x1c, 0x0e, 0x87, 0x80, 0xda, 0xa5,
+  0x24, 0xc6, 0x5c, 0x72, 0x4b, 0x72, 0xa5, 0xe8, 0x02, 0x7f, 0x98, 0xe2, 0x3e, 0x4a, 0xbe, 0xd8,
+  0xcd, 0x90, 0xdc, 0xd5, 0xca, 0xaf, 0x38, 0xed, 0x9d, 0xfe, 0xb0, 0xb4, 0xe4, 0x70, 0x38, 0xcf,
+  0xdf, 0xcc, 0xac, 0x27, 0x2f, 0x4e, 0xdf, 0x9e, 0xbc, 0xff, 0xc7, 0xd5, 0x19, 0x2c, 0x5d, 0x2e,
+  0x8f, 0x26, 0xfe, 0x6f, 0x6b, 0xb2, 0xe4, 0x2c, 0x3b, 0x9a, 0xe4, 0xdc, 0x31, 0x48, 0x97, 0xcc,
+  0x58, 0xee, 0xa6, 0xed, 0xd2, 0xcd, 0xf7, 0xfe, 0xd6, 0x8e, 0xab, 0x8a, 0xe5, 0x7c, 0xda, 0x5e,
+  0x09, 0xbe, 0x2e, 0xb4, 0x71, 0x6d, 0x48, 0xb5, 0x72, 0x5c, 0x21, 0xd5, 0x5a, 0x64, 0x6e, 0x39,
+  0xcd, 0xf8, 0x4a, 0xa4, 0x7c, 0xcf, 0x3f, 0xf4, 0x40, 0x28, 0xe1, 0x04, 0x93, 0x7b, 0x36, 0x65,
+  0x92, 0x4f, 0xf7, 0xdb, 0x78, 0x81, 0x14, 0xea, 0x06, 0x0c, 0x97, 0xd3, 0xb6, 0xc0, 0xa3, 0x6d,
+  0x58, 0x1a, 0x3e, 0x9f, 0xb6, 0x33, 0xe6, 0xd8, 0xa8, 0x47, 0xfb, 0xd6, 0x6d, 0x24, 0x3f, 0x22,
+  0x69, 0xe0, 0x33, 0xcc, 0x91, 0xf9, 0xde, 0x9c, 0xe5, 0x42, 0x6e, 0x46, 0xf0, 0x9a, 0xcb, 0x15,
+  0x77, 0x22, 0x65, 0x63, 0xc8, 0x84, 0x2d, 0x24, 0xc3, 0x35, 0xa1, 0x90, 0x1f, 0xdf, 0x9b, 0x49,
+  0x9d, 0xde, 0x8c, 0x21, 0x67, 0x66, 0x21, 0xd4, 0x08, 0x86, 0xc5, 0x27, 0x60, 0xa5, 0xd3, 0x63,
+  0x70, 0xfc, 0x93, 0xdb, 0x63, 0x52, 0x2c, 0x70, 0x35, 0x45, 0x31, 0xb9, 0x19, 0xdf, 0xb6, 0xfa,
+  0xb3, 0xd2, 0x39, 0xad, 0x90, 0xff, 0x8c, 0xa5, 0x37, 0x0b, 0xa3, 0x4b, 0x95, 0xed, 0xa5, 0x5a,
+  0x6a, 0x33, 0x82, 0xbf, 0xbc, 0x3a, 0x39, 0x3e, 0x3f, 0x1c, 0x8e, 0x61, 0xa6, 0x4d, 0xc6, 0x71,
+  0x41, 0x69, 0xc5, 0xc7, 0x10, 0x77, 0xd7, 0x4b, 0xe1, 0xf0, 0xa9, 0x60, 0x59, 0x26, 0xd4, 0x62,
+  0x04, 0xfb, 0x7f, 0xc5, 0x9b, 0x5e, 0xe1, 0x75, 0xe3, 0x96, 0xbf, 0x29, 0xe3, 0xa9, 0x36, 0xcc,
+  0x09, 0xad, 0xaa, 0x83, 0x5e, 0x03, 0x2b, 0xfe, 0xcd, 0x47, 0xf0, 0x3d, 0xd1, 0xd5, 0x32, 0x1e,
+  0xd0, 0x43, 0x5a, 0x1a, 0x4b, 0x7c, 0x0b, 0x2d, 0x76, 0x65, 0x3b, 0x80, 0xcf, 0x0f, 0xc8, 0x76,
+  0xe8, 0x3f, 0xe3, 0xdb, 0xc9, 0x20, 0x58, 0x69, 0x32, 0xf0, 0xee, 0x6a, 0x4d, 0x66, 0x3a, 0xdb,
+  0xa0, 0x0b, 0xf7, 0x8f, 0xae, 0xf5, 0xcc, 0x70, 0x61, 0x34, 0x5c, 0x6a, 0x34, 0xbd, 0x36, 0x48,
+  0xb1, 0x8f, 0xfb, 0x73, 0x6d, 0x72, 0x10, 0xd9, 0xb4, 0x4d, 0x3f, 0xae, 0x99, 0x5c, 0x31, 0xd3,
+  0x06, 0x96, 0x92, 0xa0, 0xd3, 0xf6, 0xc0, 0xb2, 0x15, 0xff, 0x40, 0x1e, 0x68, 0x03, 0xba, 0x78,
+  0xa9, 0x91, 0xae, 0xd0, 0xd6, 0x91, 0x37, 0x8a, 0xa3, 0x53, 0xb1, 0x40, 0x9d, 0x41, 0xc3, 0xf5,
+  0xf5, 0xc5, 0xe9, 0x08, 0x26, 0x83, 0xc2, 0x2f, 0x4f, 0x84, 0x2a, 0x4a, 0x07, 0x6e, 0x53, 0x60,
+  0x34, 0x90, 0xee, 0xed, 0x18, 0x19, 0xd6, 0x8a, 0xac, 0xed, 0xef, 0x0a, 0xbf, 0xa4, 0xb0, 0x18,
+  0x1c, 0x8a, 0xbb, 0xb5, 0x36, 0x37, 0xb6, 0xed, 0xfd, 0x92, 0xea, 0xbc, 0x90, 0xdc, 0x21, 0xb5,
+  0x9e, 0xcf, 0x31, 0xb0, 0x3c, 0x4f, 0x12, 0x80, 0x88, 0xfd, 0xd9, 0x9a, 0x1e, 0x37, 0xab, 0x0d,
+  0xba, 0x37, 0x30, 0x4e, 0x99, 0xba, 0x50, 0x73, 0x5d, 0x9d, 0xac, 0x85, 0x64, 0x70, 0x7d, 0xf6,
+  0xf3, 0xeb, 0xe3, 0x47, 0xa4, 0x2c, 0x98, 0xb5, 0xc8, 0x34, 0xab, 0x24, 0xdd, 0x3e, 0x13, 0xd3,
+  0xfa, 0x29, 0x32, 0x8d, 0x31, 0x12, 0x8e, 0x86, 0x87, 0x36, 0x68, 0x95, 0x4a, 0x91, 0xde, 0xa0,
+  0xc6, 0x7a, 0xb1, 0x90, 0xfc, 0x2a, 0x9e, 0xf9, 0xbb, 0xb0, 0x62, 0x26, 0xa4, 0x70, 0x9b, 0x4e,
+  0xb7, 0x7d, 0x74, 0x89, 0xb6, 0x33, 0xcc, 0x0c, 0xde, 0xa6, 0xa5, 0x74, 0xcc, 0xc0, 0x35, 0x57,
+  0x4b, 0x36, 0x19, 0x04, 0x1e, 0x5e, 0x89, 0x54, 0xe2, 0x41, 0xbc, 0xd2, 0xe8, 0xb9, 0x90, 0xdc,
+  0xbe, 0x55, 0x72, 0xd3, 0x3e, 0xba, 0x32, 0x42, 0x1b, 0x91, 0xb1, 0x8c, 0x43, 0x67, 0x88, 0xaa,
+  0x1c, 0x1c, 0x1e, 0x76, 0x6b, 0x4d, 0x1e, 0x3e, 0xb2, 0xa3, 0x9e, 0x2a, 0xf3, 0x19, 0x37, 0x51,
+  0x19, 0xcf, 0xcb, 0x6d, 0xd0, 0xa1, 0x02, 0x3d, 0x3c, 0xc4, 0x6f, 0xf6, 0x69, 0xda, 0x46, 0x96,
+  0x6d, 0x58, 0x31, 0x59, 0x22, 0xf9, 0xfe, 0x70, 0xb8, 0xb5, 0xdf, 0x0e, 0x23, 0x5b, 0xce, 0x72,
+  0xe1, 0x6a, 0xc2, 0x18, 0x2e, 0x47, 0xf0, 0xb0, 0x49, 0x1e, 0x12, 0x6c, 0x6b, 0x27, 0x4c, 0x94,
+  0xab, 0xb0, 0x43, 0x96, 0x39, 0xce, 0x44, 0x8a, 0x21, 0x87, 0x36, 0x31, 0x3c, 0xe3, 0xb5, 0x49,
+  0x82, 0x14, 0x03, 0x8a, 0xcd, 0xad, 0x8f, 0x1d, 0x73, 0xa5, 0xad, 0x24, 0x5c, 0x1e, 0x3c, 0x6c,
+  0x80, 0x77, 0xc8, 0xc6, 0x82, 0x25, 0x09, 0x2d, 0x86, 0xfa, 0x01, 0x92, 0x96, 0x32, 0x5a, 0x20,
+  0xd0, 0xb5, 0x1f, 0xb1, 0xdc, 0xa0, 0x24, 0xb4, 0xb3, 0xa9, 0x11, 0x05, 0x06, 0xd6, 0xbc, 0x54,
+  0x3e, 0x19, 0xe0, 0x71, 0xbf, 0xc2, 0xe7, 0x16, 0xa0, 0x49, 0x0c, 0x54, 0x81, 0x72, 0x2e, 0xb8,
+  0xcc, 0x60, 0x0a, 0x99, 0x4e, 0xcb, 0x1c, 0xa1, 0xa5, 0xbf, 0xe0, 0xee, 0x4c, 0x72, 0xfa, 0xf9,
+  0xd3, 0xe6, 0x22, 0xeb, 0x24, 0x15, 0x61, 0xd2, 0x1d, 0xe3, 0x51, 0x31, 0x87, 0xce, 0xce, 0xd1,
+  0x3e, 0xd9, 0x11, 0xa6, 0xd3, 0x29, 0x34, 0x28, 0xfd, 0x2d, 0x00, 0x0f, 0x11, 0x42, 0x42, 0x69,
+  0x96, 0x10, 0xaf, 0x5b, 0xe0, 0xd2, 0xf2, 0x27, 0x69, 0x6b, 0x96, 0x9e, 0xbe, 0x75, 0xdb, 0x6a,
+  0x0d, 0x06, 0xf0, 0x7e, 0xc9, 0x91, 0x7c, 0xc1, 0x41, 0x58, 0x48, 0x59, 0xba, 0xe4, 0x19, 0xcc,
+  0x36, 0xe0, 0x70, 0x75, 0x66, 0xf4, 0xda, 0x72, 0xd3, 0xf3, 0x0f, 0x84, 0x07, 0x19, 0xc4, 0x14,
+  0x44, 0xe8, 0xcb, 0xd1, 0xc6, 0x73, 0xa3, 0x73, 0x0c, 0x4a, 0xcb, 0x0b, 0x86, 0x00, 0xc7, 0x81,
+  0xab, 0xcc, 0x83, 0x56, 0x6b, 0xce, 0x5d, 0xba, 0xec, 0x24, 0x83, 0x94, 0x5c, 0xaa, 0x08, 0xed,
+  0x6d, 0xff, 0xa3, 0xd5, 0x2a, 0xe9, 0xf6, 0x91, 0x97, 0xea, 0x54, 0xa6, 0xed, 0x18, 0x6e, 0x0b,
+  0xad, 0x2c, 0x0f, 0x3a, 0x1a, 0xee, 0x4a, 0xa3, 0xa0, 0x5a, 0xf4, 0x47, 0x3a, 0x68, 0xa8, 0xdb,
+  0xbb, 0xc7, 0x1a, 0x7c, 0xc3, 0xc9, 0x47, 0xed, 0x4d, 0x78, 0x83, 0xb7, 0xfa, 0xb0, 0x45, 0x13,
+  0x34, 0x05, 0xa2, 0x2d, 0x32, 0x44, 0xb4, 0x41, 0x28, 0x52, 0xa8, 0xe1, 0x8a, 0x1b, 0x54, 0x49,
+  0x65, 0xb6, 0xa1, 0x77, 0x65, 0xb9, 0x1e, 0x30, 0x05, 0x3c, 0x2f, 0xdc, 0x06, 0xe6, 0xde, 0xd5,
+  0x37, 0x9c, 0x17, 0x16, 0x84, 0x8b, 0xce, 0x6c, 0xf2, 0x5f, 0x32, 0x5b, 0xc5, 0x4c, 0xe5, 0xc2,
+  0x67, 0x84, 0x45, 0x1f, 0x6b, 0x58, 0xca, 0x97, 0x5a, 0x62, 0xa1, 0x21, 0x9f, 0x79, 0xa0, 0x08,
+  0xd1, 0xdc, 0x43, 0x19, 0xc5, 0x27, 0x34, 0x73, 0x8e, 0xae, 0x61, 0x2a, 0xd5, 0x40, 0x76, 0xc7,
+  0x2c, 0xa6, 0x32, 0x51, 0xf9, 0xb4, 0xdb, 0x4f, 0x19, 0x19, 0xbf, 0xb6, 0x15, 0xde, 0x7d, 0x8b,
+  0x36, 0x24, 0x57, 0x5f, 0x37, 0x7d, 0x68, 0x47, 0x80, 0x89, 0x88, 0xcf, 0x4c, 0x65, 0x68, 0xf2,
+  0x5c, 0xd3, 0xde, 0x5a, 0x20, 0xd4, 0x63, 0xd2, 0xa3, 0x0b, 0x10, 0xa5, 0x1c, 0xd6, 0x33, 0x6f,
+  0x84, 0x60, 0x9b, 0x6d, 0x46, 0x48, 0xcd, 0xaa, 0x14, 0xb6, 0x31, 0x0b, 0x2a, 0x97, 0x57, 0x29,
+  0xf5, 0x1c, 0x7f, 0x07, 0x9b, 0xd5, 0xee, 0x0e, 0xe9, 0xed, 0xa3, 0xff, 0xd5, 0xf0, 0x55, 0x45,
+  0xe2, 0x1d, 0x74, 0x2e, 0x4c, 0xbe, 0x66, 0x06, 0x63, 0xb2, 0x14, 0xd2, 0xd5, 0x62, 0x9e, 0x9e,
+  0x7f, 0xf8, 0xf5, 0xe2, 0xfc, 0xe2, 0xc3, 0xf9, 0xd9, 0xf1, 0xfb, 0x5f, 0xde, 0x9d, 0x7d, 0xb8,
+  0x7a, 0xf7, 0xf6, 0xfc, 0xe2, 0xcd, 0xd9, 0x75, 0x8f, 0xa2, 0x12, 0x85, 0x97, 0xbc, 0x8e, 0x58,
+  0x8c, 0xee, 0x1b, 0x5e, 0xb8, 0xc8, 0xb2, 0x76, 0xc4, 0x6f, 0x25, 0x37, 0x9b, 0x6b, 0x2e, 0x79,
+  0x8a, 0x85, 0xf1, 0x58, 0xca, 0x4e, 0xd2, 0x6f, 0x82, 0x02, 0x2a, 0x80, 0x08, 0x74, 0xc6, 0x9a,
+  0x06, 0xe5, 0xc1, 0x71, 0x28, 0x1f, 0xc4, 0x9f, 0x7d, 0x5f, 0x79, 0xfb, 0xb1, 0x01, 0x21, 0xaf,
+  0x51, 0x9d, 0x4f, 0xc6, 0x70, 0xeb, 0xb3, 0x9c, 0x3e, 0x31, 0xb4, 0xff, 0xf9, 0xaf, 0xb0, 0x70,
+  0xdb, 0x6a, 0x2c, 0xde, 0x8b, 0x77, 0xdc, 0xbf, 0x6b, 0xb8, 0x4a, 0xa8, 0xca, 0x2a, 0x04, 0x3a,
+  0xbe, 0x30, 0x3e, 0x85, 0x35, 0xf1, 0x4c, 0x12, 0xa5, 0x20, 0xfa, 0xbe, 0x50, 0x8a, 0x9b, 0xd7,
+  0xef, 0x2f, 0xdf, 0x90, 0x98, 0x49, 0xd8, 0xa8, 0x7d, 0x76, 0x4f, 0xd7, 0xb8, 0xb3, 0xf5, 0x05,
+  0xdd, 0x8b, 0x55, 0x35, 0x6f, 0xde, 0x8b, 0x41, 0x8f, 0xd9, 0x1f, 0xaf, 0xee, 0x24, 0x52, 0x24,
+  0xb5, 0xda, 0x44, 0xda, 0x27, 0x88, 0x3a, 0x09, 0x1d, 0x21, 0x1e, 0x8b, 0x2c, 0x7d, 0xfa, 0xc1,
+  0x77, 0x90, 0x20, 0x02, 0x6e, 0x8b, 0x5c, 0x82, 0x2b, 0x15, 0x41, 0x55, 0xaf, 0x88, 0xa8, 0x0b,
+  0xc9, 0xb8, 0x21, 0x41, 0x08, 0xd7, 0x27, 0x64, 0x08, 0x45, 0x24, 0x69, 0x98, 0x9f, 0x0e, 0xd4,
+  0x40, 0x18, 0xb7, 0xef, 0xee, 0xee, 0xc8, 0x99, 0xbc, 0xf3, 0xab, 0xe6, 0x2e, 0x55, 0x2c, 0x63,
+  0x48, 0xd1, 0x4c, 0xb1, 0x48, 0x73, 0x2f, 0x0f, 0x3e, 0x64, 0x9c, 0x9a, 0x9a, 0x1f, 0x49, 0xdb,
+  0x29, 0x69, 0xc7, 0x31, 0x6f, 0x33, 0xfe, 0xcb, 0xbb, 0x8b, 0x13, 0xec, 0x77, 0x30, 0x4a, 0x50,
+  0xda, 0xa6, 0x45, 0xba, 0xd1, 0xf1, 0xcd, 0x0c, 0xab, 0xb5, 0xb8, 0xdd, 0x31, 0x2b, 0x2b, 0x0a,
+  0x44, 0xa9, 0x93, 0xa5, 0x90, 0x59, 0x27, 0xc8, 0x56, 0x13, 0x7a, 0x4f, 0x37, 0xf7, 0xe9, 0x40,
+  0xdc, 0xbd, 0xad, 0x02, 0xec, 0x61, 0x9c, 0xc0, 0xa2, 0x50, 0xa7, 0x79, 0xb3, 0x50, 0xd7, 0xa5,
+  0xae, 0x34, 0x92, 0xac, 0x53, 0x2b, 0x88, 0x44, 0x4f, 0x6a, 0xf7, 0x2c, 0x68, 0xee, 0xc2, 0x77,
+  0xb5, 0x05, 0xe9, 0x93, 0xbc, 0xac, 0x10, 0xf1, 0x9b, 0xd9, 0x36, 0xa0, 0xf4, 0x31, 0xd6, 0x31,
+  0xb0, 0xbe, 0x9d, 0x75, 0x3c, 0x58, 0xb3, 0x1e, 0xd7, 0xc0, 0x87, 0x56, 0x79, 0x0e, 0xd6, 0xbd,
+  0xa8, 0x73, 0x5d, 0xdf, 0x6c, 0xa3, 0x06, 0xe7, 0x20, 0x83, 0x41, 0x4b, 0xcd, 0x34, 0xf0, 0xd0,
+  0xae, 0x12, 0xe4, 0x62, 0x96, 0x21, 0xb0, 0x43, 0xc1, 0xa5, 0xc6, 0x1e, 0x5c, 0x69, 0x0b, 0x87,
+  0x58, 0xa1, 0x0d, 0xb6, 0xe8, 0xdc, 0x6c, 0xb3, 0x3a, 0x40, 0xc9, 0x2e, 0x22, 0x07, 0x0f, 0x7b,
+  0x67, 0xde, 0xdd, 0xa0, 0x3a, 0xf0, 0x73, 0xac, 0x00, 0xc0, 0xfc, 0x28, 0xd1, 0x80, 0xf8, 0x1e,
+  0x56, 0x3e, 0x43, 0x85, 0xc0, 0x97, 0x76, 0x5f, 0xff, 0xb0, 0xaf, 0x0e, 0x7d, 0x41, 0x1f, 0x7e,
+  0xc5, 0x58, 0xe2, 0x7e, 0x75, 0x2e, 0x0c, 0x62, 0x8f, 0xdf, 0x33, 0xa5, 0x0a, 0x95, 0x32, 0xf4,
+  0xe9, 0x36, 0x94, 0xc7, 0xfe, 0x6e, 0xb1, 0xb8, 0x46, 0xca, 0x3b, 0x85, 0x82, 0x0e, 0x3f, 0xaf,
+  0x48, 0x7c, 0x03, 0x4c, 0x12, 0xd3, 0x6f, 0x81, 0xc8, 0xaa, 0x16, 0x7e, 0x15, 0x22, 0xbd, 0xb4,
+  0x15, 0xf5, 0x7d, 0x9c, 0x8c, 0x3b, 0xbb, 0x38, 0xa9, 0x0b, 0xaf, 0xff, 0xe3, 0x28, 0x15, 0x08,
+  0xb6, 0x28, 0x15, 0x9e, 0xeb, 0x66, 0x25, 0x32, 0xad, 0x1b, 0x95, 0x06, 0x89, 0x64, 0x33, 0x2e,
+  0x1b, 0x24, 0x06, 0x69, 0x3c, 0x98, 0x66, 0x3f, 0xe5, 0x14, 0xd5, 0x9d, 0xfa, 0x2c, 0xc7, 0x71,
+  0x92, 0xc3, 0x8f, 0xa8, 0x08, 0x8c, 0x20, 0xc1, 0xc2, 0x88, 0xf3, 0x80, 0x63, 0xc9, 0xe3, 0x50,
+  0x11, 0x6e, 0xd8, 0x01, 0x8b, 0x10, 0xbb, 0xde, 0x04, 0xd8, 0x28, 0x5e, 0x5a, 0x78, 0x81, 0x25,
+  0x5a, 0x95, 0x52, 0x6e, 0xf5, 0x7d, 0x3c, 0xcb, 0xe3, 0x5c, 0x46, 0x5e, 0xde, 0xc1, 0xd7, 0x5d,
+  0x8b, 0x4a, 0xae, 0x16, 0x6e, 0xe9, 0x55, 0x30, 0xbe, 0x7f, 0xa7, 0xbc, 0x54, 0x38, 0x32, 0x65,
+  0xcc, 0xc2, 0xf2, 0xcb, 0xef, 0x54, 0x19, 0xea, 0x34, 0xbe, 0x64, 0x6e, 0xd9, 0xf7, 0xa1, 0xdb,
+  0x14, 0x6a, 0x00, 0x38, 0xbe, 0x0c, 0xbb, 0x9e, 0x87, 0x85, 0x0e, 0x7a, 0x00, 0x39, 0x95, 0xd8,
+  0x20, 0xc5, 0xba, 0xe2, 0x49, 0x69, 0x81, 0xf4, 0x43, 0x7a, 0xa2, 0xcb, 0x6d, 0x37, 0x69, 0xa6,
+  0x51, 0xad, 0x27, 0xfd, 0x51, 0xd8, 0x41, 0x6c, 0x35, 0xb4, 0xdc, 0xbd, 0x17, 0x39, 0xc7, 0xb6,
+  0xa3, 0x53, 0x45, 0x74, 0x0f, 0x0e, 0xe8, 0xc6, 0x2d, 0x83, 0xa7, 0x50, 0x75, 0x9b, 0x06, 0xe3,
+  0xba, 0xef, 0x8e, 0x3d, 0xa7, 0xc3, 0x6e, 0x2b, 0xe4, 0x90, 0xe2, 0xeb, 0xba, 0x63, 0xa1, 0x26,
+  0xc7, 0x2f, 0xd2, 0x3b, 0x15, 0x26, 0xc1, 0x3a, 0x21, 0x25, 0x94, 0x45, 0x6c, 0xd8, 0x68, 0x35,
+  0x1c, 0xc2, 0xc4, 0xc0, 0xa1, 0x12, 0xe7, 0x2b, 0x18, 0x84, 0x16, 0xca, 0x67, 0xc8, 0x36, 0x01,
+  0xd7, 0x4c, 0xb8, 0x73, 0xec, 0x6e, 0x8a, 0x42, 0x6e, 0x3a, 0xce, 0x88, 0xaa, 0x8b, 0xa8, 0x33,
+  0x71, 0x7b, 0xe8, 0x7f, 0x9a, 0x8b, 0x9e, 0x6d, 0x13, 0xfd, 0xe2, 0x45, 0x8c, 0x04, 0x09, 0x43,
+  0x0e, 0x69, 0x8e, 0x56, 0x4e, 0xe0, 0xe5, 0x4b, 0xf0, 0x92, 0xc1, 0x11, 0x0c, 0x1f, 0xb4, 0x79,
+  0xd3, 0xa2, 0x0f, 0x68, 0x04, 0x7b, 0xb0, 0xdf, 0xc5, 0x86, 0xab, 0x17, 0x82, 0x20, 0xba, 0x24,
+  0x8c, 0x44, 0x0f, 0x5f, 0x8d, 0xe1, 0xa5, 0xb0, 0xeb, 0xe3, 0xdb, 0x01, 0xeb, 0xa9, 0x28, 0xf6,
+  0xc7, 0xef, 0xc5, 0x70, 0x82, 0x3f, 0x91, 0x07, 0xcb, 0x34, 0x36, 0x9c, 0x3e, 0xc6, 0xc2, 0x35,
+  0x55, 0x6f, 0xd3, 0x83, 0x8b, 0xab, 0xe6, 0xba, 0x28, 0xea, 0xb4, 0xbb, 0x87, 0xd7, 0x77, 0x26,
+  0xb8, 0x3f, 0x20, 0xcc, 0x39, 0x93, 0x38, 0x2a, 0x30, 0x4d, 0xaf, 0xdf, 0x48, 0x2a, 0x43, 0x6d,
+  0x30, 0x65, 0x13, 0xa8, 0x2f, 0xff, 0xd1, 0x30, 0xd7, 0x22, 0xcc, 0x11, 0xc9, 0x57, 0x02, 0xb6,
+  0x15, 0x9b, 0x6e, 0x8a, 0xd0, 0xe3, 0x2b, 0x9c, 0x2f, 0x36, 0xf4, 0xda, 0x4f, 0xe1, 0x88, 0x48,
+  0x5f, 0x0a, 0x81, 0x67, 0x5d, 0x17, 0x82, 0x18, 0xc1, 0x1f, 0x71, 0xec, 0xab, 0x22, 0xd8, 0x47,
+  0x6f, 0x8f, 0x22, 0xc5, 0x6c, 0x1a, 0x94, 0xc5, 0x12, 0xa5, 0xc2, 0xd5, 0x68, 0x77, 0x5b, 0x47,
+  0xc5, 0xff, 0xc1, 0xef, 0xdb, 0xf2, 0xf7, 0xa8, 0x11, 0xb7, 0x2f, 0xbd, 0xd0, 0x90, 0xd8, 0xc3,
+  0x9c, 0xad, 0x70, 0xeb, 0x0d, 0x82, 0x21, 0x47, 0xf0, 0x47, 0x1b, 0xfb, 0xf7, 0x1d, 0xe8, 0xc0,
+  0x6d, 0xdb, 0xbf, 0x0a, 0x4d, 0x3f, 0xf2, 0xf6, 0x3f, 0xb1, 0x3f, 0xf5, 0xdf, 0xa7, 0x7c, 0xce,
+  0x30, 0xfd, 0xd0, 0x89, 0x64, 0xb3, 0xb3, 0x95, 0x70, 0x0c, 0x70, 0xaa, 0x00, 0x32, 0xb8, 0xc9,
+  0x4b, 0xf9, 0xe5, 0x77, 0xec, 0x1a, 0x50, 0xa3, 0x8f, 0x0c, 0x31, 0x6d, 0x25, 0x7c, 0xac, 0x94,
+  0x4e, 0xe7, 0x8c, 0xde, 0x5a, 0x92, 0x3c, 0x3c, 0x36, 0x56, 0x3e, 0x68, 0xa6, 0xcf, 0x1b, 0x65,
+  0xc7, 0x77, 0xde, 0x3b, 0x3c, 0xef, 0x95, 0xc3, 0xee, 0xd9, 0xaa, 0x91, 0xab, 0xdf, 0xf4, 0x3d,
+  0xd9, 0xc6, 0xf9, 0xe6, 0x94, 0x62, 0xfa, 0xab, 0x9d, 0x59, 0xb5, 0xef, 0x9d, 0xf1, 0x47, 0x33,
+  0x4a, 0x65, 0xba, 0xdf, 0xef, 0x27, 0xdf, 0xd4, 0x60, 0xa1, 0xf9, 0x5f, 0x0d, 0x7f, 0x18, 0x85,
+  0x68, 0x43, 0xe7, 0x08, 0x8d, 0xd3, 0x64, 0x63, 0xfe, 0x0b, 0x00, 0x3a, 0xe3, 0x7e, 0xaa, 0x45,
+  0xe0, 0xe1, 0x19, 0xbd, 0xda, 0xc0, 0x0d, 0x0a, 0xcc, 0x35, 0xd6, 0x19, 0xa5, 0x1d, 0x38, 0x76,
+  0xc3, 0xd5, 0x57, 0x66, 0xd3, 0x1f, 0xfe, 0x04, 0x62, 0x1c, 0x2f, 0x4a, 0x66, 0x32, 0x0a, 0x0f,
+  0x2f, 0x02, 0x64, 0x31, 0x45, 0xfd, 0x10, 0x8f, 0xed, 0x25, 0x70, 0x9f, 0xa4, 0x94, 0x59, 0x28,
+  0xcf, 0x4a, 0x27, 0xbb, 0x13, 0x64, 0xb3, 0x58, 0xa1, 0xbe, 0x87, 0xc3, 0xe1, 0xa8, 0x99, 0x76,
+  0x98, 0xfa, 0xa5, 0xcc, 0xbc, 0x22, 0xb3, 0xf8, 0xee, 0xa2, 0xd7, 0xcc, 0x53, 0x94, 0x6a, 0x63,
+  0x41, 0xa8, 0x46, 0x5d, 0x79, 0x52, 0xd7, 0xc3, 0xe1, 0xf0, 0x4f, 0xe8, 0x7a, 0x66, 0x8c, 0x26,
+  0x3c, 0xf2, 0xa8, 0x63, 0x22, 0x18, 0xa1, 0x3c, 0x14, 0xf4, 0xcf, 0xd0, 0x6f, 0x27, 0xdb, 0xbf,
+  0x1f, 0x3e, 0x3e, 0xb7, 0x3c, 0x41, 0x4d, 0x2f, 0x8f, 0xc6, 0xad, 0xc9, 0xa0, 0x7a, 0xa9, 0x37,
+  0x19, 0x84, 0xd7, 0xe2, 0x83, 0xf0, 0xaf, 0x8d, 0xff, 0x02, 0x30, 0x22, 0xc8, 0x25, 0xf1, 0x18,
+  0x00, 0x00,
+};
+
+#endif /* __MA_API_WIFI_PORTAL_PAGE_H */
+/*****************************END OF FILE**************************************/
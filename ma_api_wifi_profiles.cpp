@@ -0,0 +1,307 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_profiles.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Network profile store and selection of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <string.h>
+
+// API library
+#include "ma_api_wifi_profiles.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	A st_wifi_profile_store_t keeps up to DF_WIFI_MAX_PROFILES networks, each
+    one with a priority and the order of its last successful connection.
+    These functions only change the structure in RAM, saving it is up to the
+    caller. Nothing here depends on the Arduino framework.
+
+2.  ma_api_wifi_profiles_add() updates the profile with the same SSID or
+    takes a free slot. When the store is full, the profile with the lowest
+    priority, and among those the one unused for longest, is replaced.
+
+3.  After a scan, call ma_api_wifi_profiles_rank() with the networks found.
+    It returns the order in which the profiles should be tried: the profiles
+    seen in the scan by priority, then by signal, then by last success. If
+    no stored network was seen, all profiles are returned by priority and
+    last success, since a hidden network is not listed by the scan.
+
+4.  Call ma_api_wifi_profiles_mark_success() when a profile connected.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_PROFILES_RSSI_NOT_SEEN       (-128)
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static bool ma_api_wifi_profiles_before(const st_wifi_profile_t *in_a, int8_t in_rssiA, const st_wifi_profile_t *in_b, int8_t in_rssiB);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_profiles_clear
+  * @brief      : Empties the store
+  * @pre-cond.  : None
+  * @post-cond. : No profile in use. Unused bytes are zero, so the saved record only depends on the profiles.
+  * @parameters : out_store: The store
+  * @retval     : None
+  */
+void ma_api_wifi_profiles_clear(st_wifi_profile_store_t *out_store)
+{
+    memset(out_store, 0, sizeof(*out_store));
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_find
+  * @brief      : Looks for the profile of an SSID
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_store: The store
+  *       - in_ssid: SSID, not null terminated
+  *       - in_ssidLength: Length of the SSID
+  * @retval     : Index of the profile, -1 if not found
+  */
+int8_t ma_api_wifi_profiles_find(const st_wifi_profile_store_t *in_store, const char *in_ssid, size_t in_ssidLength)
+{
+    for (uint8_t i = 0; i < DF_WIFI_MAX_PROFILES; i++)
+    {
+        const st_wifi_profile_t *profile = &in_store->profiles[i];
+        if (profile->inUse && profile->ssidLength == in_ssidLength && memcmp(profile->ssid, in_ssid, in_ssidLength) == 0)
+        {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_add
+  * @brief      : Adds a network or updates the password and priority of a known one. When the store is
+  *               full, the profile with the lowest priority and the oldest success is replaced.
+  * @pre-cond.  : None
+  * @post-cond. : Profile in the store, with no success yet if it is new
+  * @parameters :
+  *       - io_store: The store
+  *       - in_ssid: SSID, not null terminated
+  *       - in_ssidLength: Length of the SSID, 1 to DF_WIFI_PROFILE_SSID_SIZE
+  *       - in_password: Password, not null terminated
+  *       - in_passwordLength: Length of the password, up to DF_WIFI_PROFILE_PASSWORD_SIZE
+  *       - in_priority: Higher is tried first
+  * @retval     : Index of the profile, -1 if a field does not fit
+  */
+int8_t ma_api_wifi_profiles_add(st_wifi_profile_store_t *io_store, const char *in_ssid, size_t in_ssidLength, const char *in_password, size_t in_passwordLength, uint8_t in_priority)
+{
+    if (in_ssidLength == 0 || in_ssidLength > DF_WIFI_PROFILE_SSID_SIZE || in_passwordLength > DF_WIFI_PROFILE_PASSWORD_SIZE)
+    {
+        return -1;
+    }
+
+    int8_t index = ma_api_wifi_profiles_find(io_store, in_ssid, in_ssidLength);
+    uint32_t lastSuccess = (index >= 0) ? io_store->profiles[index].lastSuccess : 0;
+
+    for (uint8_t i = 0; index < 0 && i < DF_WIFI_MAX_PROFILES; i++)
+    {
+        if (!io_store->profiles[i].inUse)
+        {
+            index = (int8_t)i;
+        }
+    }
+    if (index < 0)
+    {
+        index = 0;
+        for (uint8_t i = 1; i < DF_WIFI_MAX_PROFILES; i++)
+        {
+            const st_wifi_profile_t *profile = &io_store->profiles[i];
+            const st_wifi_profile_t *victim = &io_store->profiles[index];
+            if (profile->priority < victim->priority ||
+                (profile->priority == victim->priority && profile->lastSuccess < victim->lastSuccess))
+            {
+                index = (int8_t)i;
+            }
+        }
+    }
+
+    st_wifi_profile_t *profile = &io_store->profiles[index];
+    memset(profile, 0, sizeof(*profile));
+    profile->inUse = 1;
+    profile->priority = in_priority;
+    profile->ssidLength = (uint8_t)in_ssidLength;
+    memcpy(profile->ssid, in_ssid, in_ssidLength);
+    profile->passwordLength = (uint8_t)in_passwordLength;
+    memcpy(profile->password, in_password, in_passwordLength);
+    profile->lastSuccess = lastSuccess;
+    return index;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_delete
+  * @brief      : Removes the profile of an SSID
+  * @pre-cond.  : None
+  * @post-cond. : Slot free and cleared
+  * @parameters :
+  *       - io_store: The store
+  *       - in_ssid: SSID, not null terminated
+  *       - in_ssidLength: Length of the SSID
+  * @retval     : 0 on success, -1 if not found
+  */
+int8_t ma_api_wifi_profiles_delete(st_wifi_profile_store_t *io_store, const char *in_ssid, size_t in_ssidLength)
+{
+    int8_t index = ma_api_wifi_profiles_find(io_store, in_ssid, in_ssidLength);
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    memset(&io_store->profiles[index], 0, sizeof(io_store->profiles[index]));
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_mark_success
+  * @brief      : Records that a profile connected. Nothing changes if it was already the last one to connect,
+  *               so a device that always joins the same network does not rewrite the store.
+  * @pre-cond.  : in_index is a profile in use
+  * @post-cond. : The profile has the newest lastSuccess
+  * @parameters :
+  *       - io_store: The store
+  *       - in_index: Index of the profile
+  * @retval     : true if the store changed and must be saved
+  */
+bool ma_api_wifi_profiles_mark_success(st_wifi_profile_store_t *io_store, uint8_t in_index)
+{
+    st_wifi_profile_t *profile = &io_store->profiles[in_index];
+
+    if (profile->lastSuccess != 0 && profile->lastSuccess == io_store->successCounter)
+    {
+        return false;
+    }
+
+    io_store->successCounter++;
+    profile->lastSuccess = io_store->successCounter;
+    return true;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_best
+  * @brief      : Returns the profile to use when there is no scan: highest priority, then last success
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_store: The store
+  * @retval     : Index of the profile, -1 if the store is empty
+  */
+int8_t ma_api_wifi_profiles_best(const st_wifi_profile_store_t *in_store)
+{
+    int8_t best = -1;
+
+    for (uint8_t i = 0; i < DF_WIFI_MAX_PROFILES; i++)
+    {
+        const st_wifi_profile_t *profile = &in_store->profiles[i];
+        if (profile->inUse &&
+            (best < 0 || ma_api_wifi_profiles_before(profile, 0, &in_store->profiles[best], 0)))
+        {
+            best = (int8_t)i;
+        }
+    }
+    return best;
+}
+
+/**
+  * @Func       : ma_api_wifi_profiles_rank
+  * @brief      : Joins the scan results with the stored SSIDs and sorts the profiles found by priority,
+  *               RSSI and last success. An SSID seen on several APs counts with its strongest signal.
+  *               If none was seen, every profile is returned by priority and last success.
+  * @pre-cond.  : None
+  * @post-cond. : out_order holds the profile indexes in the order they should be tried
+  * @parameters :
+  *       - in_store: The store
+  *       - in_results: Networks found by the scan
+  *       - in_resultCount: Number of networks
+  *       - out_order: Array of DF_WIFI_MAX_PROFILES indexes
+  * @retval     : Number of indexes in out_order
+  */
+uint8_t ma_api_wifi_profiles_rank(const st_wifi_profile_store_t *in_store, const st_wifi_scan_result_t *in_results, uint8_t in_resultCount, uint8_t *out_order)
+{
+    int8_t rssi[DF_WIFI_MAX_PROFILES];
+    bool seen = false;
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < DF_WIFI_MAX_PROFILES; i++)
+    {
+        rssi[i] = DF_PROFILES_RSSI_NOT_SEEN;
+    }
+    for (uint8_t r = 0; r < in_resultCount; r++)
+    {
+        int8_t index = ma_api_wifi_profiles_find(in_store, in_results[r].ssid, strnlen(in_results[r].ssid, DF_WIFI_PROFILE_SSID_SIZE));
+        if (index >= 0 && in_results[r].rssi > rssi[index])
+        {
+            rssi[index] = in_results[r].rssi;
+            seen = true;
+        }
+    }
+
+    // Insertion sort, the store is a handful of entries
+    for (uint8_t i = 0; i < DF_WIFI_MAX_PROFILES; i++)
+    {
+        const st_wifi_profile_t *profile = &in_store->profiles[i];
+        if (!profile->inUse || (seen && rssi[i] == DF_PROFILES_RSSI_NOT_SEEN))
+        {
+            continue;
+        }
+
+        uint8_t position = count;
+        while (position > 0 &&
+               ma_api_wifi_profiles_before(profile, rssi[i], &in_store->profiles[out_order[position - 1]], rssi[out_order[position - 1]]))
+        {
+            out_order[position] = out_order[position - 1];
+            position--;
+        }
+        out_order[position] = i;
+        count++;
+    }
+    return count;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_profiles_before
+  * @brief      : Order of the connection attempts: priority, then RSSI, then the most recent success
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_a: First profile
+  *       - in_rssiA: Signal of the first profile
+  *       - in_b: Second profile
+  *       - in_rssiB: Signal of the second profile
+  * @retval     : true if a must be tried before b
+  */
+static bool ma_api_wifi_profiles_before(const st_wifi_profile_t *in_a, int8_t in_rssiA, const st_wifi_profile_t *in_b, int8_t in_rssiB)
+{
+    if (in_a->priority != in_b->priority)
+    {
+        return in_a->priority > in_b->priority;
+    }
+    if (in_rssiA != in_rssiB)
+    {
+        return in_rssiA > in_rssiB;
+    }
+    return in_a->lastSuccess > in_b->lastSuccess;
+}
+
+/*****************************END OF FILE**************************************/
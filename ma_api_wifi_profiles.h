@@ -0,0 +1,64 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_profiles.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the network profile store of the WiFi Api
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_PROFILES_H
+#define __MA_API_WIFI_PROFILES_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ma_api_wifi_config.h"
+
+/* Define --------------------------------------------------------------------*/
+#ifndef DF_WIFI_MAX_PROFILES
+#define DF_WIFI_MAX_PROFILES            4       // Networks kept in flash
+#endif
+
+#define DF_WIFI_PROFILE_SSID_SIZE       32      // 802.11 SSID, not null terminated
+#define DF_WIFI_PROFILE_PASSWORD_SIZE   64      // WPA2 passphrase or PSK in hex, not null terminated
+#define DF_WIFI_PROFILE_DEFAULT_PRIORITY 100
+
+/* Typedef -------------------------------------------------------------------*/
+typedef struct {
+  uint8_t inUse;
+  uint8_t priority;                 // Higher is tried first
+  uint8_t ssidLength;
+  uint8_t passwordLength;
+  char ssid[DF_WIFI_PROFILE_SSID_SIZE];
+  char password[DF_WIFI_PROFILE_PASSWORD_SIZE];
+  uint32_t lastSuccess;             // Store successCounter at the last connection, 0 if never connected
+}st_wifi_profile_t;
+
+// Saved as one record, so a profile change is a single power-fail safe write
+typedef struct {
+  uint32_t successCounter;          // Incremented on each successful connection, orders lastSuccess
+  st_wifi_profile_t profiles[DF_WIFI_MAX_PROFILES];
+}st_wifi_profile_store_t;
+
+typedef struct {
+  char ssid[DF_WIFI_PROFILE_SSID_SIZE + 1];
+  int8_t rssi;
+  uint8_t secure;                   // 0 for an open network
+}st_wifi_scan_result_t;
+
+/* Public objects ------------------------------------------------------------*/
+extern void ma_api_wifi_profiles_clear(st_wifi_profile_store_t *out_store);
+extern int8_t ma_api_wifi_profiles_find(const st_wifi_profile_store_t *in_store, const char *in_ssid, size_t in_ssidLength);
+extern int8_t ma_api_wifi_profiles_add(st_wifi_profile_store_t *io_store, const char *in_ssid, size_t in_ssidLength, const char *in_password, size_t in_passwordLength, uint8_t in_priority);
+extern int8_t ma_api_wifi_profiles_delete(st_wifi_profile_store_t *io_store, const char *in_ssid, size_t in_ssidLength);
+extern bool ma_api_wifi_profiles_mark_success(st_wifi_profile_store_t *io_store, uint8_t in_index);
+extern int8_t ma_api_wifi_profiles_best(const st_wifi_profile_store_t *in_store);
+extern uint8_t ma_api_wifi_profiles_rank(const st_wifi_profile_store_t *in_store, const st_wifi_scan_result_t *in_results, uint8_t in_resultCount, uint8_t *out_order);
+
+#endif /* __MA_API_WIFI_PROFILES_H */
+/*****************************END OF FILE**************************************/
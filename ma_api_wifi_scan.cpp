@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_scan.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Scan result cache of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <string.h>
+
+// API library
+#include "ma_api_wifi_scan.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	A st_wifi_scan_cache_t keeps the networks of the last scan in a fixed
+    table: one entry per SSID with its strongest signal, strongest first. 
+    When more than DF_WIFI_SCAN_CACHE_SIZE networks are found, the weakest
+    are dropped. Hidden networks (empty SSID) are not kept.
+
+2.  Call ma_api_wifi_scan_begin() when the scan starts. The previous results
+    stay readable while it runs.
+
+3.  When it ends, call ma_api_wifi_scan_done() and then ma_api_wifi_scan_add()
+    for each network found, in the same step, since done() empties the 
+    table. Call ma_api_wifi_scan_abort() instead if the scan failed.
+
+4.  ma_api_wifi_scan_is_stale() tells when the results are older than the
+    TTL and a new scan should be started. Nothing here depends on the 
+    Arduino framework, so the caller feeds the results of the real driver
+    or of a fake one.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_scan_clear
+  * @brief      : Empties the cache
+  * @pre-cond.  : None
+  * @post-cond. : No result, stale
+  * @parameters : out_cache: The cache
+  * @retval     : None
+  */
+void ma_api_wifi_scan_clear(st_wifi_scan_cache_t *out_cache)
+{
+    memset(out_cache, 0, sizeof(*out_cache));
+}
+
+/**
+  * @Func       : ma_api_wifi_scan_begin
+  * @brief      : Records the start of a scan
+  * @pre-cond.  : None
+  * @post-cond. : scanning set, the results of the previous scan are kept
+  * @parameters :
+  *       - io_cache: The cache
+  *       - in_nowMs: millis()
+  * @retval     : None
+  */
+void ma_api_wifi_scan_begin(st_wifi_scan_cache_t *io_cache, uint32_t in_nowMs)
+{
+    io_cache->scanning = 1;
+    io_cache->startMs = in_nowMs;
+}
+
+/**
+  * @Func       : ma_api_wifi_scan_done
+  * @brief      : Records the end of a scan and empties the table for its results
+  * @pre-cond.  : ma_api_wifi_scan_begin() was called
+  * @post-cond. : Table empty, ma_api_wifi_scan_add() must follow in the same step
+  * @parameters :
+  *       - io_cache: The cache
+  *       - in_nowMs: millis()
+  * @retval     : None
+  */
+void ma_api_wifi_scan_done(st_wifi_scan_cache_t *io_cache, uint32_t in_nowMs)
+{
+    io_cache->count = 0;
+    io_cache->scanning = 0;
+    io_cache->hasResult = 1;
+    io_cache->doneMs = in_nowMs;
+    io_cache->durationMs = in_nowMs - io_cache->startMs;
+}
+
+/**
+  * @Func       : ma_api_wifi_scan_abort
+  * @brief      : Records a failed scan, the previous results are kept
+  * @pre-cond.  : None
+  * @post-cond. : scanning cleared
+  * @parameters : io_cache: The cache
+  * @retval     : None
+  */
+void ma_api_wifi_scan_abort(st_wifi_scan_cache_t *io_cache)
+{
+    io_cache->scanning = 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_scan_add
+  * @brief      : Adds a network found by the scan. An SSID already in the table keeps its strongest signal.
+  * @pre-cond.  : Called after ma_api_wifi_scan_done()
+  * @post-cond. : Table sorted by RSSI, strongest first
+  * @parameters :
+  *       - io_cache: The cache
+  *       - in_ssid: SSID, not null terminated
+  *       - in_ssidLength: Length of the SSID, longer ones are cut at DF_WIFI_PROFILE_SSID_SIZE
+  *       - in_rssi: Signal in dBm
+  *       - in_secure: false for an open network
+  * @retval     : None
+  */
+void ma_api_wifi_scan_add(st_wifi_scan_cache_t *io_cache, const char *in_ssid, size_t in_ssidLength, int8_t in_rssi, bool in_secure)
+{
+    st_wifi_scan_result_t *results = io_cache->results;
+    uint8_t position;
+
+    if (in_ssidLength > DF_WIFI_PROFILE_SSID_SIZE)
+    {
+        in_ssidLength = DF_WIFI_PROFILE_SSID_SIZE;
+    }
+    if (in_ssidLength == 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < io_cache->count; i++)
+    {
+        if (strncmp(results[i].ssid, in_ssid, in_ssidLength) == 0 && results[i].ssid[in_ssidLength] == '\0')
+        {
+            if (in_rssi <= results[i].rssi)
+            {
+                return;
+            }
+            // Stronger AP of the same network: take the entry out and insert it again at its new place
+            memmove(&results[i], &results[i + 1], (io_cache->count - i - 1) * sizeof(results[0]));
+            io_cache->count--;
+            break;
+        }
+    }
+
+    if (io_cache->count == DF_WIFI_SCAN_CACHE_SIZE)
+    {
+        if (in_rssi <= results[DF_WIFI_SCAN_CACHE_SIZE - 1].rssi)
+        {
+            return;
+        }
+        io_cache->count--;
+    }
+
+    position = io_cache->count;
+    while (position > 0 && results[position - 1].rssi < in_rssi)
+    {
+        position--;
+    }
+    memmove(&results[position + 1], &results[position], (io_cache->count - position) * sizeof(results[0]));
+
+    memset(&results[position], 0, sizeof(results[0]));
+    memcpy(results[position].ssid, in_ssid, in_ssidLength);
+    results[position].rssi = in_rssi;
+    results[position].secure = in_secure ? 1 : 0;
+    io_cache->count++;
+}
+
+/**
+  * @Func       : ma_api_wifi_scan_is_stale
+  * @brief      : Tells if a new scan should be started
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_cache: The cache
+  *       - in_nowMs: millis()
+  *       - in_ttlMs: Time the results stay valid
+  * @retval     : true if no scan is running and the results are missing or older than in_ttlMs
+  */
+bool ma_api_wifi_scan_is_stale(const st_wifi_scan_cache_t *in_cache, uint32_t in_nowMs, uint32_t in_ttlMs)
+{
+    if (in_cache->scanning)
+    {
+        return false;
+    }
+    return !in_cache->hasResult || in_nowMs - in_cache->doneMs >= in_ttlMs;
+}
+
+/**
+  * @Func       : ma_api_wifi_scan_age
+  * @brief      : Time since the end of the last scan
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_cache: The cache
+  *       - in_nowMs: millis()
+  * @retval     : Age in ms, UINT32_MAX if no scan completed
+  */
+uint32_t ma_api_wifi_scan_age(const st_wifi_scan_cache_t *in_cache, uint32_t in_nowMs)
+{
+    return in_cache->hasResult ? in_nowMs - in_cache->doneMs : UINT32_MAX;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,48 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_scan.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the scan result cache of the WiFi Api
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_SCAN_H
+#define __MA_API_WIFI_SCAN_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ma_api_wifi_profiles.h"
+
+/* Define --------------------------------------------------------------------*/
+#ifndef DF_WIFI_SCAN_CACHE_SIZE
+#define DF_WIFI_SCAN_CACHE_SIZE         16      // Networks kept, the weakest are dropped
+#endif
+
+/* Typedef -------------------------------------------------------------------*/
+typedef struct {
+  st_wifi_scan_result_t results[DF_WIFI_SCAN_CACHE_SIZE];   // One per SSID, strongest first
+  uint8_t count;
+  uint8_t scanning;                 // A scan is running, results holds the previous one
+  uint8_t hasResult;                // At least one scan completed
+  uint32_t startMs;                 // millis() at the start of the running or of the last scan
+  uint32_t doneMs;                  // millis() at the end of the last scan
+  uint32_t durationMs;              // Duration of the last scan
+}st_wifi_scan_cache_t;
+
+/* Public objects ------------------------------------------------------------*/
+extern void ma_api_wifi_scan_clear(st_wifi_scan_cache_t *out_cache);
+extern void ma_api_wifi_scan_begin(st_wifi_scan_cache_t *io_cache, uint32_t in_nowMs);
+extern void ma_api_wifi_scan_done(st_wifi_scan_cache_t *io_cache, uint32_t in_nowMs);
+extern void ma_api_wifi_scan_abort(st_wifi_scan_cache_t *io_cache);
+extern void ma_api_wifi_scan_add(st_wifi_scan_cache_t *io_cache, const char *in_ssid, size_t in_ssidLength, int8_t in_rssi, bool in_secure);
+extern bool ma_api_wifi_scan_is_stale(const st_wifi_scan_cache_t *in_cache, uint32_t in_nowMs, uint32_t in_ttlMs);
+extern uint32_t ma_api_wifi_scan_age(const st_wifi_scan_cache_t *in_cache, uint32_t in_nowMs);
+
+#endif /* __MA_API_WIFI_SCAN_H */
+/*****************************END OF FILE**************************************/
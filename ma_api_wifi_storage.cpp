@@ -0,0 +1,551 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_storage.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Power-fail safe record storage of the WiFi Api, on top of
+  *               one or more backends
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+// ESP-IDF
+#include <esp_timer.h>
+#else
+// Host build
+#include <chrono>
+#endif
+
+// API library
+#include "ma_api_wifi_config.h"
+#include "ma_api_wifi_storage.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	A record is a fixed size payload with a header holding magic, version,
+    length, sequence number and a CRC32 of header and payload. The same
+    record can be kept by several backends (st_wifi_storage_backend_t):
+      - "rtc": RTC slow memory, kept in deep sleep, lost on power off.
+      - "nvs": NVS partition, through Preferences.
+      - "spiffs": two files per record, the write never touches the newest
+        valid copy. Where older versions saved the networks.
+    The backends built are chosen with DF_WIFI_STORAGE_RTC,
+    DF_WIFI_STORAGE_NVS and DF_WIFI_STORAGE_SPIFFS, see ma_api_wifi_config.h.
+
+2.  The first persistent backend of the table is the store: the records
+    are written to it and to the cheaper backends before it. The backends
+    after it hold records of older versions and are never written.
+
+3.  ma_api_wifi_storage_read() asks the backends from the cheapest to the
+    store and stops at the first valid copy, which is then copied to the
+    cheaper backends that had none. After a deep sleep the record comes
+    from RTC memory and no flash is read; after a power on it comes from NVS.
+    The backends of older versions are only read when the store never held
+    the record, neither a copy nor an erase marker: a copy found there is
+    moved to the store, and if there is none an erase marker is saved. So
+    SPIFFS is mounted at most once per record, never on a normal boot. A
+    backend that could not be read, e.g. SPIFFS that did not mount, gets
+    no marker: the read returns -2 and the next boot looks again.
+
+4.  ma_api_wifi_storage_write() and ma_api_wifi_storage_erase() go to the
+    store and the cheaper backends, so they hold the same record. An erase
+    saves a marker instead of the record, which answers the following reads
+    without asking the backends of older versions. A write succeeds when
+    the store saved it. A backend that failed the write drops its copy, so
+    it never answers with an older record.
+
+5.  Each backend counts its reads, hits, writes (the wear of the flash) and
+    the time spent, see ma_api_wifi_storage_get_stats() and /metrics.
+    ma_api_wifi_storage_set_backends() plugs in other backends, e.g. kept in
+    RAM, so the read order, the write-through and the counters can be
+    checked without the flash.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_STORAGE_ERASED_MAGIC         0x4553414D  // "MASE", erase marker of a record, no payload
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+// CRC32 (IEEE 802.3, reflected) table for one nibble, 64 bytes of flash instead of 1 KB
+static const uint32_t u32CrcNibbleTable[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+// Backends of the build, from the cheapest to read to the most expensive. A backend left out is NULL,
+// so the linker drops it.
+static constexpr const st_wifi_storage_backend_t *pstStorageDefaultBackends[] = {
+    stWifiBuildConfig.storageRtc ? &stStorageBackendRtc : NULL,
+    stWifiBuildConfig.storageNvs ? &stStorageBackendNvs : NULL,
+    stWifiBuildConfig.storageSpiffs ? &stStorageBackendSpiffs : NULL
+};
+
+static_assert(sizeof(pstStorageDefaultBackends) / sizeof(pstStorageDefaultBackends[0]) <= DF_STORAGE_MAX_BACKENDS,
+              "DF_STORAGE_MAX_BACKENDS too small");
+
+static const st_wifi_storage_backend_t *const *pstStorageBackends = pstStorageDefaultBackends;
+static uint8_t u8StorageBackendCount = sizeof(pstStorageDefaultBackends) / sizeof(pstStorageDefaultBackends[0]);
+static st_wifi_storage_stats_t stStorageStats[DF_STORAGE_MAX_BACKENDS];
+static const uint8_t u8StorageNoPayload = 0;   // Payload of the erase markers
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t ma_api_wifi_storage_store_count(void);
+static int8_t ma_api_wifi_storage_read_backend(uint8_t in_index, const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length, bool *out_erased);
+static int8_t ma_api_wifi_storage_write_backend(uint8_t in_index, const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+static void ma_api_wifi_storage_erase_backend(uint8_t in_index, const char *in_name);
+static void ma_api_wifi_storage_mark_erased(uint8_t in_index, const char *in_name);
+static uint32_t ma_api_wifi_storage_now_us(void);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_storage_crc32
+  * @brief      : Updates a CRC32 (IEEE 802.3) with more data
+  * @pre-cond.  : Start with in_crc = 0
+  * @post-cond. : None
+  * @parameters :
+  *       - in_crc: CRC of the previous data
+  *       - in_data: Data to be added
+  *       - in_length: Number of bytes
+  * @retval     : The updated CRC
+  */
+uint32_t ma_api_wifi_storage_crc32(uint32_t in_crc, const void *in_data, size_t in_length)
+{
+    const uint8_t *data = (const uint8_t *)in_data;
+    uint32_t crc = ~in_crc;
+
+    while (in_length--)
+    {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ u32CrcNibbleTable[crc & 0x0F];
+        crc = (crc >> 4) ^ u32CrcNibbleTable[crc & 0x0F];
+    }
+
+    return ~crc;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_read
+  * @brief      : Reads a record from the cheapest backend holding a valid copy, and copies it to the
+  *               cheaper backends that had none. When the store never held the record, it is moved from
+  *               the backends of older versions.
+  * @pre-cond.  : None
+  * @post-cond. : out_payload holds the record when 0 is returned
+  * @parameters :
+  *       - in_name: Name of the record, e.g. "/wifi_prof"
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - out_payload: Buffer that receives the payload
+  *       - in_length: Expected payload length
+  * @retval     : 0 on success, -1 if no backend holds a valid record or the record was erased, -2 if a
+  *               backend that may hold it could not be read. Nothing is written then, the next read tries again.
+  */
+int8_t ma_api_wifi_storage_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length)
+{
+    uint8_t storeCount = ma_api_wifi_storage_store_count();
+    bool erased = false;
+
+    if (in_length > DF_STORAGE_MAX_PAYLOAD_SIZE)
+    {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < storeCount; i++)
+    {
+        if (pstStorageBackends[i] == NULL)
+        {
+            continue;
+        }
+
+        int8_t result = ma_api_wifi_storage_read_backend(i, in_name, in_magic, in_version, out_payload, in_length, &erased);
+        if (result == -2)
+        {
+            return -2;
+        }
+        if (result == 0 || erased)
+        {
+            for (uint8_t j = 0; j < i; j++)
+            {
+                if (pstStorageBackends[j] != NULL)
+                {
+                    ma_api_wifi_storage_write_backend(j, in_name, erased ? DF_STORAGE_ERASED_MAGIC : in_magic, erased ? 0 : in_version,
+                                                      erased ? &u8StorageNoPayload : out_payload, erased ? 0 : in_length);
+                }
+            }
+            return erased ? -1 : 0;
+        }
+    }
+
+    // The store never held the record: it may be in a backend of an older version. It is moved to the
+    // store, or the store gets an erase marker, so this is done once per record.
+    bool olderBackends = false;
+    bool readError = false;
+    for (uint8_t i = storeCount; i < u8StorageBackendCount; i++)
+    {
+        if (pstStorageBackends[i] == NULL)
+        {
+            continue;
+        }
+        olderBackends = true;
+        int8_t result = ma_api_wifi_storage_read_backend(i, in_name, in_magic, in_version, out_payload, in_length, NULL);
+        readError |= (result == -2);
+        if (result == 0)
+        {
+            if (ma_api_wifi_storage_write(in_name, in_magic, in_version, out_payload, in_length) == 0)
+            {
+                for (uint8_t j = storeCount; j < u8StorageBackendCount; j++)
+                {
+                    if (pstStorageBackends[j] != NULL)
+                    {
+                        ma_api_wifi_storage_erase_backend(j, in_name);
+                    }
+                }
+            }
+            return 0;
+        }
+    }
+
+    // A backend that could not be read may hold the record: no marker, so it is looked for again
+    if (readError)
+    {
+        return -2;
+    }
+    if (olderBackends)
+    {
+        ma_api_wifi_storage_erase(in_name);
+    }
+    return -1;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_write
+  * @brief      : Writes a record to the store and to the cheaper backends before it
+  * @pre-cond.  : None
+  * @post-cond. : The backends that could write hold the record. If the store saved it, the others
+  *               dropped their copy; otherwise the store keeps the previous record and the others dropped
+  *               theirs.
+  * @parameters :
+  *       - in_name: Name of the record, e.g. "/wifi_prof"
+  *       - in_magic: Magic number of the record
+  *       - in_version: Payload version
+  *       - in_payload: Payload to be saved
+  *       - in_length: Payload length
+  * @retval     : 0 if the store saved the record, -1 otherwise
+  */
+int8_t ma_api_wifi_storage_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length)
+{
+    uint8_t storeCount = ma_api_wifi_storage_store_count();
+    bool written[DF_STORAGE_MAX_BACKENDS];
+    bool saved = false;
+
+    if (in_length > DF_STORAGE_MAX_PAYLOAD_SIZE)
+    {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < storeCount; i++)
+    {
+        written[i] = pstStorageBackends[i] != NULL &&
+                     ma_api_wifi_storage_write_backend(i, in_name, in_magic, in_version, in_payload, in_length) == 0;
+        saved |= written[i] && pstStorageBackends[i]->persistent;
+    }
+
+    // The backends must not disagree: the ones that missed the new record drop the old one. If nothing
+    // persistent has the new record, the caches drop it and the previous record stays the valid one.
+    for (uint8_t i = 0; i < storeCount; i++)
+    {
+        if (pstStorageBackends[i] != NULL &&
+            (saved ? !written[i] : (written[i] && !pstStorageBackends[i]->persistent)))
+        {
+            ma_api_wifi_storage_erase_backend(i, in_name);
+        }
+    }
+
+    return saved ? 0 : -1;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_erase
+  * @brief      : Replaces a record by an erase marker in the store and in the cheaper backends. The
+  *               backends of older versions are not touched: the marker keeps them from being read.
+  * @pre-cond.  : None
+  * @post-cond. : The record does not exist anymore
+  * @parameters : in_name: Name of the record, e.g. "/wifi_prof"
+  * @retval     : None
+  */
+void ma_api_wifi_storage_erase(const char *in_name)
+{
+    uint8_t storeCount = ma_api_wifi_storage_store_count();
+
+    for (uint8_t i = 0; i < storeCount; i++)
+    {
+        if (pstStorageBackends[i] != NULL)
+        {
+            ma_api_wifi_storage_mark_erased(i, in_name);
+        }
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_set_backends
+  * @brief      : Replaces the backends of the build, e.g. by backends in RAM to measure on a PC
+  * @pre-cond.  : No read or write in progress
+  * @post-cond. : The counters are cleared
+  * @parameters :
+  *       - in_backends: Backends from the cheapest to read to the most expensive, NULL entries are
+  *                      skipped. The first persistent one is the store, see HOW TO USE. Not copied, it
+  *                      must stay valid.
+  *       - in_count: Number of entries, up to DF_STORAGE_MAX_BACKENDS
+  * @retval     : 0 on success, -1 if there are too many backends
+  */
+int8_t ma_api_wifi_storage_set_backends(const st_wifi_storage_backend_t *const *in_backends, uint8_t in_count)
+{
+    if (in_count > DF_STORAGE_MAX_BACKENDS)
+    {
+        return -1;
+    }
+
+    pstStorageBackends = in_backends;
+    u8StorageBackendCount = in_count;
+    memset(stStorageStats, 0, sizeof(stStorageStats));
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_get_stats
+  * @brief      : Reads the counters of one backend
+  * @pre-cond.  : None
+  * @post-cond. : out_stats is filled when 0 is returned
+  * @parameters :
+  *       - in_index: Position of the backend, 0 is the cheapest
+  *       - out_stats: The counters
+  * @retval     : 0 on success, -1 if there is no backend at in_index
+  */
+int8_t ma_api_wifi_storage_get_stats(uint8_t in_index, st_wifi_storage_stats_t *out_stats)
+{
+    if (in_index >= u8StorageBackendCount || pstStorageBackends[in_index] == NULL)
+    {
+        return -1;
+    }
+
+    *out_stats = stStorageStats[in_index];
+    out_stats->name = pstStorageBackends[in_index]->name;
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_header_crc
+  * @brief      : CRC32 of the header fields that come before the crc field
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_header: The header
+  * @retval     : CRC to be continued over the payload
+  */
+uint32_t ma_api_wifi_storage_header_crc(const st_wifi_record_header_t *in_header)
+{
+    return ma_api_wifi_storage_crc32(0, in_header, offsetof(st_wifi_record_header_t, crc));
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_make_header
+  * @brief      : Fills the header of a record, CRC included
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - out_header: The header
+  *       - in_magic: Magic number of the record
+  *       - in_version: Payload version
+  *       - in_payload: Payload the header belongs to
+  *       - in_length: Payload length
+  *       - in_sequence: Sequence number, 0 for a backend that keeps one copy
+  * @retval     : None
+  */
+void ma_api_wifi_storage_make_header(st_wifi_record_header_t *out_header, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length, uint32_t in_sequence)
+{
+    memset(out_header, 0, sizeof(*out_header));
+    out_header->magic = in_magic;
+    out_header->version = in_version;
+    out_header->length = in_length;
+    out_header->sequence = in_sequence;
+    out_header->crc = ma_api_wifi_storage_crc32(ma_api_wifi_storage_header_crc(out_header), in_payload, in_length);
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_check_record
+  * @brief      : Checks that a header describes the expected record and that the CRC matches
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_header: The header
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - in_payload: Payload of in_length bytes
+  *       - in_length: Expected payload length
+  * @retval     : 0 if the record is valid, -1 otherwise
+  */
+int8_t ma_api_wifi_storage_check_record(const st_wifi_record_header_t *in_header, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length)
+{
+    if (in_header->magic != in_magic || in_header->version != in_version || in_header->length != in_length)
+    {
+        return -1;
+    }
+    uint32_t crc = ma_api_wifi_storage_crc32(ma_api_wifi_storage_header_crc(in_header), in_payload, in_length);
+    return (crc == in_header->crc) ? 0 : -1;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_storage_store_count
+  * @brief      : Number of backends written: up to the store, the first persistent backend
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Position of the store + 1, or every backend if none is persistent
+  */
+static uint8_t ma_api_wifi_storage_store_count(void)
+{
+    for (uint8_t i = 0; i < u8StorageBackendCount; i++)
+    {
+        if (pstStorageBackends[i] != NULL && pstStorageBackends[i]->persistent)
+        {
+            return i + 1;
+        }
+    }
+    return u8StorageBackendCount;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_read_backend
+  * @brief      : Reads a record from one backend and counts it
+  * @pre-cond.  : pstStorageBackends[in_index] is not NULL
+  * @post-cond. : out_payload holds the record when 0 is returned
+  * @parameters :
+  *       - in_index: Position of the backend
+  *       - in_name: Name of the record
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - out_payload: Buffer that receives the payload
+  *       - in_length: Expected payload length
+  *       - out_erased: Set when the backend holds the erase marker instead of the record, NULL if
+  *                     the marker is not looked for
+  * @retval     : 0 on success, -1 if the backend holds no valid record, -2 if it could not be read
+  */
+static int8_t ma_api_wifi_storage_read_backend(uint8_t in_index, const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length, bool *out_erased)
+{
+    const st_wifi_storage_backend_t *backend = pstStorageBackends[in_index];
+    uint8_t marker;
+
+    uint32_t startUs = ma_api_wifi_storage_now_us();
+    int8_t result = backend->read(in_name, in_magic, in_version, out_payload, in_length);
+    if (result == -1 && out_erased != NULL)
+    {
+        *out_erased = backend->read(in_name, DF_STORAGE_ERASED_MAGIC, 0, &marker, 0) == 0;
+    }
+    stStorageStats[in_index].readUs += ma_api_wifi_storage_now_us() - startUs;
+    stStorageStats[in_index].reads++;
+    if (result == 0)
+    {
+        stStorageStats[in_index].hits++;
+    }
+    return result;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_write_backend
+  * @brief      : Writes a record to one backend and counts it
+  * @pre-cond.  : pstStorageBackends[in_index] is not NULL
+  * @post-cond. : None
+  * @parameters :
+  *       - in_index: Position of the backend
+  *       - in_name: Name of the record
+  *       - in_magic: Magic number of the record
+  *       - in_version: Payload version
+  *       - in_payload: Payload to be saved
+  *       - in_length: Payload length
+  * @retval     : 0 on success, -1 on write error
+  */
+static int8_t ma_api_wifi_storage_write_backend(uint8_t in_index, const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length)
+{
+    uint32_t startUs = ma_api_wifi_storage_now_us();
+    int8_t result = pstStorageBackends[in_index]->write(in_name, in_magic, in_version, in_payload, in_length);
+    stStorageStats[in_index].writeUs += ma_api_wifi_storage_now_us() - startUs;
+    stStorageStats[in_index].writes++;
+    if (result != 0)
+    {
+        stStorageStats[in_index].failures++;
+    }
+    return result;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_erase_backend
+  * @brief      : Removes a record from one backend and counts it
+  * @pre-cond.  : pstStorageBackends[in_index] is not NULL
+  * @post-cond. : None
+  * @parameters :
+  *       - in_index: Position of the backend
+  *       - in_name: Name of the record
+  * @retval     : None
+  */
+static void ma_api_wifi_storage_erase_backend(uint8_t in_index, const char *in_name)
+{
+    uint32_t startUs = ma_api_wifi_storage_now_us();
+    pstStorageBackends[in_index]->erase(in_name);
+    stStorageStats[in_index].writeUs += ma_api_wifi_storage_now_us() - startUs;
+    stStorageStats[in_index].erases++;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_mark_erased
+  * @brief      : Removes the record from one backend and writes the erase marker in its place. The
+  *               record goes first: a backend with two slots would keep it next to the marker.
+  * @pre-cond.  : pstStorageBackends[in_index] is not NULL
+  * @post-cond. : The backend holds no copy of the record, and the marker if it could be written
+  * @parameters :
+  *       - in_index: Position of the backend
+  *       - in_name: Name of the record
+  * @retval     : None
+  */
+static void ma_api_wifi_storage_mark_erased(uint8_t in_index, const char *in_name)
+{
+    const st_wifi_storage_backend_t *backend = pstStorageBackends[in_index];
+
+    uint32_t startUs = ma_api_wifi_storage_now_us();
+    backend->erase(in_name);
+    backend->write(in_name, DF_STORAGE_ERASED_MAGIC, 0, &u8StorageNoPayload, 0);
+    stStorageStats[in_index].writeUs += ma_api_wifi_storage_now_us() - startUs;
+    stStorageStats[in_index].erases++;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_now_us
+  * @brief      : Monotonic time of the counters
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Microseconds, wraps after 71 minutes
+  */
+static uint32_t ma_api_wifi_storage_now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)esp_timer_get_time();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*****************************END OF FILE**************************************/
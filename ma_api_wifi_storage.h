@@ -0,0 +1,78 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_storage.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the power-fail safe record storage of the WiFi Api
+    *               and of its backends
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_STORAGE_H
+#define __MA_API_WIFI_STORAGE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Define --------------------------------------------------------------------*/
+#define DF_STORAGE_MAX_PAYLOAD_SIZE     512     // Biggest record payload
+#define DF_STORAGE_MAX_BACKENDS         4       // Backends of ma_api_wifi_storage_set_backends()
+
+/* Typedef -------------------------------------------------------------------*/
+// Header written before the payload in each slot
+typedef struct {
+  uint32_t magic;                   // Identifies the kind of record
+  uint8_t version;                  // Layout version of the payload
+  uint8_t reserved;
+  uint16_t length;                  // Payload length
+  uint32_t sequence;                // Incremented on every write, the newest valid slot wins
+  uint32_t crc;                     // CRC32 of the header fields above and of the payload
+}st_wifi_record_header_t;
+
+// One place where the records are kept. read returns 0 only for a valid record (magic, version, length and CRC),
+// -1 when there is none and -2 when the backend could not be read, e.g. SPIFFS did not mount.
+typedef struct {
+  const char *name;                 // Shown on /metrics
+  bool persistent;                  // Survives a power cycle. The first persistent backend is the store, the ones after it are only read to move records of older versions.
+  int8_t (*read)(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length);
+  int8_t (*write)(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+  void (*erase)(const char *in_name);
+}st_wifi_storage_backend_t;
+
+// Counters of one backend, since the boot or the last ma_api_wifi_storage_set_backends()
+typedef struct {
+  const char *name;
+  uint32_t reads;                   // Reads that reached the backend, a cheaper backend had no valid copy nor erase marker
+  uint32_t hits;                    // Reads answered with a valid record
+  uint32_t writes;                  // Records written, copies to the cheaper backends included. The wear of a flash backend.
+  uint32_t erases;                  // Erase markers written, and copies removed after a move from an older backend
+  uint32_t failures;                // Writes that failed
+  uint32_t readUs;                  // Time spent in the reads, the SPIFFS mount included
+  uint32_t writeUs;                 // Time spent in the writes and the erases
+}st_wifi_storage_stats_t;
+
+/* Public objects ------------------------------------------------------------*/
+extern uint32_t ma_api_wifi_storage_crc32(uint32_t in_crc, const void *in_data, size_t in_length);
+extern int8_t ma_api_wifi_storage_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length);
+extern int8_t ma_api_wifi_storage_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+extern void ma_api_wifi_storage_erase(const char *in_name);
+extern int8_t ma_api_wifi_storage_set_backends(const st_wifi_storage_backend_t *const *in_backends, uint8_t in_count);
+extern int8_t ma_api_wifi_storage_get_stats(uint8_t in_index, st_wifi_storage_stats_t *out_stats);
+
+// For the backends
+extern uint32_t ma_api_wifi_storage_header_crc(const st_wifi_record_header_t *in_header);
+extern void ma_api_wifi_storage_make_header(st_wifi_record_header_t *out_header, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length, uint32_t in_sequence);
+extern int8_t ma_api_wifi_storage_check_record(const st_wifi_record_header_t *in_header, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+
+// Backends, in ma_api_wifi_storage_rtc.cpp, ma_api_wifi_storage_nvs.cpp and ma_api_wifi_storage_spiffs.cpp
+extern const st_wifi_storage_backend_t stStorageBackendRtc;
+extern const st_wifi_storage_backend_t stStorageBackendNvs;
+extern const st_wifi_storage_backend_t stStorageBackendSpiffs;
+extern int8_t ma_api_wifi_storage_spiffs_mount(void);
+
+#endif /* __MA_API_WIFI_STORAGE_H */
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_storage_nvs.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : NVS backend of the record storage of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <string.h>
+
+// Arduino
+#include <Preferences.h>
+
+// API library
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_storage.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	Each record is one blob, header and payload, in the DF_STORAGE_NVS_NAMESPACE
+    namespace. The key is the record name without the leading '/', so a
+    name has up to 15 characters after it.
+
+2.  NVS writes a blob as a new entry and only then marks the old one as
+    erased, so a power loss during the write leaves the previous record.
+    Nothing to mount: the partition is initialized by the Arduino core at
+    boot, the namespace is opened by the first read, write or erase.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_STORAGE_NVS_NAMESPACE        "ma_wifi"
+#define DF_STORAGE_NVS_KEY_SIZE         15      // NVS limit, without the terminator
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static Preferences clsStoragePreferences;
+static bool bStoragePreferencesOpen = false;
+
+// Blob being read or written, static because the callers may run on a small stack. The storage is
+// called with the Api lock held.
+static uint8_t u8StorageNvsBuffer[sizeof(st_wifi_record_header_t) + DF_STORAGE_MAX_PAYLOAD_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t ma_api_wifi_storage_nvs_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length);
+static int8_t ma_api_wifi_storage_nvs_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+static void ma_api_wifi_storage_nvs_erase(const char *in_name);
+static const char *ma_api_wifi_storage_nvs_key(const char *in_name);
+
+/* Public objects ------------------------------------------------------------*/
+const st_wifi_storage_backend_t stStorageBackendNvs = {
+    "nvs",
+    true,
+    ma_api_wifi_storage_nvs_read,
+    ma_api_wifi_storage_nvs_write,
+    ma_api_wifi_storage_nvs_erase
+};
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_storage_nvs_read
+  * @brief      : Reads the blob of a record and checks it
+  * @pre-cond.  : None
+  * @post-cond. : out_payload holds the record when 0 is returned
+  * @parameters :
+  *       - in_name: Name of the record
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - out_payload: Buffer that receives the payload
+  *       - in_length: Expected payload length
+  * @retval     : 0 on success, -1 if there is no valid blob, -2 if the namespace can not be opened
+  */
+static int8_t ma_api_wifi_storage_nvs_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length)
+{
+    const char *key = ma_api_wifi_storage_nvs_key(in_name);
+    size_t size = sizeof(st_wifi_record_header_t) + in_length;
+    st_wifi_record_header_t header;
+
+    if (key == NULL)
+    {
+        return bStoragePreferencesOpen ? -1 : -2;
+    }
+    if (!clsStoragePreferences.isKey(key) ||
+        clsStoragePreferences.getBytesLength(key) != size ||
+        clsStoragePreferences.getBytes(key, u8StorageNvsBuffer, size) != size)
+    {
+        return -1;
+    }
+
+    memcpy(&header, u8StorageNvsBuffer, sizeof(header));
+    if (ma_api_wifi_storage_check_record(&header, in_magic, in_version, u8StorageNvsBuffer + sizeof(header), in_length) != 0)
+    {
+        return -1;
+    }
+
+    memcpy(out_payload, u8StorageNvsBuffer + sizeof(header), in_length);
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_nvs_write
+  * @brief      : Writes a record as one blob
+  * @pre-cond.  : None
+  * @post-cond. : The record is saved, or the previous one is kept
+  * @parameters :
+  *       - in_name: Name of the record
+  *       - in_magic: Magic number of the record
+  *       - in_version: Payload version
+  *       - in_payload: Payload to be saved
+  *       - in_length: Payload length
+  * @retval     : 0 on success, -1 on write error
+  */
+static int8_t ma_api_wifi_storage_nvs_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length)
+{
+    const char *key = ma_api_wifi_storage_nvs_key(in_name);
+    size_t size = sizeof(st_wifi_record_header_t) + in_length;
+    st_wifi_record_header_t header;
+
+    if (key == NULL)
+    {
+        return -1;
+    }
+
+    ma_api_wifi_storage_make_header(&header, in_magic, in_version, in_payload, in_length, 0);
+    memcpy(u8StorageNvsBuffer, &header, sizeof(header));
+    memcpy(u8StorageNvsBuffer + sizeof(header), in_payload, in_length);
+    if (clsStoragePreferences.putBytes(key, u8StorageNvsBuffer, size) != size)
+    {
+        PRINTF("Error writing %s to NVS.\n", key);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_nvs_erase
+  * @brief      : Removes the blob of a record
+  * @pre-cond.  : None
+  * @post-cond. : The record does not exist anymore
+  * @parameters : in_name: Name of the record
+  * @retval     : None
+  */
+static void ma_api_wifi_storage_nvs_erase(const char *in_name)
+{
+    const char *key = ma_api_wifi_storage_nvs_key(in_name);
+
+    if (key != NULL && clsStoragePreferences.isKey(key))
+    {
+        clsStoragePreferences.remove(key);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_nvs_key
+  * @brief      : Opens the namespace on the first call and gives the key of a record
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_name: Name of the record, e.g. "/wifi_prof"
+  * @retval     : The key, e.g. "wifi_prof", or NULL if it is too long or NVS can not be opened
+  */
+static const char *ma_api_wifi_storage_nvs_key(const char *in_name)
+{
+    const char *key = (in_name[0] == '/') ? in_name + 1 : in_name;
+
+    if (!bStoragePreferencesOpen)
+    {
+        bStoragePreferencesOpen = clsStoragePreferences.begin(DF_STORAGE_NVS_NAMESPACE, false);
+        if (!bStoragePreferencesOpen)
+        {
+            PRINTF("Error opening the NVS namespace %s.\n", DF_STORAGE_NVS_NAMESPACE);
+            return NULL;
+        }
+    }
+    return (strlen(key) <= DF_STORAGE_NVS_KEY_SIZE) ? key : NULL;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,211 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_storage_rtc.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : RTC memory backend of the record storage of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+// ESP-IDF
+#include <esp_attr.h>
+#else
+// Host build, the pool is plain RAM
+#define RTC_DATA_ATTR
+#endif
+
+// API library
+#include "ma_api_wifi_config.h"
+#include "ma_api_wifi_storage.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	The records are packed one after the other in a pool of
+    DF_WIFI_STORAGE_RTC_SIZE bytes of RTC slow memory. Each entry is the
+    CRC32 of the record name, the record header and the payload, padded to
+    4 bytes. The pool survives deep sleep, so the first read after a wake
+    touches no flash.
+
+2.  A write removes the old entry of the record and appends the new one. A
+    record that does not fit is not cached, the next backend answers it.
+
+3.  The pool starts empty on power on. A pool whose magic or entries do not
+    add up is emptied, and the CRC of each record is checked on every read.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_STORAGE_RTC_MAGIC            0x5257414D  // "MAWR"
+
+/* Private macros ------------------------------------------------------------*/
+#define RTC_ENTRY_SIZE(length)          (sizeof(st_wifi_rtc_entry_t) + (((length) + 3u) & ~3u))
+
+/* Private typedef -----------------------------------------------------------*/
+// Entry of the pool, followed by the payload
+typedef struct {
+  uint32_t nameCrc;                 // CRC32 of the record name
+  st_wifi_record_header_t header;
+}st_wifi_rtc_entry_t;
+
+/* Private variables ---------------------------------------------------------*/
+// Zero on power on, kept in deep sleep
+RTC_DATA_ATTR uint32_t u32RtcStorageMagic;
+RTC_DATA_ATTR uint32_t u32RtcStorageUsed;
+RTC_DATA_ATTR uint32_t u32RtcStoragePool[DF_WIFI_STORAGE_RTC_SIZE / sizeof(uint32_t)];
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t ma_api_wifi_storage_rtc_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length);
+static int8_t ma_api_wifi_storage_rtc_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+static void ma_api_wifi_storage_rtc_erase(const char *in_name);
+static int32_t ma_api_wifi_storage_rtc_find(const char *in_name);
+
+/* Public objects ------------------------------------------------------------*/
+const st_wifi_storage_backend_t stStorageBackendRtc = {
+    "rtc",
+    false,
+    ma_api_wifi_storage_rtc_read,
+    ma_api_wifi_storage_rtc_write,
+    ma_api_wifi_storage_rtc_erase
+};
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_storage_rtc_read
+  * @brief      : Reads a record from the pool
+  * @pre-cond.  : None
+  * @post-cond. : out_payload holds the record when 0 is returned
+  * @parameters :
+  *       - in_name: Name of the record
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - out_payload: Buffer that receives the payload
+  *       - in_length: Expected payload length
+  * @retval     : 0 on success, -1 if the pool holds no valid copy
+  */
+static int8_t ma_api_wifi_storage_rtc_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length)
+{
+    int32_t offset = ma_api_wifi_storage_rtc_find(in_name);
+    if (offset < 0)
+    {
+        return -1;
+    }
+
+    const uint8_t *pool = (const uint8_t *)u32RtcStoragePool;
+    const st_wifi_rtc_entry_t *entry = (const st_wifi_rtc_entry_t *)(pool + offset);
+    const uint8_t *payload = pool + offset + sizeof(st_wifi_rtc_entry_t);
+    if (ma_api_wifi_storage_check_record(&entry->header, in_magic, in_version, payload, in_length) != 0)
+    {
+        return -1;
+    }
+
+    memcpy(out_payload, payload, in_length);
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_rtc_write
+  * @brief      : Replaces the entry of a record by a new one at the end of the pool
+  * @pre-cond.  : None
+  * @post-cond. : The pool holds the record, or no copy of it if it does not fit
+  * @parameters :
+  *       - in_name: Name of the record
+  *       - in_magic: Magic number of the record
+  *       - in_version: Payload version
+  *       - in_payload: Payload to be saved
+  *       - in_length: Payload length
+  * @retval     : 0 on success, -1 if the record does not fit
+  */
+static int8_t ma_api_wifi_storage_rtc_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length)
+{
+    ma_api_wifi_storage_rtc_erase(in_name);
+
+    if (u32RtcStorageUsed + RTC_ENTRY_SIZE(in_length) > sizeof(u32RtcStoragePool))
+    {
+        return -1;
+    }
+
+    uint8_t *pool = (uint8_t *)u32RtcStoragePool;
+    st_wifi_rtc_entry_t *entry = (st_wifi_rtc_entry_t *)(pool + u32RtcStorageUsed);
+    entry->nameCrc = ma_api_wifi_storage_crc32(0, in_name, strlen(in_name));
+    ma_api_wifi_storage_make_header(&entry->header, in_magic, in_version, in_payload, in_length, 0);
+    memcpy(pool + u32RtcStorageUsed + sizeof(st_wifi_rtc_entry_t), in_payload, in_length);
+    u32RtcStorageUsed += RTC_ENTRY_SIZE(in_length);
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_rtc_erase
+  * @brief      : Removes the entry of a record and moves the following ones down
+  * @pre-cond.  : None
+  * @post-cond. : The pool holds no copy of the record
+  * @parameters : in_name: Name of the record
+  * @retval     : None
+  */
+static void ma_api_wifi_storage_rtc_erase(const char *in_name)
+{
+    int32_t offset = ma_api_wifi_storage_rtc_find(in_name);
+    if (offset < 0)
+    {
+        return;
+    }
+
+    uint8_t *pool = (uint8_t *)u32RtcStoragePool;
+    const st_wifi_rtc_entry_t *entry = (const st_wifi_rtc_entry_t *)(pool + offset);
+    uint32_t size = RTC_ENTRY_SIZE(entry->header.length);
+    memmove(pool + offset, pool + offset + size, u32RtcStorageUsed - offset - size);
+    u32RtcStorageUsed -= size;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_rtc_find
+  * @brief      : Walks the pool looking for the entry of a record. A pool that is not valid, after a
+  *               power on or a corruption, is emptied.
+  * @pre-cond.  : None
+  * @post-cond. : The pool is valid
+  * @parameters : in_name: Name of the record
+  * @retval     : Offset of the entry, -1 if the record is not in the pool
+  */
+static int32_t ma_api_wifi_storage_rtc_find(const char *in_name)
+{
+    const uint8_t *pool = (const uint8_t *)u32RtcStoragePool;
+    uint32_t nameCrc = ma_api_wifi_storage_crc32(0, in_name, strlen(in_name));
+    uint32_t offset = 0;
+
+    if (u32RtcStorageMagic == DF_STORAGE_RTC_MAGIC && u32RtcStorageUsed <= sizeof(u32RtcStoragePool))
+    {
+        while (offset + sizeof(st_wifi_rtc_entry_t) <= u32RtcStorageUsed)
+        {
+            const st_wifi_rtc_entry_t *entry = (const st_wifi_rtc_entry_t *)(pool + offset);
+            if (entry->header.length > DF_STORAGE_MAX_PAYLOAD_SIZE ||
+                offset + RTC_ENTRY_SIZE(entry->header.length) > u32RtcStorageUsed)
+            {
+                break;
+            }
+            if (entry->nameCrc == nameCrc)
+            {
+                return (int32_t)offset;
+            }
+            offset += RTC_ENTRY_SIZE(entry->header.length);
+        }
+        if (offset == u32RtcStorageUsed)
+        {
+            return -1;
+        }
+    }
+
+    u32RtcStorageMagic = DF_STORAGE_RTC_MAGIC;
+    u32RtcStorageUsed = 0;
+    return -1;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,365 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_storage_spiffs.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : SPIFFS backend of the record storage of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <stdio.h>
+#include <string.h>
+
+// API library
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+#include "ma_api_wifi_storage.h"
+#include "ma_api_wifi_trace.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	A record is a fixed size payload saved in two slots, "<name>.a" and
+    "<name>.b". Each slot has a header with magic, version, length, sequence
+    number and a CRC32 of the whole slot.
+
+2.  A write always goes to the slot that does NOT hold the newest valid 
+    copy. If power is lost during the write, the other slot still holds the
+    previous record.
+
+3.  A read returns the valid slot with the highest sequence number, reading
+    the payload straight into the caller buffer.
+
+4.  SPIFFS is mounted by the first read, write or erase. The mount is the
+    slowest step of a cold boot: with NVS built, SPIFFS only holds the
+    records of older versions and is read once per record, to move it to
+    NVS (see ma_api_wifi_storage.cpp). It is then never formatted: a
+    partition that does not mount is read again on the next boot, which
+    may mount it. Without NVS it is
+    the store, and it is formatted if it does not mount and
+    DF_WIFI_STORAGE_SPIFFS_FORMAT is set. If the application mounted SPIFFS
+    before, the mount returns at once.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_STORAGE_SLOT_COUNT           2
+#define DF_STORAGE_PATH_SIZE            32      // SPIFFS limit, including the terminator
+#define DF_STORAGE_CRC_CHUNK_SIZE       64      // Bytes read at a time when only the CRC is checked
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+// SPIFFS mounted, or the mount failed and is not tried again
+static bool bSpiffsMountTried = false;
+static bool bSpiffsMounted = false;
+
+/* Private function prototypes -----------------------------------------------*/
+static void ma_api_wifi_storage_slot_path(const char *in_name, uint8_t in_slot, char *out_path);
+static int8_t ma_api_wifi_storage_read_header(const char *in_path, uint32_t in_magic, uint8_t in_version, uint16_t in_length, st_wifi_record_header_t *out_header);
+static int8_t ma_api_wifi_storage_check_slot(const char *in_path, uint32_t in_magic, uint8_t in_version, uint16_t in_length, st_wifi_record_header_t *out_header, void *out_payload);
+static int8_t ma_api_wifi_storage_spiffs_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length);
+static int8_t ma_api_wifi_storage_spiffs_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+static void ma_api_wifi_storage_spiffs_erase(const char *in_name);
+
+/* Public objects ------------------------------------------------------------*/
+const st_wifi_storage_backend_t stStorageBackendSpiffs = {
+    "spiffs",
+    true,
+    ma_api_wifi_storage_spiffs_read,
+    ma_api_wifi_storage_spiffs_write,
+    ma_api_wifi_storage_spiffs_erase
+};
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_storage_spiffs_mount
+  * @brief      : Mounts SPIFFS on the first call, the following calls return the result of the first one
+  * @pre-cond.  : None
+  * @post-cond. : SPIFFS mounted on success
+  * @parameters : None
+  * @retval     : 0 if SPIFFS is mounted, -1 otherwise
+  */
+int8_t ma_api_wifi_storage_spiffs_mount(void)
+{
+    if (!bSpiffsMountTried)
+    {
+        TRACE_NAMED_SPAN("spiffs_mount");
+        bSpiffsMountTried = true;
+        bSpiffsMounted = SPIFFS.begin(stWifiBuildConfig.storageSpiffsFormat && !stWifiBuildConfig.storageNvs);
+        if (!bSpiffsMounted)
+        {
+            PRINTF("SPIFFS Mount Failed\n");
+        }
+    }
+    return bSpiffsMounted ? 0 : -1;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_storage_spiffs_read
+  * @brief      : Reads the newest valid copy of a record
+  * @pre-cond.  : None
+  * @post-cond. : out_payload holds the record when 0 is returned
+  * @parameters :
+  *       - in_name: Path of the record, without the slot suffix
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - out_payload: Buffer that receives the payload
+  *       - in_length: Expected payload length
+  * @retval     : 0 on success, -1 if no slot holds a valid record, -2 if SPIFFS did not mount
+  */
+static int8_t ma_api_wifi_storage_spiffs_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length)
+{
+    char path[DF_STORAGE_SLOT_COUNT][DF_STORAGE_PATH_SIZE];
+    st_wifi_record_header_t header[DF_STORAGE_SLOT_COUNT];
+    bool candidate[DF_STORAGE_SLOT_COUNT];
+
+    if (ma_api_wifi_storage_spiffs_mount() != 0)
+    {
+        return -2;
+    }
+
+    for (uint8_t slot = 0; slot < DF_STORAGE_SLOT_COUNT; slot++)
+    {
+        ma_api_wifi_storage_slot_path(in_name, slot, path[slot]);
+        candidate[slot] = ma_api_wifi_storage_read_header(path[slot], in_magic, in_version, in_length, &header[slot]) == 0;
+    }
+
+    // Try the slot with the highest sequence first, the other one only if its CRC fails
+    uint8_t first = 0;
+    if (candidate[1] && (!candidate[0] || (int32_t)(header[1].sequence - header[0].sequence) > 0))
+    {
+        first = 1;
+    }
+
+    for (uint8_t i = 0; i < DF_STORAGE_SLOT_COUNT; i++)
+    {
+        uint8_t slot = (first + i) % DF_STORAGE_SLOT_COUNT;
+        if (candidate[slot] &&
+            ma_api_wifi_storage_check_slot(path[slot], in_magic, in_version, in_length, &header[slot], out_payload) == 0)
+        {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_spiffs_write
+  * @brief      : Writes a record in the slot that does not hold the newest valid copy
+  * @pre-cond.  : None
+  * @post-cond. : The record is saved. The previous copy is kept in the other slot.
+  * @parameters :
+  *       - in_name: Path of the record, without the slot suffix
+  *       - in_magic: Magic number of the record
+  *       - in_version: Payload version
+  *       - in_payload: Payload to be saved
+  *       - in_length: Payload length
+  * @retval     : 0 on success, -1 on write error
+  */
+static int8_t ma_api_wifi_storage_spiffs_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length)
+{
+    char path[DF_STORAGE_SLOT_COUNT][DF_STORAGE_PATH_SIZE];
+    st_wifi_record_header_t header[DF_STORAGE_SLOT_COUNT];
+    bool valid[DF_STORAGE_SLOT_COUNT];
+
+    if (in_length > DF_STORAGE_MAX_PAYLOAD_SIZE || ma_api_wifi_storage_spiffs_mount() != 0)
+    {
+        return -1;
+    }
+
+    for (uint8_t slot = 0; slot < DF_STORAGE_SLOT_COUNT; slot++)
+    {
+        ma_api_wifi_storage_slot_path(in_name, slot, path[slot]);
+        valid[slot] = ma_api_wifi_storage_check_slot(path[slot], in_magic, in_version, in_length, &header[slot], NULL) == 0;
+    }
+
+    // Overwrite the older or the invalid slot, never the only valid copy
+    uint8_t target = 0;
+    uint32_t sequence = 0;
+    if (valid[0] && (!valid[1] || (int32_t)(header[0].sequence - header[1].sequence) > 0))
+    {
+        target = 1;
+        sequence = header[0].sequence + 1;
+    }
+    else if (valid[1])
+    {
+        sequence = header[1].sequence + 1;
+    }
+
+    st_wifi_record_header_t newHeader;
+    ma_api_wifi_storage_make_header(&newHeader, in_magic, in_version, in_payload, in_length, sequence);
+
+    File file = SPIFFS.open(path[target], "w");
+    if (!file)
+    {
+        PRINTF("Error opening %s for writing.\n", path[target]);
+        return -1;
+    }
+    size_t written = file.write((const uint8_t *)&newHeader, sizeof(newHeader));
+    written += file.write((const uint8_t *)in_payload, in_length);
+    file.close();
+
+    if (written != sizeof(newHeader) + in_length)
+    {
+        PRINTF("Error writing %s.\n", path[target]);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_spiffs_erase
+  * @brief      : Removes both slots of a record
+  * @pre-cond.  : None
+  * @post-cond. : The record does not exist anymore
+  * @parameters : in_name: Path of the record, without the slot suffix
+  * @retval     : None
+  */
+static void ma_api_wifi_storage_spiffs_erase(const char *in_name)
+{
+    char path[DF_STORAGE_PATH_SIZE];
+
+    if (ma_api_wifi_storage_spiffs_mount() != 0)
+    {
+        return;
+    }
+
+    for (uint8_t slot = 0; slot < DF_STORAGE_SLOT_COUNT; slot++)
+    {
+        ma_api_wifi_storage_slot_path(in_name, slot, path);
+        if (SPIFFS.exists(path))
+        {
+            SPIFFS.remove(path);
+        }
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_slot_path
+  * @brief      : Builds the file name of one slot, "<name>.a" or "<name>.b"
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_name: Path of the record, without the slot suffix
+  *       - in_slot: Slot index
+  *       - out_path: Buffer of DF_STORAGE_PATH_SIZE bytes
+  * @retval     : None
+  */
+static void ma_api_wifi_storage_slot_path(const char *in_name, uint8_t in_slot, char *out_path)
+{
+    snprintf(out_path, DF_STORAGE_PATH_SIZE, "%s.%c", in_name, 'a' + in_slot);
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_read_header
+  * @brief      : Reads the header of one slot and checks that it describes the expected record
+  * @pre-cond.  : None
+  * @post-cond. : out_header is filled when 0 is returned. The CRC is not checked.
+  * @parameters :
+  *       - in_path: File of the slot
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - in_length: Expected payload length
+  *       - out_header: Header read
+  * @retval     : 0 if the header matches, -1 otherwise
+  */
+static int8_t ma_api_wifi_storage_read_header(const char *in_path, uint32_t in_magic, uint8_t in_version, uint16_t in_length, st_wifi_record_header_t *out_header)
+{
+    if (!SPIFFS.exists(in_path))
+    {
+        return -1;
+    }
+
+    File file = SPIFFS.open(in_path, "r");
+    if (!file)
+    {
+        return -1;
+    }
+    size_t size = file.size();
+    size_t read = file.read((uint8_t *)out_header, sizeof(*out_header));
+    file.close();
+
+    if (read != sizeof(*out_header) || size != sizeof(*out_header) + in_length ||
+        out_header->magic != in_magic || out_header->version != in_version || out_header->length != in_length)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_storage_check_slot
+  * @brief      : Reads one slot and checks header and CRC
+  * @pre-cond.  : None
+  * @post-cond. : out_header, and out_payload if not NULL, are filled when 0 is returned
+  * @parameters :
+  *       - in_path: File of the slot
+  *       - in_magic: Expected magic number
+  *       - in_version: Expected payload version
+  *       - in_length: Expected payload length
+  *       - out_header: Header read
+  *       - out_payload: Buffer that receives the payload, or NULL to only check it
+  * @retval     : 0 if the slot is valid, -1 otherwise
+  */
+static int8_t ma_api_wifi_storage_check_slot(const char *in_path, uint32_t in_magic, uint8_t in_version, uint16_t in_length, st_wifi_record_header_t *out_header, void *out_payload)
+{
+    if (!SPIFFS.exists(in_path))
+    {
+        return -1;
+    }
+
+    File file = SPIFFS.open(in_path, "r");
+    if (!file)
+    {
+        return -1;
+    }
+
+    int8_t result = -1;
+    if (file.size() == sizeof(*out_header) + in_length &&
+        file.read((uint8_t *)out_header, sizeof(*out_header)) == sizeof(*out_header) &&
+        out_header->magic == in_magic && out_header->version == in_version && out_header->length == in_length)
+    {
+        uint32_t crc = ma_api_wifi_storage_header_crc(out_header);
+        if (out_payload != NULL)
+        {
+            if (file.read((uint8_t *)out_payload, in_length) == in_length)
+            {
+                crc = ma_api_wifi_storage_crc32(crc, out_payload, in_length);
+                result = (crc == out_header->crc) ? 0 : -1;
+            }
+        }
+        else
+        {
+            uint8_t chunk[DF_STORAGE_CRC_CHUNK_SIZE];
+            uint16_t remaining = in_length;
+            while (remaining > 0)
+            {
+                uint16_t toRead = (remaining < sizeof(chunk)) ? remaining : sizeof(chunk);
+                if (file.read(chunk, toRead) != toRead)
+                {
+                    break;
+                }
+                crc = ma_api_wifi_storage_crc32(crc, chunk, toRead);
+                remaining -= toRead;
+            }
+            result = (remaining == 0 && crc == out_header->crc) ? 0 : -1;
+        }
+    }
+    file.close();
+
+    return result;
+}
+
+/*****************************END OF FILE**************************************/
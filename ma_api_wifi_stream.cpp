@@ -0,0 +1,376 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_stream.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Buffered output stream of the WiFi portal
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// API library
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_stream.h"
+#include "ma_api_wifi_trace.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	Call ma_api_wifi_stream_begin() with the client (any Print) that will
+    receive the response.
+
+2.  Write the status line and the headers with ma_api_wifi_stream_print() or
+    ma_api_wifi_stream_printf(). If the body length is not known, leave out
+    the empty line that ends the headers and call 
+    ma_api_wifi_stream_start_body(). A body that ends in the first segment 
+    is sent with Content-Length, a longer one with chunked transfer encoding.
+    Either way the client knows where the response ends, so the connection 
+    can carry the next request. ma_api_wifi_stream_start_chunked() forces
+    chunked encoding, after the headers and "Transfer-Encoding: chunked".
+
+3.  Write the body. The bytes are kept in the TX buffer and given to the
+    client only when one full TCP segment (DF_STREAM_TX_BUFFER_SIZE) is
+    ready, or on ma_api_wifi_stream_flush().
+
+4.  Call ma_api_wifi_stream_end() to send what is left, including the last
+    chunk. writeCalls and segments tell how well the writes were coalesced.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_STREAM_CHUNK_END             "0\r\n\r\n"
+#define DF_STREAM_CHUNKED_HEADER        "Transfer-Encoding: chunked\r\n\r\n"
+#define DF_STREAM_LENGTH_HEADER_SIZE    26      // "Content-Length: 65535\r\n\r\n" + terminator
+
+static_assert(sizeof(DF_STREAM_CHUNKED_HEADER) - 1 + DF_STREAM_CHUNK_HEAD_SIZE == DF_STREAM_FRAMING_SIZE, "DF_STREAM_FRAMING_SIZE must hold the chunked header and a chunk size");
+static_assert(DF_STREAM_LENGTH_HEADER_SIZE - 1 <= DF_STREAM_FRAMING_SIZE, "DF_STREAM_FRAMING_SIZE too small");
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void ma_api_wifi_stream_send(st_wifi_stream_t *io_stream, bool in_last);
+static void ma_api_wifi_stream_insert(st_wifi_stream_t *io_stream, const char *in_text, size_t in_length);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_stream_begin
+  * @brief      : Prepares the stream to send a new response
+  * @pre-cond.  : None
+  * @post-cond. : Stream empty, not chunked and with all counters cleared
+  * @parameters :
+  *       - out_stream: The stream to be prepared
+  *       - in_output: The client that receives the data
+  * @retval     : None
+  */
+void ma_api_wifi_stream_begin(st_wifi_stream_t *out_stream, Print *in_output)
+{
+    out_stream->output = in_output;
+    out_stream->length = 0;
+    out_stream->capacity = DF_STREAM_TX_BUFFER_SIZE;
+    out_stream->chunkStart = 0;
+    out_stream->bodyStart = 0;
+    out_stream->chunked = false;
+    out_stream->framingPending = false;
+    out_stream->writeCalls = 0;
+    out_stream->segments = 0;
+    out_stream->bytesSent = 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_write
+  * @brief      : Adds bytes to the TX buffer. A full buffer is sent as one segment.
+  * @pre-cond.  : ma_api_wifi_stream_begin() must be called before using this function
+  * @post-cond. : Data is buffered or sent
+  * @parameters :
+  *       - io_stream: The stream
+  *       - in_data: Bytes to be sent
+  *       - in_length: Number of bytes
+  * @retval     : None
+  */
+void ma_api_wifi_stream_write(st_wifi_stream_t *io_stream, const uint8_t *in_data, size_t in_length)
+{
+    io_stream->writeCalls++;
+
+    // A block of at least one segment with nothing buffered does not need the copy
+    if (!io_stream->chunked && !io_stream->framingPending && io_stream->length == 0 && in_length >= io_stream->capacity)
+    {
+        io_stream->output->write(in_data, in_length);
+        io_stream->segments++;
+        io_stream->bytesSent += in_length;
+        TRACE_COUNT(bytesSent, in_length);
+        return;
+    }
+
+    while (in_length > 0)
+    {
+        size_t space = io_stream->capacity - io_stream->length;
+        size_t toCopy = (in_length < space) ? in_length : space;
+
+        memcpy(&io_stream->buffer[io_stream->length], in_data, toCopy);
+        io_stream->length += toCopy;
+        in_data += toCopy;
+        in_length -= toCopy;
+
+        if (io_stream->length == io_stream->capacity)
+        {
+            ma_api_wifi_stream_send(io_stream, false);
+        }
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_print
+  * @brief      : Adds a null terminated text to the TX buffer
+  * @pre-cond.  : ma_api_wifi_stream_begin() must be called before using this function
+  * @post-cond. : See ma_api_wifi_stream_write()
+  * @parameters :
+  *       - io_stream: The stream
+  *       - in_text: Text to be sent
+  * @retval     : None
+  */
+void ma_api_wifi_stream_print(st_wifi_stream_t *io_stream, const char *in_text)
+{
+    ma_api_wifi_stream_write(io_stream, (const uint8_t *)in_text, strlen(in_text));
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_printf
+  * @brief      : Formats a text straight into the TX buffer
+  * @pre-cond.  : ma_api_wifi_stream_begin() must be called before using this function
+  * @post-cond. : See ma_api_wifi_stream_write(). A text longer than one segment is cut.
+  * @parameters :
+  *       - io_stream: The stream
+  *       - in_format: printf format
+  * @retval     : None
+  */
+void ma_api_wifi_stream_printf(st_wifi_stream_t *io_stream, const char *in_format, ...)
+{
+    va_list args;
+    size_t skip = 0;
+
+    for (uint8_t attempt = 0; attempt < 2; attempt++)
+    {
+        size_t space = io_stream->capacity - io_stream->length;
+        char *destination = (char *)&io_stream->buffer[io_stream->length];
+
+        // vsnprintf needs room for the terminator, the tail area after the data provides it
+        va_start(args, in_format);
+        int length = vsnprintf(destination, space + 1, in_format, args);
+        va_end(args);
+
+        if (length < 0)
+        {
+            return;
+        }
+        if ((size_t)length <= space || attempt > 0)
+        {
+            // On the second attempt the part already sent is dropped from the start
+            size_t kept = (((size_t)length <= space) ? length : space);
+            kept = (kept > skip) ? kept - skip : 0;
+            memmove(destination, destination + skip, kept);
+            io_stream->writeCalls++;
+            io_stream->length += kept;
+            if (io_stream->length == io_stream->capacity)
+            {
+                ma_api_wifi_stream_send(io_stream, false);
+            }
+            return;
+        }
+
+        // Does not fit after the buffered data: the first part fills the segment, send it and format again for the rest
+        io_stream->length += space;
+        skip = space;
+        ma_api_wifi_stream_send(io_stream, false);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_start_chunked
+  * @brief      : Starts chunked transfer encoding. Everything written after this call is framed as chunks.
+  *               The headers stay in the buffer, so they share the first segment with the first chunk.
+  * @pre-cond.  : The headers, including "Transfer-Encoding: chunked", were written to the stream
+  * @post-cond. : Each segment carries one chunk, framing included
+  * @parameters : io_stream: The stream
+  * @retval     : None
+  */
+void ma_api_wifi_stream_start_chunked(st_wifi_stream_t *io_stream)
+{
+    // Room is kept for "\r\n" and the last chunk, so a chunk never needs a second segment
+    io_stream->capacity = DF_STREAM_TX_BUFFER_SIZE - DF_STREAM_CHUNK_TAIL_SIZE;
+    if (io_stream->length + DF_STREAM_CHUNK_HEAD_SIZE >= io_stream->capacity)
+    {
+        ma_api_wifi_stream_send(io_stream, false);
+    }
+    io_stream->chunked = true;
+    io_stream->chunkStart = io_stream->length;
+    io_stream->length += DF_STREAM_CHUNK_HEAD_SIZE;
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_start_body
+  * @brief      : Starts a body of unknown length. The framing headers and the empty line are added later:
+  *               Content-Length if the body ends before the first segment is full, otherwise chunked
+  *               transfer encoding, inserted in front of the body when the segment is sent.
+  * @pre-cond.  : The headers were written, without the empty line that ends them
+  * @post-cond. : The body can be written. Room for the framing is kept in the first segment.
+  * @parameters : io_stream: The stream
+  * @retval     : None
+  */
+void ma_api_wifi_stream_start_body(st_wifi_stream_t *io_stream)
+{
+    io_stream->capacity = DF_STREAM_TX_BUFFER_SIZE - DF_STREAM_CHUNK_TAIL_SIZE - DF_STREAM_FRAMING_SIZE;
+    if (io_stream->length >= io_stream->capacity)
+    {
+        // Headers alone fill the segment, the body can only be chunked
+        ma_api_wifi_stream_print(io_stream, DF_STREAM_CHUNKED_HEADER);
+        ma_api_wifi_stream_start_chunked(io_stream);
+        return;
+    }
+    io_stream->framingPending = true;
+    io_stream->bodyStart = io_stream->length;
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_flush
+  * @brief      : Sends the buffered bytes now
+  * @pre-cond.  : ma_api_wifi_stream_begin() must be called before using this function
+  * @post-cond. : TX buffer empty
+  * @parameters : io_stream: The stream
+  * @retval     : None
+  */
+void ma_api_wifi_stream_flush(st_wifi_stream_t *io_stream)
+{
+    if (io_stream->length > (io_stream->chunked ? DF_STREAM_CHUNK_HEAD_SIZE : 0))
+    {
+        ma_api_wifi_stream_send(io_stream, false);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_end
+  * @brief      : Ends the response. In chunked mode the last chunk is sent in the same segment as the data.
+  * @pre-cond.  : ma_api_wifi_stream_begin() must be called before using this function
+  * @post-cond. : Everything was given to the client. The stream can be started again.
+  * @parameters : io_stream: The stream
+  * @retval     : None
+  */
+void ma_api_wifi_stream_end(st_wifi_stream_t *io_stream)
+{
+    if (io_stream->framingPending)
+    {
+        // The whole body is in the buffer, its length is known
+        char header[DF_STREAM_LENGTH_HEADER_SIZE];
+        int length = snprintf(header, sizeof(header), "Content-Length: %u\r\n\r\n", (unsigned)(io_stream->length - io_stream->bodyStart));
+        ma_api_wifi_stream_insert(io_stream, header, (size_t)length);
+        io_stream->framingPending = false;
+    }
+    if (io_stream->chunked || io_stream->length > 0)
+    {
+        ma_api_wifi_stream_send(io_stream, io_stream->chunked);
+    }
+    io_stream->chunked = false;
+    io_stream->capacity = DF_STREAM_TX_BUFFER_SIZE;
+
+    PRINTF("Response: %u writes, %u segments, %u bytes\n",
+           (unsigned)io_stream->writeCalls, (unsigned)io_stream->segments, (unsigned)io_stream->bytesSent);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_stream_send
+  * @brief      : Gives the buffered bytes to the client with a single write. When the stream is chunked,
+  *               the size of the open chunk is written in the place reserved for it.
+  * @pre-cond.  : None
+  * @post-cond. : TX buffer empty. In chunked mode the size of the next chunk is already reserved.
+  * @parameters :
+  *       - io_stream: The stream
+  *       - in_last: Append the last chunk ("0\r\n\r\n")
+  * @retval     : None
+  */
+static void ma_api_wifi_stream_send(st_wifi_stream_t *io_stream, bool in_last)
+{
+    if (io_stream->framingPending)
+    {
+        // The body does not fit in one segment: chunked, the first chunk is what is buffered
+        io_stream->framingPending = false;
+        ma_api_wifi_stream_insert(io_stream, DF_STREAM_CHUNKED_HEADER "000000", DF_STREAM_FRAMING_SIZE);
+        io_stream->chunked = true;
+        io_stream->chunkStart = io_stream->bodyStart + DF_STREAM_FRAMING_SIZE - DF_STREAM_CHUNK_HEAD_SIZE;
+        io_stream->capacity = DF_STREAM_TX_BUFFER_SIZE - DF_STREAM_CHUNK_TAIL_SIZE;
+    }
+
+    size_t length = io_stream->length;
+
+    if (io_stream->chunked)
+    {
+        size_t dataStart = io_stream->chunkStart + DF_STREAM_CHUNK_HEAD_SIZE;
+        if (length > dataStart)
+        {
+            // Leading zeros keep the size field fixed width, so the data never has to move
+            char head[DF_STREAM_CHUNK_HEAD_SIZE + 1];
+            snprintf(head, sizeof(head), "%04X\r\n", (unsigned)(length - dataStart));
+            memcpy(&io_stream->buffer[io_stream->chunkStart], head, DF_STREAM_CHUNK_HEAD_SIZE);
+            memcpy(&io_stream->buffer[length], "\r\n", 2);
+            length += 2;
+        }
+        else
+        {
+            length = io_stream->chunkStart; // Empty chunk: drop the reserved size
+        }
+        if (in_last)
+        {
+            memcpy(&io_stream->buffer[length], DF_STREAM_CHUNK_END, sizeof(DF_STREAM_CHUNK_END) - 1);
+            length += sizeof(DF_STREAM_CHUNK_END) - 1;
+        }
+    }
+
+    if (length > 0)
+    {
+        io_stream->output->write(io_stream->buffer, length);
+        io_stream->segments++;
+        io_stream->bytesSent += length;
+        TRACE_COUNT(bytesSent, length);
+    }
+
+    io_stream->length = 0;
+    io_stream->chunkStart = 0;
+    if (io_stream->chunked && !in_last)
+    {
+        io_stream->length = DF_STREAM_CHUNK_HEAD_SIZE;
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_stream_insert
+  * @brief      : Inserts the framing headers between the headers and the body already buffered
+  * @pre-cond.  : framingPending is set and in_length is at most DF_STREAM_FRAMING_SIZE
+  * @post-cond. : The body moved by in_length bytes
+  * @parameters :
+  *       - io_stream: The stream
+  *       - in_text: Bytes to be inserted at bodyStart
+  *       - in_length: Number of bytes
+  * @retval     : None
+  */
+static void ma_api_wifi_stream_insert(st_wifi_stream_t *io_stream, const char *in_text, size_t in_length)
+{
+    memmove(&io_stream->buffer[io_stream->bodyStart + in_length], &io_stream->buffer[io_stream->bodyStart],
+            io_stream->length - io_stream->bodyStart);
+    memcpy(&io_stream->buffer[io_stream->bodyStart], in_text, in_length);
+    io_stream->length += in_length;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,55 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_stream.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the buffered output stream used by the WiFi portal
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_STREAM_H
+#define __MA_API_WIFI_STREAM_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <Arduino.h>
+#include <stdint.h>
+
+/* Define --------------------------------------------------------------------*/
+#ifndef DF_STREAM_TX_BUFFER_SIZE
+#define DF_STREAM_TX_BUFFER_SIZE        1436    // TCP_MSS of the ESP32 lwIP configuration
+#endif
+
+#define DF_STREAM_CHUNK_HEAD_SIZE       6       // Fixed width chunk size "059C\r\n" reserved before the chunk data
+#define DF_STREAM_CHUNK_TAIL_SIZE       7       // "\r\n" plus the last chunk "0\r\n\r\n"
+#define DF_STREAM_FRAMING_SIZE          36      // "Transfer-Encoding: chunked\r\n\r\n" and a chunk size, inserted when the body overflows
+
+/* Typedef -------------------------------------------------------------------*/
+typedef struct {
+  Print *output;
+  uint8_t buffer[DF_STREAM_TX_BUFFER_SIZE + DF_STREAM_CHUNK_TAIL_SIZE];
+  uint16_t length;                  // Bytes waiting in buffer
+  uint16_t capacity;                // Bytes that fit in one segment, without the chunk tail
+  uint16_t chunkStart;              // Offset of the chunk size reserved in buffer
+  uint16_t bodyStart;               // Offset of the body while the framing is not chosen
+  bool chunked;                     // Data is framed with chunked transfer encoding
+  bool framingPending;              // Content-Length or chunked, chosen when the body ends or overflows
+  uint32_t writeCalls;              // Calls to write/print/printf since ma_api_wifi_stream_begin()
+  uint32_t segments;                // Writes given to the output since ma_api_wifi_stream_begin()
+  uint32_t bytesSent;               // Bytes given to the output since ma_api_wifi_stream_begin()
+}st_wifi_stream_t;
+
+/* Public objects ------------------------------------------------------------*/
+extern void ma_api_wifi_stream_begin(st_wifi_stream_t *out_stream, Print *in_output);
+extern void ma_api_wifi_stream_write(st_wifi_stream_t *io_stream, const uint8_t *in_data, size_t in_length);
+extern void ma_api_wifi_stream_print(st_wifi_stream_t *io_stream, const char *in_text);
+extern void ma_api_wifi_stream_printf(st_wifi_stream_t *io_stream, const char *in_format, ...);
+extern void ma_api_wifi_stream_start_chunked(st_wifi_stream_t *io_stream);
+extern void ma_api_wifi_stream_start_body(st_wifi_stream_t *io_stream);
+extern void ma_api_wifi_stream_flush(st_wifi_stream_t *io_stream);
+extern void ma_api_wifi_stream_end(st_wifi_stream_t *io_stream);
+
+#endif /* __MA_API_WIFI_STREAM_H */
+/*****************************END OF FILE**************************************/
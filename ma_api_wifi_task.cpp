@@ -0,0 +1,176 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_task.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Background task of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// C language standard library
+#include <stddef.h>
+#include <atomic>
+
+#ifdef ESP_PLATFORM
+// FreeRTOS
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+// Host build
+#include <chrono>
+#include <thread>
+#endif
+
+// API library
+#include "ma_api_wifi_task.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	ma_api_wifi_task_start() runs a step function in a loop on its own task,
+    sleeping pollPeriodMs between two calls. There is a single task.
+
+2.  On the ESP32 it is a FreeRTOS task with the stack, priority and core of
+    the configuration. On a PC (no ESP_PLATFORM) it is a std::thread and 
+    only pollPeriodMs is used, so the callers can be checked for data races
+    with -fsanitize=thread.
+
+3.  ma_api_wifi_task_stop() waits for the step in progress to end. It must 
+    not be called from the step.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TASK_NAME                    "ma_wifi"
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static std::atomic<bool> bTaskRun(false);
+static std::atomic<bool> bTaskRunning(false);
+static ma_api_wifi_task_step_t pfTaskStep = NULL;
+static uint16_t u16TaskPollPeriodMs = 0;
+
+#ifndef ESP_PLATFORM
+static std::thread clsTaskThread;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static void ma_api_wifi_task_main(void *in_arg);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_task_start
+  * @brief      : Creates the task that calls in_step until ma_api_wifi_task_stop()
+  * @pre-cond.  : The task is not running
+  * @post-cond. : in_step runs on the task
+  * @parameters :
+  *       - in_config: Stack, priority, core and poll period, NULL for DF_WIFI_TASK_CONFIG_DEFAULT
+  *       - in_step: Function called in the loop of the task, must return quickly
+  * @retval     : 0 on success, -1 if the task is running or could not be created
+  */
+int8_t ma_api_wifi_task_start(const st_wifi_task_config_t *in_config, ma_api_wifi_task_step_t in_step)
+{
+    const st_wifi_task_config_t defaultConfig = DF_WIFI_TASK_CONFIG_DEFAULT;
+    const st_wifi_task_config_t *config = (in_config != NULL) ? in_config : &defaultConfig;
+
+    if (in_step == NULL || bTaskRunning.load())
+    {
+        return -1;
+    }
+
+    pfTaskStep = in_step;
+    u16TaskPollPeriodMs = config->pollPeriodMs;
+    bTaskRun.store(true);
+    bTaskRunning.store(true);
+
+#ifdef ESP_PLATFORM
+    BaseType_t core = (config->core == DF_WIFI_TASK_ANY_CORE) ? tskNO_AFFINITY : config->core;
+    if (xTaskCreatePinnedToCore(ma_api_wifi_task_main, DF_TASK_NAME, config->stackBytes, NULL, 
+                                config->priority, NULL, core) != pdPASS)
+    {
+        bTaskRun.store(false);
+        bTaskRunning.store(false);
+        return -1;
+    }
+#else
+    clsTaskThread = std::thread(ma_api_wifi_task_main, (void *)NULL);
+#endif
+    return 0;
+}
+
+/**
+  * @Func       : ma_api_wifi_task_stop
+  * @brief      : Asks the task to end and waits for it
+  * @pre-cond.  : Not called from the step function
+  * @post-cond. : The task is deleted, the step is no longer called
+  * @parameters : None
+  * @retval     : None
+  */
+void ma_api_wifi_task_stop(void)
+{
+    bTaskRun.store(false);
+#ifdef ESP_PLATFORM
+    while (bTaskRunning.load())
+    {
+        vTaskDelay(1);
+    }
+#else
+    if (clsTaskThread.joinable())
+    {
+        clsTaskThread.join();
+    }
+#endif
+}
+
+/**
+  * @Func       : ma_api_wifi_task_is_running
+  * @brief      : Tells if the task is running
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : true between ma_api_wifi_task_start() and the end of the task
+  */
+bool ma_api_wifi_task_is_running(void)
+{
+    return bTaskRunning.load();
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_task_main
+  * @brief      : Loop of the task
+  * @pre-cond.  : Started by ma_api_wifi_task_start()
+  * @post-cond. : bTaskRunning is false when it returns
+  * @parameters : in_arg: Not used
+  * @retval     : None
+  */
+static void ma_api_wifi_task_main(void *in_arg)
+{
+    (void)in_arg;
+    while (bTaskRun.load())
+    {
+        pfTaskStep();
+#ifdef ESP_PLATFORM
+        // At least one tick, so the idle task of the core feeds its watchdog
+        TickType_t ticks = pdMS_TO_TICKS(u16TaskPollPeriodMs);
+        vTaskDelay((ticks > 0) ? ticks : 1);
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(u16TaskPollPeriodMs));
+#endif
+    }
+    bTaskRunning.store(false);
+#ifdef ESP_PLATFORM
+    vTaskDelete(NULL);
+#endif
+}
+
+/*****************************END OF FILE**************************************/
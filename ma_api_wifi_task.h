@@ -0,0 +1,41 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_task.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the background task of the WiFi Api
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_TASK_H
+#define __MA_API_WIFI_TASK_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Define --------------------------------------------------------------------*/
+#define DF_WIFI_TASK_ANY_CORE           (-1)
+
+// stackBytes, priority, core, pollPeriodMs. Core 1 is the one of loop(), the WiFi driver runs on core 0.
+#define DF_WIFI_TASK_CONFIG_DEFAULT     {6144, 1, 1, 10}
+
+/* Typedef -------------------------------------------------------------------*/
+typedef struct {
+  uint32_t stackBytes;              // Stack of the task, the portal responses need about 4 KB
+  uint8_t priority;                 // FreeRTOS priority, loop() runs at 1
+  int8_t core;                      // 0, 1 or DF_WIFI_TASK_ANY_CORE
+  uint16_t pollPeriodMs;            // Sleep between two steps, bounds the portal latency
+}st_wifi_task_config_t;
+
+typedef void (*ma_api_wifi_task_step_t)(void);
+
+/* Public objects ------------------------------------------------------------*/
+extern int8_t ma_api_wifi_task_start(const st_wifi_task_config_t *in_config, ma_api_wifi_task_step_t in_step);
+extern void ma_api_wifi_task_stop(void);
+extern bool ma_api_wifi_task_is_running(void);
+
+#endif /* __MA_API_WIFI_TASK_H */
+/*****************************END OF FILE**************************************/
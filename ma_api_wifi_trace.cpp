@@ -0,0 +1,311 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_api_wifi_trace.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Timeline tracing of the WiFi Api
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+// API library
+#include "ma_api_wifi_trace.h"
+
+#ifdef TRACE_ENABLE
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	Define TRACE_ENABLE in the build. Without it every TRACE_ macro is empty
+    and this file compiles to nothing, as PRINTF does without PRINT_ENABLE.
+
+2.  Put TRACE_SPAN() at the start of a function to record how long it took.
+    Functions called from loop() use TRACE_POLL_SPAN(), which only records
+    the calls that took at least DF_TRACE_POLL_MIN_US, so the idle polls do
+    not flush the timeline. TRACE_NAMED_SPAN() records one block.
+
+3.  Spans are kept in a ring of DF_TRACE_SPAN_COUNT entries with their
+    micros() start time, in the order they ended. Nothing is allocated.
+
+4.  TRACE_DUMP(Serial) prints the counters and the timeline, from the task
+    that polls the Api. Any other task calls ma_api_wifi_print_trace(), 
+    e.g. on eWIFI_EVENT_CONNECTED: it copies the trace under the API lock 
+    and prints the copy without it. The portal serves the same data on 
+    /metrics.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macros ------------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+st_wifi_trace_counters_t stTraceCounters;
+
+static st_wifi_trace_span_t stTraceSpans[DF_TRACE_SPAN_COUNT];
+static uint16_t u16TraceSpanNext = 0;      // Slot of the next span
+static uint32_t u32TraceSpanTotal = 0;     // Spans recorded since boot
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t ma_api_wifi_trace_percentile(const uint32_t *in_buckets, uint8_t in_percent);
+
+/* Body of public functions --------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_trace_scope
+  * @brief      : Takes the start time of the span
+  * @pre-cond.  : None
+  * @post-cond. : The span is recorded when the object goes out of scope
+  * @parameters :
+  *       - in_name: Name of the span, must outlive the trace (function name or literal)
+  *       - in_minDurationUs: Shorter spans are not recorded
+  * @retval     : None
+  */
+ma_api_wifi_trace_scope::ma_api_wifi_trace_scope(const char *in_name, uint32_t in_minDurationUs)
+    : name(in_name), minDurationUs(in_minDurationUs), startUs(micros())
+{
+}
+
+/**
+  * @Func       : ~ma_api_wifi_trace_scope
+  * @brief      : Records the span if it was long enough
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+ma_api_wifi_trace_scope::~ma_api_wifi_trace_scope()
+{
+    uint32_t durationUs = micros() - startUs;
+    if (durationUs >= minDurationUs)
+    {
+        ma_api_wifi_trace_record(name, startUs, durationUs);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_record
+  * @brief      : Adds a span to the ring, overwriting the oldest one when it is full
+  * @pre-cond.  : Called with the API lock held or from the task that polls the Api, the ring is not locked
+  * @post-cond. : None
+  * @parameters :
+  *       - in_name: Name of the span, must outlive the trace
+  *       - in_startUs: micros() at the start
+  *       - in_durationUs: Duration
+  * @retval     : None
+  */
+void ma_api_wifi_trace_record(const char *in_name, uint32_t in_startUs, uint32_t in_durationUs)
+{
+    st_wifi_trace_span_t *span = &stTraceSpans[u16TraceSpanNext];
+
+    span->name = in_name;
+    span->startUs = in_startUs;
+    span->durationUs = in_durationUs;
+    u16TraceSpanNext = (u16TraceSpanNext + 1) % DF_TRACE_SPAN_COUNT;
+    u32TraceSpanTotal++;
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_connect_failure
+  * @brief      : Counts a failed station attempt by disconnect reason
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_reason: Disconnect reason, 0 for a timeout
+  * @retval     : None
+  */
+void ma_api_wifi_trace_connect_failure(uint8_t in_reason)
+{
+    stTraceCounters.connectFailures++;
+    for (uint8_t i = 0; i < DF_TRACE_REASON_SLOTS; i++)
+    {
+        st_wifi_trace_reason_t *slot = &stTraceCounters.failureReasons[i];
+        if (slot->count == 0 || slot->reason == in_reason)
+        {
+            slot->reason = in_reason;
+            slot->count++;
+            return;
+        }
+    }
+    stTraceCounters.otherFailures++;
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_request_latency
+  * @brief      : Adds a served request to the latency histogram
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_latencyMs: Time from the accept, or the first byte on a kept connection, to the response sent
+  * @retval     : None
+  */
+void ma_api_wifi_trace_request_latency(uint32_t in_latencyMs)
+{
+    uint8_t bucket = 0;
+
+    while (bucket < DF_TRACE_LATENCY_BUCKETS - 1 && in_latencyMs >= (1UL << bucket))
+    {
+        bucket++;
+    }
+    stTraceCounters.latencyBuckets[bucket]++;
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_latency_percentile
+  * @brief      : Estimates a request latency percentile from the histogram
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_percent: The percentile, e.g. 50 or 99
+  * @retval     : Upper bound in ms of the bucket that holds the percentile, 0 if no request was served.
+  *               UINT32_MAX if it is in the last bucket, which has no bound.
+  */
+uint32_t ma_api_wifi_trace_latency_percentile(uint8_t in_percent)
+{
+    return ma_api_wifi_trace_percentile(stTraceCounters.latencyBuckets, in_percent);
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_get_spans
+  * @brief      : Copies the spans in the ring, oldest first
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - out_spans: Array that receives the spans
+  *       - in_maxSpans: Size of the array
+  * @retval     : Number of spans copied
+  */
+uint8_t ma_api_wifi_trace_get_spans(st_wifi_trace_span_t *out_spans, uint8_t in_maxSpans)
+{
+    uint32_t count = (u32TraceSpanTotal < DF_TRACE_SPAN_COUNT) ? u32TraceSpanTotal : DF_TRACE_SPAN_COUNT;
+    uint16_t first = (u32TraceSpanTotal < DF_TRACE_SPAN_COUNT) ? 0 : u16TraceSpanNext;
+
+    if (count > in_maxSpans)
+    {
+        first = (first + (count - in_maxSpans)) % DF_TRACE_SPAN_COUNT;
+        count = in_maxSpans;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        out_spans[i] = stTraceSpans[(first + i) % DF_TRACE_SPAN_COUNT];
+    }
+    return (uint8_t)count;
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_snapshot
+  * @brief      : Copies the counters and the spans in the ring
+  * @pre-cond.  : Called with the API lock held or from the task that polls the Api
+  * @post-cond. : None
+  * @parameters : out_snapshot: Receives the copy
+  * @retval     : None
+  */
+void ma_api_wifi_trace_snapshot(st_wifi_trace_snapshot_t *out_snapshot)
+{
+    out_snapshot->counters = stTraceCounters;
+    out_snapshot->spanTotal = u32TraceSpanTotal;
+    out_snapshot->spanCount = ma_api_wifi_trace_get_spans(out_snapshot->spans, DF_TRACE_SPAN_COUNT);
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_print
+  * @brief      : Prints the heap and a copy of the counters and the timeline, one line per span
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - out_output: Where to print, e.g. Serial
+  *       - in_snapshot: Taken by ma_api_wifi_trace_snapshot()
+  * @retval     : None
+  */
+void ma_api_wifi_trace_print(Print *out_output, const st_wifi_trace_snapshot_t *in_snapshot)
+{
+    const st_wifi_trace_counters_t *counters = &in_snapshot->counters;
+
+    out_output->printf("heap free %u, low-water %u\n", (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap());
+    out_output->printf("portal: %lu requests on %lu connections, %lu bytes received, %lu bytes sent\n",
+                       (unsigned long)counters->requestsServed, (unsigned long)counters->connectionsAccepted,
+                       (unsigned long)counters->bytesReceived, (unsigned long)counters->bytesSent);
+    out_output->printf("portal connections: %lu evicted, %lu waits for a slot, %lu timed out\n",
+                       (unsigned long)counters->connectionsEvicted, (unsigned long)counters->connectionsWaiting,
+                       (unsigned long)counters->connectionsTimedOut);
+    out_output->printf("request latency: p50 < %lu ms, p99 < %lu ms\n",
+                       (unsigned long)ma_api_wifi_trace_percentile(counters->latencyBuckets, 50),
+                       (unsigned long)ma_api_wifi_trace_percentile(counters->latencyBuckets, 99));
+    out_output->printf("connect failures: %lu\n", (unsigned long)counters->connectFailures);
+    for (uint8_t i = 0; i < DF_TRACE_REASON_SLOTS && counters->failureReasons[i].count > 0; i++)
+    {
+        out_output->printf("  reason %u: %u\n", counters->failureReasons[i].reason, counters->failureReasons[i].count);
+    }
+    if (counters->otherFailures > 0)
+    {
+        out_output->printf("  other: %lu\n", (unsigned long)counters->otherFailures);
+    }
+
+    out_output->printf("%lu spans, last %lu:\n", (unsigned long)in_snapshot->spanTotal, (unsigned long)in_snapshot->spanCount);
+    for (uint8_t i = 0; i < in_snapshot->spanCount; i++)
+    {
+        const st_wifi_trace_span_t *span = &in_snapshot->spans[i];
+        out_output->printf("  %10lu us %9lu us  %s\n", (unsigned long)span->startUs, (unsigned long)span->durationUs, span->name);
+    }
+}
+
+/**
+  * @Func       : ma_api_wifi_trace_dump
+  * @brief      : Prints the heap, the counters and the timeline, one line per span
+  * @pre-cond.  : Called with the API lock held or from the task that polls the Api
+  * @post-cond. : None
+  * @parameters : out_output: Where to print, e.g. Serial
+  * @retval     : None
+  */
+void ma_api_wifi_trace_dump(Print *out_output)
+{
+    st_wifi_trace_snapshot_t snapshot;
+
+    ma_api_wifi_trace_snapshot(&snapshot);
+    ma_api_wifi_trace_print(out_output, &snapshot);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_api_wifi_trace_percentile
+  * @brief      : Estimates a percentile from a latency histogram
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_buckets: DF_TRACE_LATENCY_BUCKETS counts, see st_wifi_trace_counters_t
+  *       - in_percent: The percentile, e.g. 50 or 99
+  * @retval     : See ma_api_wifi_trace_latency_percentile()
+  */
+static uint32_t ma_api_wifi_trace_percentile(const uint32_t *in_buckets, uint8_t in_percent)
+{
+    uint32_t total = 0;
+    uint32_t cumulative = 0;
+
+    for (uint8_t i = 0; i < DF_TRACE_LATENCY_BUCKETS; i++)
+    {
+        total += in_buckets[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the percentile, rounded up so p99 of few requests is the slowest one
+    uint32_t rank = ((uint64_t)total * in_percent + 99) / 100;
+    for (uint8_t i = 0; i < DF_TRACE_LATENCY_BUCKETS - 1; i++)
+    {
+        cumulative += in_buckets[i];
+        if (cumulative >= rank)
+        {
+            return 1UL << i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+#endif /* TRACE_ENABLE */
+
+/*****************************END OF FILE**************************************/
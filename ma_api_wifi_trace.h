@@ -0,0 +1,117 @@
+/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_trace.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Header file of the timeline tracing of the WiFi Api. Everything
+    *               compiles to nothing unless TRACE_ENABLE is defined.
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_TRACE_H
+#define __MA_API_WIFI_TRACE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <Arduino.h>
+#include <stdint.h>
+
+/* Define --------------------------------------------------------------------*/
+#ifndef DF_TRACE_SPAN_COUNT
+#define DF_TRACE_SPAN_COUNT             32      // Spans kept, the oldest is overwritten
+#endif
+
+#define DF_TRACE_REASON_SLOTS           8       // Distinct disconnect reasons counted, the others go to "other"
+#define DF_TRACE_POLL_MIN_US            1000    // Poll calls shorter than this are not recorded
+#define DF_TRACE_LATENCY_BUCKETS        16      // Request latency histogram: <1 ms, <2 ms, <4 ms ... <16 s, longer
+
+#ifdef TRACE_ENABLE
+
+/* Typedef -------------------------------------------------------------------*/
+typedef struct {
+  const char *name;                 // Function name or literal, never copied
+  uint32_t startUs;                 // micros() at the start, wraps after 71 minutes
+  uint32_t durationUs;
+}st_wifi_trace_span_t;
+
+typedef struct {
+  uint8_t reason;                   // wifi_err_reason_t, 0 for a timeout
+  uint16_t count;
+}st_wifi_trace_reason_t;
+
+typedef struct {
+  uint32_t bytesSent;               // Portal bytes given to the clients
+  uint32_t bytesReceived;           // Portal bytes read from the clients
+  uint32_t requestsServed;
+  uint32_t connectionsAccepted;     // Requests per connection shows how well keep-alive works
+  uint32_t connectionsEvicted;      // Idle connections closed to make room for a new client
+  uint32_t connectionsWaiting;      // Polls in which a new client stayed in the backlog, every connection busy
+  uint32_t connectionsTimedOut;     // Requests not complete within the idle or the request timeout
+  uint32_t latencyBuckets[DF_TRACE_LATENCY_BUCKETS];  // Start of the request to response sent, power of two buckets in ms
+  uint32_t connectFailures;         // Failed station attempts, fast ones included
+  uint32_t otherFailures;           // Failures whose reason did not fit in failureReasons
+  st_wifi_trace_reason_t failureReasons[DF_TRACE_REASON_SLOTS];
+}st_wifi_trace_counters_t;
+
+// Copy of the trace, taken with the API lock held and printed without it
+typedef struct {
+  st_wifi_trace_counters_t counters;
+  uint32_t spanTotal;               // Spans recorded since boot
+  uint8_t spanCount;
+  st_wifi_trace_span_t spans[DF_TRACE_SPAN_COUNT];  // Oldest first
+}st_wifi_trace_snapshot_t;
+
+// Records the time between its construction and the end of the enclosing scope
+class ma_api_wifi_trace_scope
+{
+public:
+  ma_api_wifi_trace_scope(const char *in_name, uint32_t in_minDurationUs);
+  ~ma_api_wifi_trace_scope();
+
+private:
+  const char *name;
+  uint32_t minDurationUs;
+  uint32_t startUs;
+};
+
+/* Public objects ------------------------------------------------------------*/
+extern st_wifi_trace_counters_t stTraceCounters;
+
+extern void ma_api_wifi_trace_record(const char *in_name, uint32_t in_startUs, uint32_t in_durationUs);
+extern void ma_api_wifi_trace_connect_failure(uint8_t in_reason);
+extern void ma_api_wifi_trace_request_latency(uint32_t in_latencyMs);
+extern uint32_t ma_api_wifi_trace_latency_percentile(uint8_t in_percent);
+extern uint8_t ma_api_wifi_trace_get_spans(st_wifi_trace_span_t *out_spans, uint8_t in_maxSpans);
+extern void ma_api_wifi_trace_snapshot(st_wifi_trace_snapshot_t *out_snapshot);
+extern void ma_api_wifi_trace_print(Print *out_output, const st_wifi_trace_snapshot_t *in_snapshot);
+extern void ma_api_wifi_trace_dump(Print *out_output);
+
+#define TRACE_CONCAT_(a, b)             a##b
+#define TRACE_CONCAT(a, b)              TRACE_CONCAT_(a, b)
+
+#define TRACE_SPAN()                    ma_api_wifi_trace_scope TRACE_CONCAT(traceScope, __LINE__)(__func__, 0)
+#define TRACE_POLL_SPAN()               ma_api_wifi_trace_scope TRACE_CONCAT(traceScope, __LINE__)(__func__, DF_TRACE_POLL_MIN_US)
+#define TRACE_NAMED_SPAN(name)          ma_api_wifi_trace_scope TRACE_CONCAT(traceScope, __LINE__)(name, 0)
+#define TRACE_RECORD_MS(name, startMs)  ma_api_wifi_trace_record(name, (uint32_t)(startMs) * 1000UL, (uint32_t)(millis() - (startMs)) * 1000UL)
+#define TRACE_COUNT(counter, value)     (stTraceCounters.counter += (value))
+#define TRACE_CONNECT_FAILURE(reason)   ma_api_wifi_trace_connect_failure(reason)
+#define TRACE_REQUEST_LATENCY(ms)       ma_api_wifi_trace_request_latency(ms)
+#define TRACE_DUMP(output)              ma_api_wifi_trace_dump(&(output))
+
+#else
+
+#define TRACE_SPAN()
+#define TRACE_POLL_SPAN()
+#define TRACE_NAMED_SPAN(name)
+#define TRACE_RECORD_MS(name, startMs)
+#define TRACE_COUNT(counter, value)
+#define TRACE_CONNECT_FAILURE(reason)
+#define TRACE_REQUEST_LATENCY(ms)
+#define TRACE_DUMP(output)
+
+#endif /* TRACE_ENABLE */
+
+#endif /* __MA_API_WIFI_TRACE_H */
+/*****************************END OF FILE**************************************/
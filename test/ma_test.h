@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_test.h
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Test cases of the host build. Each TEST() runs in its own
+  *               process, on a fresh Api, see ma_test_main.cpp
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_TEST_H
+#define __MA_TEST_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+#include "ma_host.h"
+
+/* Define --------------------------------------------------------------------*/
+// TEST(name) { ... }: a test case, found by CMakeLists.txt with the regex ^TEST\([a-z0-9_]+\)
+#define TEST(name) \
+    static void test_##name(void); \
+    static ma_test_registrar_t clsTestRegistrar_##name(#name, test_##name); \
+    static void test_##name(void)
+
+// A failed check ends the test case, from any function it called
+#define CHECK(condition) \
+    do { if (!(condition)) { ma_test_fail(__FILE__, __LINE__, #condition, NULL); } } while (0)
+
+#define CHECK_EQ(expected, actual) \
+    do { \
+        long long checkExpected = (long long)(expected); \
+        long long checkActual = (long long)(actual); \
+        if (checkExpected != checkActual) { ma_test_fail_values(__FILE__, __LINE__, #actual, checkExpected, checkActual); } \
+    } while (0)
+
+// actual may be the c_str() of a temporary String, it lives until the check returns
+#define CHECK_STR(expected, actual) \
+    ma_test_check_str(__FILE__, __LINE__, #actual, (expected), (actual))
+
+/* Typedef -------------------------------------------------------------------*/
+typedef void (*ma_test_function_t)(void);
+
+class ma_test_registrar_t
+{
+public:
+    ma_test_registrar_t(const char *in_name, ma_test_function_t in_function);
+};
+
+/* Public objects ------------------------------------------------------------*/
+extern void ma_test_fail(const char *in_file, int in_line, const char *in_check, const char *in_detail) __attribute__((noreturn));
+extern void ma_test_check_str(const char *in_file, int in_line, const char *in_check, const char *in_expected, const char *in_actual);
+extern void ma_test_fail_values(const char *in_file, int in_line, const char *in_check, long long in_expected, long long in_actual) __attribute__((noreturn));
+
+// Phone side of the portal, on the sockets of the host build
+extern st_host_socket_t *ma_test_connect(uint16_t in_port);
+extern void ma_test_send(st_host_socket_t *io_socket, const char *in_text);
+// Runs in_poll and moves the clock by in_stepMs until the device closed the connection or in_maxPolls
+// ran; gives what the phone received, ended by a '\0'
+extern size_t ma_test_receive(st_host_socket_t *io_socket, void (*in_poll)(void), char *out_buffer, size_t in_size, uint32_t in_maxPolls, uint32_t in_stepMs);
+// One request on its own connection to the portal, answered by ma_api_wifi_portal_poll(); gives what was
+// received until the portal closed, so the request needs "Connection: close"
+extern size_t ma_test_portal_request(const char *in_request, char *out_response, size_t in_size);
+
+#endif /* __MA_TEST_H */
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,244 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : ma_test_main.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Runner of the test cases of one test file
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+
+/*******************************************************************************
+							HOW TO USE THIS API
+********************************************************************************
+
+1. 	"test_x <name>" runs one case, "test_x --list" lists them and "test_x"
+    runs them all, each in a child process. ctest runs one case per
+    process, see ma_wifi_test() in CMakeLists.txt.
+
+2.  A case starts on a powered-on device: the Api has never run, the clock
+    is at 0, the NVS is empty and SPIFFS is an empty directory of its own,
+    removed at the end.
+
+*******************************************************************************/
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_MAX_CASES               128
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  const char *name;
+  ma_test_function_t function;
+}st_test_case_t;
+
+// Thrown by a failed check, caught by the runner
+typedef struct {
+  int line;
+}st_test_failure_t;
+
+/* Private variables ---------------------------------------------------------*/
+static st_test_case_t stTestCases[DF_TEST_MAX_CASES];
+static uint8_t u8TestCaseCount = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static int ma_test_run(const st_test_case_t *in_case);
+static void ma_test_remove_dir(const char *in_path);
+
+/* Body of public functions --------------------------------------------------*/
+ma_test_registrar_t::ma_test_registrar_t(const char *in_name, ma_test_function_t in_function)
+{
+    if (u8TestCaseCount < DF_TEST_MAX_CASES)
+    {
+        stTestCases[u8TestCaseCount].name = in_name;
+        stTestCases[u8TestCaseCount].function = in_function;
+        u8TestCaseCount++;
+    }
+}
+
+void ma_test_fail(const char *in_file, int in_line, const char *in_check, const char *in_detail)
+{
+    fprintf(stderr, "%s:%d: CHECK(%s) failed%s%s\n", in_file, in_line, in_check,
+            (in_detail != NULL) ? ", got: " : "", (in_detail != NULL) ? in_detail : "");
+    st_test_failure_t failure = {in_line};
+    throw failure;
+}
+
+void ma_test_fail_values(const char *in_file, int in_line, const char *in_check, long long in_expected, long long in_actual)
+{
+    fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", in_file, in_line, in_check, in_actual, in_expected);
+    st_test_failure_t failure = {in_line};
+    throw failure;
+}
+
+void ma_test_check_str(const char *in_file, int in_line, const char *in_check, const char *in_expected, const char *in_actual)
+{
+    if (strcmp(in_expected, in_actual) != 0)
+    {
+        fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", in_file, in_line, in_check, in_actual, in_expected);
+        st_test_failure_t failure = {in_line};
+        throw failure;
+    }
+}
+
+st_host_socket_t *ma_test_connect(uint16_t in_port)
+{
+    st_host_socket_t *socket = ma_host_net_connect(in_port);
+    CHECK(socket != NULL);
+    return socket;
+}
+
+void ma_test_send(st_host_socket_t *io_socket, const char *in_text)
+{
+    size_t length = strlen(in_text);
+    CHECK_EQ(length, ma_host_net_send(io_socket, in_text, length));
+}
+
+size_t ma_test_receive(st_host_socket_t *io_socket, void (*in_poll)(void), char *out_buffer, size_t in_size, uint32_t in_maxPolls, uint32_t in_stepMs)
+{
+    size_t length = 0;
+    for (uint32_t i = 0; i < in_maxPolls; i++)
+    {
+        in_poll();
+        length += ma_host_net_recv(io_socket, out_buffer + length, in_size - 1 - length);
+        if (ma_host_net_is_closed(io_socket) && ma_host_net_pending(io_socket) == 0)
+        {
+            break;
+        }
+        ma_host_clock_advance(in_stepMs);
+    }
+    out_buffer[length] = '\0';
+    return length;
+}
+
+size_t ma_test_portal_request(const char *in_request, char *out_response, size_t in_size)
+{
+    st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(socket, in_request);
+    size_t length = ma_test_receive(socket, ma_api_wifi_portal_poll, out_response, in_size, 1000, 1);
+    ma_host_net_release(socket);
+    return length;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--list") == 0)
+    {
+        for (uint8_t i = 0; i < u8TestCaseCount; i++)
+        {
+            printf("%s\n", stTestCases[i].name);
+        }
+        return 0;
+    }
+
+    if (argc > 1)
+    {
+        for (uint8_t i = 0; i < u8TestCaseCount; i++)
+        {
+            if (strcmp(argv[1], stTestCases[i].name) == 0)
+            {
+                return ma_test_run(&stTestCases[i]);
+            }
+        }
+        fprintf(stderr, "No test case %s\n", argv[1]);
+        return 2;
+    }
+
+    uint8_t failed = 0;
+    for (uint8_t i = 0; i < u8TestCaseCount; i++)
+    {
+        fflush(stdout);
+        pid_t child = fork();
+        if (child == 0)
+        {
+            _exit(ma_test_run(&stTestCases[i]));
+        }
+        int status = 1;
+        waitpid(child, &status, 0);
+        bool passed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        printf("%-48s %s\n", stTestCases[i].name, passed ? "ok" : "FAILED");
+        failed += passed ? 0 : 1;
+    }
+    printf("%u of %u failed\n", (unsigned)failed, (unsigned)u8TestCaseCount);
+    return (failed == 0) ? 0 : 1;
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : ma_test_run
+  * @brief      : Runs one case with its own SPIFFS directory
+  * @pre-cond.  : Nothing of the Api ran in this process
+  * @post-cond. : The directory is removed
+  * @parameters : in_case: Test case
+  * @retval     : Exit status, 0 when it passed
+  */
+static int ma_test_run(const st_test_case_t *in_case)
+{
+    char root[] = "/tmp/ma_test_XXXXXX";
+    int result = 0;
+
+    if (mkdtemp(root) == NULL)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    ma_host_fs_set_root(root);
+    ma_host_reset();
+
+    try
+    {
+        in_case->function();
+    }
+    catch (const st_test_failure_t &)
+    {
+        result = 1;
+    }
+    catch (const ma_host_restart_t &restart)
+    {
+        fprintf(stderr, "Unexpected esp_restart() number %u\n", (unsigned)restart.count);
+        result = 1;
+    }
+    ma_test_remove_dir(root);
+    return result;
+}
+
+/**
+  * @Func       : ma_test_remove_dir
+  * @brief      : Removes a directory and its files
+  * @pre-cond.  : The directory has no sub-directory
+  * @post-cond. : None
+  * @parameters : in_path: Directory
+  * @retval     : None
+  */
+static void ma_test_remove_dir(const char *in_path)
+{
+    DIR *directory = opendir(in_path);
+    if (directory != NULL)
+    {
+        for (struct dirent *entry = readdir(directory); entry != NULL; entry = readdir(directory))
+        {
+            char path[512];
+            if (entry->d_name[0] != '.')
+            {
+                snprintf(path, sizeof(path), "%s/%s", in_path, entry->d_name);
+                unlink(path);
+            }
+        }
+        closedir(directory);
+    }
+    rmdir(in_path);
+}
+
+/*****************************END OF FILE**************************************/
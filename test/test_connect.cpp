@@ -0,0 +1,272 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_connect.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the station connect state machine, on the simulated
+  *               radio and its virtual clock
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_SSID                    "home"
+#define DF_TEST_PASSWORD                "password1"
+#define DF_TEST_MAX_BEGINS              8
+#define DF_TEST_MAX_MS                  60000   // A connection that is still running then is a failure
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  uint32_t elapsedMs;               // From the call of ma_api_wifi_connect_async() to the end of the connection
+  uint8_t beginCount;
+  uint32_t beginMs[DF_TEST_MAX_BEGINS];     // Time of each WiFi.begin(), on the same scale
+}st_test_run_t;
+
+/* Private variables ---------------------------------------------------------*/
+static const st_host_wifi_timing_t stTestTiming = DF_HOST_WIFI_TIMING_DEFAULT;
+static uint8_t u8TestCallbacks = 0;
+static e_wifi_connect_result_t eTestResult = eWIFI_CONNECT_RESULT_CANCELLED;
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_connect(const char *in_password, const st_wifi_connect_config_t *in_config, st_test_run_t *out_run);
+static void test_run(st_test_run_t *io_run);
+static uint32_t test_begins(void);
+static void test_callback(e_wifi_connect_result_t in_result);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(connected_as_soon_as_the_address_arrives)
+{
+    st_test_run_t run;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    test_connect(DF_TEST_PASSWORD, NULL, &run);
+
+    CHECK_EQ(eWIFI_STATION_CONNECTED, ma_api_wifi_get_station_state());
+    CHECK_EQ(1, u8TestCallbacks);
+    CHECK_EQ(eWIFI_CONNECT_RESULT_CONNECTED, eTestResult);
+    CHECK_EQ(stTestTiming.connectMs + stTestTiming.dhcpMs, run.elapsedMs - run.beginMs[0]);
+    st_wifi_connect_stats_t stats = ma_api_wifi_get_connect_stats();
+    CHECK_EQ(eWIFI_CONNECT_PATH_FULL, stats.path);
+    CHECK_EQ(1, stats.attempts);
+    CHECK_EQ(run.elapsedMs, stats.connectMs);
+}
+
+TEST(second_connection_takes_the_fast_path)
+{
+    st_test_run_t run;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    test_connect(DF_TEST_PASSWORD, NULL, &run);
+    WiFi.disconnect();
+    ma_host_clock_advance(10);
+
+    test_connect(DF_TEST_PASSWORD, NULL, &run);
+    CHECK_EQ(eWIFI_CONNECT_RESULT_CONNECTED, eTestResult);
+    CHECK_EQ(eWIFI_CONNECT_PATH_FAST, ma_api_wifi_get_connect_stats().path);
+    // Cached channel and BSSID, and the cached address instead of DHCP
+    CHECK_EQ(stTestTiming.fastConnectMs, run.elapsedMs - run.beginMs[0]);
+}
+
+TEST(wrong_password_fails_fast)
+{
+    st_wifi_connect_config_t config = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+    st_test_run_t run;
+
+    config.maxAttempts = 10;
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    test_connect("password2", &config, &run);
+
+    CHECK_EQ(eWIFI_STATION_FAILED, ma_api_wifi_get_station_state());
+    CHECK_EQ(eWIFI_CONNECT_RESULT_WRONG_PASSWORD, eTestResult);
+    CHECK_EQ(config.fatalFailureLimit, ma_api_wifi_get_connect_stats().attempts);
+    CHECK_EQ(config.fatalFailureLimit, run.beginCount);
+    CHECK(run.elapsedMs - run.beginMs[0] <= config.fatalFailureLimit * stTestTiming.connectMs + config.backoffBaseMs);
+}
+
+TEST(missing_network_fails_fast)
+{
+    st_wifi_connect_config_t config = DF_WIFI_CONNECT_CONFIG_DEFAULT;
+    st_test_run_t run;
+
+    config.maxAttempts = 10;
+    test_connect(DF_TEST_PASSWORD, &config, &run);
+
+    CHECK_EQ(eWIFI_CONNECT_RESULT_AP_NOT_FOUND, eTestResult);
+    CHECK_EQ(config.fatalFailureLimit, run.beginCount);
+}
+
+TEST(transient_failures_back_off)
+{
+    st_wifi_connect_config_t config = {5, 5000, 400, 8000, 2};
+    st_test_run_t run;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    ma_host_wifi_fail_next(WIFI_REASON_ASSOC_FAIL, 3);
+    test_connect(DF_TEST_PASSWORD, &config, &run);
+
+    CHECK_EQ(eWIFI_CONNECT_RESULT_CONNECTED, eTestResult);
+    CHECK_EQ(4, run.beginCount);
+    // Each wait is between half and all of base * 2^(attempt - 1)
+    for (uint8_t i = 1; i < run.beginCount; i++)
+    {
+        uint32_t waitMs = run.beginMs[i] - run.beginMs[i - 1] - stTestTiming.connectMs;
+        uint32_t backoffMs = config.backoffBaseMs << (i - 1);
+        CHECK(waitMs >= backoffMs / 2);
+        CHECK(waitMs <= backoffMs + 1);
+    }
+}
+
+TEST(backoff_stops_at_its_limit)
+{
+    st_wifi_connect_config_t config = {6, 5000, 1000, 1500, 2};
+    st_test_run_t run;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    ma_host_wifi_fail_next(WIFI_REASON_ASSOC_FAIL, 20);
+    test_connect(DF_TEST_PASSWORD, &config, &run);
+
+    CHECK_EQ(eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED, eTestResult);
+    CHECK_EQ(config.maxAttempts, run.beginCount);
+    for (uint8_t i = 1; i < run.beginCount; i++)
+    {
+        CHECK(run.beginMs[i] - run.beginMs[i - 1] - stTestTiming.connectMs <= config.backoffMaxMs + 1);
+    }
+}
+
+TEST(silent_attempt_times_out)
+{
+    st_wifi_connect_config_t config = {2, 1000, 100, 100, 2};
+    st_host_wifi_timing_t timing = DF_HOST_WIFI_TIMING_DEFAULT;
+    st_test_run_t run;
+
+    timing.connectMs = 3000;
+    ma_host_wifi_set_timing(&timing);
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    test_connect(DF_TEST_PASSWORD, &config, &run);
+
+    CHECK_EQ(eWIFI_CONNECT_RESULT_ATTEMPTS_EXHAUSTED, eTestResult);
+    CHECK_EQ(0, ma_api_wifi_get_connect_stats().lastReason);
+    CHECK_EQ(2, run.beginCount);
+    CHECK(run.beginMs[1] - run.beginMs[0] >= config.attemptTimeoutMs);
+    CHECK(run.elapsedMs - run.beginMs[0] < timing.connectMs);
+}
+
+TEST(cancel_ends_the_connection_once)
+{
+    st_wifi_credential_t credential;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    CHECK_EQ(0, ma_api_wifi_credential_set(&credential, DF_TEST_SSID, DF_TEST_PASSWORD));
+    CHECK_EQ(0, ma_api_wifi_connect_async(credential, NULL, test_callback));
+    ma_host_clock_advance(100);
+    ma_api_wifi_station_poll();
+    ma_api_wifi_connect_cancel();
+    CHECK_EQ(eWIFI_CONNECT_RESULT_CANCELLED, eTestResult);
+
+    // The events of the attempt that was cut do not revive it
+    ma_host_clock_advance(stTestTiming.connectMs + stTestTiming.dhcpMs);
+    ma_api_wifi_station_poll();
+    CHECK_EQ(eWIFI_STATION_FAILED, ma_api_wifi_get_station_state());
+    CHECK_EQ(1, u8TestCallbacks);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_connect
+  * @brief      : Starts a connection to DF_TEST_SSID and runs it to the end
+  * @pre-cond.  : None
+  * @post-cond. : The connection ended, the callback was called
+  * @parameters :
+  *       - in_password: Password given to the station
+  *       - in_config: Connect configuration, NULL for the default
+  *       - out_run: Timings of the connection
+  * @retval     : None
+  */
+static void test_connect(const char *in_password, const st_wifi_connect_config_t *in_config, st_test_run_t *out_run)
+{
+    st_wifi_credential_t credential;
+
+    memset(out_run, 0, sizeof(*out_run));
+    u8TestCallbacks = 0;
+    CHECK_EQ(0, ma_api_wifi_credential_set(&credential, DF_TEST_SSID, in_password));
+    uint32_t begins = test_begins();
+    uint64_t startUs = ma_host_clock_us();
+    CHECK_EQ(0, ma_api_wifi_connect_async(credential, in_config, test_callback));
+    // The first WiFi.begin() is the last step of ma_api_wifi_connect_async()
+    CHECK_EQ(begins + 1, test_begins());
+    out_run->beginCount = 1;
+    out_run->beginMs[0] = (uint32_t)((ma_host_clock_us() - startUs) / 1000u);
+    test_run(out_run);
+}
+
+/**
+  * @Func       : test_run
+  * @brief      : Polls the state machine each millisecond of the virtual clock until the connection ends,
+  *               and notes the time of each WiFi.begin()
+  * @pre-cond.  : A connection was started, io_run holds its first WiFi.begin()
+  * @post-cond. : State eWIFI_STATION_CONNECTED or eWIFI_STATION_FAILED
+  * @parameters : io_run: Timings of the connection
+  * @retval     : None
+  */
+static void test_run(st_test_run_t *io_run)
+{
+    uint32_t begins = test_begins();
+
+    for (uint32_t ms = io_run->beginMs[0]; ms < DF_TEST_MAX_MS; ms++)
+    {
+        e_wifi_station_state_t state = ma_api_wifi_get_station_state();
+        if (state == eWIFI_STATION_CONNECTED || state == eWIFI_STATION_FAILED)
+        {
+            io_run->elapsedMs = ms;
+            return;
+        }
+        ma_host_clock_advance(1);
+        ma_api_wifi_station_poll();
+
+        if (test_begins() != begins)
+        {
+            begins = test_begins();
+            CHECK(io_run->beginCount < DF_TEST_MAX_BEGINS);
+            io_run->beginMs[io_run->beginCount++] = ms + 1;
+        }
+    }
+    CHECK(false);
+}
+
+/**
+  * @Func       : test_begins
+  * @brief      : WiFi.begin() calls so far, fast ones included
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Number of calls
+  */
+static uint32_t test_begins(void)
+{
+    st_host_wifi_stats_t stats;
+
+    ma_host_wifi_get_stats(&stats);
+    return stats.begins;
+}
+
+/**
+  * @Func       : test_callback
+  * @brief      : Completion callback of the connection
+  * @pre-cond.  : None
+  * @post-cond. : Result kept
+  * @parameters : in_result: Result of the connection
+  * @retval     : None
+  */
+static void test_callback(e_wifi_connect_result_t in_result)
+{
+    u8TestCallbacks++;
+    eTestResult = in_result;
+}
+
+/*****************************END OF FILE**************************************/
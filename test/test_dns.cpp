@@ -0,0 +1,299 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_dns.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the captive portal DNS responder, on a loopback UDP
+  *               socket, with the queries of tools/dns_probe.py
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "ma_test.h"
+#include "ma_api_wifi_dns.h"
+
+// After IPAddress.h, whose INADDR_NONE object the macro of netinet/in.h would hide
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_TYPE_A                  1
+#define DF_TEST_TYPE_AAAA               28
+#define DF_TEST_TYPE_ANY                255
+#define DF_TEST_FIRST_PORT              20000   // Far from 53, which needs root, the port depends on the pid
+#define DF_TEST_PORT_TRIES              16
+#define DF_TEST_MAX_POLLS               1000
+#define DF_TEST_MAX_LATENCY_US          20000   // Round trip of one query, the same process on both sides
+#define DF_TEST_ROUNDS                  200
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  const char *name;
+  uint16_t type;
+  bool answer;                      // An A record with the portal address is expected
+}st_test_query_t;
+
+/* Private variables ---------------------------------------------------------*/
+static const uint8_t u8TestPortalIp[4] = {192, 168, 123, 123};
+
+// The connectivity checks of the phones, then a local name and a query the portal has no record for
+static const st_test_query_t stTestQueries[] = {
+    {"connectivitycheck.gstatic.com", DF_TEST_TYPE_A, true},       // Android, Chrome OS
+    {"clients3.google.com", DF_TEST_TYPE_A, true},
+    {"captive.apple.com", DF_TEST_TYPE_A, true},                   // iOS, macOS
+    {"www.msftconnecttest.com", DF_TEST_TYPE_A, true},             // Windows 10 and later
+    {"detectportal.firefox.com", DF_TEST_TYPE_A, true},            // Firefox
+    {"sobreiro.local", DF_TEST_TYPE_ANY, true},
+    {"connectivitycheck.gstatic.com", DF_TEST_TYPE_AAAA, false},
+};
+
+static int iTestClient = -1;
+static uint16_t u16TestPort = 0;
+static uint16_t u16TestQueryId = 0x1200;
+static uint8_t u8TestMessage[DF_WIFI_DNS_BUFFER_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_start(void);
+static size_t test_build_query(const char *in_name, uint16_t in_type, bool in_edns);
+static size_t test_exchange(size_t in_length, uint32_t *out_latencyUs);
+static void test_check_answer(size_t in_length, const st_test_query_t *in_query);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(scripted_queries_are_answered)
+{
+    uint32_t latencyUs;
+
+    test_start();
+    for (size_t i = 0; i < sizeof(stTestQueries) / sizeof(stTestQueries[0]); i++)
+    {
+        for (uint8_t edns = 0; edns < 2; edns++)
+        {
+            size_t length = test_build_query(stTestQueries[i].name, stTestQueries[i].type, edns != 0);
+            length = test_exchange(length, &latencyUs);
+            test_check_answer(length, &stTestQueries[i]);
+            printf("%-32s type %3u edns %u: %u us\n", stTestQueries[i].name, stTestQueries[i].type, edns, (unsigned)latencyUs);
+        }
+    }
+
+    st_wifi_dns_stats_t stats = ma_api_wifi_dns_get_stats();
+    CHECK_EQ(12, stats.answered);
+    CHECK_EQ(2, stats.empty);
+    CHECK_EQ(0, stats.dropped);
+    ma_api_wifi_dns_stop();
+}
+
+TEST(query_latency_stays_low)
+{
+    uint32_t latencyUs;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+    uint32_t count = 0;
+    st_host_stats_t before;
+    st_host_stats_t after;
+
+    test_start();
+    ma_host_get_stats(&before);
+    for (uint32_t round = 0; round < DF_TEST_ROUNDS; round++)
+    {
+        for (size_t i = 0; i < sizeof(stTestQueries) / sizeof(stTestQueries[0]); i++)
+        {
+            size_t length = test_build_query(stTestQueries[i].name, stTestQueries[i].type, false);
+            length = test_exchange(length, &latencyUs);
+            test_check_answer(length, &stTestQueries[i]);
+            maxUs = (latencyUs > maxUs) ? latencyUs : maxUs;
+            totalUs += latencyUs;
+            count++;
+        }
+    }
+    ma_host_get_stats(&after);
+    printf("%u queries: mean %u us, max %u us\n", (unsigned)count, (unsigned)(totalUs / count), (unsigned)maxUs);
+
+    // One fixed buffer, nothing comes from the heap
+    CHECK_EQ(0, after.allocations - before.allocations);
+    CHECK(maxUs < DF_TEST_MAX_LATENCY_US);
+    ma_api_wifi_dns_stop();
+}
+
+TEST(malformed_messages_are_not_answered)
+{
+    uint32_t latencyUs;
+
+    test_start();
+
+    // A response, e.g. our own answer sent back
+    size_t length = test_build_query("captive.apple.com", DF_TEST_TYPE_A, false);
+    u8TestMessage[2] |= 0x80;
+    CHECK_EQ(0, test_exchange(length, &latencyUs));
+
+    // Shorter than a header, then a name that runs past the end
+    CHECK_EQ(0, test_exchange(5, &latencyUs));
+    length = test_build_query("captive.apple.com", DF_TEST_TYPE_A, false);
+    CHECK_EQ(0, test_exchange(20, &latencyUs));
+
+    // Other opcode: header alone, "not implemented"
+    length = test_build_query("captive.apple.com", DF_TEST_TYPE_A, false);
+    u8TestMessage[2] |= 0x10;
+    CHECK_EQ(12, test_exchange(length, &latencyUs));
+    CHECK_EQ(4, u8TestMessage[3] & 0x0F);
+
+    // The responder still answers once the junk is gone
+    length = test_build_query("captive.apple.com", DF_TEST_TYPE_A, false);
+    test_check_answer(test_exchange(length, &latencyUs), &stTestQueries[2]);
+    ma_api_wifi_dns_stop();
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_start
+  * @brief      : Starts the responder on a free loopback port and opens the client socket
+  * @pre-cond.  : None
+  * @post-cond. : u16TestPort and iTestClient are set
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_start(void)
+{
+    struct timeval timeout = {0, 100000};
+
+    for (uint8_t i = 0; i < DF_TEST_PORT_TRIES && u16TestPort == 0; i++)
+    {
+        uint16_t port = (uint16_t)(DF_TEST_FIRST_PORT + (getpid() * DF_TEST_PORT_TRIES + i) % 40000);
+        if (ma_api_wifi_dns_start(port, u8TestPortalIp) == 0)
+        {
+            u16TestPort = port;
+        }
+    }
+    CHECK(u16TestPort != 0);
+
+    iTestClient = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(iTestClient >= 0);
+    setsockopt(iTestClient, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+/**
+  * @Func       : test_build_query
+  * @brief      : Writes a query with one question into u8TestMessage, as tools/dns_probe.py does
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_name: Name asked for, labels split by dots
+  *       - in_type: Record type
+  *       - in_edns: Adds the OPT record of EDNS, which the answer must drop
+  * @retval     : Length of the query
+  */
+static size_t test_build_query(const char *in_name, uint16_t in_type, bool in_edns)
+{
+    static const uint8_t opt[] = {0, 0x00, 41, 0x04, 0xD0, 0, 0, 0, 0, 0, 0};
+    size_t length = 12;
+
+    u16TestQueryId++;
+    memset(u8TestMessage, 0, sizeof(u8TestMessage));
+    u8TestMessage[0] = (uint8_t)(u16TestQueryId >> 8);
+    u8TestMessage[1] = (uint8_t)u16TestQueryId;
+    u8TestMessage[2] = 0x01;            // RD
+    u8TestMessage[5] = 1;               // QDCOUNT
+    u8TestMessage[11] = in_edns ? 1 : 0;
+
+    while (*in_name != '\0')
+    {
+        const char *dot = strchr(in_name, '.');
+        size_t label = (dot != NULL) ? (size_t)(dot - in_name) : strlen(in_name);
+        u8TestMessage[length] = (uint8_t)label;
+        memcpy(&u8TestMessage[length + 1], in_name, label);
+        length += label + 1;
+        in_name += label + ((dot != NULL) ? 1 : 0);
+    }
+    u8TestMessage[length++] = 0;
+    u8TestMessage[length++] = (uint8_t)(in_type >> 8);
+    u8TestMessage[length++] = (uint8_t)in_type;
+    u8TestMessage[length++] = 0;
+    u8TestMessage[length++] = 1;        // Class IN
+
+    if (in_edns)
+    {
+        memcpy(&u8TestMessage[length], opt, sizeof(opt));
+        length += sizeof(opt);
+    }
+    return length;
+}
+
+/**
+  * @Func       : test_exchange
+  * @brief      : Sends u8TestMessage to the responder, polls it and reads its answer back
+  * @pre-cond.  : test_start() was called
+  * @post-cond. : u8TestMessage holds the answer
+  * @parameters :
+  *       - in_length: Length of the query
+  *       - out_latencyUs: Wall time from the send to the answer
+  * @retval     : Length of the answer, 0 if the responder did not answer
+  */
+static size_t test_exchange(size_t in_length, uint32_t *out_latencyUs)
+{
+    struct sockaddr_in server;
+    uint8_t answered = 0;
+
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons(u16TestPort);
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    auto start = std::chrono::steady_clock::now();
+    CHECK_EQ(in_length, sendto(iTestClient, u8TestMessage, in_length, 0, (struct sockaddr *)&server, sizeof(server)));
+    // The datagram is normally there at the first poll, the loop only covers a slow scheduler
+    for (uint32_t i = 0; i < DF_TEST_MAX_POLLS && answered == 0; i++)
+    {
+        st_wifi_dns_stats_t stats = ma_api_wifi_dns_get_stats();
+        answered = ma_api_wifi_dns_poll();
+        st_wifi_dns_stats_t after = ma_api_wifi_dns_get_stats();
+        if (after.dropped != stats.dropped)
+        {
+            *out_latencyUs = 0;
+            return 0;
+        }
+        if (answered == 0)
+        {
+            usleep(10);
+        }
+    }
+    CHECK_EQ(1, answered);
+
+    ssize_t received = recv(iTestClient, u8TestMessage, sizeof(u8TestMessage), 0);
+    auto end = std::chrono::steady_clock::now();
+    CHECK(received > 0);
+    *out_latencyUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    return (size_t)received;
+}
+
+/**
+  * @Func       : test_check_answer
+  * @brief      : Checks the answer in u8TestMessage, as tools/dns_probe.py does
+  * @pre-cond.  : test_exchange() returned in_length
+  * @post-cond. : None
+  * @parameters :
+  *       - in_length: Length of the answer
+  *       - in_query: The query it answers
+  * @retval     : None
+  */
+static void test_check_answer(size_t in_length, const st_test_query_t *in_query)
+{
+    CHECK(in_length >= 12);
+    CHECK_EQ(u16TestQueryId, (u8TestMessage[0] << 8) | u8TestMessage[1]);
+    CHECK((u8TestMessage[2] & 0x80) != 0);          // QR
+    CHECK_EQ(0, u8TestMessage[3] & 0x0F);           // RCODE
+    CHECK_EQ(1, u8TestMessage[5]);                  // QDCOUNT
+    CHECK_EQ(0, u8TestMessage[8] | u8TestMessage[9] | u8TestMessage[10] | u8TestMessage[11]);
+    CHECK_EQ(in_query->answer ? 1 : 0, u8TestMessage[7]);
+    if (in_query->answer)
+    {
+        CHECK(memcmp(&u8TestMessage[in_length - 4], u8TestPortalIp, 4) == 0);
+    }
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,314 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_form.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the decoder of the query string and of the form body
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <string>
+
+#include "ma_test.h"
+#include "ma_api_wifi_http.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_FUZZ_RUNS               20000
+#define DF_TEST_FUZZ_MAX_LENGTH         48
+#define DF_TEST_GUARD                   0x5A    // Written after each value buffer, must survive the decoder
+#define DF_TEST_MAX_KEY_LENGTH          16      // DF_FORM_MAX_KEY_LENGTH of the decoder
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  char ssid[33];
+  char password[65];
+  st_wifi_form_field_t fields[2];
+}st_test_form_t;
+
+/* Private variables ---------------------------------------------------------*/
+static st_test_form_t stTestForm;
+static uint32_t u32TestRandom = 2463534242u;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t test_decode(const char *in_data);
+static void test_form_init(uint16_t in_ssidSize, uint16_t in_passwordSize);
+static uint32_t test_random(uint32_t in_range);
+static int16_t test_reference_value(const std::string &in_data, const char *in_key, uint16_t in_size, std::string *out_value);
+static bool test_reference_unescape(const std::string &in_text, std::string *out_text);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(percent_escapes_are_decoded)
+{
+    CHECK_EQ(2, test_decode("ssid=My%20Home%26Co&password=p%2Bss+word%3D"));
+    CHECK_STR("My Home&Co", stTestForm.ssid);
+    CHECK_STR("p+ss word=", stTestForm.password);
+    CHECK_EQ(10, stTestForm.fields[0].length);
+}
+
+TEST(utf8_ssid_in_either_case)
+{
+    CHECK_EQ(1, test_decode("ssid=Caf%C3%A9"));
+    CHECK_STR("Caf\xC3\xA9", stTestForm.ssid);
+    CHECK_EQ(5, stTestForm.fields[0].length);
+    CHECK_EQ(1, test_decode("ssid=caf%c3%a9"));
+    CHECK_STR("caf\xC3\xA9", stTestForm.ssid);
+}
+
+TEST(broken_escapes_are_kept)
+{
+    CHECK_EQ(1, test_decode("ssid=100%"));
+    CHECK_STR("100%", stTestForm.ssid);
+    CHECK_EQ(1, test_decode("ssid=%4"));
+    CHECK_STR("%4", stTestForm.ssid);
+    CHECK_EQ(1, test_decode("ssid=%G1x"));
+    CHECK_STR("%G1x", stTestForm.ssid);
+    CHECK_EQ(1, test_decode("ssid=%%41"));
+    CHECK_STR("%A", stTestForm.ssid);
+    CHECK_EQ(1, test_decode("ssid=%4%41"));
+    CHECK_STR("%4A", stTestForm.ssid);
+}
+
+TEST(null_byte_is_refused)
+{
+    CHECK_EQ(1, test_decode("ssid=a%00b&password=ok"));
+    CHECK_EQ(-2, stTestForm.fields[0].length);
+    CHECK_STR("", stTestForm.ssid);
+    CHECK_STR("ok", stTestForm.password);
+}
+
+TEST(value_must_fit_its_buffer)
+{
+    test_form_init(5, sizeof(stTestForm.password));
+    CHECK_EQ(1, ma_api_wifi_form_decode("ssid=1234", 9, stTestForm.fields, 2));
+    CHECK_STR("1234", stTestForm.ssid);
+
+    test_form_init(5, sizeof(stTestForm.password));
+    CHECK_EQ(0, ma_api_wifi_form_decode("ssid=12345", 10, stTestForm.fields, 2));
+    CHECK_EQ(-2, stTestForm.fields[0].length);
+    CHECK_STR("", stTestForm.ssid);
+
+    // An escape counts as one byte
+    test_form_init(5, sizeof(stTestForm.password));
+    CHECK_EQ(1, ma_api_wifi_form_decode("ssid=%31%32%33%34", 17, stTestForm.fields, 2));
+    CHECK_STR("1234", stTestForm.ssid);
+}
+
+TEST(empty_and_missing_values)
+{
+    CHECK_EQ(2, test_decode("ssid=&password"));
+    CHECK_EQ(0, stTestForm.fields[0].length);
+    CHECK_EQ(0, stTestForm.fields[1].length);
+
+    CHECK_EQ(0, test_decode("&&=x&ssidx=1&=&"));
+    CHECK_EQ(-1, stTestForm.fields[0].length);
+    CHECK_EQ(-1, stTestForm.fields[1].length);
+
+    CHECK_EQ(0, test_decode(""));
+}
+
+TEST(keys_are_decoded_and_first_one_wins)
+{
+    CHECK_EQ(1, test_decode("ss%69d=first&ssid=second"));
+    CHECK_STR("first", stTestForm.ssid);
+
+    // Query string, then body: the query keeps its value
+    test_form_init(sizeof(stTestForm.ssid), sizeof(stTestForm.password));
+    CHECK_EQ(1, ma_api_wifi_form_decode("ssid=query", 10, stTestForm.fields, 2));
+    CHECK_EQ(1, ma_api_wifi_form_decode("ssid=body&password=pw", 21, stTestForm.fields, 2));
+    CHECK_STR("query", stTestForm.ssid);
+    CHECK_STR("pw", stTestForm.password);
+
+}
+
+TEST(refused_value_is_not_replaced_by_a_duplicate)
+{
+    test_form_init(5, sizeof(stTestForm.password));
+    CHECK_EQ(1, ma_api_wifi_form_decode("ssid=toolong&ssid=x&password=pw", 31, stTestForm.fields, 2));
+    CHECK_EQ(-2, stTestForm.fields[0].length);
+    CHECK_STR("", stTestForm.ssid);
+    CHECK_STR("pw", stTestForm.password);
+
+    CHECK_EQ(0, test_decode("ssid=a%00&ssid=second"));
+    CHECK_EQ(-2, stTestForm.fields[0].length);
+    CHECK_STR("", stTestForm.ssid);
+
+    // Refused in the query string, the body does not fill it
+    test_form_init(5, sizeof(stTestForm.password));
+    CHECK_EQ(0, ma_api_wifi_form_decode("ssid=toolong", 12, stTestForm.fields, 2));
+    CHECK_EQ(0, ma_api_wifi_form_decode("ssid=x", 6, stTestForm.fields, 2));
+    CHECK_EQ(-2, stTestForm.fields[0].length);
+}
+
+TEST(fuzz_against_a_reference_decoder)
+{
+    static const char cAlphabet[] = "%%%++&&==sidpaswor0123456789aAfFgG \x01\x7f\x80\xff";
+    char data[DF_TEST_FUZZ_MAX_LENGTH];
+    char ssid[24 + 1];
+
+    for (uint32_t run = 0; run < DF_TEST_FUZZ_RUNS; run++)
+    {
+        uint16_t length = (uint16_t)test_random(DF_TEST_FUZZ_MAX_LENGTH);
+        for (uint16_t i = 0; i < length; i++)
+        {
+            // Mostly the alphabet, so keys and escapes do happen, sometimes any byte
+            data[i] = (test_random(8) == 0) ? (char)test_random(256) : cAlphabet[test_random(sizeof(cAlphabet) - 1)];
+        }
+        if (test_random(2) == 0 && length > 5)
+        {
+            memcpy(data, "ssid=", 5);
+        }
+
+        uint16_t size = (uint16_t)(1 + test_random(sizeof(ssid) - 1));
+        memset(ssid, DF_TEST_GUARD, sizeof(ssid));
+        st_wifi_form_field_t field = {"ssid", ssid, size, -1};
+        ma_api_wifi_form_clear(&field, 1);
+        uint8_t found = ma_api_wifi_form_decode(data, length, &field, 1);
+
+        std::string expected;
+        int16_t expectedLength = test_reference_value(std::string(data, length), "ssid", size, &expected);
+        CHECK_EQ(expectedLength, field.length);
+        CHECK_EQ(expectedLength >= 0 ? 1 : 0, found);
+        if (expectedLength >= 0)
+        {
+            CHECK(memcmp(expected.c_str(), ssid, expected.size() + 1) == 0);
+        }
+        else
+        {
+            CHECK_EQ(0, ssid[0]);
+        }
+        for (uint16_t i = size; i < sizeof(ssid); i++)
+        {
+            CHECK_EQ(DF_TEST_GUARD, (uint8_t)ssid[i]);
+        }
+    }
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_decode
+  * @brief      : Decodes the ssid and password fields of a text into stTestForm
+  * @pre-cond.  : None
+  * @post-cond. : stTestForm holds the fields
+  * @parameters : in_data: Form data, null terminated
+  * @retval     : Fields found
+  */
+static uint8_t test_decode(const char *in_data)
+{
+    test_form_init(sizeof(stTestForm.ssid), sizeof(stTestForm.password));
+    return ma_api_wifi_form_decode(in_data, (uint16_t)strlen(in_data), stTestForm.fields, 2);
+}
+
+/**
+  * @Func       : test_form_init
+  * @brief      : Prepares the ssid and password fields
+  * @pre-cond.  : None
+  * @post-cond. : The fields are cleared
+  * @parameters : in_ssidSize, in_passwordSize: Buffer sizes given to the decoder
+  * @retval     : None
+  */
+static void test_form_init(uint16_t in_ssidSize, uint16_t in_passwordSize)
+{
+    stTestForm.fields[0] = {"ssid", stTestForm.ssid, in_ssidSize, -1};
+    stTestForm.fields[1] = {"password", stTestForm.password, in_passwordSize, -1};
+    ma_api_wifi_form_clear(stTestForm.fields, 2);
+}
+
+/**
+  * @Func       : test_random
+  * @brief      : xorshift32, the same sequence on every run
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_range: Number of values
+  * @retval     : 0 to in_range - 1
+  */
+static uint32_t test_random(uint32_t in_range)
+{
+    u32TestRandom ^= u32TestRandom << 13;
+    u32TestRandom ^= u32TestRandom >> 17;
+    u32TestRandom ^= u32TestRandom << 5;
+    return u32TestRandom % in_range;
+}
+
+/**
+  * @Func       : test_reference_value
+  * @brief      : Straightforward model of ma_api_wifi_form_decode() for one field, on std::string
+  * @pre-cond.  : None
+  * @post-cond. : out_value holds the value when it is found and fits
+  * @parameters :
+  *       - in_data: Form data
+  *       - in_key: Wanted key
+  *       - in_size: Size of the value buffer, including the terminator
+  *       - out_value: Decoded value
+  * @retval     : Decoded length, -1 if no pair has the key, -2 if the value of the first one does not fit
+  *               or has a null byte
+  */
+static int16_t test_reference_value(const std::string &in_data, const char *in_key, uint16_t in_size, std::string *out_value)
+{
+    size_t start = 0;
+
+    while (start < in_data.size())
+    {
+        size_t end = in_data.find('&', start);
+        std::string pair = in_data.substr(start, (end == std::string::npos) ? std::string::npos : end - start);
+        start = (end == std::string::npos) ? in_data.size() : end + 1;
+
+        size_t equal = pair.find('=');
+        std::string key;
+        if (!test_reference_unescape(pair.substr(0, equal), &key) || key.size() > DF_TEST_MAX_KEY_LENGTH || key != in_key)
+        {
+            continue;
+        }
+        // The first pair with the key decides, a refused value is not replaced by a later one
+        std::string value = (equal == std::string::npos) ? std::string() : pair.substr(equal + 1);
+        if (test_reference_unescape(value, out_value) && out_value->size() + 1 <= in_size)
+        {
+            return (int16_t)out_value->size();
+        }
+        return -2;
+    }
+    return -1;
+}
+
+/**
+  * @Func       : test_reference_unescape
+  * @brief      : '+' is a space, '%' and two hex digits is one byte, any other '%' is kept
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_text: Encoded text
+  *       - out_text: Decoded text
+  * @retval     : false if an escape gives a null byte
+  */
+static bool test_reference_unescape(const std::string &in_text, std::string *out_text)
+{
+    out_text->clear();
+    for (size_t i = 0; i < in_text.size(); i++)
+    {
+        if (in_text[i] == '+')
+        {
+            *out_text += ' ';
+        }
+        else if (in_text[i] == '%' && i + 2 < in_text.size() && isxdigit((unsigned char)in_text[i + 1]) &&
+                 isxdigit((unsigned char)in_text[i + 2]))
+        {
+            char byte = (char)strtol(in_text.substr(i + 1, 2).c_str(), NULL, 16);
+            if (byte == '\0')
+            {
+                return false;
+            }
+            *out_text += byte;
+            i += 2;
+        }
+        else
+        {
+            *out_text += in_text[i];
+        }
+    }
+    return true;
+}
+
+/*****************************END OF FILE**************************************/
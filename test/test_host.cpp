@@ -0,0 +1,185 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_host.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the host build of the Arduino core, and of the Api
+  *               built on it
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t u32TestEvents = 0;
+static uint8_t *volatile pu8TestBlock = NULL;   // Keeps the compiler from removing a new/delete pair
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_count_event(arduino_event_id_t in_event, arduino_event_info_t in_info);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(string_keeps_short_text_inline)
+{
+    st_host_stats_t before;
+    st_host_stats_t after;
+
+    ma_host_get_stats(&before);
+    String text("0123456789");
+    text += "";
+    ma_host_get_stats(&after);
+    CHECK_EQ(0, after.allocations - before.allocations);
+
+    text += "X";
+    ma_host_get_stats(&after);
+    CHECK_EQ(1, after.allocations - before.allocations);
+    CHECK_STR("0123456789X", text.c_str());
+}
+
+TEST(string_operations)
+{
+    String text("  ssid=home&password=secret  ");
+    text.trim();
+    CHECK_EQ(25, text.length());
+    CHECK_EQ(4, text.indexOf('='));
+    CHECK_EQ(9, text.indexOf("&"));
+    CHECK_STR("home", text.substring(5, 9).c_str());
+    CHECK(text.substring(10).startsWith("password"));
+    text += text;
+    CHECK_EQ(50, text.length());
+    CHECK_STR("12", String(12).c_str());
+    CHECK_STR("-7", String(-7L).c_str());
+    CHECK_STR("FF", String(255u, HEX).c_str());
+}
+
+TEST(heap_counts_operator_new)
+{
+    st_host_stats_t before;
+    st_host_stats_t after;
+
+    ma_host_get_stats(&before);
+    pu8TestBlock = new uint8_t[1000];
+    ma_host_get_stats(&after);
+    CHECK_EQ(1, after.allocations - before.allocations);
+    CHECK_EQ(before.bytesInUse + 1000, after.bytesInUse);
+    CHECK_EQ(DF_HOST_HEAP_SIZE - after.bytesInUse, ESP.getFreeHeap());
+    delete[] pu8TestBlock;
+    ma_host_get_stats(&after);
+    CHECK_EQ(before.bytesInUse, after.bytesInUse);
+}
+
+TEST(esp_restart_throws)
+{
+    bool restarted = false;
+    try
+    {
+        esp_restart();
+    }
+    catch (const ma_host_restart_t &restart)
+    {
+        restarted = (restart.count == 1);
+    }
+    CHECK(restarted);
+    CHECK_EQ(1, ma_host_restart_count());
+}
+
+TEST(radio_events_follow_the_clock)
+{
+    const st_host_wifi_timing_t timing = DF_HOST_WIFI_TIMING_DEFAULT;
+
+    ma_host_wifi_add_ap("home", "password1", -50, 6);
+    WiFi.onEvent(test_count_event);
+    WiFi.begin("home", "password1");
+    ma_host_clock_advance(timing.connectMs - 1);
+    CHECK_EQ(0, u32TestEvents);
+    ma_host_clock_advance(1);
+    CHECK_EQ(1u << ARDUINO_EVENT_WIFI_STA_CONNECTED, u32TestEvents);
+    CHECK(WiFi.status() != WL_CONNECTED);
+    ma_host_clock_advance(timing.dhcpMs);
+    CHECK(WiFi.status() == WL_CONNECTED);
+    CHECK(WiFi.BSSID() != NULL);
+
+    ma_host_wifi_drop_link(WIFI_REASON_BEACON_TIMEOUT);
+    ma_host_clock_advance(0);
+    CHECK(WiFi.status() == WL_CONNECTION_LOST);
+    ma_host_clock_advance(timing.reconnectMs + timing.connectMs + timing.dhcpMs);
+    CHECK(WiFi.status() == WL_CONNECTED);
+}
+
+TEST(radio_wrong_password_fails)
+{
+    ma_host_wifi_add_ap("home", "password1", -50, 6);
+    WiFi.begin("home", "password2");
+    ma_host_clock_advance(5000);
+    CHECK(WiFi.status() == WL_CONNECT_FAILED);
+}
+
+TEST(spiffs_needs_a_mount)
+{
+    CHECK(!SPIFFS.exists("/a"));
+    CHECK(SPIFFS.begin(false));
+    File file = SPIFFS.open("/a", "w");
+    CHECK(file);
+    CHECK_EQ(5, file.write((const uint8_t *)"hello", 5));
+    file.close();
+    file = SPIFFS.open("/a", "r");
+    CHECK_EQ(5, file.size());
+    char text[6] = "";
+    CHECK_EQ(5, file.read((uint8_t *)text, 5));
+    CHECK_STR("hello", text);
+    file.close();
+
+    ma_host_reset();
+    CHECK(!ma_host_fs_is_mounted());
+    CHECK(SPIFFS.begin(false));
+    CHECK(SPIFFS.exists("/a"));
+
+    ma_host_fs_set_corrupt(true);
+    CHECK(!SPIFFS.begin(false));
+    CHECK(SPIFFS.begin(true));
+    CHECK(!SPIFFS.exists("/a"));
+}
+
+TEST(spiffs_power_fail_cuts_the_write)
+{
+    CHECK(SPIFFS.begin(false));
+    ma_host_fs_power_fail_after(3);
+    File file = SPIFFS.open("/a", "w");
+    CHECK_EQ(3, file.write((const uint8_t *)"hello", 5));
+    CHECK_EQ(0, file.write((const uint8_t *)"!", 1));
+    file.close();
+    CHECK(!SPIFFS.open("/b", "w"));
+    ma_host_fs_power_restore();
+    CHECK_EQ(3, SPIFFS.open("/a", "r").size());
+}
+
+TEST(portal_serves_the_page)
+{
+    st_wifi_credential_t credential;
+    char response[512];
+
+    memset(&credential, 0, sizeof(credential));
+    ma_api_wifi_setup_access_point(credential);
+    CHECK(ma_api_wifi_portal_is_active());
+    CHECK(ma_host_wifi_ap_running());
+
+    st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(socket, "GET / HTTP/1.1\r\nHost: 192.168.123.123\r\nConnection: close\r\n\r\n");
+    ma_test_receive(socket, ma_api_wifi_portal_poll, response, sizeof(response), 100, 1);
+    CHECK(strncmp(response, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    CHECK(strstr(response, "Content-Encoding: gzip") != NULL);
+    ma_host_net_release(socket);
+}
+
+/* Body of private functions -------------------------------------------------*/
+static void test_count_event(arduino_event_id_t in_event, arduino_event_info_t in_info)
+{
+    (void)in_info;
+    u32TestEvents |= 1u << in_event;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,286 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_http.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the HTTP request parser of the portal
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+#include "ma_test.h"
+#include "ma_api_wifi_http.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_FORM_REQUEST            "POST /save_data?from=form HTTP/1.1\r\nHost: 192.168.123.123\r\n" \
+                                        "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 27\r\n\r\n" \
+                                        "ssid=Home&password=secret12"
+
+/* Private variables ---------------------------------------------------------*/
+static st_wifi_http_request_t stTestRequest;
+
+/* Private function prototypes -----------------------------------------------*/
+static e_wifi_http_parse_result_t test_parse(const char *in_text);
+static e_wifi_http_parse_result_t test_feed(const char *in_text, uint16_t in_length);
+static void test_check_form_request(void);
+static bool test_etag_matches(const char *in_ifNoneMatch);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(content_length_frames_the_body)
+{
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("POST /save_data HTTP/1.1\r\nContent-Length: 5 \r\n\r\nabcde"));
+    CHECK_EQ(5, stTestRequest.body.length);
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.body, "abcde"));
+}
+
+TEST(content_length_with_trailing_junk_is_refused)
+{
+    CHECK_EQ(eWIFI_HTTP_PARSE_BAD_REQUEST, test_parse("POST / HTTP/1.1\r\nContent-Length: 5x\r\n\r\nabcde"));
+    CHECK_EQ(eWIFI_HTTP_PARSE_BAD_REQUEST, test_parse("POST / HTTP/1.1\r\nContent-Length: 5 5\r\n\r\nabcde"));
+    CHECK_EQ(eWIFI_HTTP_PARSE_BAD_REQUEST, test_parse("POST / HTTP/1.1\r\nContent-Length: +5\r\n\r\nabcde"));
+    CHECK_EQ(eWIFI_HTTP_PARSE_BAD_REQUEST, test_parse("POST / HTTP/1.1\r\nContent-Length: \r\n\r\n"));
+}
+
+TEST(content_length_duplicates_must_agree)
+{
+    CHECK_EQ(eWIFI_HTTP_PARSE_BAD_REQUEST, test_parse("POST / HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 3\r\n\r\nabcde"));
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("POST / HTTP/1.1\r\nContent-Length: 3\r\ncontent-length: 3\r\n\r\nabc"));
+    CHECK_EQ(3, stTestRequest.body.length);
+}
+
+TEST(transfer_encoding_is_not_implemented)
+{
+    CHECK_EQ(eWIFI_HTTP_PARSE_NOT_IMPLEMENTED, test_parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nabcde\r\n0\r\n\r\n"));
+    CHECK_EQ(eWIFI_HTTP_PARSE_NOT_IMPLEMENTED,
+             test_parse("POST / HTTP/1.1\r\nContent-Length: 4\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n"));
+}
+
+TEST(only_http_1_1_is_persistent_by_default)
+{
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("GET / HTTP/1.1\r\n\r\n"));
+    CHECK(stTestRequest.keepAlive);
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("GET / HTTP/1.1\r\nConnection: close\r\n\r\n"));
+    CHECK(!stTestRequest.keepAlive);
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("GET / HTTP/1.0\r\n\r\n"));
+    CHECK(!stTestRequest.keepAlive);
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"));
+    CHECK(stTestRequest.keepAlive);
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("GET / HTTP/1.10\r\n\r\n"));
+    CHECK(!stTestRequest.keepAlive);
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("GET / HTTP/2.0\r\n\r\n"));
+    CHECK(!stTestRequest.keepAlive);
+}
+
+TEST(request_split_at_every_byte)
+{
+    uint16_t length = (uint16_t)strlen(DF_TEST_FORM_REQUEST);
+
+    for (uint16_t split = 1; split < length; split++)
+    {
+        ma_api_wifi_http_reset(&stTestRequest);
+        CHECK_EQ(eWIFI_HTTP_PARSE_INCOMPLETE, test_feed(DF_TEST_FORM_REQUEST, split));
+        CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_feed(DF_TEST_FORM_REQUEST + split, length - split));
+        test_check_form_request();
+    }
+}
+
+TEST(request_received_one_byte_at_a_time)
+{
+    uint16_t length = (uint16_t)strlen(DF_TEST_FORM_REQUEST);
+
+    ma_api_wifi_http_reset(&stTestRequest);
+    for (uint16_t i = 0; i + 1 < length; i++)
+    {
+        CHECK_EQ(eWIFI_HTTP_PARSE_INCOMPLETE, test_feed(DF_TEST_FORM_REQUEST + i, 1));
+    }
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_feed(DF_TEST_FORM_REQUEST + length - 1, 1));
+    test_check_form_request();
+}
+
+TEST(request_over_the_cap_is_too_large)
+{
+    static char text[DF_HTTP_MAX_REQUEST_SIZE + 1];
+
+    // Headers that never end
+    memset(text, 'a', sizeof(text) - 1);
+    memcpy(text, "GET / HTTP/1.1\r\nX: ", 19);
+    CHECK_EQ(eWIFI_HTTP_PARSE_TOO_LARGE, test_parse(text));
+
+    // A body that can not fit, refused before it is received
+    CHECK_EQ(eWIFI_HTTP_PARSE_TOO_LARGE, test_parse("POST / HTTP/1.1\r\nContent-Length: 5000\r\n\r\n"));
+    CHECK_EQ(eWIFI_HTTP_PARSE_TOO_LARGE, test_parse("POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n"));
+}
+
+TEST(pipelined_requests_in_one_read)
+{
+    const char *requests = "GET /status.json HTTP/1.1\r\nHost: 192.168.123.123\r\n\r\n"
+                           DF_TEST_FORM_REQUEST
+                           "GET /scan.json HTTP/1.1\r\nConnection: close\r\n\r\n";
+
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse(requests));
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.path, "/status.json"));
+    CHECK(stTestRequest.keepAlive);
+    CHECK_EQ(0, stTestRequest.body.length);
+
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, ma_api_wifi_http_next(&stTestRequest));
+    test_check_form_request();
+    CHECK(stTestRequest.keepAlive);
+
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, ma_api_wifi_http_next(&stTestRequest));
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.path, "/scan.json"));
+    CHECK(!stTestRequest.keepAlive);
+
+    CHECK_EQ(eWIFI_HTTP_PARSE_INCOMPLETE, ma_api_wifi_http_next(&stTestRequest));
+    CHECK_EQ(0, stTestRequest.length);
+}
+
+TEST(pipelined_request_split_at_every_byte)
+{
+    const char *first = "GET /status.json HTTP/1.1\r\n\r\n";
+    uint16_t firstLength = (uint16_t)strlen(first);
+    uint16_t secondLength = (uint16_t)strlen(DF_TEST_FORM_REQUEST);
+    char requests[256];
+
+    memcpy(requests, first, firstLength);
+    memcpy(requests + firstLength, DF_TEST_FORM_REQUEST, secondLength);
+    // The first read ends anywhere in the second request; what is left comes in a second read
+    for (uint16_t split = firstLength; split < firstLength + secondLength; split++)
+    {
+        ma_api_wifi_http_reset(&stTestRequest);
+        CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_feed(requests, split));
+        CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.path, "/status.json"));
+        CHECK_EQ(eWIFI_HTTP_PARSE_INCOMPLETE, ma_api_wifi_http_next(&stTestRequest));
+        CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_feed(requests + split, (uint16_t)(firstLength + secondLength - split)));
+        test_check_form_request();
+    }
+}
+
+TEST(body_is_not_taken_as_the_next_request)
+{
+    // A body that looks like a request line belongs to the request that announced it
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse("POST /save_data HTTP/1.1\r\nContent-Length: 16\r\n\r\n"
+                                               "GET / HTTP/1.1\r\n"
+                                               "GET /scan.json HTTP/1.1\r\n\r\n"));
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.body, "GET / HTTP/1.1\r\n"));
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, ma_api_wifi_http_next(&stTestRequest));
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.path, "/scan.json"));
+}
+
+TEST(etag_list_is_compared_tag_by_tag)
+{
+    CHECK(test_etag_matches("\"abc\""));
+    CHECK(test_etag_matches("W/\"abc\""));
+    CHECK(test_etag_matches("\"x\", W/\"abc\""));
+    CHECK(test_etag_matches("\"x\",\"abc\" , \"y\""));
+    CHECK(test_etag_matches("\"a,b\", \"abc\""));
+
+    // Part of a tag or a longer tag is not the same tag
+    CHECK(!test_etag_matches("\"abcd\""));
+    CHECK(!test_etag_matches("\"xabc\""));
+    CHECK(!test_etag_matches("\"ab\""));
+    CHECK(!test_etag_matches("abc"));
+    CHECK(!test_etag_matches("w/\"abc\""));
+    CHECK(!test_etag_matches("\"x\"\"abc\""));
+    CHECK(!test_etag_matches("\"abc"));
+    CHECK(!test_etag_matches(""));
+}
+
+TEST(etag_star_matches_only_alone)
+{
+    CHECK(test_etag_matches("*"));
+    CHECK(test_etag_matches("  *  "));
+    CHECK(!test_etag_matches("\"*\""));
+    CHECK(!test_etag_matches("\"x\", *"));
+    CHECK(!test_etag_matches("\"a*b\""));
+    CHECK(!test_etag_matches("**"));
+}
+
+TEST(parser_never_allocates)
+{
+    st_host_stats_t before;
+    st_host_stats_t after;
+
+    ma_host_get_stats(&before);
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse(DF_TEST_FORM_REQUEST));
+    }
+    ma_host_get_stats(&after);
+    CHECK_EQ(0, after.allocations - before.allocations);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_parse
+  * @brief      : Parses a request received in one read
+  * @pre-cond.  : The text fits in DF_HTTP_MAX_REQUEST_SIZE
+  * @post-cond. : stTestRequest holds the request
+  * @parameters : in_text: Request
+  * @retval     : Result of the parser
+  */
+static e_wifi_http_parse_result_t test_parse(const char *in_text)
+{
+    ma_api_wifi_http_reset(&stTestRequest);
+    return test_feed(in_text, (uint16_t)strlen(in_text));
+}
+
+/**
+  * @Func       : test_feed
+  * @brief      : Gives more received bytes to the parser
+  * @pre-cond.  : stTestRequest was reset
+  * @post-cond. : None
+  * @parameters :
+  *       - in_text: Bytes received
+  *       - in_length: Number of bytes
+  * @retval     : Result of the parser
+  */
+static e_wifi_http_parse_result_t test_feed(const char *in_text, uint16_t in_length)
+{
+    uint16_t space = 0;
+
+    char *buffer = ma_api_wifi_http_get_rx_buffer(&stTestRequest, &space);
+    CHECK(in_length <= space);
+    memcpy(buffer, in_text, in_length);
+    return ma_api_wifi_http_parse(&stTestRequest, in_length);
+}
+
+/**
+  * @Func       : test_check_form_request
+  * @brief      : Checks the spans of DF_TEST_FORM_REQUEST
+  * @pre-cond.  : stTestRequest holds DF_TEST_FORM_REQUEST
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_check_form_request(void)
+{
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.method, "POST"));
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.path, "/save_data"));
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.query, "from=form"));
+    CHECK(ma_api_wifi_http_has_form_body(&stTestRequest));
+    CHECK(ma_api_wifi_http_span_equals(&stTestRequest, stTestRequest.body, "ssid=Home&password=secret12"));
+}
+
+/**
+  * @Func       : test_etag_matches
+  * @brief      : Parses a request with an If-None-Match header and checks it against the ETag "abc"
+  * @pre-cond.  : None
+  * @post-cond. : stTestRequest holds the request
+  * @parameters : in_ifNoneMatch: Value of the header
+  * @retval     : Result of ma_api_wifi_http_etag_matches()
+  */
+static bool test_etag_matches(const char *in_ifNoneMatch)
+{
+    char text[128];
+
+    snprintf(text, sizeof(text), "GET / HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", in_ifNoneMatch);
+    CHECK_EQ(eWIFI_HTTP_PARSE_DONE, test_parse(text));
+    return ma_api_wifi_http_etag_matches(&stTestRequest, "\"abc\"");
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,480 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_portal.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the portal routes, through the host sockets
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+#include "ma_api_wifi_profiles.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_PORTAL_CONNECTIONS      4       // DF_PORTAL_MAX_CONNECTIONS of the Api
+#define DF_TEST_KEEP_ALIVE_MS           5000    // DF_PORTAL_KEEP_ALIVE_TIMEOUT_MS of the Api
+#define DF_TEST_MAX_REQUESTS            32      // DF_PORTAL_MAX_REQUESTS of the Api
+
+/* Private variables ---------------------------------------------------------*/
+static char cTestResponse[8192];
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_start_portal(const char *in_ssid, const char *in_password);
+static void test_run(uint32_t in_ms);
+static void test_legacy_loop(void);
+static uint8_t test_count_responses(const char *in_data, size_t in_length);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(credentials_json_hides_the_password)
+{
+    test_start_portal("Home net", "secret123");
+
+    ma_test_portal_request("GET /credentials.json HTTP/1.1\r\nConnection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    CHECK(strstr(cTestResponse, "\r\n\r\n{\"ssid\":\"Home net\",\"hasPassword\":true}") != NULL);
+    CHECK(strstr(cTestResponse, "secret123") == NULL);
+}
+
+TEST(credentials_json_of_an_open_network)
+{
+    test_start_portal("Cafe", "");
+
+    ma_test_portal_request("GET /credentials.json HTTP/1.1\r\nConnection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strstr(cTestResponse, "{\"ssid\":\"Cafe\",\"hasPassword\":false}") != NULL);
+}
+
+TEST(profile_add_with_empty_password_keeps_the_saved_one)
+{
+    st_wifi_profile_info_t profiles[4];
+    st_wifi_credential_t saved;
+
+    CHECK_EQ(0, ma_api_wifi_profile_add("Office", "officepass1", 100));
+    test_start_portal("", "");
+
+    ma_test_portal_request("GET /profile_add?ssid=Office&password=&priority=150 HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 204 No Content\r\n", 25) == 0);
+    CHECK_EQ(1, ma_api_wifi_profile_list(profiles, 4));
+    CHECK_EQ(150, profiles[0].priority);
+    CHECK_EQ(0, ma_api_wifi_read_network_credentials(&saved));
+    CHECK_STR("officepass1", saved.psk);
+}
+
+TEST(profile_add_of_a_new_network_needs_a_password)
+{
+    test_start_portal("", "");
+
+    ma_test_portal_request("GET /profile_add?ssid=Office&password= HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 400 Bad Request\r\n", 26) == 0);
+}
+
+TEST(profile_add_refuses_a_priority_out_of_range)
+{
+    const char *priorities[] = {"256", "-1", "abc", "1000", "+5", "%2012"};
+    st_wifi_profile_info_t profiles[4];
+    char request[128];
+
+    test_start_portal("", "");
+    for (uint8_t i = 0; i < sizeof(priorities) / sizeof(priorities[0]); i++)
+    {
+        snprintf(request, sizeof(request), 
+                 "GET /profile_add?ssid=Office&password=officepass1&priority=%s HTTP/1.1\r\nConnection: close\r\n\r\n",
+                 priorities[i]);
+        ma_test_portal_request(request, cTestResponse, sizeof(cTestResponse));
+        CHECK(strncmp(cTestResponse, "HTTP/1.1 400 Bad Request\r\n", 26) == 0);
+    }
+    CHECK_EQ(0, ma_api_wifi_profile_list(profiles, 4));
+
+    // The bounds, and an empty field for the default priority
+    ma_test_portal_request("GET /profile_add?ssid=Office&password=officepass1&priority=255 HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 204 No Content\r\n", 25) == 0);
+    ma_test_portal_request("GET /profile_add?ssid=Garage&password=garagepass&priority=0 HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 204 No Content\r\n", 25) == 0);
+    ma_test_portal_request("GET /profile_add?ssid=Attic&password=atticpass1&priority= HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 204 No Content\r\n", 25) == 0);
+    CHECK_EQ(3, ma_api_wifi_profile_list(profiles, 4));
+    CHECK_EQ(255, profiles[0].priority);
+    CHECK_EQ(0, profiles[1].priority);
+    CHECK_EQ(DF_WIFI_PROFILE_DEFAULT_PRIORITY, profiles[2].priority);
+}
+
+TEST(save_data_with_empty_password_joins_with_the_saved_one)
+{
+    ma_host_wifi_add_ap("Office", "officepass1", -55, 6);
+    CHECK_EQ(0, ma_api_wifi_profile_add("Office", "officepass1", 100));
+    test_start_portal("", "");
+
+    ma_test_portal_request("POST /save_data HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                           "Content-Length: 21\r\nConnection: close\r\n\r\nssid=Office&password=",
+                           cTestResponse, sizeof(cTestResponse));
+    test_run(5000);
+
+    ma_test_portal_request("GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strstr(cTestResponse, "\"apply\":\"connected\"") != NULL);
+    CHECK(WiFi.status() == WL_CONNECTED);
+}
+
+TEST(hot_apply_through_the_legacy_loop_is_kept)
+{
+    ma_host_wifi_add_ap("Office", "officepass1", -55, 6);
+    test_start_portal("Home net", "homepass1");
+
+    // The loop of an older application passes the network it read at boot on every call
+    st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(socket, "POST /save_data HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                         "Content-Length: 32\r\nConnection: close\r\n\r\nssid=Office&password=officepass1");
+    ma_test_receive(socket, test_legacy_loop, cTestResponse, sizeof(cTestResponse), 100, 1);
+    ma_host_net_release(socket);
+    for (uint16_t i = 0; i < 500; i++)
+    {
+        test_legacy_loop();
+        ma_host_clock_advance(10);
+    }
+    CHECK(WiFi.status() == WL_CONNECTED);
+
+    socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(socket, "GET /credentials.json HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ma_test_receive(socket, test_legacy_loop, cTestResponse, sizeof(cTestResponse), 100, 1);
+    ma_host_net_release(socket);
+    CHECK(strstr(cTestResponse, "{\"ssid\":\"Office\",\"hasPassword\":true}") != NULL);
+
+    // The same network again is not a new one: no second test, the result stays
+    socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(socket, "POST /save_data HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                         "Content-Length: 21\r\nConnection: close\r\n\r\nssid=Office&password=");
+    ma_test_receive(socket, test_legacy_loop, cTestResponse, sizeof(cTestResponse), 100, 1);
+    ma_host_net_release(socket);
+    ma_test_portal_request("GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strstr(cTestResponse, "\"apply\":\"connected\"") != NULL);
+}
+
+TEST(save_data_during_a_test_gets_409)
+{
+    ma_host_wifi_add_ap("Office", "officepass1", -55, 6);
+    test_start_portal("", "");
+
+    ma_test_portal_request("GET /save_data?ssid=Office&password=officepass1 HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    ma_test_portal_request("GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strstr(cTestResponse, "\"apply\":\"testing\"") != NULL);
+
+    // Another network while Office is tested is refused, not dropped behind a 200
+    ma_test_portal_request("GET /save_data?ssid=Garage&password=garagepass HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 409 Conflict\r\n", 23) == 0);
+
+    test_run(5000);
+    ma_test_portal_request("GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strstr(cTestResponse, "\"apply\":\"connected\"") != NULL);
+    CHECK(strstr(cTestResponse, "\"ssid\":\"Office\"") != NULL);
+}
+
+TEST(save_data_with_a_refused_field_gets_400)
+{
+    st_wifi_profile_info_t profiles[4];
+
+    ma_host_wifi_add_ap("Office", "officepass1", -55, 6);
+    test_start_portal("", "");
+
+    // An SSID longer than 32 bytes, then a valid one under the same key: the first one decides
+    ma_test_portal_request("GET /save_data?ssid=0123456789012345678901234567890123&ssid=Office&password=officepass1 HTTP/1.1\r\n"
+                           "Connection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 400 Bad Request\r\n", 26) == 0);
+    ma_test_portal_request("GET /profile_add?ssid=0123456789012345678901234567890123&ssid=Office&password=officepass1 HTTP/1.1\r\n"
+                           "Connection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 400 Bad Request\r\n", 26) == 0);
+    CHECK_EQ(0, ma_api_wifi_profile_list(profiles, 4));
+
+    ma_test_portal_request("GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strstr(cTestResponse, "\"apply\":\"testing\"") == NULL);
+}
+
+TEST(save_data_that_can_not_be_saved_gets_500)
+{
+    st_wifi_profile_info_t profiles[4];
+    bool restarted = false;
+
+    test_start_portal("", "");
+    ma_api_wifi_portal_set_hot_apply(false);
+
+    // NVS does not open: the network is not saved, the device stays in the portal
+    ma_host_nvs_set_corrupt(true);
+    ma_test_portal_request("GET /save_data?ssid=Office&password=officepass1 HTTP/1.1\r\nConnection: close\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 500 Internal Server Error\r\n", 36) == 0);
+    CHECK_EQ(0, ma_host_restart_count());
+
+    ma_host_nvs_set_corrupt(false);
+    try
+    {
+        ma_test_portal_request("GET /save_data?ssid=Office&password=officepass1 HTTP/1.1\r\nConnection: close\r\n\r\n",
+                               cTestResponse, sizeof(cTestResponse));
+    }
+    catch (const ma_host_restart_t &restart)
+    {
+        restarted = (restart.count == 1);
+    }
+    CHECK(restarted);
+    CHECK_EQ(1, ma_api_wifi_profile_list(profiles, 4));
+    CHECK_STR("Office", profiles[0].ssid);
+}
+
+TEST(transfer_encoding_gets_501_and_close)
+{
+    test_start_portal("", "");
+
+    ma_test_portal_request("POST /save_data HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nssid=\r\n0\r\n\r\n",
+                           cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 501 Not Implemented\r\n", 30) == 0);
+    CHECK(strstr(cTestResponse, "Connection: close\r\n") != NULL);
+}
+
+TEST(http_1_0_connection_is_closed)
+{
+    test_start_portal("", "");
+
+    ma_test_portal_request("GET /status.json HTTP/1.0\r\n\r\n", cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    CHECK(strstr(cTestResponse, "Connection: close\r\n") != NULL);
+}
+
+TEST(client_waits_for_a_busy_table)
+{
+    st_host_socket_t *busy[DF_TEST_PORTAL_CONNECTIONS];
+
+    test_start_portal("", "");
+    for (uint8_t i = 0; i < DF_TEST_PORTAL_CONNECTIONS; i++)
+    {
+        busy[i] = ma_test_connect(DF_WIFI_HTTP_PORT);
+        ma_test_send(busy[i], "GET /status.json HTTP/1.1\r\n");
+        ma_api_wifi_portal_poll();
+    }
+
+    st_host_socket_t *waiting = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(waiting, "GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n");
+    CHECK_EQ(0, ma_test_receive(waiting, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 100, 1));
+    CHECK(!ma_host_net_is_closed(waiting));
+
+    ma_test_send(busy[0], "Connection: close\r\n\r\n");
+    ma_test_receive(waiting, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 100, 1);
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+
+    for (uint8_t i = 0; i < DF_TEST_PORTAL_CONNECTIONS; i++)
+    {
+        ma_host_net_release(busy[i]);
+    }
+    ma_host_net_release(waiting);
+}
+
+TEST(slow_client_does_not_hold_the_portal)
+{
+    test_start_portal("", "");
+
+    st_host_socket_t *slow = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(slow, "GET /status.json HTTP/1.1\r\nHo");
+    ma_api_wifi_portal_poll();
+
+    st_host_socket_t *fast = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(fast, "GET /generate_204 HTTP/1.1\r\nConnection: close\r\n\r\n");
+    ma_test_receive(fast, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 5, 1);
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 ", 9) == 0);
+    CHECK(ma_host_net_is_closed(fast));
+
+    ma_test_send(slow, "st: 192.168.123.123\r\nConnection: close\r\n\r\n");
+    ma_test_receive(slow, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 5, 1);
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+
+    ma_host_net_release(slow);
+    ma_host_net_release(fast);
+}
+
+TEST(clients_are_served_side_by_side)
+{
+    st_host_socket_t *clients[DF_TEST_PORTAL_CONNECTIONS];
+
+    test_start_portal("", "");
+    for (uint8_t i = 0; i < DF_TEST_PORTAL_CONNECTIONS; i++)
+    {
+        clients[i] = ma_test_connect(DF_WIFI_HTTP_PORT);
+        ma_test_send(clients[i], "GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n");
+    }
+
+    // One poll accepts one client: after as many polls every request was read, none waited for another one
+    for (uint8_t i = 0; i < 2 * DF_TEST_PORTAL_CONNECTIONS; i++)
+    {
+        ma_api_wifi_portal_poll();
+    }
+    for (uint8_t i = 0; i < DF_TEST_PORTAL_CONNECTIONS; i++)
+    {
+        CHECK(ma_host_net_is_closed(clients[i]));
+        size_t length = ma_host_net_recv(clients[i], cTestResponse, sizeof(cTestResponse) - 1);
+        cTestResponse[length] = '\0';
+        CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+        ma_host_net_release(clients[i]);
+    }
+}
+
+TEST(pipelined_requests_are_answered_in_order)
+{
+    test_start_portal("", "");
+
+    st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(socket, "GET /status.json HTTP/1.1\r\n\r\n"
+                         "GET /generate_204 HTTP/1.1\r\nHost: connectivitycheck.gstatic.com\r\n\r\n"
+                         "GET /missing HTTP/1.1\r\nConnection: close\r\n\r\n");
+    size_t length = ma_test_receive(socket, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 100, 1);
+    CHECK(ma_host_net_is_closed(socket));
+    CHECK_EQ(3, test_count_responses(cTestResponse, length));
+
+    // Each response is framed by its Content-Length, so the next one starts right after it
+    const char *probe = strstr(cTestResponse, "HTTP/1.1 302 Found\r\n");
+    const char *missing = strstr(cTestResponse, "HTTP/1.1 404 Not Found\r\n");
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    CHECK(probe != NULL && missing != NULL && probe < missing);
+    const char *lengthHeader = strstr(cTestResponse, "Content-Length: ");
+    const char *bodyStart = strstr(cTestResponse, "\r\n\r\n");
+    CHECK(lengthHeader != NULL && lengthHeader < bodyStart);
+    CHECK_EQ(probe - (bodyStart + 4), strtoul(lengthHeader + 16, NULL, 10));
+    CHECK(strstr(cTestResponse, "Connection: close\r\n") > missing);
+    ma_host_net_release(socket);
+}
+
+TEST(idle_connection_closes_after_its_timeout)
+{
+    test_start_portal("", "");
+
+    st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    ma_test_send(socket, "GET /status.json HTTP/1.1\r\n\r\n");
+    ma_test_receive(socket, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 10, 1);
+    CHECK(strstr(cTestResponse, "Connection: keep-alive\r\n") != NULL);
+
+    // A second request just before the timeout restarts it
+    test_run(DF_TEST_KEEP_ALIVE_MS - 100);
+    CHECK(!ma_host_net_is_closed(socket));
+    ma_test_send(socket, "GET /status.json HTTP/1.1\r\n\r\n");
+    ma_test_receive(socket, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 10, 1);
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    test_run(DF_TEST_KEEP_ALIVE_MS - 100);
+    CHECK(!ma_host_net_is_closed(socket));
+
+    test_run(200);
+    CHECK(ma_host_net_is_closed(socket));
+    CHECK_EQ(0, ma_host_net_pending(socket));
+    ma_host_net_release(socket);
+}
+
+TEST(connection_closes_after_its_last_request)
+{
+    test_start_portal("", "");
+
+    st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    for (uint8_t i = 0; i < DF_TEST_MAX_REQUESTS + 2; i++)
+    {
+        ma_test_send(socket, "GET /generate_204 HTTP/1.1\r\n\r\n");
+    }
+    size_t length = ma_test_receive(socket, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 200, 1);
+    CHECK(ma_host_net_is_closed(socket));
+
+    // The requests past the cap are left unanswered, a browser sends them again on a new connection
+    CHECK_EQ(DF_TEST_MAX_REQUESTS, test_count_responses(cTestResponse, length));
+    const char *close = strstr(cTestResponse, "Connection: close\r\n");
+    CHECK(close != NULL);
+    CHECK(strstr(close, "HTTP/1.1 ") == NULL);
+    ma_host_net_release(socket);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_start_portal
+  * @brief      : Starts the portal with the network saved in memory
+  * @pre-cond.  : None
+  * @post-cond. : Portal active
+  * @parameters : in_ssid, in_password: Network shown by the portal
+  * @retval     : None
+  */
+static void test_start_portal(const char *in_ssid, const char *in_password)
+{
+    st_wifi_credential_t credential;
+
+    memset(&credential, 0, sizeof(credential));
+    if (in_ssid[0] != '\0')
+    {
+        CHECK_EQ(0, ma_api_wifi_credential_set(&credential, in_ssid, in_password));
+    }
+    ma_api_wifi_setup_access_point(credential);
+    CHECK(ma_api_wifi_portal_is_active());
+}
+
+/**
+  * @Func       : test_run
+  * @brief      : Runs the loop() of the application for a time, in steps of 10 ms
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_ms: Time
+  * @retval     : None
+  */
+static void test_run(uint32_t in_ms)
+{
+    for (uint32_t ms = 0; ms < in_ms; ms += 10)
+    {
+        ma_api_wifi_station_poll();
+        ma_api_wifi_portal_poll();
+        ma_host_clock_advance(10);
+    }
+}
+
+/**
+  * @Func       : test_legacy_loop
+  * @brief      : One loop() of an application of older versions, with the network it read at boot
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_legacy_loop(void)
+{
+    ma_api_wifi_station_poll();
+    ma_api_wifi_process_client_request(NULL, "Home net", "homepass1", 60);
+}
+
+/**
+  * @Func       : test_count_responses
+  * @brief      : Counts the status lines received on a connection
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_data: Bytes received
+  *       - in_length: Number of bytes
+  * @retval     : Number of responses
+  */
+static uint8_t test_count_responses(const char *in_data, size_t in_length)
+{
+    uint8_t count = 0;
+    const char *end = in_data + in_length;
+
+    for (const char *response = in_data; response < end; response += 9)
+    {
+        response = (const char *)memmem(response, end - response, "HTTP/1.1 ", 9);
+        if (response == NULL)
+        {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+/*****************************END OF FILE**************************************/
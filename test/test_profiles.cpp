@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_profiles.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the order in which the saved networks are tried
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include "ma_test.h"
+#include "ma_api_wifi_profiles.h"
+
+/* Private variables ---------------------------------------------------------*/
+static st_wifi_profile_store_t stTestStore;
+static uint8_t u8TestOrder[DF_WIFI_MAX_PROFILES];
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t test_add(const char *in_ssid, uint8_t in_priority);
+static uint8_t test_rank(const st_wifi_scan_result_t *in_results, uint8_t in_resultCount);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(priority_comes_before_signal)
+{
+    const st_wifi_scan_result_t results[] = {{"low", -30, 1}, {"high", -90, 1}};
+
+    test_add("low", 50);
+    test_add("high", 200);
+    CHECK_EQ(2, test_rank(results, 2));
+    CHECK_EQ(1, u8TestOrder[0]);
+    CHECK_EQ(0, u8TestOrder[1]);
+}
+
+TEST(signal_breaks_a_priority_tie)
+{
+    const st_wifi_scan_result_t results[] = {{"far", -80, 1}, {"near", -40, 1}};
+
+    test_add("far", 100);
+    test_add("near", 100);
+    CHECK_EQ(2, test_rank(results, 2));
+    CHECK_EQ(1, u8TestOrder[0]);
+    CHECK_EQ(0, u8TestOrder[1]);
+}
+
+TEST(last_success_breaks_a_signal_tie)
+{
+    const st_wifi_scan_result_t results[] = {{"a", -60, 1}, {"b", -60, 1}, {"c", -60, 1}};
+
+    test_add("a", 100);
+    test_add("b", 100);
+    test_add("c", 100);
+    CHECK(ma_api_wifi_profiles_mark_success(&stTestStore, 2));
+    CHECK(ma_api_wifi_profiles_mark_success(&stTestStore, 1));
+    CHECK_EQ(3, test_rank(results, 3));
+    CHECK_EQ(1, u8TestOrder[0]);
+    CHECK_EQ(2, u8TestOrder[1]);
+    CHECK_EQ(0, u8TestOrder[2]);
+}
+
+TEST(full_tie_keeps_the_store_order)
+{
+    const st_wifi_scan_result_t results[] = {{"d", -60, 1}, {"c", -60, 1}, {"b", -60, 1}, {"a", -60, 1}};
+
+    test_add("a", 100);
+    test_add("b", 100);
+    test_add("c", 100);
+    test_add("d", 100);
+    // Whatever the order of the scan results, so two boots try the networks in the same order
+    CHECK_EQ(4, test_rank(results, 4));
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        CHECK_EQ(i, u8TestOrder[i]);
+    }
+    CHECK_EQ(2, test_rank(&results[2], 2));
+    CHECK_EQ(0, u8TestOrder[0]);
+    CHECK_EQ(1, u8TestOrder[1]);
+    CHECK_EQ(0, ma_api_wifi_profiles_best(&stTestStore));
+}
+
+TEST(strongest_access_point_of_an_ssid_counts)
+{
+    const st_wifi_scan_result_t results[] = {{"mesh", -85, 1}, {"single", -60, 1}, {"mesh", -50, 1}, {"mesh", -70, 1}};
+
+    test_add("single", 100);
+    test_add("mesh", 100);
+    CHECK_EQ(2, test_rank(results, 4));
+    CHECK_EQ(1, u8TestOrder[0]);
+    CHECK_EQ(0, u8TestOrder[1]);
+}
+
+TEST(networks_not_seen_are_left_out)
+{
+    const st_wifi_scan_result_t results[] = {{"other", -40, 1}, {"office", -70, 1}};
+
+    test_add("home", 200);
+    test_add("office", 100);
+    CHECK_EQ(1, test_rank(results, 2));
+    CHECK_EQ(1, u8TestOrder[0]);
+
+    // Nothing known in range: every profile, by priority, for a hidden SSID or a failed scan
+    CHECK_EQ(2, test_rank(results, 1));
+    CHECK_EQ(0, u8TestOrder[0]);
+    CHECK_EQ(1, u8TestOrder[1]);
+    CHECK_EQ(2, test_rank(NULL, 0));
+}
+
+TEST(best_without_scan_uses_priority_then_success)
+{
+    test_add("a", 100);
+    test_add("b", 100);
+    test_add("c", 50);
+    CHECK_EQ(0, ma_api_wifi_profiles_best(&stTestStore));
+
+    CHECK(ma_api_wifi_profiles_mark_success(&stTestStore, 2));
+    CHECK_EQ(0, ma_api_wifi_profiles_best(&stTestStore));
+    CHECK(ma_api_wifi_profiles_mark_success(&stTestStore, 1));
+    CHECK_EQ(1, ma_api_wifi_profiles_best(&stTestStore));
+    // The same network again does not change the store, nothing to save
+    CHECK(!ma_api_wifi_profiles_mark_success(&stTestStore, 1));
+}
+
+TEST(full_store_replaces_the_weakest_profile)
+{
+    test_add("a", 100);
+    test_add("b", 50);
+    test_add("c", 50);
+    test_add("d", 100);
+    CHECK(ma_api_wifi_profiles_mark_success(&stTestStore, 1));
+
+    // Lowest priority, then oldest success: "c" never connected
+    CHECK_EQ(2, test_add("e", 100));
+    CHECK_EQ(-1, ma_api_wifi_profiles_find(&stTestStore, "c", 1));
+    // A known SSID keeps its slot and its success
+    CHECK_EQ(1, test_add("b", 10));
+    CHECK_EQ(stTestStore.successCounter, stTestStore.profiles[1].lastSuccess);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_add
+  * @brief      : Adds a profile with a fixed password to stTestStore
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_ssid: SSID, null terminated
+  *       - in_priority: Priority of the profile
+  * @retval     : Index of the profile
+  */
+static int8_t test_add(const char *in_ssid, uint8_t in_priority)
+{
+    return ma_api_wifi_profiles_add(&stTestStore, in_ssid, strlen(in_ssid), "password1", 9, in_priority);
+}
+
+/**
+  * @Func       : test_rank
+  * @brief      : Ranks stTestStore against scan results into u8TestOrder
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_results: Scan results
+  *       - in_resultCount: Number of results
+  * @retval     : Number of profiles to try
+  */
+static uint8_t test_rank(const st_wifi_scan_result_t *in_results, uint8_t in_resultCount)
+{
+    return ma_api_wifi_profiles_rank(&stTestStore, in_results, in_resultCount, u8TestOrder);
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,236 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_race.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the Api called from several threads, built with
+  *               -fsanitize=thread so a data race fails the test case
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_SSID                    "home"
+#define DF_TEST_PASSWORD                "password1"
+#define DF_TEST_WAIT_MS                 5000    // Real time, longer means a thread is stuck
+#define DF_TEST_STATUS_REQUEST          "GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n"
+
+/* Private typedef -----------------------------------------------------------*/
+// Output that keeps what was printed
+class ma_test_output_t : public Print
+{
+public:
+    using Print::write;
+    size_t write(uint8_t in_byte) override { return write(&in_byte, 1); }
+    size_t write(const uint8_t *in_buffer, size_t in_size) override
+    {
+        data.append((const char *)in_buffer, in_size);
+        return in_size;
+    }
+
+    std::string data;
+};
+
+/* Private variables ---------------------------------------------------------*/
+static const st_wifi_task_config_t stTestTaskConfig = {6144, 1, DF_WIFI_TASK_ANY_CORE, 1};
+static std::atomic<bool> bTestInCallback(false);
+static std::atomic<bool> bTestReleased(false);
+static std::atomic<bool> bTestReturned(false);
+static std::atomic<int> s32TestResult(1);
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_on_connected(WiFiEvent_t in_event, WiFiEventInfo_t in_info);
+static bool test_wait_for(const std::atomic<bool> &in_flag);
+static void test_sleep(void);
+static bool test_wait_event(e_wifi_event_type_t in_type, st_wifi_event_t *out_event);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(calls_run_while_setup_station_waits)
+{
+    st_wifi_credential_t credential;
+    st_wifi_profile_info_t profiles[4];
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    CHECK_EQ(0, ma_api_wifi_credential_set(&credential, DF_TEST_SSID, DF_TEST_PASSWORD));
+    // Holds the waiting thread inside delay(), on the association event
+    WiFi.onEvent(test_on_connected, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+
+    std::thread station([&credential]() {
+        s32TestResult.store(ma_api_wifi_setup_station(credential, 3));
+        bTestReturned.store(true);
+    });
+    bool held = test_wait_for(bTestInCallback);
+
+    // Answered at once although the connection is not over
+    e_wifi_station_state_t state = ma_api_wifi_get_station_state();
+    st_wifi_connect_stats_t stats = ma_api_wifi_get_connect_stats();
+    bool portalActive = ma_api_wifi_portal_is_active();
+    uint8_t profileCount = ma_api_wifi_profile_list(profiles, 4);
+    bool returned = bTestReturned.load();
+    bTestReleased.store(true);
+    station.join();
+
+    CHECK(held);
+    CHECK(!returned);
+    CHECK_EQ(eWIFI_STATION_CONNECTING, state);
+    CHECK_EQ(eWIFI_CONNECT_PATH_NONE, stats.path);
+    CHECK(!portalActive);
+    CHECK_EQ(0, profileCount);
+    CHECK_EQ(0, s32TestResult.load());
+    CHECK_EQ(eWIFI_STATION_CONNECTED, ma_api_wifi_get_station_state());
+}
+
+TEST(manager_connects_while_loop_calls_the_api)
+{
+    st_wifi_credential_t credential;
+    st_wifi_profile_info_t profiles[4];
+    st_wifi_event_t event;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    CHECK_EQ(0, ma_api_wifi_credential_set(&credential, DF_TEST_SSID, DF_TEST_PASSWORD));
+    CHECK_EQ(0, ma_api_wifi_update_network_credentials(credential));
+
+    CHECK_EQ(0, ma_api_wifi_manager_start(&stTestTaskConfig));
+    bool connected = test_wait_event(eWIFI_EVENT_CONNECTED, &event);
+    e_wifi_station_state_t state = ma_api_wifi_get_station_state();
+    uint8_t profileCount = ma_api_wifi_profile_list(profiles, 4);
+    ma_api_wifi_manager_stop();
+
+    CHECK(connected);
+    CHECK_EQ(eWIFI_STATION_CONNECTED, state);
+    CHECK_EQ(1, profileCount);
+    CHECK_STR(DF_TEST_SSID, profiles[0].ssid);
+}
+
+TEST(manager_serves_the_portal_while_loop_calls_the_api)
+{
+    char response[1024];
+    st_wifi_event_t event;
+
+    CHECK_EQ(0, ma_api_wifi_manager_start(&stTestTaskConfig));
+    CHECK(ma_api_wifi_portal_is_active());
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+        ma_test_send(socket, DF_TEST_STATUS_REQUEST);
+        ma_test_receive(socket, test_sleep, response, sizeof(response), 1000, 1);
+        ma_host_net_release(socket);
+        CHECK(strncmp(response, "HTTP/1.1 200 OK\r\n", 17) == 0);
+        CHECK(test_wait_event(eWIFI_EVENT_PORTAL_CLIENT_SERVED, &event));
+    }
+    ma_api_wifi_manager_stop();
+}
+
+TEST(trace_is_printed_while_the_task_polls)
+{
+    st_wifi_credential_t credential;
+    st_wifi_event_t event;
+    ma_test_output_t output;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    CHECK_EQ(0, ma_api_wifi_credential_set(&credential, DF_TEST_SSID, DF_TEST_PASSWORD));
+    CHECK_EQ(0, ma_api_wifi_update_network_credentials(credential));
+
+    // As loop() does on the event, while the task keeps polling and recording spans
+    CHECK_EQ(0, ma_api_wifi_manager_start(&stTestTaskConfig));
+    bool connected = test_wait_event(eWIFI_EVENT_CONNECTED, &event);
+    ma_api_wifi_print_trace(&output);
+    ma_api_wifi_manager_stop();
+
+    CHECK(connected);
+    CHECK(output.data.find("connect failures: 0\n") != std::string::npos);
+    CHECK(output.data.find("spans, last") != std::string::npos);
+    CHECK(output.data.find("ma_api_wifi_manager_start") != std::string::npos);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_on_connected
+  * @brief      : WiFi event callback, runs on the thread that moved the clock and waits for the test
+  * @pre-cond.  : None
+  * @post-cond. : bTestInCallback set
+  * @parameters :
+  *       - in_event: ARDUINO_EVENT_WIFI_STA_CONNECTED
+  *       - in_info: Not used
+  * @retval     : None
+  */
+static void test_on_connected(WiFiEvent_t in_event, WiFiEventInfo_t in_info)
+{
+    bTestInCallback.store(true);
+    test_wait_for(bTestReleased);
+}
+
+/**
+  * @Func       : test_wait_for
+  * @brief      : Waits in real time until a flag is set
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_flag: Set by another thread
+  * @retval     : false if it was not set within DF_TEST_WAIT_MS
+  */
+static bool test_wait_for(const std::atomic<bool> &in_flag)
+{
+    for (uint32_t i = 0; i < DF_TEST_WAIT_MS && !in_flag.load(); i++)
+    {
+        test_sleep();
+    }
+    return in_flag.load();
+}
+
+/**
+  * @Func       : test_sleep
+  * @brief      : Lets the background task run one step, without moving the virtual clock
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_sleep(void)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+/**
+  * @Func       : test_wait_event
+  * @brief      : Reads the events as loop() does, moving the clock, until one of a type comes. The
+  *               state and the stats are read on the way, while the task polls.
+  * @pre-cond.  : Background task running
+  * @post-cond. : The events before it are dropped
+  * @parameters :
+  *       - in_type: Event to wait for
+  *       - out_event: Receives it
+  * @retval     : false if it did not come within DF_TEST_WAIT_MS
+  */
+static bool test_wait_event(e_wifi_event_type_t in_type, st_wifi_event_t *out_event)
+{
+    for (uint32_t i = 0; i < DF_TEST_WAIT_MS; i++)
+    {
+        while (ma_api_wifi_get_event(out_event))
+        {
+            if (out_event->type == in_type)
+            {
+                return true;
+            }
+        }
+        ma_api_wifi_get_station_state();
+        ma_api_wifi_get_connect_stats();
+        delay(10);
+        test_sleep();
+    }
+    return false;
+}
+
+/*****************************END OF FILE**************************************/
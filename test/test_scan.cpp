@@ -0,0 +1,253 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_scan.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the scan cache and of /scan.json, on the scanner of
+  *               the simulated radio
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_scan.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_SCAN_TTL_MS             30000   // DF_PORTAL_SCAN_TTL_MS of the Api
+#define DF_TEST_SCAN_REQUEST            "GET /scan.json HTTP/1.1\r\nConnection: close\r\n\r\n"
+
+/* Private variables ---------------------------------------------------------*/
+static const st_host_wifi_timing_t stTestTiming = DF_HOST_WIFI_TIMING_DEFAULT;
+static st_wifi_scan_cache_t stTestCache;
+static char cTestResponse[4096];
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_cache_add(const char *in_ssid, int8_t in_rssi);
+static void test_start_portal(void);
+static const char *test_scan_json(void);
+static uint32_t test_scans(void);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(cache_keeps_the_strongest_ap_of_an_ssid)
+{
+    ma_api_wifi_scan_clear(&stTestCache);
+    ma_api_wifi_scan_begin(&stTestCache, 100);
+    ma_api_wifi_scan_done(&stTestCache, 2300);
+    test_cache_add("mesh", -80);
+    test_cache_add("cafe", -60);
+    test_cache_add("mesh", -40);
+    test_cache_add("mesh", -90);
+    test_cache_add("home", -70);
+
+    CHECK_EQ(3, stTestCache.count);
+    CHECK_STR("mesh", stTestCache.results[0].ssid);
+    CHECK_EQ(-40, stTestCache.results[0].rssi);
+    CHECK_STR("cafe", stTestCache.results[1].ssid);
+    CHECK_STR("home", stTestCache.results[2].ssid);
+    CHECK_EQ(2200, stTestCache.durationMs);
+}
+
+TEST(full_cache_drops_the_weakest)
+{
+    char ssid[8];
+
+    ma_api_wifi_scan_clear(&stTestCache);
+    ma_api_wifi_scan_done(&stTestCache, 0);
+    for (int i = 0; i < DF_WIFI_SCAN_CACHE_SIZE + 4; i++)
+    {
+        snprintf(ssid, sizeof(ssid), "n%02d", i);
+        test_cache_add(ssid, (int8_t)(-90 + (i * 7) % 50));
+    }
+    CHECK_EQ(DF_WIFI_SCAN_CACHE_SIZE, stTestCache.count);
+    for (uint8_t i = 1; i < stTestCache.count; i++)
+    {
+        CHECK(stTestCache.results[i - 1].rssi >= stTestCache.results[i].rssi);
+    }
+
+    // Weaker than the whole table: left out; stronger: the weakest entry goes
+    int8_t weakest = stTestCache.results[DF_WIFI_SCAN_CACHE_SIZE - 1].rssi;
+    test_cache_add("weak", weakest);
+    CHECK(strcmp(stTestCache.results[DF_WIFI_SCAN_CACHE_SIZE - 1].ssid, "weak") != 0);
+    test_cache_add("strong", -10);
+    CHECK_STR("strong", stTestCache.results[0].ssid);
+    CHECK_EQ(DF_WIFI_SCAN_CACHE_SIZE, stTestCache.count);
+}
+
+TEST(hidden_and_long_ssids)
+{
+    ma_api_wifi_scan_clear(&stTestCache);
+    ma_api_wifi_scan_done(&stTestCache, 0);
+    ma_api_wifi_scan_add(&stTestCache, "", 0, -30, true);
+    ma_api_wifi_scan_add(&stTestCache, "0123456789012345678901234567890123456789", 40, -50, false);
+    CHECK_EQ(1, stTestCache.count);
+    CHECK_EQ(32, strlen(stTestCache.results[0].ssid));
+    CHECK_EQ(0, stTestCache.results[0].secure);
+}
+
+TEST(cache_goes_stale_after_its_ttl)
+{
+    ma_api_wifi_scan_clear(&stTestCache);
+    CHECK(ma_api_wifi_scan_is_stale(&stTestCache, 0, DF_TEST_SCAN_TTL_MS));
+    CHECK_EQ(UINT32_MAX, ma_api_wifi_scan_age(&stTestCache, 0));
+
+    ma_api_wifi_scan_begin(&stTestCache, 1000);
+    CHECK(!ma_api_wifi_scan_is_stale(&stTestCache, 1000 + DF_TEST_SCAN_TTL_MS * 2, DF_TEST_SCAN_TTL_MS));
+    ma_api_wifi_scan_done(&stTestCache, 3000);
+    test_cache_add("home", -50);
+    CHECK(!ma_api_wifi_scan_is_stale(&stTestCache, 3000 + DF_TEST_SCAN_TTL_MS - 1, DF_TEST_SCAN_TTL_MS));
+    CHECK(ma_api_wifi_scan_is_stale(&stTestCache, 3000 + DF_TEST_SCAN_TTL_MS, DF_TEST_SCAN_TTL_MS));
+    CHECK_EQ(500, ma_api_wifi_scan_age(&stTestCache, 3500));
+
+    // A failed scan keeps the previous table and its age
+    ma_api_wifi_scan_begin(&stTestCache, 40000);
+    ma_api_wifi_scan_abort(&stTestCache);
+    CHECK_EQ(1, stTestCache.count);
+    CHECK_EQ(37000, ma_api_wifi_scan_age(&stTestCache, 40000));
+}
+
+TEST(portal_scans_in_the_background)
+{
+    ma_host_wifi_add_ap("home", "password1", -60, 6);
+    ma_host_wifi_add_ap("mesh", "password2", -80, 1);
+    ma_host_wifi_add_ap("mesh", "password2", -45, 11);
+    ma_host_wifi_add_ap("cafe", "", -70, 6);
+    test_start_portal();
+
+    // Served at once while the scan runs
+    uint64_t startUs = ma_host_clock_us();
+    CHECK(strstr(test_scan_json(), "{\"scanning\":true,\"ageMs\":null,\"durationMs\":0,\"networks\":[]}") != NULL);
+    CHECK(ma_host_clock_us() - startUs < stTestTiming.scanMs * 1000u / 10);
+    CHECK_EQ(1, test_scans());
+
+    ma_host_clock_advance(stTestTiming.scanMs);
+    ma_api_wifi_portal_poll();
+    CHECK(strstr(test_scan_json(), "\"networks\":[{\"ssid\":\"mesh\",\"rssi\":-45,\"secure\":true},"
+                                   "{\"ssid\":\"home\",\"rssi\":-60,\"secure\":true},"
+                                   "{\"ssid\":\"cafe\",\"rssi\":-70,\"secure\":false}]}") != NULL);
+    CHECK(strstr(cTestResponse, "\"scanning\":false") != NULL);
+    // Seen by the poll after the radio finished, the request above ran in between
+    const char *duration = strstr(cTestResponse, "\"durationMs\":");
+    CHECK(duration != NULL);
+    uint32_t durationMs = strtoul(duration + 13, NULL, 10);
+    CHECK(durationMs >= stTestTiming.scanMs);
+    CHECK(durationMs <= stTestTiming.scanMs + 10);
+}
+
+TEST(cache_is_refreshed_after_its_ttl)
+{
+    ma_host_wifi_add_ap("home", "password1", -60, 6);
+    test_start_portal();
+    ma_host_clock_advance(stTestTiming.scanMs);
+    ma_api_wifi_portal_poll();
+    CHECK_EQ(1, test_scans());
+
+    // Fresh: requests are served from the cache, nothing is scanned
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        test_scan_json();
+        ma_host_clock_advance(DF_TEST_SCAN_TTL_MS / 20);
+    }
+    CHECK_EQ(1, test_scans());
+    CHECK(strstr(cTestResponse, "\"scanning\":false") != NULL);
+
+    // Stale: the old table is served and one new scan starts
+    ma_host_wifi_add_ap("office", "password3", -40, 1);
+    ma_host_clock_advance(DF_TEST_SCAN_TTL_MS);
+    CHECK(strstr(test_scan_json(), "\"scanning\":true") != NULL);
+    CHECK(strstr(cTestResponse, "office") == NULL);
+    test_scan_json();
+    CHECK_EQ(2, test_scans());
+
+    ma_host_clock_advance(stTestTiming.scanMs);
+    ma_api_wifi_portal_poll();
+    CHECK(strstr(test_scan_json(), "{\"ssid\":\"office\",\"rssi\":-40,\"secure\":true}") != NULL);
+}
+
+TEST(failed_scan_keeps_the_old_table)
+{
+    ma_host_wifi_add_ap("home", "password1", -60, 6);
+    test_start_portal();
+    ma_host_clock_advance(stTestTiming.scanMs);
+    ma_api_wifi_portal_poll();
+
+    ma_host_wifi_fail_scans(true);
+    ma_host_clock_advance(DF_TEST_SCAN_TTL_MS);
+    test_scan_json();
+    ma_host_clock_advance(stTestTiming.scanMs);
+    ma_api_wifi_portal_poll();
+    CHECK(strstr(test_scan_json(), "{\"ssid\":\"home\",\"rssi\":-60,\"secure\":true}") != NULL);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_cache_add
+  * @brief      : Adds a secure network to stTestCache
+  * @pre-cond.  : ma_api_wifi_scan_done() was called
+  * @post-cond. : None
+  * @parameters :
+  *       - in_ssid: SSID, null terminated
+  *       - in_rssi: Signal in dBm
+  * @retval     : None
+  */
+static void test_cache_add(const char *in_ssid, int8_t in_rssi)
+{
+    ma_api_wifi_scan_add(&stTestCache, in_ssid, strlen(in_ssid), in_rssi, true);
+}
+
+/**
+  * @Func       : test_start_portal
+  * @brief      : Starts the portal with no saved network, which asks for a background scan
+  * @pre-cond.  : None
+  * @post-cond. : Portal active, scan started
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_start_portal(void)
+{
+    st_wifi_credential_t credential;
+
+    memset(&credential, 0, sizeof(credential));
+    ma_api_wifi_setup_access_point(credential);
+    CHECK(ma_api_wifi_portal_is_active());
+    ma_api_wifi_portal_poll();
+}
+
+/**
+  * @Func       : test_scan_json
+  * @brief      : Requests /scan.json
+  * @pre-cond.  : Portal active
+  * @post-cond. : cTestResponse holds the response
+  * @parameters : None
+  * @retval     : The response
+  */
+static const char *test_scan_json(void)
+{
+    ma_test_portal_request(DF_TEST_SCAN_REQUEST, cTestResponse, sizeof(cTestResponse));
+    CHECK(strncmp(cTestResponse, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    return cTestResponse;
+}
+
+/**
+  * @Func       : test_scans
+  * @brief      : Scans started on the simulated radio
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : None
+  * @retval     : Number of WiFi.scanNetworks() calls
+  */
+static uint32_t test_scans(void)
+{
+    st_host_wifi_stats_t stats;
+
+    ma_host_wifi_get_stats(&stats);
+    return stats.scans;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,200 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_soak.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Long runs of the portal and of the station, that must not
+  *               touch the heap once they reached their steady state
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_config.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_SSID                    "Home"
+#define DF_TEST_PASSWORD                "password1"
+#define DF_TEST_ROUNDS                  1000
+#define DF_TEST_MAX_POLLS               20000
+
+/* Private variables ---------------------------------------------------------*/
+static char cTestResponse[16384];
+
+// Every route of the portal that does not change the saved networks
+static const char *const pcTestRequests[] = {
+    "GET / HTTP/1.1\r\nHost: 192.168.123.123\r\nAccept-Encoding: gzip\r\nConnection: close\r\n\r\n",
+    "GET /status.json HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "GET /credentials.json HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "GET /scan.json HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "GET /profiles.json HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "GET /generate_204 HTTP/1.1\r\nHost: connectivitycheck.gstatic.com\r\nConnection: close\r\n\r\n",
+    "GET /missing HTTP/1.1\r\nConnection: close\r\n\r\n",
+    "GET /status.json?ssid=a%20b&x=%ZZ HTTP/1.1\r\nConnection: close\r\n\r\n",
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void test_portal_round(void);
+static void test_connect_round(void);
+static void test_wait_connected(void);
+static void test_check_no_allocation(const st_host_stats_t *in_before);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(portal_requests_do_not_allocate)
+{
+    st_wifi_credential_t credential;
+    st_host_stats_t before;
+
+    CHECK_EQ(0, ma_api_wifi_credential_set(&credential, DF_TEST_SSID, DF_TEST_PASSWORD));
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    ma_host_wifi_add_ap("Neighbour", "password2", -70, 11);
+    ma_api_wifi_setup_access_point(credential);
+    CHECK(ma_api_wifi_portal_is_active());
+
+    // The first round fills the scan cache and the lazy buffers
+    test_portal_round();
+    ma_host_clock_advance(5000);
+    test_portal_round();
+
+    ma_host_get_stats(&before);
+    for (uint32_t round = 0; round < DF_TEST_ROUNDS; round++)
+    {
+        test_portal_round();
+        ma_host_clock_advance(1000);
+    }
+    test_check_no_allocation(&before);
+}
+
+TEST(connect_and_reconnect_do_not_allocate)
+{
+    st_host_stats_t before;
+
+    ma_host_wifi_add_ap(DF_TEST_SSID, DF_TEST_PASSWORD, -50, 6);
+    CHECK_EQ(0, ma_api_wifi_profile_add(DF_TEST_SSID, DF_TEST_PASSWORD, 100));
+    test_connect_round();
+    test_connect_round();
+
+    ma_host_get_stats(&before);
+    for (uint32_t round = 0; round < DF_TEST_ROUNDS; round++)
+    {
+        test_connect_round();
+    }
+    test_check_no_allocation(&before);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_portal_round
+  * @brief      : Every request of pcTestRequests on its own connection, then all of them on one
+  *               kept-alive connection
+  * @pre-cond.  : Portal active
+  * @post-cond. : Every connection was closed by the portal
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_portal_round(void)
+{
+    uint8_t count = sizeof(pcTestRequests) / sizeof(pcTestRequests[0]);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        ma_test_portal_request(pcTestRequests[i], cTestResponse, sizeof(cTestResponse));
+        CHECK(strncmp(cTestResponse, "HTTP/1.1 ", 9) == 0);
+    }
+
+    st_host_socket_t *socket = ma_test_connect(DF_WIFI_HTTP_PORT);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        // The same requests, kept alive but the last one
+        const char *request = pcTestRequests[i];
+        size_t length = strlen(request) - strlen("Connection: close\r\n\r\n");
+        ma_host_net_send(socket, request, length);
+        ma_test_send(socket, (i + 1 < count) ? "\r\n" : "Connection: close\r\n\r\n");
+    }
+    size_t received = ma_test_receive(socket, ma_api_wifi_portal_poll, cTestResponse, sizeof(cTestResponse), 200, 1);
+    CHECK(ma_host_net_is_closed(socket));
+
+    // The gzip page holds null bytes, the status lines are counted with memmem()
+    uint8_t responses = 0;
+    const char *end = cTestResponse + received;
+    for (const char *response = cTestResponse; response != NULL && response < end; response++)
+    {
+        response = (const char *)memmem(response, end - response, "HTTP/1.1 ", 9);
+        responses += (response != NULL) ? 1 : 0;
+        if (response == NULL)
+        {
+            break;
+        }
+    }
+    CHECK_EQ(count, responses);
+    ma_host_net_release(socket);
+}
+
+/**
+  * @Func       : test_connect_round
+  * @brief      : Joins the saved network, loses the link and gets it back, then disconnects
+  * @pre-cond.  : DF_TEST_SSID is saved and in range
+  * @post-cond. : Station idle
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_connect_round(void)
+{
+    CHECK_EQ(0, ma_api_wifi_connect_profiles_async(NULL, NULL));
+    test_wait_connected();
+
+    ma_host_wifi_drop_link(WIFI_REASON_BEACON_TIMEOUT);
+    ma_host_clock_advance(1);
+    ma_api_wifi_station_poll();
+    test_wait_connected();
+
+    WiFi.disconnect();
+    ma_host_clock_advance(10);
+    ma_api_wifi_station_poll();
+}
+
+/**
+  * @Func       : test_wait_connected
+  * @brief      : Polls the station each 10 ms until WiFi is connected
+  * @pre-cond.  : None
+  * @post-cond. : WiFi connected
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_wait_connected(void)
+{
+    for (uint32_t i = 0; i < DF_TEST_MAX_POLLS; i++)
+    {
+        if (WiFi.status() == WL_CONNECTED && ma_api_wifi_get_station_state() == eWIFI_STATION_CONNECTED)
+        {
+            return;
+        }
+        ma_host_clock_advance(10);
+        ma_api_wifi_station_poll();
+    }
+    CHECK(false);
+}
+
+/**
+  * @Func       : test_check_no_allocation
+  * @brief      : Checks that the heap was not used since a snapshot
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_before: Snapshot of ma_host_get_stats()
+  * @retval     : None
+  */
+static void test_check_no_allocation(const st_host_stats_t *in_before)
+{
+    st_host_stats_t after;
+
+    ma_host_get_stats(&after);
+    CHECK_EQ(0, after.allocations - in_before->allocations);
+    CHECK_EQ(in_before->bytesInUse, after.bytesInUse);
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,584 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_storage.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the record storage and of its default backends
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <SPIFFS.h>
+#include <Preferences.h>
+
+#include "ma_test.h"
+#include "ma_api_wifi_auto_ap_station.h"
+#include "ma_api_wifi_storage.h"
+#include "ma_api_wifi_profiles.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_RECORD_NAME             "/wifi_test"
+#define DF_TEST_RECORD_MAGIC            0x54534554  // "TEST"
+#define DF_TEST_RECORD_VERSION          1
+#define DF_TEST_BACKEND_NVS             1       // Position in the default table
+#define DF_TEST_BACKEND_SPIFFS          2
+#define DF_TEST_SLOT_A                  DF_TEST_RECORD_NAME ".a"
+#define DF_TEST_SLOT_B                  DF_TEST_RECORD_NAME ".b"
+#define DF_TEST_RAM_CACHE               0       // Positions in the table of RAM backends
+#define DF_TEST_RAM_STORE               1
+#define DF_TEST_RAM_OLDER               2
+#define DF_TEST_RAM_COUNT               3
+#define DF_TEST_CREDENTIALS_NAME        "/wifi_cred"    // Record of older versions, DF_WIFI_CREDENTIALS_RECORD_NAME
+#define DF_TEST_CREDENTIALS_MAGIC       0x4357414D      // "MAWC"
+#define DF_TEST_CREDENTIALS_VERSION     1
+#define DF_TEST_PROFILES_KEY            "wifi_prof"     // NVS key of DF_PROFILES_RECORD_NAME
+#define DF_TEST_PROFILES_MAGIC          0x5057414D      // "MAWP"
+#define DF_TEST_PROFILES_VERSION        1
+#define DF_TEST_NVS_NAMESPACE           "ma_wifi"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  uint32_t value;
+  char text[12];
+}st_test_record_t;
+
+// Layout of the credential record of older versions
+typedef struct {
+  uint8_t ssidLength;
+  char ssid[DF_WIFI_SSID_BUFFER_SIZE - 1];
+  uint8_t passwordLength;
+  char password[DF_WIFI_PASSWORD_BUFFER_SIZE - 1];
+}st_test_credentials_t;
+
+// Backend kept in RAM, one record
+typedef struct {
+  bool used;
+  bool failWrites;
+  st_wifi_record_header_t header;
+  st_test_record_t payload;
+}st_test_ram_t;
+
+/* Private variables ---------------------------------------------------------*/
+static st_test_ram_t stTestRam[DF_TEST_RAM_COUNT];
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t test_backend_reads(uint8_t in_index);
+static st_wifi_storage_stats_t test_backend_stats(uint8_t in_index);
+static void test_write(uint32_t in_value);
+static uint32_t test_read(void);
+static void test_slot_write(uint32_t in_value);
+static uint32_t test_slot_read(void);
+static void test_file_flip_last_byte(const char *in_path);
+static void test_profiles_seed(void);
+template <uint8_t index> static int8_t test_ram_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length);
+template <uint8_t index> static int8_t test_ram_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length);
+template <uint8_t index> static void test_ram_erase(const char *in_name);
+
+/* Private objects -----------------------------------------------------------*/
+// RTC, NVS and SPIFFS of the default table, in RAM
+static const st_wifi_storage_backend_t stTestRamCache = {"cache", false, test_ram_read<0>, test_ram_write<0>, test_ram_erase<0>};
+static const st_wifi_storage_backend_t stTestRamStore = {"store", true, test_ram_read<1>, test_ram_write<1>, test_ram_erase<1>};
+static const st_wifi_storage_backend_t stTestRamOlder = {"older", true, test_ram_read<2>, test_ram_write<2>, test_ram_erase<2>};
+static const st_wifi_storage_backend_t *const pstTestRamBackends[DF_TEST_RAM_COUNT] = {&stTestRamCache, &stTestRamStore, &stTestRamOlder};
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(miss_checks_spiffs_once)
+{
+    st_test_record_t record;
+
+    CHECK_EQ(-1, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+    CHECK_EQ(1, test_backend_reads(DF_TEST_BACKEND_SPIFFS));
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        CHECK_EQ(-1, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+    }
+    CHECK_EQ(1, test_backend_reads(DF_TEST_BACKEND_SPIFFS));
+    // The erase marker is cached in RTC memory as well
+    CHECK_EQ(1, test_backend_reads(DF_TEST_BACKEND_NVS));
+}
+
+TEST(erase_and_write_do_not_mount_spiffs)
+{
+    st_test_record_t record = {7, "seven"};
+    st_test_record_t copy;
+
+    CHECK_EQ(0, ma_api_wifi_storage_write(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+    ma_api_wifi_storage_erase(DF_TEST_RECORD_NAME);
+    CHECK_EQ(-1, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+    CHECK_EQ(0, test_backend_reads(DF_TEST_BACKEND_SPIFFS));
+    CHECK(!ma_host_fs_is_mounted());
+}
+
+TEST(erase_marker_hides_an_older_copy)
+{
+    st_test_record_t record = {1, "old"};
+    st_test_record_t copy;
+
+    CHECK_EQ(0, stStorageBackendSpiffs.write(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+    ma_api_wifi_storage_erase(DF_TEST_RECORD_NAME);
+    CHECK_EQ(-1, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+    CHECK_EQ(0, test_backend_reads(DF_TEST_BACKEND_SPIFFS));
+}
+
+TEST(older_copy_is_moved_to_nvs)
+{
+    st_test_record_t record = {42, "from spiffs"};
+    st_test_record_t copy;
+
+    CHECK_EQ(0, stStorageBackendSpiffs.write(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+
+    memset(&copy, 0, sizeof(copy));
+    CHECK_EQ(0, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+    CHECK_EQ(42, copy.value);
+    CHECK_STR("from spiffs", copy.text);
+    CHECK_EQ(-1, stStorageBackendSpiffs.read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+
+    memset(&copy, 0, sizeof(copy));
+    CHECK_EQ(0, stStorageBackendNvs.read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+    CHECK_EQ(42, copy.value);
+    CHECK_EQ(0, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+    CHECK_EQ(1, test_backend_reads(DF_TEST_BACKEND_SPIFFS));
+}
+
+TEST(spiffs_that_does_not_mount_is_not_formatted)
+{
+    st_test_record_t record;
+
+    ma_host_fs_set_corrupt(true);
+    CHECK_EQ(-2, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+    CHECK(!ma_host_fs_is_mounted());
+
+    // No erase marker: the record may be there, the next read looks again
+    CHECK_EQ(-2, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+    CHECK_EQ(2, test_backend_reads(DF_TEST_BACKEND_SPIFFS));
+}
+
+TEST(read_after_a_wake_touches_no_flash)
+{
+    static const st_wifi_storage_backend_t *const backends[] = {&stStorageBackendRtc, &stStorageBackendNvs, &stStorageBackendSpiffs};
+    st_host_nvs_stats_t before;
+    st_host_nvs_stats_t after;
+
+    test_write(7);
+    // Same backends, the counters start again as after a wake from deep sleep
+    CHECK_EQ(0, ma_api_wifi_storage_set_backends(backends, 3));
+    ma_host_nvs_get_stats(&before);
+    CHECK_EQ(7, test_read());
+    ma_host_nvs_get_stats(&after);
+
+    CHECK_EQ(1, test_backend_stats(0).hits);
+    CHECK_EQ(0, test_backend_reads(DF_TEST_BACKEND_NVS));
+    CHECK_EQ(0, test_backend_reads(DF_TEST_BACKEND_SPIFFS));
+    CHECK_EQ(before.reads, after.reads);
+    CHECK(!ma_host_fs_is_mounted());
+}
+
+TEST(write_goes_through_up_to_the_store)
+{
+    CHECK_EQ(0, ma_api_wifi_storage_set_backends(pstTestRamBackends, DF_TEST_RAM_COUNT));
+    for (uint32_t value = 1; value <= 100; value++)
+    {
+        test_write(value);
+        CHECK_EQ(value, stTestRam[DF_TEST_RAM_CACHE].payload.value);
+        CHECK_EQ(value, stTestRam[DF_TEST_RAM_STORE].payload.value);
+    }
+    for (uint8_t i = 0; i < 100; i++)
+    {
+        CHECK_EQ(100, test_read());
+    }
+
+    // One write of the store per record written, the reads write nothing and stop at the cache
+    CHECK_EQ(100, test_backend_stats(DF_TEST_RAM_CACHE).writes);
+    CHECK_EQ(100, test_backend_stats(DF_TEST_RAM_CACHE).hits);
+    CHECK_EQ(100, test_backend_stats(DF_TEST_RAM_STORE).writes);
+    CHECK_EQ(0, test_backend_reads(DF_TEST_RAM_STORE));
+    CHECK_EQ(0, test_backend_stats(DF_TEST_RAM_OLDER).writes);
+    CHECK(!stTestRam[DF_TEST_RAM_OLDER].used);
+}
+
+TEST(power_on_reads_the_store_once)
+{
+    CHECK_EQ(0, ma_api_wifi_storage_set_backends(pstTestRamBackends, DF_TEST_RAM_COUNT));
+    test_write(5);
+    // The cache does not survive a power cycle
+    memset(&stTestRam[DF_TEST_RAM_CACHE], 0, sizeof(stTestRam[0]));
+
+    CHECK_EQ(5, test_read());
+    CHECK_EQ(5, test_read());
+    CHECK_EQ(1, test_backend_reads(DF_TEST_RAM_STORE));
+    CHECK_EQ(2, test_backend_stats(DF_TEST_RAM_CACHE).writes);
+    CHECK_EQ(1, test_backend_stats(DF_TEST_RAM_STORE).writes);
+    CHECK_EQ(0, test_backend_reads(DF_TEST_RAM_OLDER));
+}
+
+TEST(failed_cache_write_drops_the_old_copy)
+{
+    CHECK_EQ(0, ma_api_wifi_storage_set_backends(pstTestRamBackends, DF_TEST_RAM_COUNT));
+    test_write(1);
+    stTestRam[DF_TEST_RAM_CACHE].failWrites = true;
+    test_write(2);
+
+    // The cache has no copy left, not the older one
+    CHECK(!stTestRam[DF_TEST_RAM_CACHE].used);
+    CHECK_EQ(1, test_backend_stats(DF_TEST_RAM_CACHE).failures);
+    CHECK_EQ(2, test_read());
+}
+
+TEST(torn_write_keeps_the_previous_copy)
+{
+    st_test_record_t record = {1, "torn"};
+    size_t slotSize = sizeof(st_wifi_record_header_t) + sizeof(record);
+    uint32_t expected = 1;
+
+    test_slot_write(expected);
+    // Every cut of the slot, header and payload, alternating between slot a and slot b
+    for (size_t cut = 0; cut < slotSize; cut++)
+    {
+        record.value = 5000 + (uint32_t)cut;
+        ma_host_fs_power_fail_after(cut);
+        CHECK_EQ(-1, stStorageBackendSpiffs.write(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+        ma_host_fs_power_restore();
+        CHECK_EQ(expected, test_slot_read());
+
+        expected = 100 + (uint32_t)cut;
+        test_slot_write(expected);
+        CHECK_EQ(expected, test_slot_read());
+    }
+}
+
+TEST(writes_alternate_between_the_slots)
+{
+    test_slot_write(1);
+    CHECK(SPIFFS.exists(DF_TEST_SLOT_A));
+    CHECK(!SPIFFS.exists(DF_TEST_SLOT_B));
+    test_slot_write(2);
+    CHECK(SPIFFS.exists(DF_TEST_SLOT_B));
+    CHECK_EQ(2, test_slot_read());
+
+    // A bad CRC in the newest slot falls back to the other one, and the next write replaces it
+    test_file_flip_last_byte(DF_TEST_SLOT_B);
+    CHECK_EQ(1, test_slot_read());
+    test_slot_write(3);
+    CHECK_EQ(3, test_slot_read());
+    test_file_flip_last_byte(DF_TEST_SLOT_A);
+    CHECK_EQ(3, test_slot_read());
+
+    test_file_flip_last_byte(DF_TEST_SLOT_B);
+    st_test_record_t copy;
+    CHECK_EQ(-1, stStorageBackendSpiffs.read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+}
+
+TEST(legacy_text_file_is_migrated)
+{
+    st_wifi_credential_t credential;
+
+    CHECK_EQ(0, ma_api_wifi_storage_spiffs_mount());
+    File file = SPIFFS.open("/wifi_credentials.txt", "w");
+    CHECK(file);
+    file.print("SSID: Home \r\nPassword: secret12\n");
+    file.close();
+
+    st_host_nvs_stats_t nvsStats;
+    st_host_fs_stats_t fsStats;
+    ma_host_fs_get_stats(&fsStats);
+    uint32_t fsWrites = fsStats.writes;
+
+    CHECK_EQ(0, ma_api_wifi_read_network_credentials(&credential));
+    CHECK_STR("Home", credential.ssid);
+    CHECK_STR("secret12", credential.psk);
+    CHECK(!SPIFFS.exists("/wifi_credentials.txt"));
+
+    // Converted in RAM: the markers of the two misses (profile store, credential record) and the profile
+    // store, no credential record
+    ma_host_nvs_get_stats(&nvsStats);
+    ma_host_fs_get_stats(&fsStats);
+    CHECK_EQ(3, nvsStats.writes);
+    CHECK_EQ(fsWrites, fsStats.writes);
+}
+
+TEST(legacy_text_file_waits_for_spiffs_to_mount)
+{
+    st_wifi_credential_t credential;
+    st_host_nvs_stats_t stats;
+
+    // Saved by an older version, SPIFFS is not mounted by the Api yet
+    CHECK(SPIFFS.begin(false));
+    File file = SPIFFS.open("/wifi_credentials.txt", "w");
+    CHECK(file);
+    file.print("SSID: Home\nPassword: secret12\n");
+    file.close();
+    SPIFFS.end();
+
+    // A boot where SPIFFS does not mount writes nothing, neither the empty profile store nor a marker
+    ma_host_fs_set_corrupt(true);
+    CHECK_EQ(-1, ma_api_wifi_read_network_credentials(&credential));
+    ma_host_nvs_get_stats(&stats);
+    CHECK_EQ(0, stats.writes);
+
+    ma_host_fs_set_corrupt(false);
+    CHECK(SPIFFS.begin(false));
+    CHECK(SPIFFS.exists("/wifi_credentials.txt"));
+}
+
+TEST(legacy_record_is_migrated)
+{
+    st_test_credentials_t record;
+    st_wifi_credential_t credential;
+    st_host_nvs_stats_t stats;
+
+    memset(&record, 0, sizeof(record));
+    record.ssidLength = 4;
+    memcpy(record.ssid, "Home", 4);
+    record.passwordLength = 8;
+    memcpy(record.password, "secret12", 8);
+    CHECK_EQ(0, ma_api_wifi_storage_write(DF_TEST_CREDENTIALS_NAME, DF_TEST_CREDENTIALS_MAGIC, DF_TEST_CREDENTIALS_VERSION, &record, sizeof(record)));
+    ma_host_nvs_get_stats(&stats);
+    uint32_t writes = stats.writes;
+
+    CHECK_EQ(0, ma_api_wifi_read_network_credentials(&credential));
+    CHECK_STR("Home", credential.ssid);
+    CHECK_STR("secret12", credential.psk);
+    // Marker of the profile store miss, the profile store, then the erase marker of the old record
+    ma_host_nvs_get_stats(&stats);
+    CHECK_EQ(writes + 3, stats.writes);
+    CHECK_EQ(-1, ma_api_wifi_storage_read(DF_TEST_CREDENTIALS_NAME, DF_TEST_CREDENTIALS_MAGIC, DF_TEST_CREDENTIALS_VERSION, &record, sizeof(record)));
+}
+
+TEST(read_error_keeps_the_saved_networks)
+{
+    st_wifi_profile_info_t profiles[DF_WIFI_MAX_PROFILES];
+    st_host_nvs_stats_t stats;
+
+    test_profiles_seed();
+    ma_host_nvs_get_stats(&stats);
+    uint32_t writes = stats.writes;
+
+    // NVS does not open: nothing is changed, nothing is written
+    ma_host_nvs_set_corrupt(true);
+    CHECK_EQ(-1, ma_api_wifi_profile_add("Cafe", "password3", DF_WIFI_PROFILE_DEFAULT_PRIORITY));
+    CHECK_EQ(-1, ma_api_wifi_profile_delete("Home"));
+    CHECK_EQ(0, ma_api_wifi_profile_list(profiles, DF_WIFI_MAX_PROFILES));
+    ma_host_nvs_get_stats(&stats);
+    CHECK_EQ(writes, stats.writes);
+
+    // The next call reads again and adds to the saved networks
+    ma_host_nvs_set_corrupt(false);
+    CHECK_EQ(0, ma_api_wifi_profile_add("Cafe", "password3", DF_WIFI_PROFILE_DEFAULT_PRIORITY));
+    CHECK_EQ(3, ma_api_wifi_profile_list(profiles, DF_WIFI_MAX_PROFILES));
+    CHECK_STR("Home", profiles[0].ssid);
+    CHECK_STR("Office", profiles[1].ssid);
+    CHECK_STR("Cafe", profiles[2].ssid);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_backend_reads
+  * @brief      : Reads that reached one backend of the default table
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_index: Position of the backend
+  * @retval     : Number of reads
+  */
+static uint32_t test_backend_reads(uint8_t in_index)
+{
+    st_wifi_storage_stats_t stats;
+
+    CHECK_EQ(0, ma_api_wifi_storage_get_stats(in_index, &stats));
+    return stats.reads;
+}
+
+/**
+  * @Func       : test_backend_stats
+  * @brief      : Counters of one backend of the table in use
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_index: Position of the backend
+  * @retval     : Counters
+  */
+static st_wifi_storage_stats_t test_backend_stats(uint8_t in_index)
+{
+    st_wifi_storage_stats_t stats;
+
+    CHECK_EQ(0, ma_api_wifi_storage_get_stats(in_index, &stats));
+    return stats;
+}
+
+/**
+  * @Func       : test_write
+  * @brief      : Writes the test record through ma_api_wifi_storage_write()
+  * @pre-cond.  : None
+  * @post-cond. : The write succeeded
+  * @parameters : in_value: Value of the record
+  * @retval     : None
+  */
+static void test_write(uint32_t in_value)
+{
+    st_test_record_t record = {in_value, "record"};
+
+    CHECK_EQ(0, ma_api_wifi_storage_write(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+}
+
+/**
+  * @Func       : test_read
+  * @brief      : Reads the test record through ma_api_wifi_storage_read()
+  * @pre-cond.  : None
+  * @post-cond. : The read succeeded
+  * @parameters : None
+  * @retval     : Value of the record
+  */
+static uint32_t test_read(void)
+{
+    st_test_record_t copy;
+
+    CHECK_EQ(0, ma_api_wifi_storage_read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+    CHECK_STR("record", copy.text);
+    return copy.value;
+}
+
+/**
+  * @Func       : test_ram_read
+  * @brief      : read of the RAM backend stTestRam[index]
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : See st_wifi_storage_backend_t
+  * @retval     : 0 for a valid record, -1 otherwise
+  */
+template <uint8_t index> static int8_t test_ram_read(const char *in_name, uint32_t in_magic, uint8_t in_version, void *out_payload, uint16_t in_length)
+{
+    const st_test_ram_t *ram = &stTestRam[index];
+
+    (void)in_name;
+    if (!ram->used || in_length > sizeof(ram->payload) ||
+        ma_api_wifi_storage_check_record(&ram->header, in_magic, in_version, &ram->payload, in_length) != 0)
+    {
+        return -1;
+    }
+    memcpy(out_payload, &ram->payload, in_length);
+    return 0;
+}
+
+/**
+  * @Func       : test_ram_write
+  * @brief      : write of the RAM backend stTestRam[index], fails while failWrites is set
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : See st_wifi_storage_backend_t
+  * @retval     : 0 on success, -1 otherwise
+  */
+template <uint8_t index> static int8_t test_ram_write(const char *in_name, uint32_t in_magic, uint8_t in_version, const void *in_payload, uint16_t in_length)
+{
+    st_test_ram_t *ram = &stTestRam[index];
+
+    (void)in_name;
+    if (ram->failWrites || in_length > sizeof(ram->payload))
+    {
+        return -1;
+    }
+    memset(&ram->payload, 0, sizeof(ram->payload));
+    memcpy(&ram->payload, in_payload, in_length);
+    ma_api_wifi_storage_make_header(&ram->header, in_magic, in_version, &ram->payload, in_length, ram->header.sequence + 1);
+    ram->used = true;
+    return 0;
+}
+
+/**
+  * @Func       : test_ram_erase
+  * @brief      : erase of the RAM backend stTestRam[index]
+  * @pre-cond.  : None
+  * @post-cond. : No record
+  * @parameters : in_name: Name of the record
+  * @retval     : None
+  */
+template <uint8_t index> static void test_ram_erase(const char *in_name)
+{
+    (void)in_name;
+    stTestRam[index].used = false;
+}
+
+/**
+  * @Func       : test_slot_write
+  * @brief      : Writes the test record straight to the SPIFFS backend
+  * @pre-cond.  : None
+  * @post-cond. : The write succeeded
+  * @parameters : in_value: Value of the record
+  * @retval     : None
+  */
+static void test_slot_write(uint32_t in_value)
+{
+    st_test_record_t record = {in_value, "slot"};
+
+    CHECK_EQ(0, stStorageBackendSpiffs.write(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &record, sizeof(record)));
+}
+
+/**
+  * @Func       : test_slot_read
+  * @brief      : Reads the test record straight from the SPIFFS backend
+  * @pre-cond.  : None
+  * @post-cond. : The read succeeded
+  * @parameters : None
+  * @retval     : Value of the record
+  */
+static uint32_t test_slot_read(void)
+{
+    st_test_record_t copy;
+
+    CHECK_EQ(0, stStorageBackendSpiffs.read(DF_TEST_RECORD_NAME, DF_TEST_RECORD_MAGIC, DF_TEST_RECORD_VERSION, &copy, sizeof(copy)));
+    CHECK_STR("slot", copy.text);
+    return copy.value;
+}
+
+/**
+  * @Func       : test_file_flip_last_byte
+  * @brief      : Damages the payload of a slot file, as a bad flash cell would
+  * @pre-cond.  : SPIFFS is mounted
+  * @post-cond. : The last byte of the file is inverted
+  * @parameters : in_path: File of the slot
+  * @retval     : None
+  */
+static void test_file_flip_last_byte(const char *in_path)
+{
+    uint8_t data[sizeof(st_wifi_record_header_t) + sizeof(st_test_record_t)];
+
+    File file = SPIFFS.open(in_path, "r");
+    CHECK(file);
+    size_t length = file.read(data, sizeof(data));
+    file.close();
+    CHECK(length > 0);
+
+    data[length - 1] ^= 0xFF;
+    file = SPIFFS.open(in_path, "w");
+    CHECK_EQ(length, file.write(data, length));
+    file.close();
+}
+
+/**
+  * @Func       : test_profiles_seed
+  * @brief      : Saves "Home" and "Office" as a previous boot did, without the Api
+  * @pre-cond.  : The Api has not opened NVS
+  * @post-cond. : Profile record in NVS
+  * @parameters : None
+  * @retval     : None
+  */
+static void test_profiles_seed(void)
+{
+    st_wifi_profile_store_t store;
+    st_wifi_record_header_t header;
+    uint8_t blob[sizeof(header) + sizeof(store)];
+    Preferences preferences;
+
+    ma_api_wifi_profiles_clear(&store);
+    CHECK(ma_api_wifi_profiles_add(&store, "Home", 4, "password1", 9, DF_WIFI_PROFILE_DEFAULT_PRIORITY) >= 0);
+    CHECK(ma_api_wifi_profiles_add(&store, "Office", 6, "password2", 9, DF_WIFI_PROFILE_DEFAULT_PRIORITY) >= 0);
+    ma_api_wifi_storage_make_header(&header, DF_TEST_PROFILES_MAGIC, DF_TEST_PROFILES_VERSION, &store, sizeof(store), 0);
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), &store, sizeof(store));
+    CHECK(preferences.begin(DF_TEST_NVS_NAMESPACE, false));
+    CHECK_EQ(sizeof(blob), preferences.putBytes(DF_TEST_PROFILES_KEY, blob, sizeof(blob)));
+    preferences.end();
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,304 @@
+/**
+  ******************************************************************************
+  * @Company    : Mauro Almeida.
+  * @file       : test_stream.cpp
+  * @author     : Mauro Almeida
+  * @version	: V0.0
+  * @date       : 09/02/2024
+  * @brief      : Tests of the buffered output stream, on a client that records
+  *               the boundary of each write
+  ******************************************************************************
+*/
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "ma_test.h"
+#include "ma_api_wifi_stream.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DF_TEST_HEADERS                 "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n"
+#define DF_TEST_MAX_BODY                20000
+#define DF_TEST_MAX_PIECE               300     // Largest single write of the body
+
+/* Private typedef -----------------------------------------------------------*/
+// Client that keeps every byte and the size of every write it was given
+class ma_test_client_t : public Print
+{
+public:
+    using Print::write;
+    size_t write(uint8_t in_byte) override { return write(&in_byte, 1); }
+    size_t write(const uint8_t *in_buffer, size_t in_size) override
+    {
+        data.append((const char *)in_buffer, in_size);
+        writes.push_back(in_size);
+        return in_size;
+    }
+
+    std::string data;
+    std::vector<size_t> writes;
+};
+
+/* Private variables ---------------------------------------------------------*/
+static st_wifi_stream_t stTestStream;
+static uint32_t u32TestRandom = 88172645u;
+
+/* Private function prototypes -----------------------------------------------*/
+static std::string test_body(size_t in_length);
+static void test_write_body(const std::string &in_body);
+static std::string test_decode_response(const std::string &in_response, bool *out_chunked);
+static void test_check_segments(const ma_test_client_t &in_client);
+static uint32_t test_random(uint32_t in_range);
+
+/* Test cases ----------------------------------------------------------------*/
+TEST(body_of_every_length_is_framed)
+{
+    for (size_t length = 0; length <= DF_TEST_MAX_BODY; length++)
+    {
+        ma_test_client_t client;
+        std::string body = test_body(length);
+        bool chunked = false;
+
+        ma_api_wifi_stream_begin(&stTestStream, &client);
+        ma_api_wifi_stream_print(&stTestStream, DF_TEST_HEADERS);
+        ma_api_wifi_stream_start_body(&stTestStream);
+        test_write_body(body);
+        ma_api_wifi_stream_end(&stTestStream);
+
+        CHECK(test_decode_response(client.data, &chunked) == body);
+        test_check_segments(client);
+        if (strlen(DF_TEST_HEADERS) + length < DF_STREAM_TX_BUFFER_SIZE - DF_STREAM_CHUNK_TAIL_SIZE - DF_STREAM_FRAMING_SIZE)
+        {
+            // Ends before the first segment is full: Content-Length and a single write
+            CHECK(!chunked);
+            CHECK_EQ(1, client.writes.size());
+        }
+        else
+        {
+            CHECK(chunked);
+        }
+    }
+}
+
+TEST(forced_chunked_body_is_framed)
+{
+    for (size_t length = 0; length <= DF_TEST_MAX_BODY; length += 7)
+    {
+        ma_test_client_t client;
+        std::string body = test_body(length);
+        bool chunked = false;
+
+        ma_api_wifi_stream_begin(&stTestStream, &client);
+        ma_api_wifi_stream_print(&stTestStream, DF_TEST_HEADERS "Transfer-Encoding: chunked\r\n\r\n");
+        ma_api_wifi_stream_start_chunked(&stTestStream);
+        test_write_body(body);
+        ma_api_wifi_stream_end(&stTestStream);
+
+        CHECK(test_decode_response(client.data, &chunked) == body);
+        CHECK(chunked);
+        test_check_segments(client);
+    }
+}
+
+TEST(flush_ends_a_segment_early)
+{
+    ma_test_client_t client;
+    std::string body = test_body(5000);
+    bool chunked = false;
+
+    ma_api_wifi_stream_begin(&stTestStream, &client);
+    ma_api_wifi_stream_print(&stTestStream, DF_TEST_HEADERS);
+    ma_api_wifi_stream_start_body(&stTestStream);
+    ma_api_wifi_stream_write(&stTestStream, (const uint8_t *)body.data(), 100);
+    ma_api_wifi_stream_flush(&stTestStream);
+    CHECK_EQ(1, client.writes.size());
+    ma_api_wifi_stream_flush(&stTestStream);
+    CHECK_EQ(1, client.writes.size());
+    ma_api_wifi_stream_write(&stTestStream, (const uint8_t *)body.data() + 100, body.size() - 100);
+    ma_api_wifi_stream_end(&stTestStream);
+
+    // A flush before the body ended can not know its length
+    CHECK(test_decode_response(client.data, &chunked) == body);
+    CHECK(chunked);
+}
+
+TEST(headers_that_fill_a_segment)
+{
+    ma_test_client_t client;
+    std::string headers = DF_TEST_HEADERS "X-Padding: " + std::string(DF_STREAM_TX_BUFFER_SIZE, 'p') + "\r\n";
+    std::string body = test_body(3000);
+    bool chunked = false;
+
+    ma_api_wifi_stream_begin(&stTestStream, &client);
+    ma_api_wifi_stream_print(&stTestStream, headers.c_str());
+    ma_api_wifi_stream_start_body(&stTestStream);
+    test_write_body(body);
+    ma_api_wifi_stream_end(&stTestStream);
+
+    CHECK(test_decode_response(client.data, &chunked) == body);
+    CHECK(chunked);
+    CHECK(client.data.compare(0, headers.size(), headers) == 0);
+}
+
+TEST(known_length_body_is_not_copied)
+{
+    ma_test_client_t client;
+    std::string body = test_body(DF_TEST_MAX_BODY);
+
+    ma_api_wifi_stream_begin(&stTestStream, &client);
+    ma_api_wifi_stream_printf(&stTestStream, DF_TEST_HEADERS "Content-Length: %u\r\n\r\n", (unsigned)body.size());
+    ma_api_wifi_stream_flush(&stTestStream);
+    ma_api_wifi_stream_write(&stTestStream, (const uint8_t *)body.data(), body.size());
+    ma_api_wifi_stream_end(&stTestStream);
+
+    CHECK_EQ(2, client.writes.size());
+    CHECK_EQ(body.size(), client.writes[1]);
+    CHECK_EQ(2, stTestStream.writeCalls);
+    CHECK_EQ(2, stTestStream.segments);
+}
+
+/* Body of private functions -------------------------------------------------*/
+
+/**
+  * @Func       : test_body
+  * @brief      : Body whose bytes depend on their position, so a lost or repeated byte is seen
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_length: Length of the body
+  * @retval     : The body
+  */
+static std::string test_body(size_t in_length)
+{
+    std::string body(in_length, '\0');
+
+    for (size_t i = 0; i < in_length; i++)
+    {
+        body[i] = (char)('a' + (i * 7 + i / 26) % 26);
+    }
+    return body;
+}
+
+/**
+  * @Func       : test_write_body
+  * @brief      : Writes a body to stTestStream in pieces of random size, some of them with printf
+  * @pre-cond.  : The headers were written
+  * @post-cond. : None
+  * @parameters : in_body: The body
+  * @retval     : None
+  */
+static void test_write_body(const std::string &in_body)
+{
+    size_t offset = 0;
+
+    while (offset < in_body.size())
+    {
+        size_t piece = 1 + test_random(DF_TEST_MAX_PIECE);
+        if (piece > in_body.size() - offset)
+        {
+            piece = in_body.size() - offset;
+        }
+        if (test_random(4) == 0)
+        {
+            ma_api_wifi_stream_printf(&stTestStream, "%.*s", (int)piece, in_body.data() + offset);
+        }
+        else
+        {
+            ma_api_wifi_stream_write(&stTestStream, (const uint8_t *)in_body.data() + offset, piece);
+        }
+        offset += piece;
+    }
+}
+
+/**
+  * @Func       : test_decode_response
+  * @brief      : Takes the body out of a response, framed by Content-Length or by chunks.
+  *               The framing must end exactly at the end of the response.
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters :
+  *       - in_response: Everything the client received
+  *       - out_chunked: Set if the body was chunked
+  * @retval     : The body
+  */
+static std::string test_decode_response(const std::string &in_response, bool *out_chunked)
+{
+    size_t headersEnd = in_response.find("\r\n\r\n");
+    CHECK(headersEnd != std::string::npos);
+    std::string headers = in_response.substr(0, headersEnd + 2);
+    size_t position = headersEnd + 4;
+
+    size_t contentLength = headers.find("Content-Length: ");
+    *out_chunked = (headers.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+    CHECK((contentLength != std::string::npos) != *out_chunked);
+
+    if (!*out_chunked)
+    {
+        size_t length = strtoul(headers.c_str() + contentLength + 16, NULL, 10);
+        CHECK_EQ(in_response.size() - position, length);
+        return in_response.substr(position);
+    }
+
+    std::string body;
+    for (;;)
+    {
+        size_t lineEnd = in_response.find("\r\n", position);
+        CHECK(lineEnd != std::string::npos);
+        char *end = NULL;
+        size_t length = strtoul(in_response.c_str() + position, &end, 16);
+        CHECK(end == in_response.c_str() + lineEnd && lineEnd > position);
+        position = lineEnd + 2;
+        if (length == 0)
+        {
+            break;
+        }
+        CHECK(position + length + 2 <= in_response.size());
+        body.append(in_response, position, length);
+        CHECK(in_response.compare(position + length, 2, "\r\n") == 0);
+        position += length + 2;
+    }
+    CHECK(in_response.compare(position, std::string::npos, "\r\n") == 0);
+    return body;
+}
+
+/**
+  * @Func       : test_check_segments
+  * @brief      : Every write fits one TCP segment and only the last one may be short.
+  *               The counters of the stream agree with what the client saw.
+  * @pre-cond.  : ma_api_wifi_stream_end() was called
+  * @post-cond. : None
+  * @parameters : in_client: The client
+  * @retval     : None
+  */
+static void test_check_segments(const ma_test_client_t &in_client)
+{
+    for (size_t i = 0; i < in_client.writes.size(); i++)
+    {
+        CHECK(in_client.writes[i] <= DF_STREAM_TX_BUFFER_SIZE);
+        if (i + 1 < in_client.writes.size())
+        {
+            CHECK(in_client.writes[i] >= DF_STREAM_TX_BUFFER_SIZE - DF_STREAM_CHUNK_TAIL_SIZE);
+        }
+    }
+    CHECK_EQ(in_client.writes.size(), stTestStream.segments);
+    CHECK_EQ(in_client.data.size(), stTestStream.bytesSent);
+}
+
+/**
+  * @Func       : test_random
+  * @brief      : xorshift32, the same sequence on every run
+  * @pre-cond.  : None
+  * @post-cond. : None
+  * @parameters : in_range: Number of values
+  * @retval     : 0 to in_range - 1
+  */
+static uint32_t test_random(uint32_t in_range)
+{
+    u32TestRandom ^= u32TestRandom << 13;
+    u32TestRandom ^= u32TestRandom >> 17;
+    u32TestRandom ^= u32TestRandom << 5;
+    return u32TestRandom % in_range;
+}
+
+/*****************************END OF FILE**************************************/
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Builds ma_api_wifi_portal_page.h from portal/index.html.
+
+The page is gzip-compressed and stored as a constexpr byte array, so the
+firmware sends it from flash with a single write and no String temporaries.
+The ETag is derived from the compressed bytes, so it changes only when the
+page changes.
+
+Usage: python3 tools/build_portal_page.py
+"""
+
+import gzip
+import hashlib
+import os
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "portal", "index.html")
+OUTPUT = os.path.join(ROOT, "ma_api_wifi_portal_page.h")
+
+HEADER = """/**
+    ******************************************************************************
+    * @Company    : Mauro Almeida.
+    * @file       : ma_api_wifi_portal_page.h
+    * @author     : Mauro Almeida
+    * @version	  : V0.0
+    * @date       : 09/02/2024
+    * @brief      : Portal page, gzip-compressed. GENERATED FILE, DO NOT EDIT.
+    *               Edit portal/index.html and run tools/build_portal_page.py
+    ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MA_API_WIFI_PORTAL_PAGE_H
+#define __MA_API_WIFI_PORTAL_PAGE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Define --------------------------------------------------------------------*/
+#define DF_PORTAL_PAGE_ETAG             "\\"{etag}\\""
+#define DF_PORTAL_PAGE_RAW_SIZE         {raw_size}      // Size before compression
+
+/* Public objects ------------------------------------------------------------*/
+static constexpr uint8_t u8PortalPageGzip[{size}] = {{
+{data}
+}};
+
+#endif /* __MA_API_WIFI_PORTAL_PAGE_H */
+/*****************************END OF FILE**************************************/
+"""
+
+
+def main():
+    with open(SOURCE, "rb") as source:
+        raw = source.read()
+
+    # mtime=0 keeps the output identical between builds of the same page
+    compressed = gzip.compress(raw, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(compressed).hexdigest()[:16]
+
+    lines = []
+    for i in range(0, len(compressed), 16):
+        chunk = compressed[i:i + 16]
+        lines.append("  " + ", ".join("0x%02x" % b for b in chunk) + ",")
+
+    with open(OUTPUT, "w", newline="\n") as output:
+        output.write(HEADER.format(etag=etag, raw_size=len(raw), size=len(compressed),
+                                   data="\n".join(lines)))
+
+    print("%s: %d -> %d bytes, ETag %s" % (os.path.basename(OUTPUT), len(raw), len(compressed), etag))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Sends a scripted set of DNS queries to the captive portal responder.
+
+Each query is checked against the expected answer and its round trip is
+measured. Run it against the board, from a PC joined to the AP, or against
+ma_api_wifi_dns.cpp built on the PC and listening on a loopback port.
+
+Usage: python3 tools/dns_probe.py [server] [port] [expected_ip]
+       python3 tools/dns_probe.py 192.168.123.123
+       python3 tools/dns_probe.py 127.0.0.1 5353 192.168.123.123
+"""
+
+import socket
+import struct
+import sys
+import time
+
+TYPE_A = 1
+TYPE_AAAA = 28
+TYPE_ANY = 255
+
+# name, type, answer expected
+QUERIES = [
+    ("connectivitycheck.gstatic.com", TYPE_A, True),
+    ("captive.apple.com", TYPE_A, True),
+    ("www.msftconnecttest.com", TYPE_A, True),
+    ("detectportal.firefox.com", TYPE_A, True),
+    ("sobreiro.local", TYPE_ANY, True),
+    ("connectivitycheck.gstatic.com", TYPE_AAAA, False),
+]
+
+
+def build_query(query_id, name, qtype, edns=False):
+    header = struct.pack(">HHHHHH", query_id, 0x0100, 1, 0, 0, 1 if edns else 0)
+    question = b"".join(bytes([len(label)]) + label.encode() for label in name.split(".")) + b"\0"
+    question += struct.pack(">HH", qtype, 1)
+    # OPT record of EDNS, the responder must drop it from the answer
+    opt = b"\0" + struct.pack(">HHIH", 41, 1232, 0, 0) if edns else b""
+    return header + question + opt
+
+
+def check_answer(data, query_id, expect_answer, expected_ip):
+    if len(data) < 12:
+        return "short answer"
+    rid, flags, qdcount, ancount, nscount, arcount = struct.unpack(">HHHHHH", data[:12])
+    if rid != query_id or not flags & 0x8000 or flags & 0x000F:
+        return "bad header %04x" % flags
+    if qdcount != 1 or nscount or arcount:
+        return "bad counts"
+    if not expect_answer:
+        return None if ancount == 0 else "unexpected answer"
+    if ancount != 1 or socket.inet_ntoa(data[-4:]) != expected_ip:
+        return "wrong answer"
+    return None
+
+
+def main():
+    server = sys.argv[1] if len(sys.argv) > 1 else "192.168.123.123"
+    port = int(sys.argv[2]) if len(sys.argv) > 2 else 53
+    expected_ip = sys.argv[3] if len(sys.argv) > 3 else server
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(1.0)
+    failures = 0
+    latencies = []
+    for index, (name, qtype, expect_answer) in enumerate(QUERIES * 2):
+        query_id = 0x1000 + index
+        edns = index >= len(QUERIES)
+        start = time.perf_counter()
+        sock.sendto(build_query(query_id, name, qtype, edns), (server, port))
+        try:
+            data, _ = sock.recvfrom(512)
+        except socket.timeout:
+            error = "timeout"
+        else:
+            error = check_answer(data, query_id, expect_answer, expected_ip)
+        elapsed_ms = (time.perf_counter() - start) * 1000
+        latencies.append(elapsed_ms)
+        failures += error is not None
+        print("%-32s %-4s %-4s %7.2f ms  %s" % (name, {1: "A", 28: "AAAA", 255: "ANY"}[qtype],
+                                                 "edns" if edns else "", elapsed_ms, error or "ok"))
+
+    latencies.sort()
+    print("%d queries, %d failed, p50 %.2f ms, max %.2f ms" %
+          (len(latencies), failures, latencies[len(latencies) // 2], latencies[-1]))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
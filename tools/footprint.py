@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Reports the flash and RAM taken by each feature set of ma_api_wifi_config.h.
+
+example.cpp is built as a sketch with arduino-cli once per entry of
+CONFIGURATIONS, with its -D flags added to the C++ flags. The sizes come
+from the JSON output of arduino-cli and are written as a Markdown table,
+with the difference to the full build, so a change that grows the firmware
+shows up next to the feature it belongs to.
+
+Usage: python3 tools/footprint.py [--fqbn esp32:esp32:esp32] [--output footprint.md]
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# name, build flags. The first one is the reference of the differences.
+CONFIGURATIONS = [
+    ("full", ""),
+    ("no DNS", "-DDF_WIFI_FEATURE_DNS=0"),
+    ("no scan", "-DDF_WIFI_FEATURE_SCAN=0"),
+    ("one network", "-DDF_WIFI_FEATURE_PROFILES=0"),
+    ("no SPIFFS", "-DDF_WIFI_STORAGE_SPIFFS=0"),
+    ("minimal", "-DDF_WIFI_FEATURE_DNS=0 -DDF_WIFI_FEATURE_SCAN=0 -DDF_WIFI_FEATURE_PROFILES=0"),
+    ("metrics", "-DTRACE_ENABLE"),
+]
+
+
+def make_sketch(directory):
+    """Copies the Api into a sketch folder, example.cpp being the sketch."""
+    sketch = os.path.join(directory, "footprint")
+    os.mkdir(sketch)
+    shutil.copy(os.path.join(ROOT, "example.cpp"), os.path.join(sketch, "footprint.ino"))
+    for path in glob.glob(os.path.join(ROOT, "ma_api_wifi_*")):
+        shutil.copy(path, sketch)
+    return sketch
+
+
+def section_sizes(result):
+    """Returns (flash, ram) from the JSON of arduino-cli compile, older and newer layouts."""
+    sections = result.get("builder_result", result).get("executable_sections_size") or []
+    sizes = {section["name"]: section["size"] for section in sections}
+    return sizes.get("text", 0), sizes.get("data", 0)
+
+
+def build(sketch, build_path, fqbn, flags):
+    command = ["arduino-cli", "compile", "--fqbn", fqbn, "--format", "json", "--build-path", build_path,
+               "--build-property", "compiler.cpp.extra_flags=" + flags, sketch]
+    completed = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    if completed.returncode != 0:
+        sys.stderr.write(completed.stdout + completed.stderr)
+        raise SystemExit("build failed: %s" % (flags or "default flags"))
+    return section_sizes(json.loads(completed.stdout))
+
+
+def delta(value, reference):
+    return "%+d" % (value - reference) if value != reference else "0"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--fqbn", default="esp32:esp32:esp32", help="board of arduino-cli")
+    parser.add_argument("--output", default=os.path.join(ROOT, "footprint.md"), help="Markdown report")
+    arguments = parser.parse_args()
+
+    if shutil.which("arduino-cli") is None:
+        raise SystemExit("arduino-cli not found, install it and the esp32 core first")
+
+    rows = []
+    with tempfile.TemporaryDirectory() as directory:
+        sketch = make_sketch(directory)
+        for index, (name, flags) in enumerate(CONFIGURATIONS):
+            flash, ram = build(sketch, os.path.join(directory, "build%d" % index), arguments.fqbn, flags)
+            print("%-12s flash %8d  ram %7d" % (name, flash, ram))
+            rows.append((name, flags, flash, ram))
+
+    reference = rows[0]
+    lines = ["# Footprint on %s" % arguments.fqbn, "",
+             "| Configuration | Flags | Flash (bytes) | RAM (bytes) | Flash vs %s | RAM vs %s |" % (reference[0], reference[0]),
+             "| --- | --- | ---: | ---: | ---: | ---: |"]
+    for name, flags, flash, ram in rows:
+        lines.append("| %s | `%s` | %d | %d | %s | %s |" % (name, flags or "-", flash, ram,
+                                                         delta(flash, reference[2]), delta(ram, reference[3])))
+    with open(arguments.output, "w", newline="\n") as output:
+        output.write("\n".join(lines) + "\n")
+    print("written to %s" % arguments.output)
+
+
+if __name__ == "__main__":
+    main()
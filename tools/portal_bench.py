@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Replays a provisioning session against the portal and compares connection reuse.
+
+The requests a phone makes while provisioning (page, credentials, saved
+networks, scan, a few status polls) are sent three times: one connection
+per request with "Connection: close", one persistent connection, and one
+persistent connection with every request pipelined. For each mode the
+connections opened and the total time are printed. Each response must be
+framed by Content-Length or chunked encoding, or the reuse modes fail.
+
+--save adds /save_data with the network given, which makes the board join
+it, so the default session only reads.
+
+Usage: python3 tools/portal_bench.py [server] [port] [--rounds N] [--save SSID PASSWORD]
+       python3 tools/portal_bench.py 192.168.123.123
+"""
+
+import argparse
+import http.client
+import socket
+import time
+import urllib.parse
+
+SESSION = [
+    "/",
+    "/credentials.json",
+    "/profiles.json",
+    "/scan.json",
+    "/status.json",
+    "/status.json",
+    "/status.json",
+]
+
+
+class SharedFile:
+    """Gives every HTTPResponse the same buffered reader, so pipelined bytes are not lost.
+
+    HTTPResponse closes its file once the body is read, the reader must outlive it.
+    """
+
+    def __init__(self, sock):
+        self.file = sock.makefile("rb")
+
+    def makefile(self, *args, **kwargs):
+        return self
+
+    def close(self):
+        pass
+
+    def __getattr__(self, name):
+        return getattr(self.file, name)
+
+
+def request_bytes(host, path, close):
+    return ("GET %s HTTP/1.1\r\nHost: %s\r\nAccept-Encoding: gzip\r\n%s\r\n" %
+            (path, host, "Connection: close\r\n" if close else "")).encode()
+
+
+def read_response(shared, method="GET"):
+    response = http.client.HTTPResponse(shared, method=method)
+    response.begin()
+    body = response.read()
+    if response.status >= 400:
+        raise RuntimeError("status %d" % response.status)
+    return response, body
+
+
+def run_close(host, port, paths):
+    for path in paths:
+        with socket.create_connection((host, port), timeout=10) as sock:
+            sock.sendall(request_bytes(host, path, True))
+            read_response(SharedFile(sock))
+    return len(paths)
+
+
+def run_keep_alive(host, port, paths):
+    connections = 0
+    sock = None
+    for path in paths:
+        if sock is None:
+            sock = socket.create_connection((host, port), timeout=10)
+            shared = SharedFile(sock)
+            connections += 1
+        sock.sendall(request_bytes(host, path, False))
+        response, _ = read_response(shared)
+        if response.will_close:
+            sock.close()
+            sock = None
+    if sock is not None:
+        sock.close()
+    return connections
+
+
+def run_pipelined(host, port, paths):
+    with socket.create_connection((host, port), timeout=10) as sock:
+        sock.sendall(b"".join(request_bytes(host, path, False) for path in paths))
+        shared = SharedFile(sock)
+        for _ in paths:
+            response, _ = read_response(shared)
+            if response.will_close:
+                raise RuntimeError("closed by the server before the last pipelined request")
+    return 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("server", nargs="?", default="192.168.123.123")
+    parser.add_argument("port", nargs="?", type=int, default=80)
+    parser.add_argument("--rounds", type=int, default=5, help="sessions per mode, the median is printed")
+    parser.add_argument("--save", nargs=2, metavar=("SSID", "PASSWORD"), help="also send /save_data")
+    arguments = parser.parse_args()
+
+    paths = list(SESSION)
+    if arguments.save:
+        query = urllib.parse.urlencode({"ssid": arguments.save[0], "password": arguments.save[1]})
+        paths.insert(4, "/save_data?" + query)
+
+    modes = [("close", run_close), ("keep-alive", run_keep_alive), ("pipelined", run_pipelined)]
+    print("%d requests per session, %d sessions per mode" % (len(paths), arguments.rounds))
+    for name, run in modes:
+        times = []
+        connections = 0
+        for _ in range(arguments.rounds):
+            start = time.perf_counter()
+            try:
+                connections = run(arguments.server, arguments.port, paths)
+            except (OSError, RuntimeError, http.client.HTTPException) as error:
+                print("%-11s failed: %s" % (name, error))
+                break
+            times.append((time.perf_counter() - start) * 1000)
+        else:
+            times.sort()
+            print("%-11s %2d connections  median %8.1f ms  best %8.1f ms" %
+                  (name, connections, times[len(times) // 2], times[0]))
+
+
+if __name__ == "__main__":
+    main()